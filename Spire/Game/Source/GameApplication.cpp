@@ -13,6 +13,8 @@
 #include "Types/VoxelTypeInfo.h"
 #include "Types/VoxelTypeRegistry.h"
 #include "Utils/RaycastUtils.h"
+#include "Utils/SimulationThread.h"
+#include "Utils/VoxelCameraSnapshot.h"
 
 using namespace Spire;
 using namespace SpireVoxel;
@@ -41,6 +43,7 @@ void GameApplication::Start(Engine &engine) {
     }
 
     m_camera = std::make_unique<GameCamera>(engine, Camera::ControlScheme::Developer);
+    m_voxelCamera = std::make_unique<VoxelCameraSnapshot>(*m_camera);
     VoxelWorld::Settings voxelSettings = {
         .LoadBalanceMeshing = !Profiling::IS_PROFILING,
         .AllowFrustumCulling = true,
@@ -52,12 +55,12 @@ void GameApplication::Start(Engine &engine) {
         [this] { RecreatePipeline(); },
         std::move(proceduralGenerationProvider),
         std::move(proceduralGenerationController),
-        *m_camera,
+        *m_voxelCamera,
         voxelSettings
     );
 
     constexpr glm::vec3 CORNFLOWER_BLUE = {0.392, 0.584, 0.929};
-    m_voxelRenderer = std::make_unique<VoxelRenderer>(*m_engine, *m_camera, std::move(tempWorld), CORNFLOWER_BLUE, [](VoxelTypeRegistry &voxelTypeRegistry) {
+    m_voxelRenderer = std::make_unique<VoxelRenderer>(*m_engine, *m_voxelCamera, std::move(tempWorld), CORNFLOWER_BLUE, [](VoxelTypeRegistry &voxelTypeRegistry) {
         if (WORLD_NAME == std::string("Test8")) {
             RegisterMinecraftVoxelTypes(voxelTypeRegistry);
             info("Registered {} Minecraft voxel types", voxelTypeRegistry.GetTypes().size());
@@ -154,7 +157,7 @@ void GameApplication::Start(Engine &engine) {
 
     //  CuboidVoxelEdit({0, 0, 0}, {64, 64, 64}, 1).Apply(world);
     // world.GetRenderer().HandleChunkEdits();
-    //   for (VoxelType voxelType : world.GetLoadedChunk({0, 0, 0})->VoxelData) {
+    //   for (VoxelType voxelType : world.GetLoadedChunk({0, 0, 0})->GetVoxelData()) {
     //       assert(voxelType == 1);
     //   }
 
@@ -175,21 +178,21 @@ void GameApplication::Start(Engine &engine) {
 
     // Stress test: (big world)
     // should be profiling!!
-    // copies the current world n*n-1 times for a nxn region
+    // clones the current world n*n-1 times for a nxn region, the clones share voxel storage until they are edited
     //
-    // std::unordered_map<glm::ivec3, Chunk *> chunks;
+    // std::vector<glm::ivec3> sourceChunks;
     //
     // glm::ivec3 minChunkPos{INT32_MAX};
     // glm::ivec3 maxChunkPos{INT32_MIN};
     //
     // for (auto &[pos, chunk] : world) {
-    //     chunks.emplace(pos, chunk.get());
+    //     sourceChunks.push_back(pos);
     //
     //     minChunkPos = glm::min(minChunkPos, pos);
     //     maxChunkPos = glm::max(maxChunkPos, pos);
     // }
     //
-    // if (chunks.empty())
+    // if (sourceChunks.empty())
     //     return;
     //
     // glm::ivec3 worldSize = maxChunkPos - minChunkPos + glm::ivec3(1);
@@ -209,36 +212,12 @@ void GameApplication::Start(Engine &engine) {
     //             if (ox == 0 && oy == 0 && oz == 0)
     //                 continue;
     //
-    //             glm::ivec3 offset{ox, oy, oz};
-    //             glm::ivec3 baseDst = minChunkPos + offset * worldSize;
-    //
-    //             for (int i = 0; i < worldSize.x; ++i) {
-    //                 for (int j = 0; j < worldSize.y; ++j) {
-    //                     for (int k = 0; k < worldSize.z; ++k) {
-    //                         glm::ivec3 local{i, j, k};
-    //                         glm::ivec3 srcPos = minChunkPos + local;
-    //
-    //                         auto it = chunks.find(srcPos);
-    //                         if (it == chunks.end())
-    //                             continue;
-    //
-    //                         Chunk *src = it->second;
-    //
-    //                         glm::ivec3 dstPos = baseDst + local;
-    //                         Chunk &dst = world.LoadChunk(dstPos);
-    //
-    //                         dst.VoxelData = src->VoxelData;
-    //                         dst.VoxelBits = src->VoxelBits;
-    //
-    //                         world.GetRenderer().NotifyChunkEdited(dst);
-    //                     }
-    //                 }
-    //             }
+    //             world.CloneChunks(sourceChunks, glm::ivec3{ox, oy, oz} * worldSize);
     //         }
     //     }
     // }
 
-    m_profiling = std::make_unique<Profiling>(*m_engine, *m_voxelRenderer, *m_camera);
+    m_profiling = std::make_unique<Profiling>(*m_engine, *m_voxelRenderer, *m_camera, std::filesystem::path("Worlds") / WORLD_NAME);
 
     int numMeshesNotSupporing16BitIndices = 0;
     int maxVerticesInMesh = 0;
@@ -251,6 +230,11 @@ void GameApplication::Start(Engine &engine) {
         }
     }
     info("numMeshesNotSupporing16BitIndices: {}, maxVerticesInMesh {}, totalVertices: {}", numMeshesNotSupporing16BitIndices, maxVerticesInMesh, totalVertices);
+
+    PublishWorldInfo();
+    if (!Profiling::IS_PROFILING) {
+        m_simulation = std::make_unique<SimulationThread>([&world](std::thread::id ownerThread) { world.SetOwnerThread(ownerThread); }, [this] { Simulate(); });
+    }
 }
 
 GameApplication::~GameApplication() {
@@ -258,42 +242,89 @@ GameApplication::~GameApplication() {
 }
 
 void GameApplication::Cleanup() {
+    m_simulation.reset();
     m_voxelRenderer.reset();
 }
 
 void GameApplication::Update() {
-    m_voxelRenderer->Update();
+    // take the world back from the tick kicked last frame, the main thread owns it until the next Kick
+    if (m_simulation) m_simulation->Wait();
+    for (std::function<void()> &work : m_worldWork) work();
+    m_worldWork.clear();
     m_profiling->Update();
 
+    // the tick sees the camera as it was at the end of last frame
+    m_voxelCamera->Capture();
+    if (m_simulation) m_simulation->Kick();
+    else Simulate();
+
+    // everything from here until the next Wait runs alongside the tick, so it only reads what the last tick published
     m_camera->Update();
-    RaycastUtils::Hit hit = RaycastUtils::Raycast(m_voxelRenderer->GetWorld(), m_camera->GetCamera().GetPosition(), m_camera->GetCamera().GetForward(), 10);
+    m_worldInfo.Acquire();
+    const RaycastUtils::Hit &hit = m_worldInfo.GetFront().Hit;
     if (hit) {
-        Chunk *chunkOfHitVoxel = m_voxelRenderer->GetWorld().TryGetLoadedChunk(VoxelWorld::GetChunkPositionOfVoxel(hit.VoxelPosition));
-
-        if (m_engine->GetWindow().IsKeyPressed(GLFW_KEY_L) && chunkOfHitVoxel) {
-            glm::ivec3 adjacentVoxel = hit.VoxelPosition + FaceToDirection(hit.Face);
-            BasicVoxelEdit(BasicVoxelEdit::Edit{.Position = adjacentVoxel, .Type = 1}).Apply(m_voxelRenderer->GetWorld());
+        if (m_engine->GetWindow().IsKeyPressed(GLFW_KEY_L)) {
+            m_worldWork.emplace_back([this, adjacentVoxel = hit.VoxelPosition + FaceToDirection(hit.Face)] {
+                BasicVoxelEdit edit(BasicVoxelEdit::Edit{.Position = adjacentVoxel, .Type = 1});
+                m_profiling->ApplyEdit(edit);
+            });
         }
 
-        if (m_engine->GetWindow().IsKeyPressed(GLFW_KEY_K) && chunkOfHitVoxel) {
-            BasicVoxelEdit(BasicVoxelEdit::Edit{.Position = hit.VoxelPosition, .Type = 0}).Apply(m_voxelRenderer->GetWorld());
+        if (m_engine->GetWindow().IsKeyPressed(GLFW_KEY_K)) {
+            m_worldWork.emplace_back([this, voxelPosition = hit.VoxelPosition] {
+                BasicVoxelEdit edit(BasicVoxelEdit::Edit{.Position = voxelPosition, .Type = 0});
+                m_profiling->ApplyEdit(edit);
+            });
         }
     }
 }
 
+void GameApplication::Simulate() {
+    m_voxelRenderer->Update();
+    PublishWorldInfo();
+}
+
+void GameApplication::PublishWorldInfo() {
+    VoxelWorld &world = m_voxelRenderer->GetWorld();
+    WorldInfo &worldInfo = m_worldInfo.GetBack();
+
+    // what the camera the tick saw is looking at, edited by the input next frame
+    worldInfo.Hit = RaycastUtils::Raycast(world, m_voxelCamera->GetPosition(), m_voxelCamera->GetForward(), 10);
+    worldInfo.TargetedVoxelType = worldInfo.Hit ? world.GetVoxelAt(worldInfo.Hit.VoxelPosition) : 0;
+    worldInfo.NumChunksGeneratedThisFrame = world.GetProceduralGenerationManager().NumChunksGeneratedThisFrame();
+    worldInfo.NumLoadedChunks = world.NumLoadedChunks();
+    worldInfo.CPUMemoryUsageForChunks = world.CalculateCPUMemoryUsageForChunks();
+    worldInfo.GPUMemoryUsageForChunks = world.CalculateGPUMemoryUsageForChunks();
+    worldInfo.ResidencyStats = world.GetResidencyManager().GetStats();
+    worldInfo.NumActiveChunks = world.GetTickSystem().NumActiveChunks();
+    worldInfo.TickStats = world.GetTickSystem().GetStats();
+
+    worldInfo.TotalRenderedVoxelFaces = 0;
+    for (auto &[chunkPos,chunk] : world) {
+        worldInfo.TotalRenderedVoxelFaces += chunk->TotalRenderedVoxelFaces;
+    }
+
+    worldInfo.NumNonEmptyChunks = world.GetRenderer().GetNumNonEmptyChunks();
+    worldInfo.NumChunksOutsideFrustum = world.GetRenderer().GetNumChunksOutsideFrustum();
+    worldInfo.NumBackfaceCulledFaces = world.GetRenderer().GetNumBackfaceCulledFaces();
+    worldInfo.NumNonBackfaceCulledFaces = world.GetRenderer().GetNumNonBackfaceCulledFaces();
+    m_worldInfo.Publish();
+}
+
 void GameApplication::Render() {
     m_frame++;
 
     auto &rm = m_engine->GetRenderingManager();
 
+    // the ui only reads what the last tick published and defers anything that edits the world
+    RenderUi();
+
     m_swapchainImageIndex = rm.GetQueue().AcquireNextImage();
     if (m_swapchainImageIndex == rm.GetQueue().INVALID_IMAGE_INDEX) return;
 
     VkCommandBuffer commandBuffer = m_voxelRenderer->Render(m_swapchainImageIndex);
     if (commandBuffer == VK_NULL_HANDLE) return;
 
-    RenderUi();
-
     std::array commandBuffersToSubmit = {
         rm.GetRenderer().GetBeginRenderingCommandBuffer(m_swapchainImageIndex),
         commandBuffer,
@@ -305,7 +336,7 @@ void GameApplication::Render() {
     rm.GetQueue().Present(m_swapchainImageIndex);
 }
 
-void GameApplication::RenderUi() const {
+void GameApplication::RenderUi() {
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
 
@@ -318,22 +349,22 @@ void GameApplication::RenderUi() const {
 
     ImGui::Text("Initial World: %s", WORLD_NAME);
 
-    glm::u32 numChunksGeneratedThisFrame = m_voxelRenderer->GetWorld().GetProceduralGenerationManager().NumChunksGeneratedThisFrame();
-    if (numChunksGeneratedThisFrame) {
-        ImGui::TextColored({1, 0, 0, 1}, "Generated %d chunks this frame", numChunksGeneratedThisFrame);
+    const WorldInfo &worldInfo = m_worldInfo.GetFront();
+    if (worldInfo.NumChunksGeneratedThisFrame) {
+        ImGui::TextColored({1, 0, 0, 1}, "Generated %d chunks this frame", worldInfo.NumChunksGeneratedThisFrame);
     }
 
     const CameraInfo &cameraInfo = m_camera->GetCameraInfo();
     glm::vec3 forward = m_camera->GetCamera().GetForward();
     std::string targetedVoxelStr = "None";
-    RaycastUtils::Hit hit = RaycastUtils::Raycast(m_voxelRenderer->GetWorld(), m_camera->GetCamera().GetPosition(), forward, 10);
+    const RaycastUtils::Hit &hit = worldInfo.Hit;
     if (hit) {
         targetedVoxelStr = std::format(
             "({}, {}, {}), Voxel Type: {}, Targeted Face: {}",
             hit.VoxelPosition.x,
             hit.VoxelPosition.y,
             hit.VoxelPosition.z,
-            m_voxelRenderer->GetWorld().GetVoxelAt(hit.VoxelPosition),
+            worldInfo.TargetedVoxelType,
             FaceToString(hit.Face)
         );
     } else if (hit.TerminatedInLODChunk) {
@@ -346,12 +377,14 @@ void GameApplication::RenderUi() const {
     else ImGui::Text("Facing %s Z", forward.z > 0 ? "Positive" : "Negative");
 
     if (ImGui::Button("Remesh All Chunks")) {
-        MergedVoxelEdit edit;
-        for (auto &[_,chunk] : m_voxelRenderer->GetWorld()) {
-            VoxelType newVoxelType = chunk->VoxelData[0] == 0 ? 1 : 0;
-            edit.With(BasicVoxelEdit{{chunk->ChunkPosition * SPIRE_VOXEL_CHUNK_SIZE}, newVoxelType});
-        }
-        edit.Apply(m_voxelRenderer->GetWorld());
+        m_worldWork.emplace_back([this] {
+            MergedVoxelEdit edit;
+            for (auto &[_,chunk] : m_voxelRenderer->GetWorld()) {
+                VoxelType newVoxelType = chunk->GetVoxelData()[0] == 0 ? 1 : 0;
+                edit.With(BasicVoxelEdit{{chunk->ChunkPosition * SPIRE_VOXEL_CHUNK_SIZE}, newVoxelType});
+            }
+            edit.Apply(m_voxelRenderer->GetWorld());
+        });
     }
 
     glm::vec3 cameraPos = m_camera->GetCamera().GetPosition();
@@ -359,41 +392,60 @@ void GameApplication::RenderUi() const {
     glm::ivec3 chunkPos = {glm::floor(cameraPos.x / SPIRE_VOXEL_CHUNK_SIZE), glm::floor(cameraPos.y / SPIRE_VOXEL_CHUNK_SIZE), glm::floor(cameraPos.z / SPIRE_VOXEL_CHUNK_SIZE)};
     ImGui::Text("Chunk Position %d, %d, %d (Voxel Position %d, %d, %d)", chunkPos.x, chunkPos.y, chunkPos.z, cameraPosInt.x, cameraPosInt.y, cameraPosInt.z);
 
-    ImGui::Text("Chunks Loaded: %d / %d (%d MB RAM / %d MB VRAM)", m_voxelRenderer->GetWorld().NumLoadedChunks(), VoxelWorldRenderer::MAXIMUM_LOADED_CHUNKS,
-                static_cast<glm::u64>(std::ceil(static_cast<double>(m_voxelRenderer->GetWorld().CalculateCPUMemoryUsageForChunks()) / 1024.0 / 1024.0)),
-                static_cast<glm::u64>(std::ceil(static_cast<double>(m_voxelRenderer->GetWorld().CalculateGPUMemoryUsageForChunks()) / 1024.0 / 1024.0))
+    ImGui::Text("Chunks Loaded: %d / %d (%d MB RAM / %d MB VRAM)", worldInfo.NumLoadedChunks, VoxelWorldRenderer::MAXIMUM_LOADED_CHUNKS,
+                static_cast<glm::u64>(std::ceil(static_cast<double>(worldInfo.CPUMemoryUsageForChunks) / 1024.0 / 1024.0)),
+                static_cast<glm::u64>(std::ceil(static_cast<double>(worldInfo.GPUMemoryUsageForChunks) / 1024.0 / 1024.0))
     );
 
-    glm::u64 totalRenderedVoxelFaces = 0;
-    for (auto &[chunkPos,chunk] : m_voxelRenderer->GetWorld()) {
-        totalRenderedVoxelFaces += chunk->TotalRenderedVoxelFaces;
+    const ChunkResidencyManager::Stats &residencyStats = worldInfo.ResidencyStats;
+    ImGui::Text("Compressed Chunks: %llu (%.1fx smaller), Hits: %llu, Misses: %llu", residencyStats.CompressedChunks, residencyStats.GetCompressionRatio(),
+                residencyStats.Hits, residencyStats.Misses);
+    ImGui::Text("Paged Out Chunks: %llu, Evictions: %llu, Page Ins: %llu", residencyStats.PagedOutChunks, residencyStats.Evictions, residencyStats.Swap.PageIns);
+
+    ImGui::Text("Active Chunks: %llu, Last Tick: %u chunks in %.2f ms, Voxels Written: %llu", static_cast<glm::u64>(worldInfo.NumActiveChunks),
+                worldInfo.TickStats.LastChunksTicked, worldInfo.TickStats.LastTickMillis, worldInfo.TickStats.VoxelsWritten);
+
+    if (ImGui::CollapsingHeader("Memory")) {
+        MemoryAccounting::Report memoryReport = MemoryAccounting::Instance().GetReport();
+        ImGui::Text("Total: %.1f MB RAM / %.1f MB VRAM", static_cast<double>(memoryReport.GetCPUBytes()) / 1024.0 / 1024.0,
+                    static_cast<double>(memoryReport.GetGPUBytes()) / 1024.0 / 1024.0);
+        for (std::size_t i = 0; i < MemoryAccounting::NUM_CATEGORIES; i++) {
+            auto category = static_cast<MemoryCategory>(i);
+            ImGui::Text("%s %s: %.1f MB (peak %.1f MB)", MemoryAccounting::IsGPUCategory(category) ? "GPU" : "CPU", MemoryAccounting::GetCategoryName(category),
+                        static_cast<double>(memoryReport.Categories[i].Bytes) / 1024.0 / 1024.0,
+                        static_cast<double>(memoryReport.Categories[i].PeakBytes) / 1024.0 / 1024.0);
+        }
+        if (ImGui::Button("Write memory.json")) {
+            MemoryAccounting::Instance().WriteJSON("memory.json");
+        }
     }
-    ImGui::Text("Total rendered voxel faces: %d", totalRenderedVoxelFaces);
+
+    ImGui::Text("Total rendered voxel faces: %d", worldInfo.TotalRenderedVoxelFaces);
 
     if (m_voxelRenderer->GetWorld().GetSettings().AllowFrustumCulling) {
-        int nonEmpty = m_voxelRenderer->GetWorld().GetRenderer().GetNumNonEmptyChunks();
+        int nonEmpty = worldInfo.NumNonEmptyChunks;
         ImGui::Text("Frustum culled %d of %d non-empty chunks (%.1f%%)",
-                    m_voxelRenderer->GetWorld().GetRenderer().GetNumChunksOutsideFrustum(),
+                    worldInfo.NumChunksOutsideFrustum,
                     nonEmpty,
-                    nonEmpty == 0 ? 0.0f : 100 * m_voxelRenderer->GetWorld().GetRenderer().GetNumChunksOutsideFrustum() / static_cast<float>(nonEmpty)
+                    nonEmpty == 0 ? 0.0f : 100 * worldInfo.NumChunksOutsideFrustum / static_cast<float>(nonEmpty)
         );
     } else {
         ImGui::TextColored(ImVec4{1, 0, 0, 1}, "Frustum culling is disabled!");
     }
 
     if (m_voxelRenderer->GetWorld().GetSettings().AllowBackfaceCulling) {
-        int total = m_voxelRenderer->GetWorld().GetRenderer().GetNumBackfaceCulledFaces() + m_voxelRenderer->GetWorld().GetRenderer().GetNumNonBackfaceCulledFaces();
+        int total = worldInfo.NumBackfaceCulledFaces + worldInfo.NumNonBackfaceCulledFaces;
         ImGui::Text(
             "Backface culling culled %d of %d faces (%.1f%%) (excluding already culled chunks)",
-            m_voxelRenderer->GetWorld().GetRenderer().GetNumBackfaceCulledFaces(),
+            worldInfo.NumBackfaceCulledFaces,
             total,
-            total == 0 ? 0.0f : 100 * m_voxelRenderer->GetWorld().GetRenderer().GetNumBackfaceCulledFaces() / static_cast<float>(total)
+            total == 0 ? 0.0f : 100 * worldInfo.NumBackfaceCulledFaces / static_cast<float>(total)
         );
     } else {
         ImGui::TextColored(ImVec4{1, 0, 0, 1}, "Backface culling is disabled!");
     }
 
-    m_profiling->RenderUI();
+    m_profiling->RenderUI(m_worldWork);
 
     if (ImGui::CollapsingHeader("Camera")) {
         glm::vec3 cameraForward = glm::normalize(m_camera->GetCamera().GetForward());
@@ -431,22 +483,24 @@ void GameApplication::RenderUi() const {
         chanceToLOD = std::clamp(chanceToLOD, 0.0f, 1.0f);
 
         if (ImGui::Button("Generate New LOD")) {
-            Timer timer;
-            auto &world = m_voxelRenderer->GetWorld();
-            std::vector<Chunk *> chunks;
-            glm::u32 originalNumChunks = world.NumLoadedChunks();
-            for (auto &[chunkCoords,chunk] : world) {
-                bool shouldLOD = m_engine->GetRandom().RandomFloat() < chanceToLOD;
-                if (chunkCoords.x % newLod == 0 && (chunkCoords.y + 1 /*Test5 starts at chunk y = -1*/) % newLod == 0 && chunkCoords.z % newLod == 0 && shouldLOD) {
-                    chunks.push_back(chunk.get());
+            m_worldWork.emplace_back([this] {
+                Timer timer;
+                auto &world = m_voxelRenderer->GetWorld();
+                std::vector<Chunk *> chunks;
+                glm::u32 originalNumChunks = world.NumLoadedChunks();
+                for (auto &[chunkCoords,chunk] : world) {
+                    bool shouldLOD = m_engine->GetRandom().RandomFloat() < chanceToLOD;
+                    if (chunkCoords.x % newLod == 0 && (chunkCoords.y + 1 /*Test5 starts at chunk y = -1*/) % newLod == 0 && chunkCoords.z % newLod == 0 && shouldLOD) {
+                        chunks.push_back(chunk.get());
+                    }
                 }
-            }
-            for (Chunk *chunk : chunks) {
-                world.GetLODManager().IncreaseLODTo(*chunk, newLod);
-            }
-            glm::u32 numConverted = chunks.size() + (originalNumChunks - world.NumLoadedChunks());
-            info("{} of {} chunks converted to new LOD {} (requested {}%) in {} ms.", numConverted, originalNumChunks, newLod, static_cast<int>(chanceToLOD * 100),
-                 timer.MillisSinceStart());
+                for (Chunk *chunk : chunks) {
+                    world.GetLODManager().IncreaseLODTo(*chunk, newLod);
+                }
+                glm::u32 numConverted = chunks.size() + (originalNumChunks - world.NumLoadedChunks());
+                info("{} of {} chunks converted to new LOD {} (requested {}%) in {} ms.", numConverted, originalNumChunks, newLod, static_cast<int>(chanceToLOD * 100),
+                     timer.MillisSinceStart());
+            });
             canLOD = false;
         }
     }
@@ -469,5 +523,6 @@ void GameApplication::OnWindowResize() const {
 }
 
 void GameApplication::RecreatePipeline() {
-    m_voxelRenderer->RecreatePipeline();
+    // called by the buffer allocators, which can grow on the simulation thread
+    m_voxelRenderer->RequestRecreatePipeline();
 }
@@ -2,9 +2,16 @@
 
 #include "Profiling.h"
 #include "SpireVoxelRenderer.h"
+#include "Utils/RaycastUtils.h"
+#include "Utils/TripleBuffer.h"
 
 class GameCamera;
 
+namespace SpireVoxel {
+    class SimulationThread;
+    class VoxelCameraSnapshot;
+}
+
 class GameApplication final : public Spire::Application {
 public:
     GameApplication();
@@ -20,7 +27,7 @@ public:
 
     void Render() override;
 
-    void RenderUi() const;
+    void RenderUi();
 
     [[nodiscard]] bool ShouldClose() const override;
 
@@ -29,13 +36,40 @@ public:
     void OnWindowResize() const override;
 
 private:
+    // What the UI shows about the world, published by every tick so the main thread doesn't read the world while it's simulated
+    struct WorldInfo {
+        SpireVoxel::RaycastUtils::Hit Hit = {}; // what the camera looked at when the tick started
+        SpireVoxel::VoxelType TargetedVoxelType = 0;
+        glm::u32 NumChunksGeneratedThisFrame = 0;
+        std::size_t NumLoadedChunks = 0;
+        glm::u64 CPUMemoryUsageForChunks = 0;
+        glm::u64 GPUMemoryUsageForChunks = 0;
+        SpireVoxel::ChunkResidencyManager::Stats ResidencyStats = {};
+        std::size_t NumActiveChunks = 0;
+        SpireVoxel::ChunkTickSystem::Stats TickStats = {};
+        glm::u64 TotalRenderedVoxelFaces = 0;
+        glm::u32 NumNonEmptyChunks = 0;
+        glm::u32 NumChunksOutsideFrustum = 0;
+        glm::u32 NumBackfaceCulledFaces = 0;
+        glm::u32 NumNonBackfaceCulledFaces = 0;
+    };
+
+    // One world tick, on the simulation thread unless profiling
+    void Simulate();
+
+    void PublishWorldInfo();
+
     void RecreatePipeline();
 
 private:
     Spire::Engine *m_engine = nullptr;
     std::unique_ptr<GameCamera> m_camera;
+    std::unique_ptr<SpireVoxel::VoxelCameraSnapshot> m_voxelCamera; // what the world sees of m_camera, captured once a frame while the main thread owns the world
     std::unique_ptr<SpireVoxel::VoxelRenderer> m_voxelRenderer;
     std::unique_ptr<Profiling> m_profiling;
+    std::unique_ptr<SpireVoxel::SimulationThread> m_simulation; // null when profiling so frames are measured on one thread
+    Spire::TripleBuffer<WorldInfo> m_worldInfo; // written by Simulate, read by the main thread
+    std::vector<std::function<void()> > m_worldWork; // input and UI actions that touch the world, run at the start of the next frame while the main thread owns it
     glm::u32 m_frame = 0;
     glm::u32 m_swapchainImageIndex = 0;
 };
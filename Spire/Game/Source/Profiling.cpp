@@ -2,16 +2,21 @@
 
 #include "GameCamera.h"
 #include "Chunk/VoxelWorld.h"
+#include "Edits/BatchedVoxelEdit.h"
+#include "Edits/EditReplay.h"
+#include "Serialisation/VoxelSerializer.h"
 
 using namespace Spire;
 
 Profiling::Profiling(
     Engine &engine,
     SpireVoxel::VoxelRenderer &voxelRenderer,
-    GameCamera &camera)
+    GameCamera &camera,
+    std::filesystem::path worldDirectory)
     : m_engine(engine),
       m_voxelRenderer(voxelRenderer),
-      m_camera(camera) {
+      m_camera(camera),
+      m_worldDirectory(std::move(worldDirectory)) {
     if constexpr (BEGIN_PROFILING_AUTOMATICALLY) {
         m_profilingStartedFrame = 1;
     }
@@ -42,7 +47,8 @@ void Profiling::Update() {
 
     if (profileStrategy.Dynamic == ProfileStrategy::DYNAMIC) {
         for (auto &[_,chunk] : world) {
-            chunk->VoxelData[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(1, 1, 1)] = chunk->VoxelData[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(1, 1, 1)] == 0 ? 1 : 0;
+            glm::u32 index = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(1, 1, 1);
+            chunk->SetVoxel(index, chunk->GetVoxelData()[index] == 0 ? 1 : 0);
             world.GetRenderer().NotifyChunkEdited(*chunk);
         }
     } else {
@@ -78,14 +84,38 @@ void Profiling::Update() {
     }
 }
 
-void Profiling::RenderUI() {
+void Profiling::RenderUI(std::vector<std::function<void()> > &worldWork) {
     if constexpr (!BEGIN_PROFILING_AUTOMATICALLY) {
         if (ImGui::CollapsingHeader("Profiling")) {
             if (m_profilingStartedFrame > 0) {
                 ImGui::Text("Profiling Started");
             } else {
                 if (ImGui::Button("Begin Profiling")) {
-                    m_profilingStartedFrame = m_voxelRenderer.GetCurrentFrame();
+                    worldWork.emplace_back([this] { m_profilingStartedFrame = m_voxelRenderer.GetCurrentFrame(); });
+                }
+            }
+
+            if (ImGui::Button("Benchmark 1M random voxel edits")) {
+                worldWork.emplace_back([this] { BenchmarkPointEdits(); });
+            }
+
+            if (m_editRecording) {
+                ImGui::Text("Recorded %zu edits", m_editRecording->GetEdits().size());
+                if (ImGui::Button("Stop recording edits")) {
+                    m_editRecording->Save(EDIT_RECORDING_PATH);
+                    info("Saved {} recorded edits ({} voxels) to {}", m_editRecording->GetEdits().size(), m_editRecording->CountWrittenVoxels(), EDIT_RECORDING_PATH);
+                    m_editRecording.reset();
+                }
+            } else if (ImGui::Button("Record edits")) {
+                m_editRecording = std::make_unique<SpireVoxel::EditRecording>();
+            }
+
+            if (!m_editRecording) {
+                if (ImGui::Button("Replay recorded edits (no GPU upload)")) {
+                    worldWork.emplace_back([this] { BenchmarkEditReplay(false); });
+                }
+                if (ImGui::Button("Replay recorded edits")) {
+                    worldWork.emplace_back([this] { BenchmarkEditReplay(true); });
                 }
             }
 
@@ -106,3 +136,76 @@ void Profiling::RenderUI() {
         }
     }
 }
+
+void Profiling::BenchmarkPointEdits() {
+    static constexpr glm::u32 NUM_EDITS = 1000000;
+    SpireVoxel::VoxelWorld &world = m_voxelRenderer.GetWorld();
+
+    // LOD chunks can't be edited
+    std::vector<glm::ivec3> chunkPositions;
+    for (auto &[chunkPosition, chunk] : world) {
+        if (chunk->LOD.Scale == 1) chunkPositions.push_back(chunkPosition);
+    }
+    if (chunkPositions.empty()) {
+        warn("Can't benchmark voxel edits without any loaded chunks");
+        return;
+    }
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<std::size_t> chunkDistribution(0, chunkPositions.size() - 1);
+    std::uniform_int_distribution<glm::u32> voxelDistribution(0, SPIRE_VOXEL_CHUNK_SIZE - 1);
+
+    // toggle each voxel so every edit is a real write, then the batched edit puts the original voxels back
+    std::vector<SpireVoxel::BasicVoxelEdit::Edit> toggled;
+    std::vector<SpireVoxel::BasicVoxelEdit::Edit> original;
+    toggled.reserve(NUM_EDITS);
+    original.reserve(NUM_EDITS);
+    for (glm::u32 i = 0; i < NUM_EDITS; i++) {
+        glm::ivec3 chunkPosition = chunkPositions[chunkDistribution(random)];
+        glm::ivec3 position = SpireVoxel::VoxelWorld::GetWorldVoxelPositionInChunk(chunkPosition, {
+                                                                                       voxelDistribution(random), voxelDistribution(random), voxelDistribution(random)
+                                                                                   });
+        SpireVoxel::VoxelType type = world.GetVoxelAt(position);
+        toggled.push_back({position, static_cast<SpireVoxel::VoxelType>(type == 0 ? 1 : 0)});
+        original.push_back({position, type});
+    }
+
+    Timer basicTimer;
+    SpireVoxel::BasicVoxelEdit(toggled).Apply(world);
+    float basicMillis = basicTimer.MillisSinceStart();
+
+    Timer batchedTimer;
+    SpireVoxel::BatchedVoxelEdit(original).Apply(world);
+    float batchedMillis = batchedTimer.MillisSinceStart();
+
+    info("{} random voxel edits across {} chunks: BasicVoxelEdit {} ms, BatchedVoxelEdit {} ms ({}x faster)",
+         NUM_EDITS, chunkPositions.size(), basicMillis, batchedMillis, basicMillis / std::max(batchedMillis, 0.001f));
+}
+
+void Profiling::ApplyEdit(SpireVoxel::IVoxelEdit &edit) {
+    if (m_editRecording) {
+        m_editRecording->Apply(m_voxelRenderer.GetWorld(), edit);
+    } else {
+        edit.Apply(m_voxelRenderer.GetWorld());
+    }
+}
+
+void Profiling::BenchmarkEditReplay(bool uploadToGPU) {
+    std::optional<SpireVoxel::EditRecording> recording = SpireVoxel::EditRecording::Load(EDIT_RECORDING_PATH);
+    if (!recording) return;
+
+    // edits are recorded as the voxels they changed so they must be replayed against the world they were recorded in
+    SpireVoxel::VoxelWorld &world = m_voxelRenderer.GetWorld();
+    SpireVoxel::VoxelSerializer::ClearAndDeserialize(world, m_worldDirectory);
+
+    SpireVoxel::NullChunkMeshUploader nullUploader;
+    SpireVoxel::RendererChunkMeshUploader rendererUploader(world.GetRenderer());
+    SpireVoxel::IChunkMeshUploader &uploader = uploadToGPU ? static_cast<SpireVoxel::IChunkMeshUploader &>(rendererUploader) : nullUploader;
+    SpireVoxel::EditReplay::Result result = SpireVoxel::EditReplay::Replay(world, *recording, uploader);
+
+    info("Replayed {} edits against {} ({}): {}", result.NumEdits, m_worldDirectory.string(), uploadToGPU ? "GPU upload" : "no GPU upload", result.ToJson());
+    if (!uploadToGPU) {
+        // the GPU still has the meshes from before the replay
+        for (auto &[_, chunk] : world) world.GetRenderer().NotifyChunkEdited(*chunk);
+    }
+}
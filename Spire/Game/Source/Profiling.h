@@ -2,19 +2,32 @@
 
 #include "GameCamera.h"
 #include "VoxelRenderer.h"
+#include "Edits/EditRecording.h"
 
 class Profiling {
 public:
     explicit Profiling(
         Spire::Engine &engine,
         SpireVoxel::VoxelRenderer &voxelRenderer,
-        GameCamera &camera
+        GameCamera &camera,
+        std::filesystem::path worldDirectory
     );
 
 public:
     void Update();
 
-    void RenderUI();
+    // Buttons that touch the world add their work to worldWork, to be run while the main thread owns the world
+    void RenderUI(std::vector<std::function<void()> > &worldWork);
+
+    // Write 1M random voxels in loaded chunks with BasicVoxelEdit then write them back with BatchedVoxelEdit, logs the time taken by each
+    void BenchmarkPointEdits();
+
+    // Apply an edit made by the player, recorded if recording edits
+    void ApplyEdit(SpireVoxel::IVoxelEdit &edit);
+
+    // Reload the world from disk then replay the saved edit recording through the whole edit path, logs the percentiles of each stage
+    // Without uploadToGPU the meshes are only copied on the CPU (NullChunkMeshUploader)
+    void BenchmarkEditReplay(bool uploadToGPU);
 
 public:
     struct ProfileStrategy {
@@ -27,6 +40,7 @@ public:
     };
 
     static constexpr const char *PROFILE_WORLD_NAME = "Test8";
+    static constexpr const char *EDIT_RECORDING_PATH = "Worlds/EditRecording.sprve";
 
     static constexpr ProfileStrategy PROFILE_STATIC = {ProfileStrategy::STATIC, 10000};
     static constexpr ProfileStrategy PROFILE_STATIC_1000 = {ProfileStrategy::STATIC, 1000};
@@ -51,4 +65,6 @@ private:
     Spire::Timer m_timeSinceBeginProfiling;
     glm::u32 m_profilingStartedFrame = 0;
     GameCamera &m_camera;
+    std::filesystem::path m_worldDirectory;
+    std::unique_ptr<SpireVoxel::EditRecording> m_editRecording; // null when not recording
 };
@@ -42,4 +42,5 @@
 #include "Utils/Timer.h"
 #include "Utils/Log.h"
 #include "Utils/Hashing.h"
+#include "Utils/MemoryAccounting.h"
 #include "Utils/Delegates/DelegateSubscriber.h"
\ No newline at end of file
@@ -42,12 +42,14 @@ namespace Spire {
      glm::u32 numSwapchainImages,
      std::size_t sizePerInternalBuffer,
      glm::u32 numInternalBuffers,
-     bool canResize
+     bool canResize,
+     MemoryCategory category
  ) : m_renderingManager(renderingManager),
      m_elementSize(elementSize),
      m_numSwapchainImages(numSwapchainImages),
      m_recreatePipelineCallback(recreatePipelineCallback),
-    m_canResize(canResize){
+    m_canResize(canResize),
+    m_category(category) {
 
         // Get max buffer size
         VkDeviceSize maxBufferSize =
@@ -149,16 +151,21 @@ namespace Spire {
         std::unique_lock lock(m_mutex);
         assert(m_allocations.contains(location));
         m_pendingFreesMade++;
-        m_allocationsPendingFree.push_back({location, m_numSwapchainImages - 1});
+        // one more frame than there are swapchain images, the render thread can still draw the snapshot from before the free for a frame
+        m_allocationsPendingFree.push_back({location, m_numSwapchainImages});
     }
 
     void BufferAllocator::ScheduleFreeAllocation(const Allocation &allocation) {
-        assert(m_allocations.contains(allocation.Location));
-        assert(m_allocations[allocation.Location] == allocation.Size);
+        {
+            std::unique_lock lock(m_mutex);
+            assert(m_allocations.contains(allocation.Location));
+            assert(m_allocations[allocation.Location] == allocation.Size);
+        }
         ScheduleFreeAllocation(allocation.Location);
     }
 
     Spire::Descriptor BufferAllocator::CreateDescriptor(glm::u32 binding, VkShaderStageFlags stages, const std::string &debugName) {
+        std::unique_lock lock(m_mutex);
         Descriptor descriptor = {
             .ResourceType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             .Binding = binding,
@@ -230,6 +237,7 @@ namespace Spire {
     }
 
     glm::u32 BufferAllocator::GetNumElementsPerInternalBuffer() const {
+        std::unique_lock lock(m_mutex);
         return m_buffers[0].Count;
     }
 
@@ -270,6 +278,6 @@ namespace Spire {
     }
 
     void BufferAllocator::PushBuffer(glm::u32 elementsInBuffer) {
-        m_buffers.push_back(m_renderingManager.GetBufferManager().CreateStorageBuffer(nullptr, elementsInBuffer * m_elementSize, m_elementSize));
+        m_buffers.push_back(m_renderingManager.GetBufferManager().CreateStorageBuffer(nullptr, elementsInBuffer * m_elementSize, m_elementSize, false, 0, m_category));
     }
 } // Spire
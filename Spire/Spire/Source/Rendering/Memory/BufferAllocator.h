@@ -7,6 +7,8 @@
 #include "Utils/Hashing.h"
 #include "Utils/MacroDisableCopy.h"
 
+#include <deque>
+
 namespace Spire {
     struct VulkanBuffer;
     // Instead of using a million buffers, use a single buffer and allocate sub ranges to different buffers
@@ -78,7 +80,8 @@ namespace Spire {
                         glm::u32 numSwapchainImages,
                         std::size_t sizePerInternalBuffer,
                         glm::u32 numInternalBuffers,
-                        bool canResize);
+                        bool canResize,
+                        MemoryCategory category = MemoryCategory::GPUOther);
 
         ~BufferAllocator();
 
@@ -118,7 +121,7 @@ namespace Spire {
 
     private:
         Spire::RenderingManager &m_renderingManager;
-        std::vector<Spire::VulkanBuffer> m_buffers;
+        std::deque<Spire::VulkanBuffer> m_buffers; // a deque so growing doesn't move the buffers descriptors point to
         glm::u32 m_elementSize;
         glm::u32 m_numSwapchainImages;
         std::vector<PendingFree> m_allocationsPendingFree;
@@ -127,10 +130,11 @@ namespace Spire {
         glm::u32 m_pendingFreesMade = 0;
         glm::u32 m_finishedFreesMade = 0;
         std::shared_ptr<bool> m_allocatorValid = std::make_shared<bool>(true); // set to false when destroyed
-        std::mutex m_mutex;
+        mutable std::mutex m_mutex;
         std::weak_ptr<MappedMemory> m_mappedMemory;
         std::function<void()> m_recreatePipelineCallback;
         bool m_canResize;
+        MemoryCategory m_category; // what the internal buffers are reported as in MemoryAccounting
     };
 } // SpireVoxel
 
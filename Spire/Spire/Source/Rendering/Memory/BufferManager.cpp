@@ -51,12 +51,12 @@ namespace Spire {
     }
 
     VulkanBuffer BufferManager::CreateStorageBuffer(const void *elements, std::size_t size, glm::u32 elementSize,
-                                                    bool isTransferSource, VkBufferUsageFlags extraUsageFlags) {
+                                                    bool isTransferSource, VkBufferUsageFlags extraUsageFlags, MemoryCategory category) {
         VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | extraUsageFlags;
         if (isTransferSource) usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
         VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-        return CreateBufferWithData(size, usage, memoryProperties, elements, elementSize);
+        return CreateBufferWithData(size, usage, memoryProperties, elements, elementSize, category);
     }
 
     VulkanBuffer BufferManager::CreateUniformBuffer(std::size_t size, glm::u32 elementSize, bool isTransferSource) {
@@ -71,6 +71,7 @@ namespace Spire {
 
     void BufferManager::DestroyBuffer(const VulkanBuffer &buffer) {
         assert(m_numAllocatedBuffers > 0);
+        MemoryAccounting::Instance().Free(buffer.Category, GetAllocationSize(buffer.Allocation));
         vmaDestroyBuffer(m_renderingManager.GetAllocatorWrapper().GetAllocator(), buffer.Buffer, buffer.Allocation);
         m_numAllocatedBuffers--;
     }
@@ -148,16 +149,16 @@ namespace Spire {
 
     VulkanBuffer BufferManager::CreateBufferWithData(VkDeviceSize size, VkBufferUsageFlags usage,
                                                      VkMemoryPropertyFlags properties, const void *data,
-                                                     glm::u32 elementSize) {
+                                                     glm::u32 elementSize, MemoryCategory category) {
         // create the final buffer
-        VulkanBuffer buffer = CreateBuffer(size, usage, properties);
+        VulkanBuffer buffer = CreateBuffer(size, usage, properties, category);
 
         if (data) {
             // create the staging buffer
             VkBufferUsageFlags stagingUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
             VkMemoryPropertyFlags stagingProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-            VulkanBuffer stagingBuffer = CreateBuffer(size, stagingUsage, stagingProperties);
+            VulkanBuffer stagingBuffer = CreateBuffer(size, stagingUsage, stagingProperties, MemoryCategory::Staging);
 
             // copy vertices into staging buffer
             UpdateBuffer(stagingBuffer, data, size);
@@ -180,10 +181,11 @@ namespace Spire {
     }
 
     VulkanBuffer BufferManager::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
-                                             VkMemoryPropertyFlags properties) {
+                                             VkMemoryPropertyFlags properties, MemoryCategory category) {
         assert(size != 0);
         VulkanBuffer buffer;
         buffer.Size = size;
+        buffer.Category = category;
 
         VkBufferCreateInfo vbCreateInfo = {
             .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -211,9 +213,18 @@ namespace Spire {
             error("Error creating vulkan buffer of size {}", size);
         } else {
             m_numAllocatedBuffers++;
+            MemoryAccounting::Instance().Allocate(category, GetAllocationSize(buffer.Allocation));
         }
 
         assert(buffer.Size != 0);
         return buffer;
     }
+
+    glm::u64 BufferManager::GetAllocationSize(VmaAllocation allocation) const {
+        if (!allocation) return 0;
+        // the allocation can be bigger than requested because of alignment
+        VmaAllocationInfo allocationInfo = {};
+        vmaGetAllocationInfo(m_renderingManager.GetAllocatorWrapper().GetAllocator(), allocation, &allocationInfo);
+        return allocationInfo.size;
+    }
 }
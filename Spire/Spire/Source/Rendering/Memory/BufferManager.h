@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "VulkanBuffer.h"
 #include "Utils/MacroDisableCopy.h"
+#include "Utils/MemoryAccounting.h"
 
 namespace Spire {
     class PerImageBuffer;
@@ -41,8 +42,10 @@ namespace Spire {
         [[nodiscard]] VulkanBuffer CreateIndexBuffer(glm::u32 indexTypeSize, const void *indices, std::size_t numIndices);
 
         // elements can be nullptr which means that initial data is undefined
+        // category is what the buffer's memory is reported as in MemoryAccounting
         [[nodiscard]] VulkanBuffer CreateStorageBuffer(const void *elements, std::size_t size, glm::u32 elementSize,
-                                                       bool isTransferSource = false, VkBufferUsageFlags extraUsageFlags = 0);
+                                                       bool isTransferSource = false, VkBufferUsageFlags extraUsageFlags = 0,
+                                                       MemoryCategory category = MemoryCategory::GPUOther);
 
         [[nodiscard]] VulkanBuffer CreateUniformBuffer(std::size_t size, glm::u32 elementSize, bool isTransferSource = false);
 
@@ -66,14 +69,17 @@ namespace Spire {
 
         // data can be nullptr which means initial data is undefined and call is basically equivalent to create buffer
         [[nodiscard]] VulkanBuffer CreateBufferWithData(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                                                        const void *data, glm::u32 elementSize);
+                                                        const void *data, glm::u32 elementSize, MemoryCategory category = MemoryCategory::GPUOther);
 
-        [[nodiscard]] VulkanBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        [[nodiscard]] VulkanBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                                                MemoryCategory category = MemoryCategory::GPUOther);
+
+        [[nodiscard]] glm::u64 GetAllocationSize(VmaAllocation allocation) const;
 
     private:
         const glm::u32 INVALID_MEMORY_TYPE_INDEX = -1; // overflow
         RenderingManager &m_renderingManager;
         VkCommandBuffer m_copyCommandBuffer;
-        glm::u32 m_numAllocatedBuffers = 0;
+        std::atomic<glm::u32> m_numAllocatedBuffers = 0; // buffers can be created and destroyed on the simulation and render threads
     };
 }
@@ -59,6 +59,7 @@ namespace Spire {
 
     void ImageManager::DestroyImage(const VulkanImage &image) {
         assert(m_numAllocatedImages > 0);
+        MemoryAccounting::Instance().Free(image.Category, m_renderingManager.GetBufferManager().GetAllocationSize(image.Allocation));
         VkDevice device = m_renderingManager.GetDevice();
         vkDestroySampler(device, image.Sampler, nullptr);
         vkDestroyImageView(device, image.ImageView, nullptr);
@@ -71,7 +72,8 @@ namespace Spire {
     }
 
     void ImageManager::CreateImage(VulkanImage &image, glm::uvec2 dimensions,
-                                   VkImageUsageFlags usage, VkMemoryPropertyFlags propertyFlags, VkFormat format) {
+                                   VkImageUsageFlags usage, VkMemoryPropertyFlags propertyFlags, VkFormat format, MemoryCategory category) {
+        image.Category = category;
         VkImageCreateInfo imageInfo = {
             .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
             .pNext = nullptr,
@@ -112,6 +114,7 @@ namespace Spire {
             error("Failed to create vulkan image");
         } else {
             m_numAllocatedImages++;
+            MemoryAccounting::Instance().Allocate(category, m_renderingManager.GetBufferManager().GetAllocationSize(image.Allocation));
         }
     }
 
@@ -181,7 +184,7 @@ namespace Spire {
         VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
         auto &bufferManager = m_renderingManager.GetBufferManager();
-        VulkanBuffer stagingBuffer = bufferManager.CreateBuffer(imageSize, usage, memoryProperties);
+        VulkanBuffer stagingBuffer = bufferManager.CreateBuffer(imageSize, usage, memoryProperties, MemoryCategory::Staging);
         bufferManager.UpdateBuffer(stagingBuffer, loadedImage.Data, imageSize);
 
         TransitionImageLayout(image.Image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
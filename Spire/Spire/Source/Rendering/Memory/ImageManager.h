@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pch.h"
+#include "Utils/MemoryAccounting.h"
 
 namespace Spire
 {
@@ -18,8 +19,9 @@ namespace Spire
         VulkanImage CreateImageFromFile(const char* filename);
         void DestroyImage(const VulkanImage& image);
 
+        // category is what the image's memory is reported as in MemoryAccounting
         void CreateImage(VulkanImage& image, glm::uvec2 dimensions, VkImageUsageFlags usage,
-                         VkImageUsageFlags propertyFlags, VkFormat format);
+                         VkImageUsageFlags propertyFlags, VkFormat format, MemoryCategory category = MemoryCategory::Textures);
 
         void TransitionImageLayout(const VkImage& image, VkFormat format, VkImageLayout oldLayout,
                                    VkImageLayout newLayout) const;
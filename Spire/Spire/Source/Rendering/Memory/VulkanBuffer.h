@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pch.h"
+#include "Utils/MemoryAccounting.h"
 
 namespace Spire {
     struct VulkanBuffer {
@@ -10,5 +11,6 @@ namespace Spire {
         std::size_t Size = 0; // size in bytes
         glm::u32 Count = 0; // number of elements
         glm::u32 ElementSize = 0; // size of a single element in bytes
+        MemoryCategory Category = MemoryCategory::GPUOther; // what the memory is reported as
     };
 }
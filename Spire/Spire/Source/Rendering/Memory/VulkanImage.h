@@ -1,6 +1,7 @@
 #pragma once
 
 #include "pch.h"
+#include "Utils/MemoryAccounting.h"
 
 namespace Spire {
     struct VulkanImage {
@@ -8,6 +9,7 @@ namespace Spire {
         VmaAllocation Allocation = nullptr;
         VkImageView ImageView = VK_NULL_HANDLE;
         VkSampler Sampler = VK_NULL_HANDLE;
+        MemoryCategory Category = MemoryCategory::Textures; // what the memory is reported as
 #ifndef NDEBUG
         std::string DebugName;
 #endif
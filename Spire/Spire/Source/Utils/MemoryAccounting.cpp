@@ -0,0 +1,110 @@
+#include "MemoryAccounting.h"
+
+namespace Spire {
+    glm::u64 MemoryAccounting::Report::GetCPUBytes() const {
+        glm::u64 bytes = 0;
+        for (std::size_t i = 0; i < NUM_CATEGORIES; i++) {
+            if (!IsGPUCategory(static_cast<MemoryCategory>(i))) bytes += Categories[i].Bytes;
+        }
+        return bytes;
+    }
+
+    glm::u64 MemoryAccounting::Report::GetGPUBytes() const {
+        glm::u64 bytes = 0;
+        for (std::size_t i = 0; i < NUM_CATEGORIES; i++) {
+            if (IsGPUCategory(static_cast<MemoryCategory>(i))) bytes += Categories[i].Bytes;
+        }
+        return bytes;
+    }
+
+    std::string MemoryAccounting::Report::ToJSON() const {
+        std::string json = std::format(R"({{"cpu_bytes": {}, "gpu_bytes": {}, "categories": {{)", GetCPUBytes(), GetGPUBytes());
+        for (std::size_t i = 0; i < NUM_CATEGORIES; i++) {
+            auto category = static_cast<MemoryCategory>(i);
+            json += std::format(R"({}"{}": {{"gpu": {}, "bytes": {}, "peak_bytes": {}}})",
+                                i == 0 ? "" : ", ",
+                                GetCategoryName(category),
+                                IsGPUCategory(category) ? "true" : "false",
+                                Categories[i].Bytes,
+                                Categories[i].PeakBytes);
+        }
+        json += "}}";
+        return json;
+    }
+
+    MemoryAccounting &MemoryAccounting::Instance() {
+        static MemoryAccounting accounting;
+        return accounting;
+    }
+
+    void MemoryAccounting::Allocate(MemoryCategory category, glm::u64 bytes) {
+        Counter &counter = m_categories[static_cast<std::size_t>(category)];
+        glm::u64 newBytes = counter.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        glm::u64 peak = counter.PeakBytes.load(std::memory_order_relaxed);
+        while (newBytes > peak && !counter.PeakBytes.compare_exchange_weak(peak, newBytes, std::memory_order_relaxed)) {
+        }
+    }
+
+    void MemoryAccounting::Free(MemoryCategory category, glm::u64 bytes) {
+        [[maybe_unused]] glm::u64 oldBytes = m_categories[static_cast<std::size_t>(category)].Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        assert(oldBytes >= bytes); // freed more than was allocated
+    }
+
+    glm::u64 MemoryAccounting::GetBytes(MemoryCategory category) const {
+        return m_categories[static_cast<std::size_t>(category)].Bytes.load(std::memory_order_relaxed);
+    }
+
+    MemoryAccounting::Report MemoryAccounting::GetReport() const {
+        Report report;
+        for (std::size_t i = 0; i < NUM_CATEGORIES; i++) {
+            report.Categories[i] = {
+                .Bytes = m_categories[i].Bytes.load(std::memory_order_relaxed),
+                .PeakBytes = m_categories[i].PeakBytes.load(std::memory_order_relaxed)
+            };
+        }
+        return report;
+    }
+
+    bool MemoryAccounting::WriteJSON(const std::filesystem::path &path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) return false;
+        file << GetReport().ToJSON();
+        return static_cast<bool>(file);
+    }
+
+    void MemoryAccounting::ResetPeaks() {
+        for (Counter &counter : m_categories) {
+            counter.PeakBytes.store(counter.Bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    const char *MemoryAccounting::GetCategoryName(MemoryCategory category) {
+        switch (category) {
+            case MemoryCategory::VoxelStorage: return "voxel_storage";
+            case MemoryCategory::MeshScratch: return "mesh_scratch";
+            case MemoryCategory::ChunkMetadata: return "chunk_metadata";
+            case MemoryCategory::EditHistory: return "edit_history";
+            case MemoryCategory::GPUVertex: return "gpu_vertex";
+            case MemoryCategory::GPUVoxelData: return "gpu_voxel_data";
+            case MemoryCategory::Textures: return "textures";
+            case MemoryCategory::Staging: return "staging";
+            case MemoryCategory::GPUOther: return "gpu_other";
+            default:
+                assert(false);
+                return "unknown";
+        }
+    }
+
+    bool MemoryAccounting::IsGPUCategory(MemoryCategory category) {
+        switch (category) {
+            case MemoryCategory::VoxelStorage:
+            case MemoryCategory::MeshScratch:
+            case MemoryCategory::ChunkMetadata:
+            case MemoryCategory::EditHistory:
+                return false;
+            default:
+                return true;
+        }
+    }
+} // Spire
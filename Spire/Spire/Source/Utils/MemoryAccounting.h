@@ -0,0 +1,141 @@
+#pragma once
+
+#include "pch.h"
+#include "MacroDisableCopy.h"
+
+namespace Spire {
+    // What memory is being used for, every allocator reports into one of these
+    enum class MemoryCategory : glm::u8 {
+        VoxelStorage, // chunk voxel types, presence bits and occupancy (resident, compressed or paged out)
+        MeshScratch, // CPU side meshes waiting to be uploaded
+        ChunkMetadata, // chunk objects and the tables that index them
+        EditHistory, // undo/redo deltas
+        GPUVertex, // chunk vertex buffers
+        GPUVoxelData, // chunk voxel type and AO buffers
+        Textures,
+        Staging, // host visible buffers that are only used to copy data to the GPU
+        GPUOther, // uniform, indirect, depth and any other GPU allocations
+        COUNT
+    };
+
+    // Tracks how many bytes are in use for each MemoryCategory across the whole process, thread safe
+    // GPU categories count the size of the VMA allocations (including alignment), CPU categories count the bytes requested from the heap
+    class MemoryAccounting {
+    public:
+        static constexpr std::size_t NUM_CATEGORIES = static_cast<std::size_t>(MemoryCategory::COUNT);
+
+        struct CategoryUsage {
+            glm::u64 Bytes = 0;
+            glm::u64 PeakBytes = 0; // since the start of the process or the last ResetPeaks
+        };
+
+        struct Report {
+            std::array<CategoryUsage, NUM_CATEGORIES> Categories = {};
+
+            [[nodiscard]] const CategoryUsage &Get(MemoryCategory category) const { return Categories[static_cast<std::size_t>(category)]; }
+
+            [[nodiscard]] glm::u64 GetCPUBytes() const;
+
+            [[nodiscard]] glm::u64 GetGPUBytes() const;
+
+            [[nodiscard]] std::string ToJSON() const;
+        };
+
+    public:
+        MemoryAccounting() = default;
+
+        DISABLE_COPY_AND_MOVE(MemoryAccounting)
+
+        static MemoryAccounting &Instance();
+
+    public:
+        void Allocate(MemoryCategory category, glm::u64 bytes);
+
+        void Free(MemoryCategory category, glm::u64 bytes);
+
+        [[nodiscard]] glm::u64 GetBytes(MemoryCategory category) const;
+
+        [[nodiscard]] Report GetReport() const;
+
+        // Returns false if the file couldn't be written
+        bool WriteJSON(const std::filesystem::path &path) const;
+
+        // Set each peak to the current usage
+        void ResetPeaks();
+
+        [[nodiscard]] static const char *GetCategoryName(MemoryCategory category);
+
+        [[nodiscard]] static bool IsGPUCategory(MemoryCategory category);
+
+    private:
+        struct Counter {
+            std::atomic<glm::u64> Bytes = 0;
+            std::atomic<glm::u64> PeakBytes = 0;
+        };
+
+        std::array<Counter, NUM_CATEGORIES> m_categories;
+    };
+
+    // Reports memory that is easier to recalculate than to track allocation by allocation (e.g. the size of a hash map)
+    // Set adjusts the category by the difference from the last value, the last value is freed on destruction
+    class MemoryCounter {
+    public:
+        explicit MemoryCounter(MemoryCategory category) : m_category(category) {
+        }
+
+        ~MemoryCounter() { Set(0); }
+
+        DISABLE_COPY_AND_MOVE(MemoryCounter)
+
+        void Set(glm::u64 bytes) {
+            if (bytes > m_bytes) MemoryAccounting::Instance().Allocate(m_category, bytes - m_bytes);
+            else if (bytes < m_bytes) MemoryAccounting::Instance().Free(m_category, m_bytes - bytes);
+            m_bytes = bytes;
+        }
+
+        [[nodiscard]] glm::u64 Get() const { return m_bytes; }
+
+    private:
+        MemoryCategory m_category;
+        glm::u64 m_bytes = 0;
+    };
+
+    // Approximate heap usage of a std::unordered_map/set, every bucket is a pointer and every element is a node with two pointers of overhead
+    template<typename Container>
+    [[nodiscard]] glm::u64 EstimateHashContainerMemoryUsage(const Container &container) {
+        return container.bucket_count() * sizeof(void *) + container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void *));
+    }
+
+    // Standard allocator that reports every allocation into a MemoryCategory
+    // e.g. std::allocate_shared<T>(TrackingAllocator<T, MemoryCategory::VoxelStorage>()) also counts the shared_ptr control block
+    template<typename T, MemoryCategory Category>
+    class TrackingAllocator {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = TrackingAllocator<U, Category>;
+        };
+
+        TrackingAllocator() = default;
+
+        template<typename U>
+        TrackingAllocator(const TrackingAllocator<U, Category> &) {
+        }
+
+        [[nodiscard]] T *allocate(std::size_t count) {
+            T *memory = std::allocator<T>().allocate(count);
+            MemoryAccounting::Instance().Allocate(Category, count * sizeof(T));
+            return memory;
+        }
+
+        void deallocate(T *memory, std::size_t count) {
+            MemoryAccounting::Instance().Free(Category, count * sizeof(T));
+            std::allocator<T>().deallocate(memory, count);
+        }
+
+        template<typename U>
+        bool operator==(const TrackingAllocator<U, Category> &) const { return true; }
+    };
+} // Spire
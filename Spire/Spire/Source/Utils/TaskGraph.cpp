@@ -0,0 +1,337 @@
+#include "TaskGraph.h"
+
+namespace Spire {
+    class TaskGraph::Task {
+    public:
+        std::function<void()> Function;
+        TaskGroup *Group = nullptr;
+        TaskPriority Priority = TaskPriority::Normal;
+        // the submission holds one count until every dependency has been registered, so the task can't start early
+        std::atomic<glm::u32> NumPendingDependencies = 1;
+        std::atomic<bool> Done = false;
+        std::mutex Mutex; // guards Continuations and setting Done
+        std::vector<TaskHandle> Continuations;
+    };
+
+    namespace {
+        struct WorkerThreadInfo {
+            const TaskGraph *Graph = nullptr;
+            glm::u32 Index = 0;
+            TaskPriority Priority = TaskPriority::IO; // of the task the worker is running
+        };
+
+        thread_local WorkerThreadInfo t_worker;
+    }
+
+    TaskGraph::TaskGraph(glm::u32 numThreads) : TaskGraph(Settings{.NumThreads = numThreads}) {
+    }
+
+    TaskGraph::TaskGraph(const Settings &settings) : m_starvationLimit(std::max(1u, settings.StarvationLimit)) {
+        glm::u32 numThreads = settings.NumThreads > 0 ? settings.NumThreads : std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+            glm::u32 maxThreads = settings.MaxThreads[priority];
+            m_maxThreads[priority] = maxThreads == 0 ? numThreads : std::min(maxThreads, numThreads);
+        }
+
+        // every worker must exist before any of them can try to steal
+        for (glm::u32 i = 0; i < numThreads; i++) m_workers.push_back(std::make_unique<Worker>());
+        for (glm::u32 i = 0; i < numThreads; i++) {
+            m_workers[i]->Thread = std::thread([this, i] { Run(i); });
+        }
+    }
+
+    TaskGraph::~TaskGraph() {
+        BlockUntil([this] { return m_numIncomplete.load(std::memory_order_acquire) == 0; });
+
+        {
+            std::lock_guard lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (auto &worker : m_workers) worker->Thread.join();
+    }
+
+    TaskGraph &TaskGraph::Instance() {
+        static TaskGraph graph([] {
+            glm::u32 numThreads = std::max(1u, std::thread::hardware_concurrency());
+            Settings settings = {.NumThreads = numThreads};
+            settings.MaxThreads[static_cast<std::size_t>(TaskPriority::Background)] = std::max(1u, numThreads - 1);
+            settings.MaxThreads[static_cast<std::size_t>(TaskPriority::IO)] = std::max(1u, numThreads / 4);
+            return settings;
+        }());
+        return graph;
+    }
+
+    TaskGraph::TaskHandle TaskGraph::Submit(std::function<void()> task, const std::vector<TaskHandle> &dependencies, TaskGroup *group, TaskPriority priority) {
+        assert(priority != TaskPriority::COUNT);
+        auto handle = std::make_shared<Task>();
+        handle->Function = std::move(task);
+        handle->Group = group;
+        handle->Priority = priority;
+        if (group) {
+            group->m_numPending.fetch_add(1, std::memory_order_relaxed);
+            group->m_priorities.fetch_or(static_cast<glm::u8>(1u << static_cast<std::size_t>(priority)), std::memory_order_relaxed);
+        }
+        m_numIncomplete.fetch_add(1, std::memory_order_relaxed);
+
+        for (const TaskHandle &dependency : dependencies) {
+            if (!dependency) continue;
+
+            std::lock_guard lock(dependency->Mutex);
+            if (dependency->Done.load(std::memory_order_relaxed)) continue;
+            handle->NumPendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->Continuations.push_back(handle);
+        }
+
+        Release(handle);
+        return handle;
+    }
+
+    TaskGraph::TaskHandle TaskGraph::Then(const TaskHandle &task, std::function<void()> continuation, TaskGroup *group, TaskPriority priority) {
+        return Submit(std::move(continuation), {task}, group, priority);
+    }
+
+    void TaskGraph::ParallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)> &function, TaskPriority priority) {
+        if (begin >= end) return;
+        std::size_t count = end - begin;
+        std::size_t numBlocks = std::min<std::size_t>(count, GetMaxThreads(priority));
+        if (numBlocks <= 1) {
+            for (std::size_t i = begin; i < end; i++) function(i);
+            return;
+        }
+
+        // the first blocks take the remainder
+        std::size_t blockSize = count / numBlocks;
+        std::size_t remainder = count % numBlocks;
+        TaskGroup group;
+        std::size_t blockStart = begin;
+        for (std::size_t block = 0; block < numBlocks; block++) {
+            std::size_t blockEnd = blockStart + blockSize + (block < remainder ? 1 : 0);
+            Submit([&function, blockStart, blockEnd] {
+                for (std::size_t i = blockStart; i < blockEnd; i++) function(i);
+            }, {}, &group, priority);
+            blockStart = blockEnd;
+        }
+        assert(blockStart == end);
+        Wait(group);
+    }
+
+    void TaskGraph::Wait(const TaskHandle &task) {
+        if (IsDone(task)) return;
+
+        auto done = [&task] { return task->Done.load(std::memory_order_acquire); };
+        if (IsWorkerThread()) HelpUntil(done, std::max(t_worker.Priority, task->Priority));
+        else BlockUntil(done);
+    }
+
+    void TaskGraph::Wait(const TaskGroup &group) {
+        if (group.IsDone()) return;
+
+        auto done = [&group] { return group.IsDone(); };
+        if (!IsWorkerThread()) {
+            BlockUntil(done);
+            return;
+        }
+
+        TaskPriority lowestPriority = t_worker.Priority;
+        glm::u8 priorities = group.m_priorities.load(std::memory_order_relaxed);
+        for (std::size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+            if (priorities & (1u << priority)) lowestPriority = std::max(lowestPriority, static_cast<TaskPriority>(priority));
+        }
+        HelpUntil(done, lowestPriority);
+    }
+
+    bool TaskGraph::IsDone(const TaskHandle &task) {
+        return !task || task->Done.load(std::memory_order_acquire);
+    }
+
+    bool TaskGraph::IsWorkerThread() const {
+        return t_worker.Graph == this;
+    }
+
+    TaskGraph::Stats TaskGraph::GetStats() const {
+        return {m_tasksRun.load(std::memory_order_relaxed), m_steals.load(std::memory_order_relaxed), m_starvationRuns.load(std::memory_order_relaxed)};
+    }
+
+    void TaskGraph::Run(glm::u32 workerIndex) {
+        t_worker = {this, workerIndex};
+
+        while (true) {
+            TaskHandle task = TryTake(workerIndex, false);
+            if (task) {
+                Execute(task);
+                continue;
+            }
+
+            // the destructor only stops the workers once every task has finished
+            std::unique_lock lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stopping || HasRunnableTask(); });
+            if (m_stopping) return;
+        }
+    }
+
+    void TaskGraph::Release(const TaskHandle &task) {
+        if (task->NumPendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) Schedule(task);
+    }
+
+    void TaskGraph::Schedule(TaskHandle task) {
+        // tasks made ready by a worker stay on it, others are spread across the workers
+        glm::u32 workerIndex = IsWorkerThread()
+                                   ? t_worker.Index
+                                   : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % static_cast<glm::u32>(m_workers.size());
+        Worker &worker = *m_workers[workerIndex];
+        std::size_t priority = static_cast<std::size_t>(task->Priority);
+        {
+            std::lock_guard lock(worker.Mutex);
+            worker.Queues[priority].push_back(std::move(task));
+            m_numQueued[priority].fetch_add(1, std::memory_order_release);
+        }
+        WakeWorker();
+    }
+
+    TaskGraph::TaskHandle TaskGraph::TryTake(glm::u32 workerIndex, bool ignoreLimits, TaskPriority lowestPriority) {
+        // classes that have been passed over too many times go first, then the rest in priority order
+        std::array<std::size_t, NUM_PRIORITIES> order;
+        std::size_t numOrdered = 0;
+        for (std::size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+            if (m_numPassedOver[priority].load(std::memory_order_relaxed) >= m_starvationLimit) order[numOrdered++] = priority;
+        }
+        for (std::size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+            if (m_numPassedOver[priority].load(std::memory_order_relaxed) < m_starvationLimit) order[numOrdered++] = priority;
+        }
+
+        for (std::size_t priority : order) {
+            if (priority > static_cast<std::size_t>(lowestPriority)) continue;
+            if (m_numQueued[priority].load(std::memory_order_acquire) == 0) continue;
+
+            // claim a slot first so two workers can't both take the last one
+            glm::u32 running = m_numRunning[priority].fetch_add(1, std::memory_order_acq_rel);
+            if (!ignoreLimits && running >= m_maxThreads[priority]) {
+                m_numRunning[priority].fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+
+            TaskHandle task = TryTakeClass(workerIndex, priority);
+            if (!task) {
+                m_numRunning[priority].fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+
+            bool starved = m_numPassedOver[priority].exchange(0, std::memory_order_relaxed) >= m_starvationLimit;
+            bool jumpedQueue = false;
+            for (std::size_t higher = 0; higher < priority; higher++) {
+                jumpedQueue |= m_numQueued[higher].load(std::memory_order_relaxed) > 0;
+            }
+            if (starved && jumpedQueue) m_starvationRuns.fetch_add(1, std::memory_order_relaxed);
+
+            for (std::size_t lower = priority + 1; lower < NUM_PRIORITIES; lower++) {
+                if (m_numQueued[lower].load(std::memory_order_relaxed) > 0) m_numPassedOver[lower].fetch_add(1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+        return nullptr;
+    }
+
+    TaskGraph::TaskHandle TaskGraph::TryTakeClass(glm::u32 workerIndex, std::size_t priority) {
+        // newest first from our own queue, its data is most likely still in cache
+        {
+            Worker &worker = *m_workers[workerIndex];
+            std::lock_guard lock(worker.Mutex);
+            std::deque<TaskHandle> &queue = worker.Queues[priority];
+            if (!queue.empty()) {
+                TaskHandle task = std::move(queue.back());
+                queue.pop_back();
+                m_numQueued[priority].fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        // oldest first from the others, it is the work its owner will get to last
+        glm::u32 numWorkers = static_cast<glm::u32>(m_workers.size());
+        for (glm::u32 i = 1; i < numWorkers; i++) {
+            Worker &victim = *m_workers[(workerIndex + i) % numWorkers];
+            std::lock_guard lock(victim.Mutex);
+            std::deque<TaskHandle> &queue = victim.Queues[priority];
+            if (queue.empty()) continue;
+
+            TaskHandle task = std::move(queue.front());
+            queue.pop_front();
+            m_numQueued[priority].fetch_sub(1, std::memory_order_relaxed);
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+        return nullptr;
+    }
+
+    bool TaskGraph::HasRunnableTask() const {
+        for (std::size_t priority = 0; priority < NUM_PRIORITIES; priority++) {
+            if (m_numQueued[priority].load(std::memory_order_acquire) == 0) continue;
+            if (m_numRunning[priority].load(std::memory_order_acquire) < m_maxThreads[priority]) return true;
+        }
+        return false;
+    }
+
+    void TaskGraph::WakeWorker() {
+        // taking the lock means a worker that just found nothing to run is either already waiting or will see the change
+        {
+            std::lock_guard lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    void TaskGraph::Execute(const TaskHandle &task) {
+        // tasks run while helping inside another task are nested, the waiting task's class is restored after
+        TaskPriority waitingPriority = t_worker.Priority;
+        t_worker.Priority = task->Priority;
+        task->Function();
+        t_worker.Priority = waitingPriority;
+        task->Function = nullptr; // free captures now, the handle may be kept around for a while
+        m_tasksRun.fetch_add(1, std::memory_order_relaxed);
+
+        // a worker may be asleep because this class was at its limit
+        std::size_t priority = static_cast<std::size_t>(task->Priority);
+        glm::u32 running = m_numRunning[priority].fetch_sub(1, std::memory_order_acq_rel);
+        if (running == m_maxThreads[priority] && m_numQueued[priority].load(std::memory_order_acquire) > 0) WakeWorker();
+
+        std::vector<TaskHandle> continuations;
+        {
+            std::lock_guard lock(task->Mutex);
+            task->Done.store(true, std::memory_order_release);
+            continuations.swap(task->Continuations);
+        }
+        for (const TaskHandle &continuation : continuations) Release(continuation);
+
+        if (task->Group) task->Group->m_numPending.fetch_sub(1, std::memory_order_acq_rel);
+        m_numIncomplete.fetch_sub(1, std::memory_order_acq_rel);
+        NotifyWaiters();
+    }
+
+    void TaskGraph::BlockUntil(const std::function<bool()> &done) {
+        assert(!IsWorkerThread());
+        m_numWaiters.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(m_waitMutex);
+            m_finished.wait(lock, done);
+        }
+        m_numWaiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void TaskGraph::HelpUntil(const std::function<bool()> &done, TaskPriority lowestPriority) {
+        assert(IsWorkerThread());
+        while (!done()) {
+            TaskHandle task = TryTake(t_worker.Index, true, lowestPriority);
+            if (task) Execute(task);
+            else std::this_thread::yield(); // what we are waiting for is running on another worker
+        }
+    }
+
+    void TaskGraph::NotifyWaiters() {
+        // a waiter registers before checking its condition under the lock, so it either sees the task finished or is woken here
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_numWaiters.load(std::memory_order_seq_cst) == 0) return;
+        {
+            std::lock_guard lock(m_waitMutex);
+        }
+        m_finished.notify_all();
+    }
+} // Spire
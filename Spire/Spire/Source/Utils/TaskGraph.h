@@ -0,0 +1,232 @@
+#pragma once
+
+#include "pch.h"
+#include "MacroDisableCopy.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Spire {
+    class TaskGraph;
+
+    // Which kind of work a task is, workers run the highest class with a task queued first
+    enum class TaskPriority : glm::u8 {
+        Interactive, // the player is waiting on it, e.g. meshing edited chunks
+        Normal,
+        Background, // bulk work spread over many frames, e.g. generation and LOD
+        IO, // mostly waiting on the disk
+        COUNT
+    };
+
+    // Counts the tasks submitted with it that haven't finished
+    // Must outlive its tasks
+    class TaskGroup {
+    public:
+        TaskGroup() = default;
+
+        DISABLE_COPY_AND_MOVE(TaskGroup)
+
+    public:
+        [[nodiscard]] bool IsDone() const { return m_numPending.load(std::memory_order_acquire) == 0; }
+
+        [[nodiscard]] glm::u32 NumPending() const { return m_numPending.load(std::memory_order_acquire); }
+
+    private:
+        friend class TaskGraph;
+
+        std::atomic<glm::u32> m_numPending = 0;
+        std::atomic<glm::u8> m_priorities = 0; // bit for each TaskPriority submitted with the group, a worker waiting on it must be able to run them
+    };
+
+    // Runs tasks on its own worker threads once the tasks they depend on have finished
+    // Each worker has its own queue, a worker runs the newest task it queued itself first and steals the oldest task from another worker when it runs out
+    // A task that becomes ready on a worker (e.g. a continuation) is queued on that worker, so chained work stays on the same core
+    // Waiting on a worker thread runs other tasks until the wait is over instead of blocking the worker
+    // It only runs tasks of the waiting task's class or higher, and of the classes it is waiting on, so a long lower class task can't delay it
+    // Queues are split by TaskPriority, a class is skipped while it is running on its maximum number of workers
+    // A class that has been passed over StarvationLimit times in a row is run next, so lower classes always make progress
+    // Tasks must not throw
+    class TaskGraph {
+    public:
+        class Task;
+
+        using TaskHandle = std::shared_ptr<Task>;
+
+        static constexpr std::size_t NUM_PRIORITIES = static_cast<std::size_t>(TaskPriority::COUNT);
+
+        struct Settings {
+            glm::u32 NumThreads = 0; // 0 is the number of hardware threads
+            // Most workers that can run each class at once, 0 is every worker
+            std::array<glm::u32, NUM_PRIORITIES> MaxThreads = {};
+            // Tasks of higher classes that can be run ahead of a queued task before its class is run next
+            glm::u32 StarvationLimit = 16;
+        };
+
+        struct Stats {
+            glm::u64 TasksRun = 0;
+            glm::u64 Steals = 0; // tasks run by a worker other than the one they were queued on
+            glm::u64 StarvationRuns = 0; // tasks run ahead of a higher class because their class hit the starvation limit
+        };
+
+    public:
+        // numThreads - 0 is the number of hardware threads
+        explicit TaskGraph(glm::u32 numThreads = 0);
+
+        explicit TaskGraph(const Settings &settings);
+
+        // Waits for every task to finish
+        ~TaskGraph();
+
+        DISABLE_COPY_AND_MOVE(TaskGraph)
+
+        // Background work can use every worker but one so there is always a worker for interactive work, IO a quarter of them
+        static TaskGraph &Instance();
+
+    public:
+        // Run task once every dependency has finished, null and finished dependencies are ignored
+        // group - counts the task until it finishes, can be null
+        TaskHandle Submit(std::function<void()> task, const std::vector<TaskHandle> &dependencies = {}, TaskGroup *group = nullptr,
+                          TaskPriority priority = TaskPriority::Normal);
+
+        // Run continuation after task, same as Submit(continuation, {task}, group, priority)
+        TaskHandle Then(const TaskHandle &task, std::function<void()> continuation, TaskGroup *group = nullptr, TaskPriority priority = TaskPriority::Normal);
+
+        // Call function for every index in [begin, end) and wait for them to finish
+        // The range is split into a block for each worker the class can use, so the loop obeys the class limits like any other task
+        void ParallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)> &function, TaskPriority priority = TaskPriority::Normal);
+
+        // Block until the task has finished, worker threads run other tasks while they wait
+        void Wait(const TaskHandle &task);
+
+        // Block until every task in the group has finished, worker threads run other tasks while they wait
+        void Wait(const TaskGroup &group);
+
+        // Null is treated as finished
+        [[nodiscard]] static bool IsDone(const TaskHandle &task);
+
+        [[nodiscard]] bool IsWorkerThread() const;
+
+        [[nodiscard]] glm::u32 NumThreads() const { return static_cast<glm::u32>(m_workers.size()); }
+
+        [[nodiscard]] glm::u32 GetMaxThreads(TaskPriority priority) const { return m_maxThreads[static_cast<std::size_t>(priority)]; }
+
+        // Tasks that are ready to run and waiting for a worker
+        [[nodiscard]] glm::u64 NumQueued(TaskPriority priority) const { return m_numQueued[static_cast<std::size_t>(priority)].load(std::memory_order_relaxed); }
+
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        struct Worker {
+            std::mutex Mutex;
+            // the owner pushes and pops at the back, thieves take from the front
+            std::array<std::deque<TaskHandle>, NUM_PRIORITIES> Queues;
+            std::thread Thread;
+        };
+
+        void Run(glm::u32 workerIndex);
+
+        // Called once for each dependency that finishes and once when the task has been submitted
+        void Release(const TaskHandle &task);
+
+        void Schedule(TaskHandle task);
+
+        // Take a task of the class that should run next from this worker's queue or steal one, returns null if nothing can run
+        // ignoreLimits - a worker that is waiting inside a task can run a class that is at its maximum, it isn't adding a thread
+        // lowestPriority - classes below this are skipped
+        [[nodiscard]] TaskHandle TryTake(glm::u32 workerIndex, bool ignoreLimits, TaskPriority lowestPriority = TaskPriority::IO);
+
+        [[nodiscard]] TaskHandle TryTakeClass(glm::u32 workerIndex, std::size_t priority);
+
+        // A class has a queued task and a free worker slot
+        [[nodiscard]] bool HasRunnableTask() const;
+
+        void WakeWorker();
+
+        void Execute(const TaskHandle &task);
+
+        // Block a thread that isn't a worker until done returns true
+        void BlockUntil(const std::function<bool()> &done);
+
+        // Run other tasks of lowestPriority or higher on a worker until done returns true
+        void HelpUntil(const std::function<bool()> &done, TaskPriority lowestPriority);
+
+        void NotifyWaiters();
+
+    private:
+        std::vector<std::unique_ptr<Worker> > m_workers;
+        std::array<glm::u32, NUM_PRIORITIES> m_maxThreads;
+        glm::u32 m_starvationLimit;
+        std::atomic<glm::u32> m_nextWorker = 0; // round robin for tasks scheduled by other threads
+        std::array<std::atomic<glm::u64>, NUM_PRIORITIES> m_numQueued = {};
+        std::array<std::atomic<glm::u32>, NUM_PRIORITIES> m_numRunning = {};
+        std::array<std::atomic<glm::u32>, NUM_PRIORITIES> m_numPassedOver = {}; // tasks of higher classes run while this class had tasks queued
+        std::atomic<glm::u64> m_numIncomplete = 0; // submitted and not finished
+        std::atomic<glm::u64> m_tasksRun = 0;
+        std::atomic<glm::u64> m_steals = 0;
+        std::atomic<glm::u64> m_starvationRuns = 0;
+        bool m_stopping = false; // guarded by m_sleepMutex
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+
+        // threads that aren't workers block on this
+        std::atomic<glm::u32> m_numWaiters = 0;
+        std::mutex m_waitMutex;
+        std::condition_variable m_finished;
+    };
+
+    // Tasks submitted with the same key run one after another in submission order, tasks with different keys run in parallel
+    // e.g. per chunk chains so a chunk is meshed after it has been generated
+    // Not thread safe
+    template<typename Key, typename Hash = std::hash<Key> >
+    class TaskChains {
+    public:
+        explicit TaskChains(TaskGraph &graph) : m_graph(graph) {
+        }
+
+    public:
+        // Run task after the last task submitted with key and any other dependencies
+        TaskGraph::TaskHandle Submit(const Key &key, std::function<void()> task, TaskGroup *group = nullptr, std::vector<TaskGraph::TaskHandle> dependencies = {},
+                                     TaskPriority priority = TaskPriority::Normal) {
+            TaskGraph::TaskHandle &last = m_last[key];
+            dependencies.push_back(last);
+            last = m_graph.Submit(std::move(task), dependencies, group, priority);
+            return last;
+        }
+
+        // The last task submitted with key if it hasn't finished, otherwise null
+        [[nodiscard]] TaskGraph::TaskHandle GetLast(const Key &key) const {
+            auto it = m_last.find(key);
+            if (it == m_last.end() || TaskGraph::IsDone(it->second)) return nullptr;
+            return it->second;
+        }
+
+        [[nodiscard]] bool IsRunning(const Key &key) const { return GetLast(key) != nullptr; }
+
+        // Wait for every task submitted with key and forget the chain
+        void Wait(const Key &key) {
+            auto it = m_last.find(key);
+            if (it == m_last.end()) return;
+            m_graph.Wait(it->second);
+            m_last.erase(it);
+        }
+
+        void WaitForAll() {
+            for (auto &[_, last] : m_last) m_graph.Wait(last);
+            m_last.clear();
+        }
+
+        // Forget chains that have finished
+        void Prune() {
+            std::erase_if(m_last, [](const auto &pair) { return TaskGraph::IsDone(pair.second); });
+        }
+
+        // Number of chains that haven't been pruned
+        [[nodiscard]] std::size_t Size() const { return m_last.size(); }
+
+    private:
+        TaskGraph &m_graph;
+        std::unordered_map<Key, TaskGraph::TaskHandle, Hash> m_last;
+    };
+} // Spire
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "pch.h"
+#include "MacroDisableCopy.h"
+
+namespace Spire {
+    // Hands the latest value from a writer thread to a reader thread without either of them waiting
+    // The writer fills the back buffer and publishes it, the reader takes the newest published buffer as its front buffer
+    // Publishing and acquiring swap a buffer with the middle slot, so a buffer is never written while the reader can see it and the reader always sees a whole value
+    // Publishing again before the reader acquires replaces the unread value, the reader skips it
+    // One writer thread and one reader thread
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() = default;
+
+        DISABLE_COPY_AND_MOVE(TripleBuffer)
+
+    public:
+        // Writer only, the buffer to fill next, still holds whatever was written to it before it was last published
+        [[nodiscard]] T &GetBack() { return m_buffers[m_back]; }
+
+        // Writer only, make the back buffer the newest value and take the middle buffer as the new back buffer
+        void Publish() {
+            glm::u8 previous = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+            m_back = previous & INDEX_MASK;
+        }
+
+        // Reader only, take the newest published value if there is one, returns true if the front buffer changed
+        bool Acquire() {
+            // only the writer sets FRESH and only the reader clears it, so it is still set when we swap
+            if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+            glm::u8 previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = previous & INDEX_MASK;
+            return true;
+        }
+
+        // Reader only, the value taken by the last Acquire, default constructed before the first
+        [[nodiscard]] const T &GetFront() const { return m_buffers[m_front]; }
+
+        // A value has been published that the reader hasn't acquired
+        [[nodiscard]] bool HasNew() const { return m_middle.load(std::memory_order_relaxed) & FRESH; }
+
+        // Writer only, e.g. for memory usage, the other buffers are usually about the same size
+        [[nodiscard]] const T &PeekBack() const { return m_buffers[m_back]; }
+
+    private:
+        static constexpr glm::u8 INDEX_MASK = 0b11;
+        static constexpr glm::u8 FRESH = 0b100;
+
+        std::array<T, 3> m_buffers = {};
+        glm::u8 m_back = 0; // writer only
+        glm::u8 m_front = 1; // reader only
+        std::atomic<glm::u8> m_middle = 2; // index of the middle buffer, FRESH if it was published and hasn't been acquired
+    };
+} // Spire
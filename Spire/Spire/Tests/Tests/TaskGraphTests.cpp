@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include "EngineIncludes.h"
+#include "Utils/TaskGraph.h"
+
+using namespace Spire;
+
+TEST(TaskGraphTests, TestDependenciesRunFirst) {
+    TaskGraph graph(4);
+    std::mt19937 random(7);
+
+    // random DAG, every task records when it started and finished
+    constexpr glm::u32 NUM_TASKS = 2000;
+    std::atomic<glm::u32> clock = 0;
+    std::vector<glm::u32> started(NUM_TASKS, 0);
+    std::vector<glm::u32> finished(NUM_TASKS, 0);
+    std::vector<std::vector<glm::u32> > dependencies(NUM_TASKS);
+    std::vector<TaskGraph::TaskHandle> tasks;
+    TaskGroup group;
+    for (glm::u32 i = 0; i < NUM_TASKS; i++) {
+        std::vector<TaskGraph::TaskHandle> taskDependencies;
+        glm::u32 numDependencies = i == 0 ? 0 : random() % 4;
+        for (glm::u32 j = 0; j < numDependencies; j++) {
+            glm::u32 dependency = random() % i;
+            dependencies[i].push_back(dependency);
+            taskDependencies.push_back(tasks[dependency]);
+        }
+
+        tasks.push_back(graph.Submit([&, i] {
+            started[i] = ++clock;
+            finished[i] = ++clock;
+        }, taskDependencies, &group));
+    }
+
+    graph.Wait(group);
+    EXPECT_TRUE(group.IsDone());
+    for (glm::u32 i = 0; i < NUM_TASKS; i++) {
+        ASSERT_TRUE(TaskGraph::IsDone(tasks[i]));
+        for (glm::u32 dependency : dependencies[i]) {
+            ASSERT_GT(started[i], finished[dependency]);
+        }
+    }
+}
+
+TEST(TaskGraphTests, TestContinuations) {
+    TaskGraph graph(2);
+    std::vector<int> order;
+    std::mutex mutex;
+    auto record = [&](int value) {
+        return [&, value] {
+            std::lock_guard lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    // diamond, 0 -> {1, 2} -> 3, then 4
+    TaskGraph::TaskHandle first = graph.Submit(record(0));
+    TaskGraph::TaskHandle left = graph.Then(first, record(1));
+    TaskGraph::TaskHandle right = graph.Then(first, record(2));
+    TaskGraph::TaskHandle joined = graph.Submit(record(3), {left, right});
+    TaskGraph::TaskHandle last = graph.Then(joined, record(4));
+    graph.Wait(last);
+
+    ASSERT_EQ(order.size(), 5);
+    EXPECT_EQ(order[0], 0);
+    EXPECT_EQ(order[3], 3);
+    EXPECT_EQ(order[4], 4);
+
+    // depending on a finished task or nothing runs straight away
+    TaskGraph::TaskHandle after = graph.Submit(record(5), {first, nullptr});
+    graph.Wait(after);
+    EXPECT_EQ(order.back(), 5);
+}
+
+TEST(TaskGraphTests, TestChainsKeepOrder) {
+    TaskGraph graph(4);
+    TaskChains<glm::u32> chains(graph);
+
+    // tasks with the same key must never overlap and must run in the order they were submitted
+    constexpr glm::u32 NUM_KEYS = 16;
+    constexpr glm::u32 TASKS_PER_KEY = 200;
+    std::array<std::vector<glm::u32>, NUM_KEYS> order;
+    std::array<std::atomic<glm::u32>, NUM_KEYS> running = {};
+    std::atomic<glm::u32> numOverlaps = 0;
+    for (glm::u32 i = 0; i < TASKS_PER_KEY; i++) {
+        for (glm::u32 key = 0; key < NUM_KEYS; key++) {
+            chains.Submit(key, [&, key, i] {
+                if (running[key].fetch_add(1) != 0) numOverlaps++;
+                order[key].push_back(i);
+                running[key].fetch_sub(1);
+            });
+        }
+    }
+
+    chains.WaitForAll();
+    EXPECT_EQ(chains.Size(), 0);
+    EXPECT_EQ(numOverlaps, 0);
+    for (const std::vector<glm::u32> &keyOrder : order) {
+        ASSERT_EQ(keyOrder.size(), TASKS_PER_KEY);
+        for (glm::u32 i = 0; i < TASKS_PER_KEY; i++) ASSERT_EQ(keyOrder[i], i);
+    }
+
+    // a chain can also wait for tasks outside it
+    std::atomic<bool> generated = false;
+    std::atomic<bool> meshedAfterGenerating = false;
+    TaskGraph::TaskHandle generate = graph.Submit([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        generated = true;
+    });
+    chains.Submit(0, [&] { meshedAfterGenerating = generated.load(); }, nullptr, {generate});
+    EXPECT_TRUE(chains.IsRunning(0));
+    chains.Wait(0);
+    EXPECT_TRUE(meshedAfterGenerating);
+    EXPECT_FALSE(chains.IsRunning(0));
+}
+
+TEST(TaskGraphTests, TestWaitInsideTaskDoesNotBlockWorkers) {
+    // more outer tasks than workers, each waits on inner work it submitted, blocking a worker would deadlock
+    TaskGraph graph(2);
+    constexpr glm::u32 NUM_OUTER = 8;
+    constexpr glm::u32 NUM_INNER = 32;
+    std::atomic<glm::u32> numInner = 0;
+    std::atomic<glm::u32> numOuterSawInner = 0;
+    TaskGroup outer;
+    for (glm::u32 i = 0; i < NUM_OUTER; i++) {
+        graph.Submit([&] {
+            TaskGroup inner;
+            for (glm::u32 j = 0; j < NUM_INNER; j++) {
+                graph.Submit([&] { numInner++; }, {}, &inner);
+            }
+            EXPECT_TRUE(graph.IsWorkerThread());
+            graph.Wait(inner);
+            if (inner.IsDone()) numOuterSawInner++;
+        }, {}, &outer);
+    }
+
+    EXPECT_FALSE(graph.IsWorkerThread());
+    graph.Wait(outer);
+    EXPECT_EQ(numInner, NUM_OUTER * NUM_INNER);
+    EXPECT_EQ(numOuterSawInner, NUM_OUTER);
+    EXPECT_EQ(graph.GetStats().TasksRun, NUM_OUTER * NUM_INNER + NUM_OUTER);
+}
+
+TEST(TaskGraphTests, TestWaitOnlyHelpsWithHigherClasses) {
+    // an interactive task waiting on interactive work running on the other worker mustn't pick up background work meanwhile
+    TaskGraph graph(2);
+    std::atomic<bool> innerStarted = false;
+    std::atomic<bool> waiting = false;
+    std::atomic<glm::u32> numBackgroundWhileWaiting = 0;
+    TaskGroup background;
+    graph.Wait(graph.Submit([&] {
+        TaskGraph::TaskHandle inner = graph.Submit([&] {
+            innerStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }, {}, nullptr, TaskPriority::Interactive);
+        while (!innerStarted) std::this_thread::yield();
+
+        std::thread::id waitingThread = std::this_thread::get_id();
+        for (glm::u32 i = 0; i < 16; i++) {
+            graph.Submit([&, waitingThread] {
+                if (waiting && std::this_thread::get_id() == waitingThread) numBackgroundWhileWaiting++;
+            }, {}, &background, TaskPriority::Background);
+        }
+        waiting = true;
+        graph.Wait(inner);
+        waiting = false;
+    }, {}, nullptr, TaskPriority::Interactive));
+
+    graph.Wait(background);
+    EXPECT_EQ(numBackgroundWhileWaiting, 0);
+
+    // waiting on a lower class still helps with it, e.g. an interactive task waiting for generation
+    std::atomic<glm::u32> numRun = 0;
+    graph.Wait(graph.Submit([&] {
+        TaskGroup group;
+        for (glm::u32 i = 0; i < 64; i++) graph.Submit([&] { numRun++; }, {}, &group, TaskPriority::Background);
+        graph.Wait(group);
+        EXPECT_EQ(numRun, 64);
+    }, {}, nullptr, TaskPriority::Interactive));
+}
+
+// Occupy every worker until the returned function is called so tasks can be queued up before any of them run
+static std::function<void()> BlockWorkers(TaskGraph &graph, TaskGroup &group) {
+    auto release = std::make_shared<std::atomic<bool> >(false);
+    auto numBlocked = std::make_shared<std::atomic<glm::u32> >(0);
+    for (glm::u32 i = 0; i < graph.NumThreads(); i++) {
+        graph.Submit([release, numBlocked] {
+            ++*numBlocked;
+            while (!release->load()) std::this_thread::yield();
+        }, {}, &group, TaskPriority::Interactive);
+    }
+    while (numBlocked->load() < graph.NumThreads()) std::this_thread::yield();
+    return [release] { *release = true; };
+}
+
+TEST(TaskGraphTests, TestInteractiveJumpsQueue) {
+    TaskGraph graph(2);
+    TaskGroup group;
+    std::function<void()> release = BlockWorkers(graph, group);
+
+    std::vector<TaskPriority> order;
+    std::mutex mutex;
+    auto submit = [&](TaskPriority priority) {
+        graph.Submit([&, priority] {
+            std::lock_guard lock(mutex);
+            order.push_back(priority);
+        }, {}, &group, priority);
+    };
+
+    // a saturated background queue, then the edit the player is waiting on
+    constexpr glm::u32 NUM_BACKGROUND = 1000;
+    constexpr glm::u32 NUM_INTERACTIVE = 8;
+    for (glm::u32 i = 0; i < NUM_BACKGROUND; i++) submit(TaskPriority::Background);
+    for (glm::u32 i = 0; i < NUM_INTERACTIVE; i++) submit(TaskPriority::Interactive);
+    EXPECT_EQ(graph.NumQueued(TaskPriority::Background), NUM_BACKGROUND);
+
+    release();
+    graph.Wait(group);
+    ASSERT_EQ(order.size(), NUM_BACKGROUND + NUM_INTERACTIVE);
+
+    // every interactive task was taken before any background task, only the order they were recorded in can differ
+    glm::u32 lastInteractive = 0;
+    for (glm::u32 i = 0; i < order.size(); i++) {
+        if (order[i] == TaskPriority::Interactive) lastInteractive = i;
+    }
+    EXPECT_LT(lastInteractive, NUM_INTERACTIVE + graph.NumThreads());
+}
+
+TEST(TaskGraphTests, TestStarvationProtection) {
+    TaskGraph graph(TaskGraph::Settings{.NumThreads = 1, .StarvationLimit = 4});
+    TaskGroup group;
+    std::function<void()> release = BlockWorkers(graph, group);
+
+    std::vector<TaskPriority> order;
+    for (glm::u32 i = 0; i < 100; i++) {
+        graph.Submit([&] { order.push_back(TaskPriority::Interactive); }, {}, &group, TaskPriority::Interactive);
+    }
+    for (glm::u32 i = 0; i < 5; i++) {
+        graph.Submit([&] { order.push_back(TaskPriority::Background); }, {}, &group, TaskPriority::Background);
+    }
+
+    release();
+    graph.Wait(group);
+
+    // with one worker a background task runs after every 4 interactive tasks until they are all done
+    for (glm::u32 i = 0; i < 25; i++) {
+        EXPECT_EQ(order[i], i % 5 == 4 ? TaskPriority::Background : TaskPriority::Interactive);
+    }
+    EXPECT_EQ(graph.GetStats().StarvationRuns, 5);
+}
+
+TEST(TaskGraphTests, TestConcurrencyLimit) {
+    TaskGraph::Settings settings = {.NumThreads = 4};
+    settings.MaxThreads[static_cast<std::size_t>(TaskPriority::IO)] = 1;
+    TaskGraph graph(settings);
+    EXPECT_EQ(graph.GetMaxThreads(TaskPriority::IO), 1);
+    EXPECT_EQ(graph.GetMaxThreads(TaskPriority::Normal), 4);
+
+    std::atomic<glm::u32> running = 0;
+    std::atomic<glm::u32> maxRunning = 0;
+    std::atomic<glm::u32> numNormal = 0;
+    TaskGroup group;
+    for (glm::u32 i = 0; i < 50; i++) {
+        graph.Submit([&] {
+            glm::u32 now = ++running;
+            glm::u32 max = maxRunning.load();
+            while (now > max && !maxRunning.compare_exchange_weak(max, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            --running;
+        }, {}, &group, TaskPriority::IO);
+        graph.Submit([&] { numNormal++; }, {}, &group);
+    }
+
+    graph.Wait(group);
+    EXPECT_EQ(maxRunning, 1);
+    EXPECT_EQ(numNormal, 50);
+}
+
+TEST(TaskGraphTests, TestParallelFor) {
+    TaskGraph::Settings settings = {.NumThreads = 4};
+    settings.MaxThreads[static_cast<std::size_t>(TaskPriority::Background)] = 2;
+    TaskGraph graph(settings);
+
+    // every index runs exactly once, including when the range doesn't divide evenly
+    std::vector<std::atomic<glm::u32> > counts(1003);
+    graph.ParallelFor(3, counts.size(), [&](std::size_t i) { counts[i]++; });
+    for (std::size_t i = 0; i < counts.size(); i++) EXPECT_EQ(counts[i], i < 3 ? 0 : 1);
+
+    // the loop is split into tasks of its class, so it can't use more workers than the class is allowed
+    std::atomic<glm::u32> running = 0;
+    std::atomic<glm::u32> maxRunning = 0;
+    graph.ParallelFor(0, 64, [&](std::size_t) {
+        glm::u32 now = ++running;
+        glm::u32 max = maxRunning.load();
+        while (now > max && !maxRunning.compare_exchange_weak(max, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        --running;
+    }, TaskPriority::Background);
+    EXPECT_LE(maxRunning, 2);
+
+    // nested loops help instead of blocking the workers
+    std::atomic<glm::u32> numInner = 0;
+    graph.ParallelFor(0, 8, [&](std::size_t) {
+        graph.ParallelFor(0, 8, [&](std::size_t) { numInner++; });
+    });
+    EXPECT_EQ(numInner, 64);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "EngineIncludes.h"
+#include "Utils/TripleBuffer.h"
+
+#include <thread>
+
+using namespace Spire;
+
+TEST(TripleBufferTests, TestLatestValueWins) {
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.HasNew());
+    EXPECT_FALSE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetFront(), 0);
+
+    buffer.GetBack() = 1;
+    buffer.Publish();
+    buffer.GetBack() = 2;
+    buffer.Publish();
+    EXPECT_TRUE(buffer.HasNew());
+
+    // 1 was never acquired so it is skipped
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetFront(), 2);
+    EXPECT_FALSE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetFront(), 2);
+
+    // the writer never gets the front buffer back while the reader holds it
+    for (int i = 3; i < 10; i++) {
+        EXPECT_NE(&buffer.GetBack(), &buffer.GetFront());
+        buffer.GetBack() = i;
+        buffer.Publish();
+        EXPECT_EQ(buffer.GetFront(), 2);
+    }
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetFront(), 9);
+}
+
+namespace {
+    // Stands in for a chunk's draw state, every field is written with the tick that last changed it
+    struct ChunkRecord {
+        glm::u64 Tick;
+        std::array<glm::u32, 15> Data;
+        glm::u64 Checksum;
+    };
+
+    struct WorldSnapshot {
+        glm::u64 Version = 0;
+        std::vector<ChunkRecord> Chunks;
+    };
+
+    glm::u64 CalculateChecksum(const ChunkRecord &record) {
+        glm::u64 checksum = record.Tick * 31;
+        for (glm::u32 value : record.Data) checksum = checksum * 1099511628211ull ^ value;
+        return checksum;
+    }
+
+    // Number of chunks the world has after a tick, grows and shrinks so the snapshot vectors reallocate
+    std::size_t NumChunksAtTick(glm::u64 tick) {
+        return 64 + (tick * 37) % 512;
+    }
+}
+
+// A simulation thread mutates a world and publishes a snapshot every tick while the render thread takes the newest one,
+// a snapshot must always be a single tick's whole world and must not change while the render thread holds it
+TEST(TripleBufferTests, TestSnapshotsAreNeverTorn) {
+    static constexpr glm::u64 NUM_TICKS = 20000;
+
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::atomic<bool> finished = false;
+
+    std::thread simulation([&] {
+        std::vector<ChunkRecord> world;
+        std::mt19937 random(3);
+        for (glm::u64 tick = 1; tick <= NUM_TICKS; tick++) {
+            world.resize(NumChunksAtTick(tick));
+            for (ChunkRecord &chunk : world) {
+                chunk.Tick = tick;
+                for (glm::u32 &value : chunk.Data) value = random();
+                chunk.Checksum = CalculateChecksum(chunk);
+            }
+
+            WorldSnapshot &snapshot = snapshots.GetBack();
+            snapshot.Version = tick;
+            snapshot.Chunks.assign(world.begin(), world.end());
+            snapshots.Publish();
+        }
+        finished = true;
+    });
+
+    glm::u64 numAcquired = 0;
+    glm::u64 lastVersion = 0;
+    glm::u32 numTorn = 0;
+    auto isWhole = [](const WorldSnapshot &snapshot) {
+        if (snapshot.Chunks.size() != NumChunksAtTick(snapshot.Version)) return false;
+        for (const ChunkRecord &chunk : snapshot.Chunks) {
+            if (chunk.Tick != snapshot.Version || chunk.Checksum != CalculateChecksum(chunk)) return false;
+        }
+        return true;
+    };
+
+    while (true) {
+        // read the flag first so the last publish is acquired after it is set
+        bool simulationFinished = finished;
+        if (snapshots.Acquire()) {
+            const WorldSnapshot &snapshot = snapshots.GetFront();
+            numAcquired++;
+            EXPECT_GT(snapshot.Version, lastVersion);
+            lastVersion = snapshot.Version;
+            if (!isWhole(snapshot)) numTorn++;
+
+            // hold it like a frame being recorded while the simulation keeps publishing, it must not change
+            std::this_thread::yield();
+            if (snapshot.Version != lastVersion || !isWhole(snapshot)) numTorn++;
+        }
+        if (simulationFinished && !snapshots.HasNew()) break;
+    }
+    simulation.join();
+
+    info("Acquired {} of {} snapshots", numAcquired, NUM_TICKS);
+    EXPECT_EQ(numTorn, 0);
+    EXPECT_GT(numAcquired, 0);
+    EXPECT_EQ(lastVersion, NUM_TICKS);
+}
@@ -1,6 +1,9 @@
 #include "Chunk.h"
 
 #include "AOLookupTable.h"
+#include "ChunkResidencyManager.h"
+#include "Serialisation/ChunkSwapStore.h"
+#include "VoxelKernels.h"
 #include "Meshing/GreedyMeshingGrid.h"
 #include "VoxelWorld.h"
 #include "Meshing/ChunkMesh.h"
@@ -45,8 +48,9 @@ namespace SpireVoxel {
         if (queryChunkPosition != chunk.ChunkPosition) {
             queryChunk = chunk.World.TryGetLoadedChunk(queryChunkPosition);
             if (!queryChunk) return VOXEL_TYPE_AIR;
+            queryChunk->Touch();
         }
-        return queryChunk->VoxelData[SPIRE_VOXEL_POSITION_TO_INDEX(queryPosition)];
+        return queryChunk->GetVoxelData()[SPIRE_VOXEL_POSITION_TO_INDEX(queryPosition)];
     }
 
 
@@ -65,7 +69,7 @@ namespace SpireVoxel {
 
         TotalRenderedVoxelFaces++;
 
-        VoxelType type = VoxelData[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)];
+        VoxelType type = GetVoxelData()[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)];
         assert(type != 0);
 
         // Push voxel type
@@ -217,24 +221,154 @@ namespace SpireVoxel {
         PushRelatedFaceData(mesh, p, width, height, face);
     }
 
+    Chunk::Chunk(glm::ivec3 chunkPosition, VoxelWorld &world)
+        : ChunkPosition(chunkPosition),
+          World(world) {
+    }
+
+    void Chunk::ShareVoxelsFrom(const Chunk &other) {
+        Touch();
+        other.Touch();
+        BeginWrite();
+        m_voxels = other.m_voxels;
+        EndWrite();
+    }
+
+    void Chunk::ModifyVoxels(const std::function<void(std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels)> &modify) {
+        Touch();
+        BeginWrite();
+        ChunkVoxelStorage::Data &data = m_voxels.Write();
+        modify(data.Voxels);
+        VoxelKernels::PackPresenceBits(data.Voxels.data(), data.Bits.GetWords(), data.Voxels.size());
+        data.Occupancy.Recalculate(data.Bits);
+        assert(data.Occupancy.GetSolidCount() == VoxelKernels::CountNonAir(data.Voxels.data(), data.Voxels.size()));
+        EndWrite();
+    }
+
+    VoxelType Chunk::GetVoxel(glm::u32 index) const {
+        Touch();
+        while (true) {
+            glm::u64 version = BeginRead();
+            VoxelType type = GetVoxelData()[index];
+            if (EndRead(version)) return type;
+            std::this_thread::yield();
+        }
+    }
+
+    bool Chunk::EndRead(glm::u64 version) const {
+        // make sure the voxel reads happen before the version is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version % 2 == 0 && m_version.load(std::memory_order_relaxed) == version;
+    }
+
+    void Chunk::BeginWrite() {
+        glm::u64 version = m_version.load(std::memory_order_relaxed);
+        while (true) {
+            if (version % 2 == 0 && m_version.compare_exchange_weak(version, version + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            if (version % 2 == 1) {
+                std::this_thread::yield();
+                version = m_version.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void Chunk::Touch() const {
+        ChunkResidencyManager &residency = World.GetResidencyManager();
+        glm::u64 frame = residency.GetFrame();
+        bool firstAccessThisFrame = m_lastAccessFrame.load(std::memory_order_relaxed) != frame;
+        if (firstAccessThisFrame) m_lastAccessFrame.store(frame, std::memory_order_relaxed);
+
+        bool madeResident = m_voxels.EnsureResident();
+        if (firstAccessThisFrame || madeResident) residency.OnChunkAccessed(firstAccessThisFrame, madeResident);
+    }
+
+    // Compressing and paging out don't change the voxels so they don't change the version either
+
+    bool Chunk::Compress(float minimumRatio) {
+        // don't keep trying to compress a chunk that didn't compress well until it is edited
+        glm::u64 version = m_version.load(std::memory_order_relaxed);
+        if (version == m_incompressibleVersion) return false;
+
+        bool compressed = m_voxels.Compress(minimumRatio);
+        if (!compressed) m_incompressibleVersion = version;
+        return compressed;
+    }
+
+    bool Chunk::PageOut(ChunkSwapStore &swapStore) {
+        glm::u64 version = m_version.load(std::memory_order_relaxed);
+        if (!swapStore.PageOut(m_voxels, ChunkPosition, version == m_swapVersion)) return false;
+        m_swapVersion = version;
+        return true;
+    }
+
+    void Chunk::EndWrite() {
+        assert(m_version.load(std::memory_order_relaxed) % 2 == 1);
+        m_version.fetch_add(1, std::memory_order_release);
+    }
+
     void Chunk::SetVoxel(glm::u32 index, VoxelType type) {
-        VoxelData[index] = type;
-        VoxelBits[index] = static_cast<bool>(type);
+        Touch();
+        // don't copy shared storage when nothing changes
+        if (GetVoxelData()[index] == type) return;
+
+        BeginWrite();
+        ChunkVoxelStorage::Data &data = m_voxels.Write();
+        data.Occupancy.OnVoxelChanged(index, data.Bits[index], static_cast<bool>(type));
+        data.Voxels[index] = type;
+        data.Bits.Set(index, static_cast<bool>(type));
+        EndWrite();
     }
 
     void Chunk::SetVoxels(glm::u32 startIndex, glm::u32 endIndex, VoxelType type) {
-        std::fill(VoxelData.data() + startIndex,
-                  VoxelData.data() + endIndex,
-                  type);
+        assert(startIndex <= endIndex && endIndex <= SPIRE_VOXEL_CHUNK_VOLUME);
+        Touch();
+        if (m_voxels.IsShared()) {
+            // don't copy shared storage when nothing changes
+            if (VoxelKernels::AllEqual(GetVoxelData().data() + startIndex, endIndex - startIndex, type)) return;
+        }
 
-        for (glm::u32 i = startIndex; i < endIndex; ++i) {
-            VoxelBits[i] = static_cast<bool>(type);
+        BeginWrite();
+        ChunkVoxelStorage::Data &data = m_voxels.Write();
+        data.Occupancy.OnVoxelsSet(startIndex, endIndex, static_cast<bool>(type), data.Bits);
+        VoxelKernels::Fill(data.Voxels.data() + startIndex, endIndex - startIndex, type);
+        VoxelKernels::SetBitSpan(data.Bits.GetWords(), startIndex, endIndex, static_cast<bool>(type));
+        EndWrite();
+    }
+
+    void Chunk::SetVoxels(glm::u32 startIndex, std::span<const VoxelType> types) {
+        assert(startIndex + types.size() <= SPIRE_VOXEL_CHUNK_VOLUME);
+        Touch();
+        // don't copy shared storage when nothing changes
+        if (VoxelKernels::Equal(GetVoxelData().data() + startIndex, types.data(), types.size())) return;
+
+        BeginWrite();
+        ChunkVoxelStorage::Data &data = m_voxels.Write();
+        for (glm::u32 i = 0; i < types.size(); i++) {
+            glm::u32 index = startIndex + i;
+            if (data.Voxels[index] == types[i]) continue;
+            data.Occupancy.OnVoxelChanged(index, data.Bits[index], static_cast<bool>(types[i]));
+            data.Voxels[index] = types[i];
+            data.Bits.Set(index, static_cast<bool>(types[i]));
         }
+        EndWrite();
+    }
+
+    // true if rows [rowStart, rowEnd) of a slice don't contain any voxels
+    bool AreSliceRowsEmpty(const ChunkOccupancy &occupancy, glm::u32 slice, glm::u32 rowStart, glm::u32 rowEnd, glm::u32 face) {
+        glm::uvec3 a = GreedyMeshingGrid::GetChunkCoords(slice, rowStart, 0, face);
+        glm::uvec3 b = GreedyMeshingGrid::GetChunkCoords(slice, rowEnd - 1, SPIRE_VOXEL_CHUNK_SIZE - 1, face);
+        return occupancy.IsRegionEmpty(glm::min(a, b), glm::max(a, b) + glm::uvec3(1));
     }
 
     ChunkMesh Chunk::GenerateMesh() {
+        Touch();
         TotalRenderedVoxelFaces = 0;
         ChunkMesh mesh = {};
+        const VoxelBitmask &voxelBits = GetVoxelBits();
+        const ChunkOccupancy &occupancy = GetOccupancy();
+        if (occupancy.IsEmpty()) return mesh;
 
         // slice, row, col are voxel chunk coordinates, but they could be different depending on face, see GreedyMeshingBitmask::GetChunkCoords
         // slice is the slice of voxels we are working with
@@ -242,10 +376,18 @@ namespace SpireVoxel {
 
         for (glm::u32 face = 0; face < SPIRE_VOXEL_NUM_FACES; face += 2) {
             for (glm::u32 slice = 0; slice < SPIRE_VOXEL_CHUNK_SIZE; slice++) {
+                // faces in a slice only belong to voxels in that slice, so an empty slice has no faces
+                if (AreSliceRowsEmpty(occupancy, slice, 0, SPIRE_VOXEL_CHUNK_SIZE, face)) continue;
+
                 // generate the grid
                 std::array<GreedyMeshingGrid, 2> grids;
 
                 for (glm::u32 row = 0; row < SPIRE_VOXEL_CHUNK_SIZE; row++) {
+                    if (row % ChunkOccupancy::BRICK_SIZE == 0 && AreSliceRowsEmpty(occupancy, slice, row, row + ChunkOccupancy::BRICK_SIZE, face)) {
+                        row += ChunkOccupancy::BRICK_SIZE - 1;
+                        continue;
+                    }
+
                     for (glm::u32 col = 0; col < SPIRE_VOXEL_CHUNK_SIZE; col++) {
                         glm::ivec3 chunkCoords = GreedyMeshingGrid::GetChunkCoords(slice, row, col, face);
                         glm::ivec3 adjacentPositive = chunkCoords + FaceToDirection(face);
@@ -253,19 +395,19 @@ namespace SpireVoxel {
                         bool adjacentPositiveIsPresent = adjacentPositive.x < SPIRE_VOXEL_CHUNK_SIZE &&
                                                          adjacentPositive.y < SPIRE_VOXEL_CHUNK_SIZE &&
                                                          adjacentPositive.z < SPIRE_VOXEL_CHUNK_SIZE &&
-                                                         VoxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(adjacentPositive)];
+                                                         voxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(adjacentPositive)];
                         bool adjacentNegativeIsPresent = adjacentNegative.x >= 0 &&
                                                          adjacentNegative.y >= 0 &&
                                                          adjacentNegative.z >= 0 &&
-                                                         VoxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(adjacentNegative)];
+                                                         voxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(adjacentNegative)];
                         // This seems to be getting compiler optimised really heavily
                         // I tried adding another check and not generating any faces if the adjacent is outside of chunk bounds
                         // and it reduced generation time by 20%
-                        if (VoxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)] && !adjacentPositiveIsPresent) {
+                        if (voxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)] && !adjacentPositiveIsPresent) {
                             grids[0].SetBit(row, col);
                         }
 
-                        if (VoxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)] && !adjacentNegativeIsPresent) {
+                        if (voxelBits[SPIRE_VOXEL_POSITION_TO_INDEX(chunkCoords)] && !adjacentNegativeIsPresent) {
                             grids[1].SetBit(row, col);
                         }
                     }
@@ -342,12 +484,6 @@ namespace SpireVoxel {
         return params;
     }
 
-    void Chunk::RegenerateVoxelBits() {
-        for (std::size_t i = 0; i < VoxelData.size(); i++) {
-            VoxelBits[i] = static_cast<bool>(VoxelData[i]); // todo can this be done in a single write?
-        }
-    }
-
     std::optional<std::size_t> Chunk::GetIndexOfVoxel(glm::ivec3 chunkPosition, glm::ivec3 voxelWorldPosition) {
         if (chunkPosition != VoxelWorld::GetChunkPositionOfVoxel(voxelWorldPosition)) return std::nullopt;
         glm::uvec3 pos = voxelWorldPosition - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE;
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "ChunkDrawParams.h"
+#include "ChunkVoxelStorage.h"
 #include "DetailLevel.h"
 #include "EngineIncludes.h"
 #include "VoxelType.h"
+#include "Utils/SlotMap.h"
 #include "../../Assets/Shaders/ShaderInfo.h"
 
 namespace SpireVoxel {
@@ -11,45 +13,104 @@ namespace SpireVoxel {
 }
 
 namespace SpireVoxel {
+    class ChunkSwapStore;
     class VoxelWorld;
 }
 
 namespace SpireVoxel {
     static constexpr int VOXEL_TYPE_AIR = 0;
 
+    // Identifies a loaded chunk, see VoxelWorld::TryGetChunk
+    using ChunkHandle = SlotMapHandle;
+
     // Represents a 64^3 chunk of a world
     struct Chunk {
         static constexpr glm::u32 VERTICES_PER_FACE = 6;
 
+        Chunk(glm::ivec3 chunkPosition, VoxelWorld &world);
+
         glm::ivec3 ChunkPosition;
         VoxelWorld &World;
-        std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> VoxelData{}; // Do not edit this directly, use SetVoxel or SetVoxels which updates other internal state (e.g. VoxelBits)
-        std::uint64_t CorruptedMemoryCheck = 9238745897238972389; // This value will be changed if something overruns when editing VoxelData
-        std::bitset<SPIRE_VOXEL_CHUNK_VOLUME> VoxelBits{}; // 1 = voxel is present, 0 = voxel is empty
-        std::uint64_t CorruptedMemoryCheck2 = 12387732823748723; // This value will be changed if something overruns when editing VoxelBits
+        // Set by the world when loaded, the index is also the chunk's slot in the GPU ChunkData buffer
+        ChunkHandle Handle = {};
         Spire::BufferAllocator::Allocation VertexAllocation = {};
         Spire::BufferAllocator::Allocation VoxelDataAllocation = {};
         Spire::BufferAllocator::Allocation AODataAllocation = {};
-        std::array<glm::u32, SPIRE_VOXEL_NUM_FACES> NumVertices;
-        glm::u32 TotalVertices;
-        glm::u32 TotalRenderedVoxelFaces;
+        std::array<glm::u32, SPIRE_VOXEL_NUM_FACES> NumVertices{};
+        glm::u32 TotalVertices = 0;
+        glm::u32 TotalRenderedVoxelFaces = 0;
         DetailLevel LOD = {};
 
+        // Read only view of the voxel types, use SetVoxel or SetVoxels to edit which updates other internal state (e.g. voxel bits)
+        [[nodiscard]] const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &GetVoxelData() const { return m_voxels.Read().Voxels; }
+
+        // 1 = voxel is present, 0 = voxel is empty
+        [[nodiscard]] const VoxelBitmask &GetVoxelBits() const { return m_voxels.Read().Bits; }
+
+        // Bulk write the voxel types (e.g. deserializing), copies the storage first if it is shared
+        // The version stays odd until modify returns and the bits are regenerated, so readers discard anything they read in between
+        void ModifyVoxels(const std::function<void(std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels)> &modify);
+
+        // Read a single voxel, safe while another thread is writing to the chunk
+        [[nodiscard]] VoxelType GetVoxel(glm::u32 index) const;
+
+        // Seqlock style versioning so voxel data can be read while other threads edit the chunk
+        // The version is odd while a write is in progress and increases with every write
+        // Readers call BeginRead, read the voxels, then EndRead, if EndRead returns false the data read may be torn and must be discarded
+        // Every edit notifies the chunk after its write finishes, so a reader that discards its result will be given the chunk again
+        [[nodiscard]] glm::u64 BeginRead() const { return m_version.load(std::memory_order_acquire); }
+
+        [[nodiscard]] bool EndRead(glm::u64 version) const;
+
+        [[nodiscard]] glm::u64 GetVersion() const { return m_version.load(std::memory_order_acquire); }
+
+        // Which bricks of the chunk contain voxels, use to skip empty space
+        [[nodiscard]] const ChunkOccupancy &GetOccupancy() const { return m_voxels.Read().Occupancy; }
+
+        [[nodiscard]] const ChunkVoxelStorage &GetVoxelStorage() const { return m_voxels; }
+
+        // Share the voxels of another chunk, nothing is copied until either chunk is edited
+        void ShareVoxelsFrom(const Chunk &other);
+
+        // true if the voxel storage is shared with another chunk (or is the shared empty storage)
+        [[nodiscard]] bool IsSharingVoxels() const { return m_voxels.IsShared(); }
+
         void SetVoxel(glm::u32 index, VoxelType type);
 
         void SetVoxels(glm::u32 startIndex, glm::u32 endIndex, VoxelType type);
 
+        // Copy types to voxels [startIndex, startIndex + types.size())
+        void SetVoxels(glm::u32 startIndex, std::span<const VoxelType> types);
+
         [[nodiscard]] ChunkMesh GenerateMesh();
 
         [[nodiscard]] ChunkData GenerateChunkData() const;
 
         [[nodiscard]] ChunkDrawParams GenerateDrawParams(glm::u32 chunkIndex) const;
 
-        void RegenerateVoxelBits();
-
         [[nodiscard]] static std::optional<std::size_t> GetIndexOfVoxel(glm::ivec3 chunkPosition, glm::ivec3 voxelWorldPosition);
 
-        [[nodiscard]] bool IsCorrupted() const { return CorruptedMemoryCheck != 9238745897238972389 || CorruptedMemoryCheck2 != 12387732823748723; }
+        [[nodiscard]] bool IsCorrupted() const { return m_voxels.IsCorrupted(); }
+
+        // Mark the chunk as used this frame and decompress/page it in if needed, see ChunkResidencyManager
+        // Edits, meshing, raycasts and serialisation call this, reads through GetVoxelData still make it resident but aren't counted
+        void Touch() const;
+
+        // Compress the voxels in place until the next access, nothing else can be using the chunk
+        bool Compress(float minimumRatio);
+
+        // Move the voxels to the swap store until the next access, nothing else can be using the chunk
+        // Doesn't write the voxels again if they haven't changed since the chunk was last paged out
+        bool PageOut(ChunkSwapStore &swapStore);
+
+        [[nodiscard]] bool IsCompressed() const { return m_voxels.IsCompressed(); }
+
+        [[nodiscard]] bool IsPagedOut() const { return m_voxels.IsPagedOut(); }
+
+        [[nodiscard]] glm::u64 GetLastAccessFrame() const { return m_lastAccessFrame.load(std::memory_order_relaxed); }
+
+        // Set while the chunk is waiting in the renderer's edited chunks, see ChunkDirtyList
+        [[nodiscard]] std::atomic<bool> &GetDirtyFlag() const { return m_dirty; }
 
     private:
         void PushFace(ChunkMesh &mesh, glm::u32 face, glm::uvec3 p, glm::u32 width, glm::u32 height);
@@ -57,5 +118,18 @@ namespace SpireVoxel {
         void PushRelatedFaceData(ChunkMesh &mesh, glm::uvec3 start, glm::u32 width, glm::u32 height, glm::u32 face);
 
         void PushRelatedVoxelData(ChunkMesh &mesh, glm::uvec3 chunkCoords, glm::u32 face);
+
+        // Writers are serialized, waits if another thread is writing to this chunk
+        void BeginWrite();
+
+        void EndWrite();
+
+    private:
+        ChunkVoxelStorage m_voxels;
+        std::atomic<glm::u64> m_version = 0;
+        mutable std::atomic<glm::u64> m_lastAccessFrame = 0;
+        mutable std::atomic<bool> m_dirty = false;
+        glm::u64 m_incompressibleVersion = std::numeric_limits<glm::u64>::max();
+        glm::u64 m_swapVersion = std::numeric_limits<glm::u64>::max(); // version of the voxels in the swap store
     };
 } // SpireVoxel
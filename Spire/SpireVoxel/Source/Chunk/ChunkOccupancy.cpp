@@ -0,0 +1,87 @@
+#include "ChunkOccupancy.h"
+
+namespace SpireVoxel {
+    static_assert(SPIRE_VOXEL_CHUNK_SIZE % ChunkOccupancy::BRICK_SIZE == 0);
+    static_assert(ChunkOccupancy::BRICK_VOLUME <= std::numeric_limits<glm::u16>::max());
+    static_assert(ChunkOccupancy::BRICK_SIZE == 8); // Recalculate counts a byte of a row at a time
+
+    void ChunkOccupancy::OnVoxelChanged(glm::u32 voxelIndex, bool wasPresent, bool isPresent) {
+        if (wasPresent == isPresent) return;
+
+        glm::u32 brickIndex = GetBrickIndexOfVoxel(voxelIndex);
+        if (isPresent) {
+            m_brickSolidCounts[brickIndex]++;
+            m_solidCount++;
+        } else {
+            assert(m_brickSolidCounts[brickIndex] > 0);
+            m_brickSolidCounts[brickIndex]--;
+            m_solidCount--;
+        }
+        m_brickMask[brickIndex] = m_brickSolidCounts[brickIndex] > 0;
+    }
+
+    void ChunkOccupancy::OnVoxelsSet(glm::u32 startIndex, glm::u32 endIndex, bool isPresent, const VoxelBitmask &oldVoxelBits) {
+        assert(startIndex <= endIndex && endIndex <= SPIRE_VOXEL_CHUNK_VOLUME);
+
+        // z is contiguous, so every aligned run of BRICK_SIZE indices is in a single brick
+        glm::u32 segmentStart = startIndex;
+        while (segmentStart < endIndex) {
+            glm::u32 segmentEnd = std::min(endIndex, (segmentStart / BRICK_SIZE + 1) * BRICK_SIZE);
+            glm::u32 brickIndex = GetBrickIndexOfVoxel(segmentStart);
+
+            auto oldPresent = static_cast<glm::u32>(oldVoxelBits.Count(segmentStart, segmentEnd));
+            glm::u32 newPresent = isPresent ? segmentEnd - segmentStart : 0;
+
+            m_brickSolidCounts[brickIndex] = static_cast<glm::u16>(m_brickSolidCounts[brickIndex] - oldPresent + newPresent);
+            m_solidCount = m_solidCount - oldPresent + newPresent;
+            m_brickMask[brickIndex] = m_brickSolidCounts[brickIndex] > 0;
+
+            segmentStart = segmentEnd;
+        }
+    }
+
+    void ChunkOccupancy::Recalculate(const VoxelBitmask &voxelBits) {
+        m_brickSolidCounts = {};
+        m_solidCount = 0;
+
+        // each word is a row along z and each byte of it is the part of the row in one brick
+        for (glm::u32 wordIndex = 0; wordIndex < VoxelBitmask::NUM_WORDS; wordIndex++) {
+            glm::u64 word = voxelBits.GetWord(wordIndex);
+            if (word == 0) continue;
+
+            glm::u32 x = wordIndex / SPIRE_VOXEL_CHUNK_SIZE;
+            glm::u32 y = wordIndex % SPIRE_VOXEL_CHUNK_SIZE;
+            for (glm::u32 brickZ = 0; brickZ < BRICKS_PER_AXIS; brickZ++) {
+                auto count = static_cast<glm::u32>(std::popcount((word >> (brickZ * BRICK_SIZE)) & 0xFF));
+                m_brickSolidCounts[GetBrickIndex({x / BRICK_SIZE, y / BRICK_SIZE, brickZ})] += count;
+                m_solidCount += count;
+            }
+        }
+
+        for (glm::u32 brickIndex = 0; brickIndex < NUM_BRICKS; brickIndex++) {
+            m_brickMask[brickIndex] = m_brickSolidCounts[brickIndex] > 0;
+        }
+    }
+
+    bool ChunkOccupancy::IsRegionEmpty(glm::uvec3 min, glm::uvec3 maxExclusive) const {
+        assert(maxExclusive.x <= SPIRE_VOXEL_CHUNK_SIZE && maxExclusive.y <= SPIRE_VOXEL_CHUNK_SIZE && maxExclusive.z <= SPIRE_VOXEL_CHUNK_SIZE);
+        if (m_solidCount == 0) return true;
+        if (min.x >= maxExclusive.x || min.y >= maxExclusive.y || min.z >= maxExclusive.z) return true;
+
+        glm::uvec3 minBrick = min / BRICK_SIZE;
+        glm::uvec3 maxBrick = (maxExclusive - glm::uvec3(1)) / BRICK_SIZE; // inclusive
+        for (glm::u32 x = minBrick.x; x <= maxBrick.x; x++) {
+            for (glm::u32 y = minBrick.y; y <= maxBrick.y; y++) {
+                for (glm::u32 z = minBrick.z; z <= maxBrick.z; z++) {
+                    if (m_brickMask[GetBrickIndex({x, y, z})]) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    glm::u32 ChunkOccupancy::GetBrickIndexOfVoxel(glm::u32 voxelIndex) {
+        glm::uvec3 position = SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, voxelIndex);
+        return GetBrickIndexOfVoxel(position);
+    }
+} // SpireVoxel
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "VoxelBitmask.h"
+#include "VoxelType.h"
+#include "../../Assets/Shaders/ShaderInfo.h"
+
+namespace SpireVoxel {
+    // Summary of which parts of a chunk contain voxels
+    // The chunk is split into 8^3 bricks, each brick has a bit that is set if any voxel in the brick is present
+    // Used to quickly skip empty space (raycasting, meshing, LOD)
+    class ChunkOccupancy {
+    public:
+        static constexpr glm::u32 BRICK_SIZE = 8;
+        static constexpr glm::u32 BRICKS_PER_AXIS = SPIRE_VOXEL_CHUNK_SIZE / BRICK_SIZE;
+        static constexpr glm::u32 NUM_BRICKS = BRICKS_PER_AXIS * BRICKS_PER_AXIS * BRICKS_PER_AXIS;
+        static constexpr glm::u32 BRICK_VOLUME = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+    public:
+        // Update after a single voxel changed from wasPresent to isPresent
+        void OnVoxelChanged(glm::u32 voxelIndex, bool wasPresent, bool isPresent);
+
+        // Update after voxels [startIndex, endIndex) were all set to the same type
+        // Must be called before the voxel bits are updated
+        void OnVoxelsSet(glm::u32 startIndex, glm::u32 endIndex, bool isPresent, const VoxelBitmask &oldVoxelBits);
+
+        // Rebuild from the voxel bits
+        void Recalculate(const VoxelBitmask &voxelBits);
+
+        [[nodiscard]] bool IsBrickEmpty(glm::u32 brickIndex) const { return !m_brickMask[brickIndex]; }
+
+        // Returns true if every voxel in [min, maxExclusive) is air, coordinates are in chunk space
+        // This is conservative, it only looks at bricks so it may return false for an empty region inside a non-empty brick
+        [[nodiscard]] bool IsRegionEmpty(glm::uvec3 min, glm::uvec3 maxExclusive) const;
+
+        [[nodiscard]] bool IsEmpty() const { return m_solidCount == 0; }
+
+        [[nodiscard]] bool IsFull() const { return m_solidCount == SPIRE_VOXEL_CHUNK_VOLUME; }
+
+        // Number of voxels in the chunk that aren't air
+        [[nodiscard]] glm::u32 GetSolidCount() const { return m_solidCount; }
+
+        [[nodiscard]] glm::u32 GetBrickSolidCount(glm::u32 brickIndex) const { return m_brickSolidCounts[brickIndex]; }
+
+        [[nodiscard]] const std::bitset<NUM_BRICKS> &GetBrickMask() const { return m_brickMask; }
+
+        // Brick coordinates are in 0 to BRICKS_PER_AXIS range
+        [[nodiscard]] static glm::u32 GetBrickIndex(glm::uvec3 brickCoords) {
+            return (brickCoords.x * BRICKS_PER_AXIS + brickCoords.y) * BRICKS_PER_AXIS + brickCoords.z;
+        }
+
+        [[nodiscard]] static glm::u32 GetBrickIndexOfVoxel(glm::uvec3 voxelPositionInChunk) { return GetBrickIndex(voxelPositionInChunk / BRICK_SIZE); }
+
+        [[nodiscard]] static glm::u32 GetBrickIndexOfVoxel(glm::u32 voxelIndex);
+
+    private:
+        std::bitset<NUM_BRICKS> m_brickMask{}; // 1 = brick contains at least one voxel
+        std::array<glm::u16, NUM_BRICKS> m_brickSolidCounts{};
+        glm::u32 m_solidCount = 0;
+    };
+} // SpireVoxel
@@ -0,0 +1,218 @@
+#include "ChunkResidencyManager.h"
+
+#include "Chunk.h"
+#include "VoxelWorld.h"
+#include "Rendering/VoxelWorldRenderer.h"
+#include "Utils/IVoxelCamera.h"
+#include "Utils/TaskGraph.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    ChunkResidencyManager::ChunkResidencyManager(VoxelWorld &world, const IVoxelCamera &camera, Settings settings)
+        : m_world(world),
+          m_camera(camera),
+          m_settings(settings) {
+        m_compressionJob = m_world.GetFrameScheduler().Register("Compression", 0.5f);
+    }
+
+    void ChunkResidencyManager::Update() {
+        assert(m_world.IsOwnerThread());
+        glm::u64 frame = m_frame.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        glm::vec3 cameraChunkPosition = m_camera.GetPosition() / static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE);
+        CompressColdChunks(cameraChunkPosition, frame);
+        if (m_settings.MemoryBudget > 0) EnforceMemoryBudget(cameraChunkPosition);
+    }
+
+    void ChunkResidencyManager::CompressColdChunks(glm::vec3 cameraChunkPosition, glm::u64 frame) {
+        struct Candidate {
+            Chunk *Target;
+            float SquaredDistance;
+        };
+
+        std::vector<Candidate> candidates;
+        m_compressedChunks = 0;
+        m_compressedBytes = 0;
+        m_pagedOutChunks = 0;
+
+        // chunks being meshed and their neighbours can't be compressed under the mesh task
+        std::unordered_set<glm::ivec3> meshingChunks = GetChunksReadByMeshing();
+        const ProceduralGenerationManager &generationManager = m_world.GetProceduralGenerationManager();
+        for (auto &[chunkPosition, chunk] : m_world) {
+            if (chunk->IsPagedOut()) {
+                m_pagedOutChunks++;
+                continue;
+            }
+
+            if (chunk->IsCompressed()) {
+                m_compressedChunks++;
+                m_compressedBytes += chunk->GetVoxelStorage().GetMemoryUsage();
+                continue;
+            }
+
+            // shared storage (e.g. empty chunks) wouldn't free anything
+            if (chunk->IsSharingVoxels()) continue;
+            if (meshingChunks.contains(chunkPosition) || generationManager.IsGenerating(chunkPosition)) continue;
+            if (!IsCold(*chunk, glm::ivec3(glm::floor(cameraChunkPosition)), frame)) continue;
+
+            glm::vec3 delta = glm::vec3(chunkPosition) - cameraChunkPosition;
+            candidates.push_back({chunk.get(), glm::dot(delta, delta)});
+        }
+        m_uncompressedBytes = m_compressedChunks * sizeof(ChunkVoxelStorage::Data);
+
+        if (candidates.empty()) return;
+
+        // compress the furthest chunks first, cold chunks can wait for a frame with time to spare
+        FrameBudgetScheduler &scheduler = m_world.GetFrameScheduler();
+        std::size_t count = scheduler.Admit(m_compressionJob, std::min<glm::u32>(candidates.size(), m_settings.MaxCompressionsPerFrame));
+        if (count == 0) return;
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate &a, const Candidate &b) {
+            return a.SquaredDistance > b.SquaredDistance;
+        });
+
+        // the chunks are independent so compress them in parallel, Normal so the frame isn't left waiting behind background generation
+        Spire::Timer timer;
+        std::vector<std::uint8_t> compressed(count, false);
+        Spire::TaskGraph::Instance().ParallelFor(0, count, [&](std::size_t i) {
+            compressed[i] = candidates[i].Target->Compress(m_settings.MinimumCompressionRatio);
+        }, Spire::TaskPriority::Normal);
+        scheduler.Report(m_compressionJob, count, timer.MillisSinceStart());
+
+        glm::u32 numCompressed = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            if (!compressed[i]) continue;
+            numCompressed++;
+            m_compressedChunks++;
+            m_compressedBytes += candidates[i].Target->GetVoxelStorage().GetMemoryUsage();
+            m_uncompressedBytes += sizeof(ChunkVoxelStorage::Data);
+        }
+        m_compressions += numCompressed;
+
+        if (LOG && numCompressed > 0) {
+            Spire::info("[ChunkResidencyManager] Compressed {} chunks in {} ms", numCompressed, timer.MillisSinceStart());
+        }
+    }
+
+    void ChunkResidencyManager::EnforceMemoryBudget(glm::vec3 cameraChunkPosition) {
+        m_memoryUsage = m_world.CalculateCPUMemoryUsageForChunks();
+        if (m_memoryUsage <= m_settings.MemoryBudget) {
+            m_warnedOverBudget = false;
+            return;
+        }
+
+        // chunks waiting to be meshed (and the neighbours their mesh tasks read) or generating will be used soon
+        std::unordered_set<glm::ivec3> meshingChunks = GetChunksReadByMeshing();
+        const ProceduralGenerationManager &generationManager = m_world.GetProceduralGenerationManager();
+
+        std::vector<Chunk *> chunks;
+        std::vector<EvictionCandidate> candidates;
+        for (auto &[chunkPosition, chunk] : m_world) {
+            if (chunk->IsPagedOut() || chunk->IsSharingVoxels()) continue;
+            if (meshingChunks.contains(chunkPosition) || generationManager.IsGenerating(chunkPosition)) continue;
+
+            glm::vec3 delta = glm::vec3(chunkPosition) - cameraChunkPosition;
+            candidates.push_back({chunk->GetLastAccessFrame(), glm::dot(delta, delta), chunk->GetVoxelStorage().GetMemoryUsage(), chunks.size()});
+            chunks.push_back(chunk.get());
+        }
+
+        std::size_t count = SelectEvictions(candidates, m_memoryUsage, m_settings.MemoryBudget);
+        if (count == 0) return;
+
+        if (!m_swapStore) m_swapStore = std::make_unique<ChunkSwapStore>(m_settings.SwapDirectory);
+
+        // writing the swap files is the slow part and every chunk has its own file, IO so it shares the disk workers with saving
+        Spire::Timer timer;
+        std::vector<std::uint8_t> pagedOut(count, false);
+        Spire::TaskGraph::Instance().ParallelFor(0, count, [&](std::size_t i) {
+            pagedOut[i] = chunks[candidates[i].Index]->PageOut(*m_swapStore);
+        }, Spire::TaskPriority::IO);
+
+        glm::u32 numPagedOut = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            if (!pagedOut[i]) continue;
+            numPagedOut++;
+            m_memoryUsage -= std::min<glm::u64>(m_memoryUsage, GetFreedMemory(candidates[i]));
+        }
+        m_evictions += numPagedOut;
+        m_pagedOutChunks += numPagedOut;
+
+        if (LOG) {
+            Spire::info("[ChunkResidencyManager] Paged out {} chunks in {} ms, {} MB / {} MB", numPagedOut, timer.MillisSinceStart(),
+                        m_memoryUsage / 1024 / 1024, m_settings.MemoryBudget / 1024 / 1024);
+        }
+        if (m_memoryUsage > m_settings.MemoryBudget && !m_warnedOverBudget) {
+            m_warnedOverBudget = true;
+            Spire::warn("[ChunkResidencyManager] Chunks are using {} MB which is over the budget of {} MB, nothing else can be paged out",
+                        m_memoryUsage / 1024 / 1024, m_settings.MemoryBudget / 1024 / 1024);
+        }
+    }
+
+    std::unordered_set<glm::ivec3> ChunkResidencyManager::GetChunksReadByMeshing() const {
+        // mesh tasks read the voxels of all 26 neighbours for faces and AO
+        std::unordered_set<glm::ivec3> chunkPositions;
+        for (ChunkHandle handle : m_world.GetRenderer().GetEditedChunks()) {
+            const Chunk *chunk = m_world.TryGetChunk(handle);
+            if (!chunk) continue;
+            for (glm::i32 x = -1; x <= 1; x++) {
+                for (glm::i32 y = -1; y <= 1; y++) {
+                    for (glm::i32 z = -1; z <= 1; z++) {
+                        chunkPositions.insert(chunk->ChunkPosition + glm::ivec3(x, y, z));
+                    }
+                }
+            }
+        }
+        return chunkPositions;
+    }
+
+    std::size_t ChunkResidencyManager::GetFreedMemory(const EvictionCandidate &candidate) {
+        // paged out storages still use a little memory
+        std::size_t pagedOutUsage = ChunkVoxelStorage::GetPagedOutMemoryUsage();
+        return candidate.MemoryUsage > pagedOutUsage ? candidate.MemoryUsage - pagedOutUsage : 0;
+    }
+
+    std::size_t ChunkResidencyManager::SelectEvictions(std::vector<EvictionCandidate> &candidates, glm::u64 memoryUsage, glm::u64 memoryBudget) {
+        if (memoryUsage <= memoryBudget) return 0;
+
+        std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate &a, const EvictionCandidate &b) {
+            if (a.LastAccessFrame != b.LastAccessFrame) return a.LastAccessFrame < b.LastAccessFrame;
+            return a.SquaredDistance > b.SquaredDistance;
+        });
+
+        std::size_t count = 0;
+        while (count < candidates.size() && memoryUsage > memoryBudget) {
+            memoryUsage -= std::min<glm::u64>(memoryUsage, GetFreedMemory(candidates[count]));
+            count++;
+        }
+        return count;
+    }
+
+    void ChunkResidencyManager::OnChunkAccessed(bool firstAccessThisFrame, bool decompressed) {
+        if (decompressed) m_misses.fetch_add(1, std::memory_order_relaxed);
+        else if (firstAccessThisFrame) m_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ChunkResidencyManager::Stats ChunkResidencyManager::GetStats() const {
+        return {
+            .Hits = m_hits.load(std::memory_order_relaxed),
+            .Misses = m_misses.load(std::memory_order_relaxed),
+            .Compressions = m_compressions,
+            .CompressedChunks = m_compressedChunks,
+            .CompressedBytes = m_compressedBytes,
+            .UncompressedBytes = m_uncompressedBytes,
+            .PagedOutChunks = m_pagedOutChunks,
+            .MemoryUsage = m_memoryUsage,
+            .Evictions = m_evictions,
+            .Swap = m_swapStore ? m_swapStore->GetStats() : ChunkSwapStore::Stats{}
+        };
+    }
+
+    bool ChunkResidencyManager::IsCold(const Chunk &chunk, glm::ivec3 cameraChunkPosition, glm::u64 frame) const {
+        if (m_settings.CompressAfterFrames > 0 && frame - chunk.GetLastAccessFrame() > m_settings.CompressAfterFrames) return true;
+        if (m_settings.CompressDistance > 0) {
+            glm::ivec3 delta = glm::abs(chunk.ChunkPosition - cameraChunkPosition);
+            if (static_cast<glm::u32>(std::max({delta.x, delta.y, delta.z})) > m_settings.CompressDistance) return true;
+        }
+        return false;
+    }
+} // SpireVoxel
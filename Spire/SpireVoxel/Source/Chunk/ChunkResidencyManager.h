@@ -0,0 +1,120 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Serialisation/ChunkSwapStore.h"
+#include "Utils/FrameBudgetScheduler.h"
+
+namespace SpireVoxel {
+    class IVoxelCamera;
+    class VoxelWorld;
+    struct Chunk;
+}
+
+namespace SpireVoxel {
+    // Compresses the voxels of chunks that are far from the camera or haven't been used recently
+    // If there is a memory budget, the least recently used chunks are paged out to a ChunkSwapStore until the chunks fit in it
+    // Compressed and paged out chunks stay loaded and are made resident transparently the next time they are accessed (edit, mesh, raycast, save)
+    // Update must be called on the world's owner thread when no other thread is using the chunks (VoxelWorld::Update does this)
+    class ChunkResidencyManager {
+    public:
+        struct Settings {
+            // Chunks further than this many chunks from the camera on any axis are compressed, 0 disables
+            glm::u32 CompressDistance = 16;
+            // Chunks that haven't been accessed for this many frames are compressed, 0 disables
+            glm::u32 CompressAfterFrames = 600;
+            // Upper limit on compressions each frame, fewer are done if they don't fit in the world's frame budget
+            glm::u32 MaxCompressionsPerFrame = 8;
+            // Chunks that wouldn't be at least this many times smaller aren't compressed
+            float MinimumCompressionRatio = 4.0f;
+            // Bytes of CPU memory the chunks can use (see VoxelWorld::CalculateCPUMemoryUsageForChunks), 0 disables paging
+            // Checked every Update, chunks paged in between updates can go over it until the next Update
+            glm::u64 MemoryBudget = 0;
+            // Where to create the swap store, the system temp directory if empty
+            std::filesystem::path SwapDirectory = {};
+        };
+
+        struct Stats {
+            // Hits and misses are counted the first time a chunk is accessed in a frame
+            // a miss means the chunk had to be decompressed
+            glm::u64 Hits = 0;
+            glm::u64 Misses = 0;
+            glm::u64 Compressions = 0;
+            // As of the last Update
+            glm::u64 CompressedChunks = 0;
+            glm::u64 CompressedBytes = 0;
+            glm::u64 UncompressedBytes = 0; // size of the compressed chunks if they were decompressed
+            glm::u64 PagedOutChunks = 0;
+            glm::u64 MemoryUsage = 0; // only calculated when there is a memory budget
+            glm::u64 Evictions = 0;
+            ChunkSwapStore::Stats Swap = {};
+
+            [[nodiscard]] float GetCompressionRatio() const {
+                return CompressedBytes == 0 ? 1.0f : static_cast<float>(UncompressedBytes) / static_cast<float>(CompressedBytes);
+            }
+
+            [[nodiscard]] float GetHitRate() const {
+                return Hits + Misses == 0 ? 1.0f : static_cast<float>(Hits) / static_cast<float>(Hits + Misses);
+            }
+        };
+
+        struct EvictionCandidate {
+            glm::u64 LastAccessFrame;
+            float SquaredDistance;
+            std::size_t MemoryUsage;
+            std::size_t Index; // for the caller
+        };
+
+    public:
+        ChunkResidencyManager(VoxelWorld &world, const IVoxelCamera &camera, Settings settings);
+
+        DISABLE_COPY(ChunkResidencyManager)
+
+        // Advance the frame and compress cold chunks
+        void Update();
+
+        // Called by Chunk::Touch, thread safe
+        void OnChunkAccessed(bool firstAccessThisFrame, bool decompressed);
+
+        [[nodiscard]] glm::u64 GetFrame() const { return m_frame.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] Stats GetStats() const;
+
+        [[nodiscard]] const Settings &GetSettings() const { return m_settings; }
+
+        void SetSettings(const Settings &settings) { m_settings = settings; }
+
+        // Moves the least recently used (then furthest) candidates to the front
+        // Returns how many of them must be evicted to bring memoryUsage down to memoryBudget
+        [[nodiscard]] static std::size_t SelectEvictions(std::vector<EvictionCandidate> &candidates, glm::u64 memoryUsage, glm::u64 memoryBudget);
+
+    private:
+        [[nodiscard]] static std::size_t GetFreedMemory(const EvictionCandidate &candidate);
+
+        // Positions of the chunks queued for or being meshed and their neighbours, none of them can be compressed or paged out
+        [[nodiscard]] std::unordered_set<glm::ivec3> GetChunksReadByMeshing() const;
+
+        [[nodiscard]] bool IsCold(const Chunk &chunk, glm::ivec3 cameraChunkPosition, glm::u64 frame) const;
+
+        void CompressColdChunks(glm::vec3 cameraChunkPosition, glm::u64 frame);
+
+        void EnforceMemoryBudget(glm::vec3 cameraChunkPosition);
+
+    private:
+        VoxelWorld &m_world;
+        const IVoxelCamera &m_camera;
+        Settings m_settings;
+        FrameBudgetScheduler::JobType m_compressionJob;
+        std::atomic<glm::u64> m_frame = 1; // 0 is never accessed
+        std::atomic<glm::u64> m_hits = 0;
+        std::atomic<glm::u64> m_misses = 0;
+        glm::u64 m_compressions = 0;
+        glm::u64 m_compressedChunks = 0;
+        glm::u64 m_compressedBytes = 0;
+        glm::u64 m_uncompressedBytes = 0;
+        glm::u64 m_pagedOutChunks = 0;
+        glm::u64 m_memoryUsage = 0;
+        glm::u64 m_evictions = 0;
+        bool m_warnedOverBudget = false;
+        std::unique_ptr<ChunkSwapStore> m_swapStore; // created the first time a chunk is paged out
+    };
+} // SpireVoxel
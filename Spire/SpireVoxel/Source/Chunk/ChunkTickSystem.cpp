@@ -0,0 +1,221 @@
+#include "ChunkTickSystem.h"
+
+#include "Chunk.h"
+#include "Utils/TaskGraph.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    static glm::i32 FloorDivide(glm::i32 value, glm::i32 divisor) {
+        return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+    }
+
+    static glm::ivec3 GetChunkOfVoxel(glm::ivec3 voxelPosition) {
+        return {
+            FloorDivide(voxelPosition.x, SPIRE_VOXEL_CHUNK_SIZE),
+            FloorDivide(voxelPosition.y, SPIRE_VOXEL_CHUNK_SIZE),
+            FloorDivide(voxelPosition.z, SPIRE_VOXEL_CHUNK_SIZE)
+        };
+    }
+
+    // same layout as IVoxelEdit::GetAffectedNeighbours
+    static glm::u32 GetNeighbourIndex(glm::ivec3 offset) {
+        return (offset.x + 1) * 9 + (offset.y + 1) * 3 + (offset.z + 1);
+    }
+
+    static glm::u64 Mix(glm::u64 value) {
+        // splitmix64 finaliser
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+
+    ChunkTickSystem::TickContext::TickContext(const ChunkTickSystem &system, glm::ivec3 chunkPosition, glm::u64 tick,
+                                              const std::array<ITickVoxels::ChunkState, 27> &neighbours, std::vector<glm::ivec3> &activations)
+        : m_system(system),
+          m_chunkPosition(chunkPosition),
+          m_tick(tick),
+          m_neighbours(neighbours),
+          m_activations(activations) {
+    }
+
+    std::optional<glm::u32> ChunkTickSystem::TickContext::GetNeighbour(glm::ivec3 chunkPosition) const {
+        glm::ivec3 offset = chunkPosition - m_chunkPosition;
+        glm::ivec3 distance = glm::abs(offset);
+        if (glm::max(distance.x, glm::max(distance.y, distance.z)) > 1) return std::nullopt;
+        return GetNeighbourIndex(offset);
+    }
+
+    bool ChunkTickSystem::TickContext::IsAvailable(glm::ivec3 voxelPosition) const {
+        std::optional<glm::u32> neighbour = GetNeighbour(GetChunkOfVoxel(voxelPosition));
+        // reaching further would race with chunks of the same colour
+        assert(neighbour.has_value());
+        return neighbour.has_value() && m_neighbours[*neighbour] == ITickVoxels::ChunkState::READY;
+    }
+
+    VoxelType ChunkTickSystem::TickContext::GetVoxel(glm::ivec3 voxelPosition) const {
+        if (!IsAvailable(voxelPosition)) return VOXEL_TYPE_AIR;
+        glm::ivec3 chunkPosition = GetChunkOfVoxel(voxelPosition);
+        glm::ivec3 positionInChunk = voxelPosition - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE;
+        return m_system.m_voxels.GetVoxel(chunkPosition, SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk));
+    }
+
+    bool ChunkTickSystem::TickContext::SetVoxel(glm::ivec3 voxelPosition, VoxelType type) {
+        if (!IsAvailable(voxelPosition)) return false;
+        glm::ivec3 chunkPosition = GetChunkOfVoxel(voxelPosition);
+        glm::ivec3 positionInChunk = voxelPosition - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE;
+        glm::u32 index = SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk);
+        if (m_system.m_voxels.GetVoxel(chunkPosition, index) == type) return true;
+
+        m_system.m_voxels.SetVoxel(chunkPosition, index, type);
+        m_numWrites++;
+
+        // the voxel's chunk and every chunk it touches, a voxel next to this one may need to tick now
+        glm::ivec3 min, max;
+        for (glm::u32 axis = 0; axis < 3; axis++) {
+            min[axis] = positionInChunk[axis] == 0 ? -1 : 0;
+            max[axis] = positionInChunk[axis] == SPIRE_VOXEL_CHUNK_SIZE - 1 ? 1 : 0;
+        }
+        for (glm::i32 x = min.x; x <= max.x; x++) {
+            for (glm::i32 y = min.y; y <= max.y; y++) {
+                for (glm::i32 z = min.z; z <= max.z; z++) {
+                    m_activations.push_back(chunkPosition + glm::ivec3(x, y, z));
+                }
+            }
+        }
+        return true;
+    }
+
+    glm::u32 ChunkTickSystem::TickContext::Random(glm::ivec3 voxelPosition, glm::u32 salt) const {
+        glm::u64 hash = Mix(m_tick ^ (static_cast<glm::u64>(salt) << 32));
+        hash = Mix(hash ^ static_cast<glm::u32>(voxelPosition.x));
+        hash = Mix(hash ^ static_cast<glm::u32>(voxelPosition.y));
+        hash = Mix(hash ^ static_cast<glm::u32>(voxelPosition.z));
+        return static_cast<glm::u32>(hash);
+    }
+
+    ChunkTickSystem::ChunkTickSystem(ITickVoxels &voxels) : ChunkTickSystem(voxels, Settings{}) {
+    }
+
+    ChunkTickSystem::ChunkTickSystem(ITickVoxels &voxels, Settings settings)
+        : m_voxels(voxels),
+          m_settings(settings),
+          m_isTicked(std::numeric_limits<VoxelType>::max() + 1, false) {
+        assert(m_settings.FramesPerTick > 0);
+    }
+
+    void ChunkTickSystem::Register(VoxelType type, TickCallback callback) {
+        assert(type != VOXEL_TYPE_AIR); // air is everywhere, tick the voxels next to it instead
+        assert(callback);
+        m_callbacks[type].push_back(std::move(callback));
+        m_isTicked[type] = true;
+    }
+
+    void ChunkTickSystem::Activate(glm::ivec3 chunkPosition) {
+        if (m_callbacks.empty()) return;
+        m_active.insert(chunkPosition);
+    }
+
+    bool ChunkTickSystem::Update() {
+        if (++m_framesSinceTick < m_settings.FramesPerTick) return false;
+        m_framesSinceTick = 0;
+        Tick();
+        return true;
+    }
+
+    void ChunkTickSystem::Tick() {
+        if (m_active.empty()) return;
+        Spire::Timer timer;
+        m_tick++;
+
+        // activations made while ticking are for the next tick
+        std::array<std::vector<ChunkTick>, NUM_COLOURS> colours;
+        std::unordered_set<glm::ivec3> active;
+        active.swap(m_active);
+        for (glm::ivec3 chunkPosition : active) {
+            ITickVoxels::ChunkState state = m_voxels.GetChunkState(chunkPosition);
+            if (state == ITickVoxels::ChunkState::UNAVAILABLE) continue;
+            if (state == ITickVoxels::ChunkState::NOT_READY) {
+                m_active.insert(chunkPosition);
+                continue;
+            }
+
+            ChunkTick &chunk = colours[GetColour(chunkPosition)].emplace_back();
+            chunk.Position = chunkPosition;
+            for (glm::u32 neighbour = 0; neighbour < 27; neighbour++) {
+                glm::ivec3 offset = glm::ivec3(neighbour / 9, (neighbour / 3) % 3, neighbour % 3) - glm::ivec3(1);
+                chunk.Neighbours[neighbour] = offset == glm::ivec3(0) ? state : m_voxels.GetChunkState(chunkPosition + offset);
+            }
+        }
+
+        Spire::TaskGraph &taskGraph = Spire::TaskGraph::Instance();
+        glm::u32 numChunksTicked = 0;
+        for (std::vector<ChunkTick> &chunks : colours) {
+            if (chunks.empty()) continue;
+            // the order within a colour doesn't change the result, sorted so activations are always applied in the same order
+            std::ranges::sort(chunks, [](const ChunkTick &a, const ChunkTick &b) {
+                return std::tie(a.Position.x, a.Position.y, a.Position.z) < std::tie(b.Position.x, b.Position.y, b.Position.z);
+            });
+
+            if (m_settings.Parallel && chunks.size() > 1) {
+                Spire::TaskGroup group;
+                for (ChunkTick &chunk : chunks) {
+                    taskGraph.Submit([this, &chunk, tick = m_tick] { TickChunk(chunk, tick); }, {}, &group, Spire::TaskPriority::Interactive);
+                }
+                taskGraph.Wait(group);
+            } else {
+                for (ChunkTick &chunk : chunks) TickChunk(chunk, m_tick);
+            }
+
+            for (const ChunkTick &chunk : chunks) {
+                for (glm::ivec3 activation : chunk.Activations) m_active.insert(activation);
+                m_stats.VoxelsTicked += chunk.NumVoxelsTicked;
+                m_stats.VoxelsWritten += chunk.NumWrites;
+            }
+            numChunksTicked += chunks.size();
+        }
+
+        m_stats.Ticks++;
+        m_stats.ChunksTicked += numChunksTicked;
+        m_stats.LastChunksTicked = numChunksTicked;
+        m_stats.LastTickMillis = timer.MillisSinceStart();
+        if (LOG) Spire::info("[ChunkTickSystem] Ticked {} chunks in {} ms, {} active", numChunksTicked, m_stats.LastTickMillis, m_active.size());
+    }
+
+    void ChunkTickSystem::TickChunk(ChunkTick &chunk, glm::u64 tick) const {
+        // find the voxels to tick first so a voxel moved further into the chunk isn't ticked twice
+        std::vector<glm::u32> tickedIndices;
+        const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels = m_voxels.ReadVoxels(chunk.Position);
+        for (glm::u32 index = 0; index < SPIRE_VOXEL_CHUNK_VOLUME; index++) {
+            VoxelType type = voxels[index];
+            if (type != VOXEL_TYPE_AIR && m_isTicked[type]) tickedIndices.push_back(index);
+        }
+
+        TickContext context(*this, chunk.Position, tick, chunk.Neighbours, chunk.Activations);
+        for (glm::u32 index : tickedIndices) {
+            // an earlier callback may have changed it
+            VoxelType type = m_voxels.GetVoxel(chunk.Position, index);
+            auto callbacks = m_callbacks.find(type);
+            if (callbacks == m_callbacks.end()) continue;
+
+            glm::ivec3 voxelPosition = chunk.Position * SPIRE_VOXEL_CHUNK_SIZE + SPIRE_VOXEL_INDEX_TO_POSITION(glm::ivec3, index);
+            for (const TickCallback &callback : callbacks->second) {
+                callback(context, voxelPosition, type);
+                chunk.NumVoxelsTicked++;
+            }
+        }
+
+        if (context.m_keepActive) chunk.Activations.push_back(chunk.Position);
+        chunk.NumWrites = context.m_numWrites;
+    }
+
+    glm::u64 ChunkTickSystem::CalculateMemoryUsage() const {
+        // roughly a node and a bucket per active chunk
+        return m_active.size() * (sizeof(glm::ivec3) + 2 * sizeof(void *)) + m_isTicked.capacity() / 8;
+    }
+
+    glm::u32 ChunkTickSystem::GetColour(glm::ivec3 chunkPosition) {
+        glm::ivec3 colour = ((chunkPosition % 3) + 3) % 3;
+        return colour.x * 9 + colour.y * 3 + colour.z;
+    }
+} // SpireVoxel
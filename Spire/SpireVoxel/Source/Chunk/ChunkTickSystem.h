@@ -0,0 +1,159 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "VoxelType.h"
+#include "../../Assets/Shaders/ShaderInfo.h"
+
+#include <unordered_set>
+
+namespace SpireVoxel {
+    // The voxels ChunkTickSystem reads and writes, see WorldTickVoxels
+    class ITickVoxels {
+    public:
+        enum class ChunkState {
+            UNAVAILABLE, // not loaded or not full detail, dropped from the active set
+            NOT_READY, // e.g. still generating, stays active but isn't ticked, read or written
+            READY
+        };
+
+        virtual ~ITickVoxels() = default;
+
+        // Called on the owner thread at the start of each tick
+        [[nodiscard]] virtual ChunkState GetChunkState(glm::ivec3 chunkPosition) const = 0;
+
+        // The rest are called from tick tasks, only for ready chunks in the neighbourhood of the chunk being ticked
+        // The reference is only valid until the chunk is next written
+        [[nodiscard]] virtual const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &ReadVoxels(glm::ivec3 chunkPosition) const = 0;
+
+        [[nodiscard]] virtual VoxelType GetVoxel(glm::ivec3 chunkPosition, glm::u32 index) const = 0;
+
+        virtual void SetVoxel(glm::ivec3 chunkPosition, glm::u32 index, VoxelType type) = 0;
+    };
+
+    // Runs per voxel simulation (fluids, falling blocks, growth...) registered by voxel type, only on chunks in a sparse active set
+    // A chunk is active for the next tick if it was edited, a tick wrote to it or next to it, or a callback kept it active,
+    // chunks where nothing happens drop out of the set after one tick
+    // A tick can read and write its chunk and the 26 around it. Ticks run on the TaskGraph in 27 passes, one per colour,
+    // a chunk's colour is its position mod 3 on each axis so chunks of the same colour are at least 3 apart and their neighbourhoods never overlap
+    // Chunks are ticked colour by colour and voxels in index order, so the result is the same as ticking on one thread
+    // Owner thread only
+    class ChunkTickSystem {
+    public:
+        class TickContext;
+
+        // Called for each voxel of the registered type in an active chunk
+        using TickCallback = std::function<void(TickContext &context, glm::ivec3 voxelPosition, VoxelType type)>;
+
+        struct Settings {
+            glm::u32 FramesPerTick = 3;
+            bool Parallel = true; // false ticks every chunk on the owner thread, the result is the same
+        };
+
+        struct Stats {
+            glm::u64 Ticks = 0;
+            glm::u64 ChunksTicked = 0;
+            glm::u64 VoxelsTicked = 0; // callbacks called
+            glm::u64 VoxelsWritten = 0;
+            // As of the last tick
+            glm::u32 LastChunksTicked = 0;
+            float LastTickMillis = 0;
+        };
+
+        // What a callback can see, the voxels of the ticking chunk and the 26 around it
+        class TickContext {
+            friend class ChunkTickSystem;
+
+        public:
+            [[nodiscard]] glm::ivec3 GetChunkPosition() const { return m_chunkPosition; }
+
+            [[nodiscard]] glm::u64 GetTick() const { return m_tick; }
+
+            // false if the voxel's chunk isn't loaded and ready, it then can't be read or written
+            [[nodiscard]] bool IsAvailable(glm::ivec3 voxelPosition) const;
+
+            // Air if the voxel isn't available
+            [[nodiscard]] VoxelType GetVoxel(glm::ivec3 voxelPosition) const;
+
+            // Returns false if the voxel isn't available, activates the chunks that touch the voxel for the next tick
+            bool SetVoxel(glm::ivec3 voxelPosition, VoxelType type);
+
+            // Tick this chunk again next tick even if nothing was written, e.g. a plant that is still growing
+            void KeepActive() { m_keepActive = true; }
+
+            // The same for a tick, voxel and salt however the ticks are scheduled, use for chances like growth
+            [[nodiscard]] glm::u32 Random(glm::ivec3 voxelPosition, glm::u32 salt = 0) const;
+
+        private:
+            TickContext(const ChunkTickSystem &system, glm::ivec3 chunkPosition, glm::u64 tick, const std::array<ITickVoxels::ChunkState, 27> &neighbours,
+                        std::vector<glm::ivec3> &activations);
+
+            // Index into the neighbourhood of the chunk containing the voxel, nullopt if it is outside
+            [[nodiscard]] std::optional<glm::u32> GetNeighbour(glm::ivec3 chunkPosition) const;
+
+        private:
+            const ChunkTickSystem &m_system;
+            glm::ivec3 m_chunkPosition;
+            glm::u64 m_tick;
+            const std::array<ITickVoxels::ChunkState, 27> &m_neighbours;
+            std::vector<glm::ivec3> &m_activations;
+            glm::u64 m_numWrites = 0;
+            bool m_keepActive = false;
+        };
+
+    public:
+        explicit ChunkTickSystem(ITickVoxels &voxels);
+
+        ChunkTickSystem(ITickVoxels &voxels, Settings settings);
+
+        DISABLE_COPY_AND_MOVE(ChunkTickSystem)
+
+    public:
+        // Call callback for every voxel of this type in active chunks, a type can have more than one callback
+        void Register(VoxelType type, TickCallback callback);
+
+        // Tick the chunk next tick, does nothing if no callbacks are registered
+        void Activate(glm::ivec3 chunkPosition);
+
+        [[nodiscard]] bool IsActive(glm::ivec3 chunkPosition) const { return m_active.contains(chunkPosition); }
+
+        [[nodiscard]] std::size_t NumActiveChunks() const { return m_active.size(); }
+
+        // Call once per frame, ticks every FramesPerTick frames, returns true if it ticked
+        bool Update();
+
+        // Tick the active chunks now
+        void Tick();
+
+        [[nodiscard]] const Stats &GetStats() const { return m_stats; }
+
+        [[nodiscard]] const Settings &GetSettings() const { return m_settings; }
+
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const;
+
+        // Colour of the pass a chunk is ticked in, chunks of the same colour are ticked at the same time
+        [[nodiscard]] static glm::u32 GetColour(glm::ivec3 chunkPosition);
+
+        static constexpr glm::u32 NUM_COLOURS = 27;
+
+    private:
+        struct ChunkTick {
+            glm::ivec3 Position;
+            std::array<ITickVoxels::ChunkState, 27> Neighbours;
+            std::vector<glm::ivec3> Activations; // written by the task, applied in order once its colour has finished
+            glm::u64 NumVoxelsTicked = 0;
+            glm::u64 NumWrites = 0;
+        };
+
+        void TickChunk(ChunkTick &chunk, glm::u64 tick) const;
+
+    private:
+        ITickVoxels &m_voxels;
+        Settings m_settings;
+        std::unordered_map<VoxelType, std::vector<TickCallback> > m_callbacks;
+        std::vector<bool> m_isTicked; // indexed by voxel type
+        std::unordered_set<glm::ivec3> m_active;
+        glm::u64 m_tick = 0;
+        glm::u64 m_framesSinceTick = 0;
+        Stats m_stats;
+    };
+} // SpireVoxel
@@ -0,0 +1,201 @@
+#include "ChunkVoxelStorage.h"
+
+#include "VoxelKernels.h"
+
+namespace SpireVoxel {
+    static constexpr std::size_t MAXIMUM_RUN_LENGTH = std::numeric_limits<glm::u16>::max() + 1;
+
+    ChunkVoxelStorage::ChunkVoxelStorage() {
+        SetData(GetSharedEmptyData());
+    }
+
+    ChunkVoxelStorage::ChunkVoxelStorage(const ChunkVoxelStorage &other) {
+        // paged in under the same lock as the copy so a PageOut can't happen in between
+        std::unique_lock lock(other.m_residencyMutex);
+        if (other.m_residency.load(std::memory_order_relaxed) == Residency::PagedOut) other.MakeResidentLocked();
+        SetData(other.m_data);
+        m_compressed = other.m_compressed;
+        m_residency.store(other.m_residency.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    ChunkVoxelStorage &ChunkVoxelStorage::operator=(const ChunkVoxelStorage &other) {
+        if (this == &other) return *this;
+
+        std::scoped_lock lock(m_residencyMutex, other.m_residencyMutex);
+        if (other.m_residency.load(std::memory_order_relaxed) == Residency::PagedOut) other.MakeResidentLocked();
+        SetData(other.m_data);
+        m_compressed = other.m_compressed;
+        m_pagedOut.reset();
+        m_residency.store(other.m_residency.load(std::memory_order_relaxed), std::memory_order_release);
+        return *this;
+    }
+
+    ChunkVoxelStorage::Data &ChunkVoxelStorage::Write() {
+        EnsureResident();
+
+        // writers are serialized and the storage is resident, so nothing else replaces m_data while it is read here
+        if (m_data.use_count() > 1) {
+            // detach, the other storages keep the old data
+            std::shared_ptr<Data> copy = MakeShared<Data>(*m_data);
+            std::unique_lock lock(m_residencyMutex);
+            SetData(std::move(copy));
+        }
+        assert(!m_data->IsCorrupted());
+        return *m_data;
+    }
+
+    bool ChunkVoxelStorage::Compress(float minimumRatio) {
+        std::unique_lock lock(m_residencyMutex);
+        Residency residency = m_residency.load(std::memory_order_relaxed);
+        if (residency == Residency::Compressed) return true;
+        if (residency == Residency::PagedOut) return false;
+        // compressing shared data wouldn't free anything
+        if (m_data.use_count() > 1) return false;
+
+        auto maximumRuns = static_cast<std::size_t>(static_cast<float>(sizeof(Data)) / minimumRatio / sizeof(CompressedData::Run));
+        std::shared_ptr<const CompressedData> compressed = CompressVoxels(*m_data, maximumRuns);
+        if (!compressed) return false;
+
+        m_compressed = std::move(compressed);
+        SetData(nullptr);
+        m_residency.store(Residency::Compressed, std::memory_order_release);
+        return true;
+    }
+
+    bool ChunkVoxelStorage::PageOut(PageInFunction pageIn) {
+        std::unique_lock lock(m_residencyMutex);
+        switch (m_residency.load(std::memory_order_relaxed)) {
+            case Residency::Resident:
+                if (m_data.use_count() > 1) return false;
+                SetData(nullptr);
+                break;
+            case Residency::Compressed:
+                if (m_compressed.use_count() > 1) return false;
+                m_compressed.reset();
+                break;
+            case Residency::PagedOut:
+                return true;
+        }
+
+        m_pagedOut = MakeShared<PagedOutData>(PagedOutData{std::move(pageIn)});
+        m_residency.store(Residency::PagedOut, std::memory_order_release);
+        return true;
+    }
+
+    bool ChunkVoxelStorage::MakeResident() const {
+        std::unique_lock lock(m_residencyMutex);
+        return MakeResidentLocked();
+    }
+
+    bool ChunkVoxelStorage::MakeResidentLocked() const {
+        // another thread may have made the data resident while we waited for the lock
+        Residency residency = m_residency.load(std::memory_order_relaxed);
+        if (residency == Residency::Resident) return false;
+
+        auto data = MakeShared<Data>();
+        if (residency == Residency::Compressed) {
+            DecompressVoxels(*m_compressed, *data);
+            m_compressed.reset();
+        } else {
+            if (!m_pagedOut->PageIn(data->Voxels)) {
+                // nothing better to do than carry on with an empty chunk
+                Spire::error("Failed to page in chunk voxels, the chunk has been cleared");
+                assert(false);
+                data->Voxels.fill(0);
+            }
+            VoxelKernels::PackPresenceBits(data->Voxels.data(), data->Bits.GetWords(), data->Voxels.size());
+            data->Occupancy.Recalculate(data->Bits);
+            m_pagedOut.reset();
+        }
+
+        SetData(std::move(data));
+        m_residency.store(Residency::Resident, std::memory_order_release);
+        return true;
+    }
+
+    void ChunkVoxelStorage::SetData(std::shared_ptr<Data> data) const {
+        m_data = std::move(data);
+        m_residentData.store(m_data.get(), std::memory_order_release);
+    }
+
+    std::shared_ptr<const ChunkVoxelStorage::CompressedData> ChunkVoxelStorage::CompressVoxels(const Data &data, std::size_t maximumRuns) {
+        auto compressed = MakeShared<CompressedData>();
+
+        const VoxelType *voxels = data.Voxels.data();
+        std::size_t index = 0;
+        while (index < SPIRE_VOXEL_CHUNK_VOLUME) {
+            if (compressed->Runs.size() >= maximumRuns) return nullptr;
+
+            VoxelType type = voxels[index];
+            std::size_t end = index + 1;
+            std::size_t maximumEnd = std::min<std::size_t>(SPIRE_VOXEL_CHUNK_VOLUME, index + MAXIMUM_RUN_LENGTH);
+            while (end < maximumEnd && voxels[end] == type) end++;
+
+            compressed->Runs.push_back({type, static_cast<glm::u16>(end - index - 1)});
+            index = end;
+        }
+
+        compressed->Runs.shrink_to_fit();
+        return compressed;
+    }
+
+    void ChunkVoxelStorage::DecompressVoxels(const CompressedData &compressed, Data &data) {
+        std::size_t index = 0;
+        for (const CompressedData::Run &run : compressed.Runs) {
+            std::size_t length = static_cast<std::size_t>(run.LengthMinusOne) + 1;
+            assert(index + length <= SPIRE_VOXEL_CHUNK_VOLUME);
+            VoxelKernels::Fill(data.Voxels.data() + index, length, run.Type);
+            index += length;
+        }
+        assert(index == SPIRE_VOXEL_CHUNK_VOLUME);
+
+        VoxelKernels::PackPresenceBits(data.Voxels.data(), data.Bits.GetWords(), data.Voxels.size());
+        data.Occupancy.Recalculate(data.Bits);
+    }
+
+    // m_data only goes from set to null in Compress/PageOut, which can't run while the storage is being used
+    // (ChunkResidencyManager skips chunks that are generating, queued for meshing or next to one being meshed)
+    // so once we've seen the storage resident m_residentData can be read without locking, m_data itself is only read under the lock
+
+    bool ChunkVoxelStorage::IsShared() const {
+        std::unique_lock lock(m_residencyMutex);
+        switch (m_residency.load(std::memory_order_relaxed)) {
+            case Residency::Compressed: return m_compressed.use_count() > 1;
+            case Residency::PagedOut: return false; // paged out storages are never shared
+            default: return m_data.use_count() > 1;
+        }
+    }
+
+    const void *ChunkVoxelStorage::GetDataIdentity() const {
+        if (IsResident()) return m_residentData.load(std::memory_order_acquire);
+
+        std::unique_lock lock(m_residencyMutex);
+        switch (m_residency.load(std::memory_order_relaxed)) {
+            case Residency::Compressed: return m_compressed.get();
+            case Residency::PagedOut: return m_pagedOut.get();
+            default: return m_data.get();
+        }
+    }
+
+    std::size_t ChunkVoxelStorage::GetMemoryUsage() const {
+        if (IsResident()) return sizeof(Data);
+
+        std::unique_lock lock(m_residencyMutex);
+        switch (m_residency.load(std::memory_order_relaxed)) {
+            case Residency::Compressed: return m_compressed->GetMemoryUsage();
+            case Residency::PagedOut: return GetPagedOutMemoryUsage();
+            default: return sizeof(Data);
+        }
+    }
+
+    std::size_t ChunkVoxelStorage::GetPagedOutMemoryUsage() {
+        return sizeof(PagedOutData);
+    }
+
+    const std::shared_ptr<ChunkVoxelStorage::Data> &ChunkVoxelStorage::GetSharedEmptyData() {
+        // never written to because this reference keeps it shared
+        // leaked so it is never freed after the MemoryAccounting statics it reports to are destroyed
+        static const std::shared_ptr<Data> *emptyData = new std::shared_ptr<Data>(MakeShared<Data>());
+        return *emptyData;
+    }
+} // SpireVoxel
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "ChunkOccupancy.h"
+#include "VoxelBitmask.h"
+#include "VoxelType.h"
+#include "../../Assets/Shaders/ShaderInfo.h"
+
+namespace SpireVoxel {
+    // Reference counted voxel storage for a chunk
+    // Copying a storage shares the underlying data, the data is only copied the first time it is written to (copy-on-write)
+    // All default constructed storages share a single empty (all air) allocation
+    // Not thread safe if two threads use storages that share data and one of them writes
+    // Reading while another thread writes the same storage is safe, the data is only replaced under a lock when a write detaches it
+    // Data returned by Read stays valid while a storage references it, copy the storage to keep it alive past a detach or an unload
+    //
+    // The storage can be compressed in place (run length encoded) or paged out (e.g. to disk), it is made resident again the next time it is read or written
+    // Making the storage resident is thread safe, Compress and PageOut must only be called when no other thread is using the storage
+    class ChunkVoxelStorage {
+    public:
+        struct Data {
+            std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> Voxels{};
+            std::uint64_t CorruptedMemoryCheck = 9238745897238972389; // This value will be changed if something overruns when editing Voxels
+            VoxelBitmask Bits{}; // 1 = voxel is present, 0 = voxel is empty
+            std::uint64_t CorruptedMemoryCheck2 = 12387732823748723; // This value will be changed if something overruns when editing Bits
+            ChunkOccupancy Occupancy{}; // Kept in sync with Bits
+
+            [[nodiscard]] bool IsCorrupted() const { return CorruptedMemoryCheck != 9238745897238972389 || CorruptedMemoryCheck2 != 12387732823748723; }
+        };
+
+        // Voxel types as runs in index order, the bits and occupancy are rebuilt when decompressing
+        struct CompressedData {
+            struct Run {
+                VoxelType Type;
+                glm::u16 LengthMinusOne;
+            };
+
+            std::vector<Run, Spire::TrackingAllocator<Run, Spire::MemoryCategory::VoxelStorage> > Runs;
+
+            [[nodiscard]] std::size_t GetMemoryUsage() const { return sizeof(CompressedData) + Runs.capacity() * sizeof(Run); }
+        };
+
+        // Fills in the voxel types of a paged out storage when it is next accessed, returns false if they couldn't be loaded
+        // The bits and occupancy are rebuilt afterwards
+        using PageInFunction = std::function<bool(std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels)>;
+
+        enum class Residency : glm::u8 {
+            Resident,
+            Compressed,
+            PagedOut
+        };
+
+        ChunkVoxelStorage();
+
+        // Copying a paged out storage pages it in first so the copies don't depend on where it was paged out to
+        ChunkVoxelStorage(const ChunkVoxelStorage &other);
+
+        ChunkVoxelStorage &operator=(const ChunkVoxelStorage &other);
+
+    public:
+        [[nodiscard]] const Data &Read() const {
+            if (!IsResident()) [[unlikely]] (void) MakeResident();
+            return *m_residentData.load(std::memory_order_acquire);
+        }
+
+        // Get the data for writing, copies the data first if it is shared with another storage
+        [[nodiscard]] Data &Write();
+
+        // Run length encode the voxels and free the uncompressed data
+        // Does nothing and returns false if the data is shared or would be less than minimumRatio times smaller
+        bool Compress(float minimumRatio);
+
+        // Free the voxels (compressed or not), pageIn is called to load them again on the next access
+        // The caller must have saved the voxels somewhere pageIn can load them from
+        // Does nothing and returns false if the data is shared
+        bool PageOut(PageInFunction pageIn);
+
+        [[nodiscard]] Residency GetResidency() const { return m_residency.load(std::memory_order_acquire); }
+
+        [[nodiscard]] bool IsResident() const { return GetResidency() == Residency::Resident; }
+
+        [[nodiscard]] bool IsCompressed() const { return GetResidency() == Residency::Compressed; }
+
+        [[nodiscard]] bool IsPagedOut() const { return GetResidency() == Residency::PagedOut; }
+
+        // Decompress/page in now instead of on the next access, returns true if this call made the data resident
+        bool EnsureResident() const { return !IsResident() && MakeResident(); }
+
+        // true if another storage is referencing the same data
+        [[nodiscard]] bool IsShared() const;
+
+        [[nodiscard]] bool SharesDataWith(const ChunkVoxelStorage &other) const { return GetDataIdentity() == other.GetDataIdentity(); }
+
+        // Identifies the underlying allocation, storages that share data have the same identity
+        [[nodiscard]] const void *GetDataIdentity() const;
+
+        // Bytes used by the underlying allocation (compressed or not, nearly nothing when paged out)
+        [[nodiscard]] std::size_t GetMemoryUsage() const;
+
+        // GetMemoryUsage of a paged out storage
+        [[nodiscard]] static std::size_t GetPagedOutMemoryUsage();
+
+        [[nodiscard]] bool IsCorrupted() const {
+            const Data *data = m_residentData.load(std::memory_order_acquire);
+            return data && data->IsCorrupted();
+        }
+
+        [[nodiscard]] static std::shared_ptr<const CompressedData> CompressVoxels(const Data &data, std::size_t maximumRuns);
+
+        static void DecompressVoxels(const CompressedData &compressed, Data &data);
+
+    private:
+        struct PagedOutData {
+            PageInFunction PageIn;
+        };
+
+        bool MakeResident() const;
+
+        // MakeResident with m_residencyMutex already held
+        bool MakeResidentLocked() const;
+
+        // Replace the data handle, must hold m_residencyMutex unless the storage is being constructed
+        void SetData(std::shared_ptr<Data> data) const;
+
+        template<typename T, typename... Args>
+        [[nodiscard]] static std::shared_ptr<T> MakeShared(Args &&... args) {
+            return std::allocate_shared<T>(Spire::TrackingAllocator<T, Spire::MemoryCategory::VoxelStorage>(), std::forward<Args>(args)...);
+        }
+
+        [[nodiscard]] static const std::shared_ptr<Data> &GetSharedEmptyData();
+
+    private:
+        // all of these are allocated with MakeShared so they are reported as MemoryCategory::VoxelStorage
+        // exactly one of m_data, m_compressed and m_pagedOut is set depending on m_residency
+        // mutable so reading can make the data resident
+        // m_data is only replaced under m_residencyMutex, other threads read m_residentData (m_data.get(), null when not resident) instead
+        mutable std::shared_ptr<Data> m_data;
+        mutable std::atomic<Data *> m_residentData = nullptr;
+        mutable std::shared_ptr<const CompressedData> m_compressed;
+        mutable std::shared_ptr<const PagedOutData> m_pagedOut;
+        mutable std::atomic<Residency> m_residency = Residency::Resident;
+        mutable std::mutex m_residencyMutex;
+    };
+} // SpireVoxel
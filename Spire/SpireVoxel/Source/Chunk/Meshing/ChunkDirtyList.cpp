@@ -0,0 +1,47 @@
+#include "ChunkDirtyList.h"
+
+namespace SpireVoxel {
+    ChunkDirtyList::~ChunkDirtyList() {
+        Node *node = m_head.load(std::memory_order_acquire);
+        while (node) {
+            Node *next = node->Next;
+            delete node;
+            node = next;
+        }
+    }
+
+    bool ChunkDirtyList::Push(ChunkHandle handle, std::atomic<bool> &dirty) {
+        if (dirty.exchange(true, std::memory_order_acq_rel)) return false;
+
+        // counted first so taking the node can't make the size wrap around
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        auto *node = new Node{handle, m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+    std::vector<ChunkHandle> ChunkDirtyList::TakeAll() {
+        Node *node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+        std::vector<ChunkHandle> handles;
+        while (node) {
+            handles.push_back(node->Handle);
+            Node *next = node->Next;
+            delete node;
+            node = next;
+        }
+        m_size.fetch_sub(handles.size(), std::memory_order_relaxed);
+
+        // the stack is newest first
+        std::ranges::reverse(handles);
+        return handles;
+    }
+
+    void ChunkDirtyList::ForEach(const std::function<void(ChunkHandle)> &function) const {
+        // pushes only prepend and only the owner frees nodes, so the nodes after the head can be read while other threads push
+        for (Node *node = m_head.load(std::memory_order_acquire); node; node = node->Next) {
+            function(node->Handle);
+        }
+    }
+} // SpireVoxel
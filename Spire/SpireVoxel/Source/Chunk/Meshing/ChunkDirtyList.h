@@ -0,0 +1,48 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Utils/SlotMap.h"
+
+namespace SpireVoxel {
+    using ChunkHandle = SlotMapHandle;
+
+    // Chunks edited since the owner last took them, pushed from any thread without a lock
+    // Each chunk has a dirty flag and only the push that sets it adds the chunk, so a chunk is in the list at most once however many threads edit it
+    // The list is a singly linked stack: pushing is a compare exchange on the head and the owner takes every node at once,
+    // so a node is never freed or reused while a pushing thread can still see it
+    class ChunkDirtyList {
+    public:
+        ChunkDirtyList() = default;
+
+        ~ChunkDirtyList();
+
+        DISABLE_COPY_AND_MOVE(ChunkDirtyList)
+
+    public:
+        // Thread safe, does nothing and returns false if dirty was already set
+        // Always an exchange rather than checking first, so the owner clearing the flag synchronises with every edit made before it
+        bool Push(ChunkHandle handle, std::atomic<bool> &dirty);
+
+        // Call once the chunk has been taken, edits made after this push the chunk again
+        static void Clear(std::atomic<bool> &dirty) { (void) dirty.exchange(false, std::memory_order_acq_rel); }
+
+        // Every chunk pushed so far in push order, their flags must be cleared with Clear, owner thread only
+        [[nodiscard]] std::vector<ChunkHandle> TakeAll();
+
+        // Visit the chunks in the list without taking them, pushes made meanwhile may be missed, owner thread only
+        void ForEach(const std::function<void(ChunkHandle)> &function) const;
+
+        [[nodiscard]] std::size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const { return Size() * sizeof(Node); }
+
+    private:
+        struct Node {
+            ChunkHandle Handle;
+            Node *Next;
+        };
+
+        std::atomic<Node *> m_head = nullptr;
+        std::atomic<std::size_t> m_size = 0;
+    };
+} // SpireVoxel
@@ -29,6 +29,15 @@ namespace SpireVoxel {
             return count;
         }
 
+        // Heap usage of the vertex, voxel type and AO vectors
+        [[nodiscard]] std::size_t GetMemoryUsage() const {
+            std::size_t usage = VoxelTypes.capacity() * sizeof(VoxelType) + AOData.capacity() * sizeof(glm::u32);
+            for (const auto &vec : Vertices) {
+                usage += vec.capacity() * sizeof(VertexData);
+            }
+            return usage;
+        }
+
         [[nodiscard]] std::array<glm::u32, SPIRE_VOXEL_NUM_FACES> GetVertexCounts() const {
             return {
                 static_cast<glm::u32>(Vertices[0].size()),
@@ -3,8 +3,7 @@
 #include "VoxelRenderer.h"
 #include "Chunk/Chunk.h"
 #include "Edits/BasicVoxelEdit.h"
-#include "Utils/ClosestUtil.h"
-#include "Utils/ThreadPool.h"
+#include "Utils/TaskGraph.h"
 
 namespace SpireVoxel {
     ChunkMesher::ChunkMesher(
@@ -26,68 +25,196 @@ namespace SpireVoxel {
         } else {
             Spire::info("Using {} threads to mesh chunks", m_numCPUThreads);
         }
+        m_maxMeshesInFlight = m_settings.MaxMeshesInFlight > 0 ? m_settings.MaxMeshesInFlight : 2 * m_numCPUThreads;
+        m_uploadJob = m_world.GetFrameScheduler().Register("Mesh upload", 0.5f);
     }
 
-    struct ToMesh {
-        glm::ivec3 ChunkCoords;
-        float SquaredDistanceFromCamera;
+    ChunkMesher::~ChunkMesher() {
+        // the mesh tasks hold references to the chunks
+        WaitForMeshing();
+    }
+
+    bool ChunkMesher::HandleChunkEdits(const std::unordered_set<ChunkHandle> &editedChunks, const DirtyChunkQueue::View &view) {
+        m_dirtyChunks.SetView(view);
+        QueueChunks(editedChunks);
+
+        CollectMeshes(false);
+        if (m_meshScratchMemory.Get() <= m_settings.MaxPendingMeshBytes) {
+            (void) SubmitEditedChunks(m_settings.LoadBalanceMeshing ? m_maxMeshesInFlight : SIZE_MAX);
+        }
+
+        // without load balancing everything is meshed and uploaded in the same frame
+        if (!m_settings.LoadBalanceMeshing) {
+            CollectMeshes(true);
+            return UploadMeshedChunks(SIZE_MAX, UINT64_MAX) > 0;
+        }
 
-        bool operator<(const ToMesh &other) const {
-            return SquaredDistanceFromCamera < other.SquaredDistanceFromCamera;
+        // uploads are the last maintenance work of the frame, they get what is left of the budget
+        FrameBudgetScheduler &scheduler = m_world.GetFrameScheduler();
+        glm::u32 maxChunks = scheduler.Admit(m_uploadJob, static_cast<glm::u32>(m_meshedChunks.size()), 1);
+        if (maxChunks == 0) return false;
+
+        Spire::Timer timer;
+        std::size_t numUploaded = UploadMeshedChunks(maxChunks, m_settings.MaxMeshUploadBytesPerFrame);
+        scheduler.Report(m_uploadJob, static_cast<glm::u32>(numUploaded), timer.MillisSinceStart());
+        return numUploaded > 0;
+    }
+
+    void ChunkMesher::QueueChunks(const std::unordered_set<ChunkHandle> &editedChunks) {
+        for (ChunkHandle handle : editedChunks) {
+            Chunk *chunk = m_world.TryGetChunk(handle);
+            if (chunk) m_dirtyChunks.Push(handle, chunk->ChunkPosition);
         }
-    };
+    }
+
+    void ChunkMesher::MeshQueuedChunks(std::unordered_map<Chunk *, ChunkMesh> &meshes) {
+        while (true) {
+            std::size_t numSubmitted = SubmitEditedChunks(SIZE_MAX);
+            CollectMeshes(true);
+
+            // taken every round so a chunk waiting behind its own finished mesh can be submitted again
+            glm::u64 freedBytes = 0;
+            for (auto &[handle, mesh] : m_meshedChunks) {
+                freedBytes += mesh.GetMemoryUsage();
+                if (Chunk *chunk = m_world.TryGetChunk(handle)) meshes[chunk] = std::move(mesh);
+                m_dirtyChunks.Release(handle);
+            }
+            m_meshedChunks.clear();
+            m_meshScratchMemory.Set(m_meshScratchMemory.Get() - freedBytes);
+
+            // chunks another thread is writing to stay queued for the next HandleChunkEdits
+            if (numSubmitted == 0 || m_dirtyChunks.Empty()) break;
+        }
+    }
+
+    void ChunkMesher::GetQueuedChunks(std::unordered_set<ChunkHandle> &chunks) const {
+        m_dirtyChunks.GetChunks(chunks);
+        for (const auto &[handle, _] : m_meshingChunks) chunks.insert(handle);
+        for (const auto &[handle, _] : m_meshedChunks) chunks.insert(handle);
+    }
+
+    void ChunkMesher::WaitForMeshing(ChunkHandle handle) const {
+        auto it = m_meshingChunks.find(handle);
+        if (it != m_meshingChunks.end()) it->second.wait();
+    }
+
+    void ChunkMesher::WaitForMeshing() const {
+        for (const auto &[_, meshing] : m_meshingChunks) meshing.wait();
+    }
+
+    void ChunkMesher::CollectMeshes(bool wait) {
+        for (auto it = m_meshingChunks.begin(); it != m_meshingChunks.end();) {
+            if (!wait && it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+
+            ChunkHandle handle = it->first;
+            auto [mesh, version] = it->second.get();
+            it = m_meshingChunks.erase(it);
+
+            // the chunk was unloaded while meshing, nothing to upload
+            Chunk *chunk = m_world.TryGetChunk(handle);
+            if (!chunk) {
+                m_dirtyChunks.Release(handle);
+                continue;
+            }
 
-    bool ChunkMesher::HandleChunkEdits(std::unordered_set<glm::ivec3> &editedChunks, glm::vec3 cameraCoords) const {
-        // find the highest priority chunks
-        glm::vec3 cameraChunkCoords = cameraCoords / static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE);
-        std::vector<glm::uvec3> chunksToMesh = ClosestUtil::GetClosestCoords(editedChunks, cameraChunkCoords, m_settings.LoadBalanceMeshing ? m_numCPUThreads : UINT32_MAX);
+            // the chunk was written to while meshing so the mesh may be torn, mesh it again
+            if (!chunk->EndRead(version)) {
+                m_dirtyChunks.Release(handle);
+                m_dirtyChunks.Push(handle, chunk->ChunkPosition);
+                continue;
+            }
 
-        std::unordered_map<Chunk *, std::future<ChunkMesh> > meshingChunks;
+            m_meshScratchMemory.Set(m_meshScratchMemory.Get() + mesh.GetMemoryUsage());
+            m_meshedChunks[handle] = std::move(mesh);
+        }
+    }
 
-        // submit mesh tasks to thread pool
-        for (glm::uvec3 chunkCoords : chunksToMesh) {
-            Chunk *chunk = m_world.TryGetLoadedChunk(chunkCoords);
-            if (!chunk) continue;
+    std::size_t ChunkMesher::UploadMeshedChunks(std::size_t maxChunks, glm::u64 maxBytes) {
+        if (m_meshedChunks.empty()) return 0;
 
-            meshingChunks[chunk] = Mesh(*chunk);
+        std::unordered_map<Chunk *, ChunkMesh> meshes;
+        glm::u64 uploadBytes = 0;
+        glm::u64 freedBytes = 0;
+        for (auto it = m_meshedChunks.begin(); it != m_meshedChunks.end() && meshes.size() < maxChunks && uploadBytes < maxBytes;) {
+            glm::u64 size = it->second.GetMemoryUsage();
+            Chunk *chunk = m_world.TryGetChunk(it->first);
+            if (chunk) {
+                uploadBytes += size;
+                meshes[chunk] = std::move(it->second);
+            }
+            freedBytes += size;
+            m_dirtyChunks.Release(it->first);
+            it = m_meshedChunks.erase(it);
         }
 
-        // wait for meshing to complete then move meshingChunks into meshedChunks
-        if (meshingChunks.empty()) return false;
+        // mesh tasks may be queued on the task graph, copying there would wait behind them
+        UploadChunkMeshes(meshes, !m_settings.LoadBalanceMeshing);
+        m_meshScratchMemory.Set(m_meshScratchMemory.Get() - freedBytes);
+        return meshes.size();
+    }
+
+    std::size_t ChunkMesher::SubmitEditedChunks(std::size_t maxInFlight) {
+        if (m_meshingChunks.size() >= maxInFlight) return 0;
+
+        return m_dirtyChunks.Take(maxInFlight - m_meshingChunks.size(), [&](ChunkHandle handle, glm::ivec3) {
+            // forget chunks that were unloaded after being edited
+            Chunk *chunk = m_world.TryGetChunk(handle);
+            if (!chunk) return DirtyChunkQueue::Selection::DROP;
+
+            // chunks that are already being meshed wait for that mesh to be uploaded, they are released then
+            if (m_meshingChunks.contains(handle) || m_meshedChunks.contains(handle)) return DirtyChunkQueue::Selection::HOLD;
 
-        std::vector<std::future<void> > meshUploadFutures;
-        std::unordered_map<Chunk *, ChunkMesh> meshedChunks;
-        meshedChunks.reserve(meshingChunks.size());
+            // another thread is writing to the chunk, it will be notified again once the write is done
+            // a generating chunk is written to by its generation task, the mesh task waits for that instead
+            bool writing = chunk->BeginRead() % 2 == 1;
+            if (writing && !m_world.GetProceduralGenerationManager().IsGenerating(chunk->ChunkPosition)) return DirtyChunkQueue::Selection::KEEP;
 
+            m_meshingChunks[handle] = Mesh(*chunk);
+            return DirtyChunkQueue::Selection::TAKE;
+        });
+    }
+
+    void ChunkMesher::UploadChunkMeshes(std::unordered_map<Chunk *, ChunkMesh> &meshedChunks, bool parallelCopies) const {
+        if (meshedChunks.empty()) return;
+
+        Spire::TaskGroup meshUploadCopies;
+        Spire::TaskGroup *copies = parallelCopies ? &meshUploadCopies : nullptr;
         std::shared_ptr<Spire::BufferAllocator::MappedMemory> voxelDataMemory = m_chunkVoxelDataBufferAllocator.MapMemory();
         std::shared_ptr<Spire::BufferAllocator::MappedMemory> vertexBufferMemory = m_chunkVertexBufferAllocator.MapMemory();
         std::shared_ptr<Spire::BufferAllocator::MappedMemory> aoDataMemory = m_chunkAODataBufferAllocator.MapMemory();
 
-        for (auto &[chunk, meshFuture] : meshingChunks) {
-            meshedChunks[chunk] = meshFuture.get();
-        }
-        meshingChunks.clear();
-
         // Upload meshed chunks to GPU
-        for (auto &[chunk, meshFuture] : meshedChunks) {
-            editedChunks.erase(chunk->ChunkPosition);
-            UploadChunkMesh(*chunk, meshFuture, *voxelDataMemory, *aoDataMemory, *vertexBufferMemory, meshUploadFutures);
+        for (auto &[chunk, mesh] : meshedChunks) {
+            UploadChunkMesh(*chunk, mesh, *voxelDataMemory, *aoDataMemory, *vertexBufferMemory, copies);
         }
 
         // Wait for upload tasks to complete
-        for (auto &future : meshUploadFutures) {
-            future.wait();
-        }
-        return true;
+        Spire::TaskGraph::Instance().Wait(meshUploadCopies);
     }
 
-    std::future<ChunkMesh> ChunkMesher::Mesh(Chunk &chunk) const {
-        return Spire::ThreadPool::Instance().submit_task([this, &chunk] {
-            return chunk.GenerateMesh();
-        });
+    std::future<ChunkMesher::MeshingChunk> ChunkMesher::Mesh(Chunk &chunk) const {
+        auto meshing = std::make_shared<std::promise<MeshingChunk> >();
+        std::future<MeshingChunk> future = meshing->get_future();
+
+        // the version is recorded when the task starts, so a chunk queued while generating isn't meshed torn and thrown away
+        Spire::TaskGraph::TaskHandle generation = m_world.GetProceduralGenerationManager().GetGenerationTask(chunk.ChunkPosition);
+        Spire::TaskGraph::Instance().Submit([&chunk, meshing] {
+            glm::u64 version = chunk.BeginRead();
+            meshing->set_value({chunk.GenerateMesh(), version});
+        }, {generation}, nullptr, Spire::TaskPriority::Interactive);
+        return future;
+    }
+
+    void ChunkMesher::Copy(Spire::TaskGroup *copies, std::function<void()> copy) {
+        // the uploads are on the way to showing an edit
+        if (copies) Spire::TaskGraph::Instance().Submit(std::move(copy), {}, copies, Spire::TaskPriority::Interactive);
+        else copy();
     }
 
-    bool ChunkMesher::UploadData(Chunk &chunk, Spire::BufferAllocator::MappedMemory &mappedMemory, std::vector<std::future<void> > &futures, glm::u32 requestedSize,
+    bool ChunkMesher::UploadData(Chunk &chunk, Spire::BufferAllocator::MappedMemory &mappedMemory, Spire::TaskGroup *copies, glm::u32 requestedSize,
                                  const void *data, Spire::BufferAllocator::Allocation &allocation, Spire::BufferAllocator &allocator) const {
         const Spire::BufferAllocator::Allocation oldAllocation = allocation;
         allocation = {};
@@ -99,11 +226,11 @@ namespace SpireVoxel {
                 allocation = *alloc;
 
                 // write the data async
-                futures.push_back(Spire::ThreadPool::Instance().submit_task([&mappedMemory, &allocation, data, alloc]() {
+                Copy(copies, [&mappedMemory, &allocation, data, alloc]() {
                     void *memory = mappedMemory.GetByAllocation(allocation).Memory;
                     memcpy(static_cast<char *>(memory) + allocation.Location.Start,
                            data, alloc->Size);
-                }));
+                });
             }
         }
 
@@ -114,7 +241,7 @@ namespace SpireVoxel {
     }
 
     void ChunkMesher::UploadChunkMesh(Chunk &chunk, ChunkMesh &mesh, Spire::BufferAllocator::MappedMemory &voxelDataMemory, Spire::BufferAllocator::MappedMemory &aoDataMemory,
-                                      Spire::BufferAllocator::MappedMemory &chunkVertexBufferMemory, std::vector<std::future<void> > &futures) const {
+                                      Spire::BufferAllocator::MappedMemory &chunkVertexBufferMemory, Spire::TaskGroup *copies) const {
         // write the new mesh
         const Spire::BufferAllocator::Allocation oldAllocation = chunk.VertexAllocation;
         chunk.VertexAllocation = {};
@@ -125,17 +252,16 @@ namespace SpireVoxel {
                 chunk.VertexAllocation = *alloc;
 
                 // write the mesh into the vertex buffer
-                futures.push_back(
-                    Spire::ThreadPool::Instance().submit_task([&chunk,&chunkVertexBufferMemory, &mesh] {
-                        void *memory = chunkVertexBufferMemory.GetByAllocation(chunk.VertexAllocation).Memory;
-                        glm::u32 offset = 0;
-                        for (const std::vector vertices : mesh.Vertices) {
-                            glm::u32 size = vertices.size() * sizeof(VertexData);
-                            memcpy(static_cast<char *>(memory) + chunk.VertexAllocation.Location.Start + offset,
-                                   vertices.data(), size);
-                            offset += size;
-                        }
-                    }));
+                Copy(copies, [&chunk,&chunkVertexBufferMemory, &mesh] {
+                    void *memory = chunkVertexBufferMemory.GetByAllocation(chunk.VertexAllocation).Memory;
+                    glm::u32 offset = 0;
+                    for (const std::vector vertices : mesh.Vertices) {
+                        glm::u32 size = vertices.size() * sizeof(VertexData);
+                        memcpy(static_cast<char *>(memory) + chunk.VertexAllocation.Location.Start + offset,
+                               vertices.data(), size);
+                        offset += size;
+                    }
+                });
             } else {
                 Spire::error("Chunk vertex data allocation failed");
                 mesh.Vertices = {};
@@ -155,7 +281,7 @@ namespace SpireVoxel {
         // write the voxel data
         // Since voxel data is stored in uint32 on GPU, we need to push an extra u16 as padding if we have an odd number of u16's
         std::size_t voxelDataPadding = mesh.VoxelTypes.size() % 2 == 1 ? sizeof(mesh.VoxelTypes[0]) : 0;
-        if (!UploadData(chunk, voxelDataMemory, futures, sizeof(mesh.VoxelTypes[0]) * mesh.VoxelTypes.size() + voxelDataPadding, mesh.VoxelTypes.data(), chunk.VoxelDataAllocation,
+        if (!UploadData(chunk, voxelDataMemory, copies, sizeof(mesh.VoxelTypes[0]) * mesh.VoxelTypes.size() + voxelDataPadding, mesh.VoxelTypes.data(), chunk.VoxelDataAllocation,
                         m_chunkVoxelDataBufferAllocator) && chunk.TotalVertices > 0) {
             // allocation failed, need to free the vertex allocation
             Spire::error("Chunk voxel data allocation failed, deallocating vertex buffer");
@@ -164,7 +290,7 @@ namespace SpireVoxel {
         }
 
         // write the AO data
-        if (!UploadData(chunk, aoDataMemory, futures, sizeof(mesh.AOData[0]) * mesh.AOData.size(), mesh.AOData.data(), chunk.AODataAllocation,
+        if (!UploadData(chunk, aoDataMemory, copies, sizeof(mesh.AOData[0]) * mesh.AOData.size(), mesh.AOData.data(), chunk.AODataAllocation,
                         m_chunkAODataBufferAllocator) && chunk.TotalVertices > 0) {
             // allocation failed, need to free the vertex allocation
             Spire::error("Chunk AO data allocation failed, deallocating other buffers");
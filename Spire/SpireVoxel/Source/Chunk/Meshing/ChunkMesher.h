@@ -1,14 +1,19 @@
 #pragma once
 
 #include "ChunkMesh.h"
+#include "DirtyChunkQueue.h"
 #include "EngineIncludes.h"
 #include "Chunk/VoxelWorld.h"
+#include "Utils/TaskGraph.h"
 
 namespace SpireVoxel {
     class VoxelWorld;
     struct Chunk;
     struct VertexData;
 
+    // Meshes edited chunks on the task graph across frames:
+    // each frame finished meshes are uploaded and the highest priority edited chunks are submitted, chunks keep their old mesh until the new one is uploaded
+    // Edited chunks wait in a DirtyChunkQueue across frames
     class ChunkMesher {
     public:
         ChunkMesher(
@@ -19,28 +24,78 @@ namespace SpireVoxel {
             const VoxelWorld::Settings &settings
         );
 
+        ~ChunkMesher();
+
+        DISABLE_COPY_AND_MOVE(ChunkMesher)
+
     public:
-        // Return true if something was remeshed
-        [[nodiscard]] bool HandleChunkEdits(std::unordered_set<glm::ivec3> &editedChunks, glm::vec3 cameraCoords) const;
+        // Queue newly edited chunks, upload finished meshes then submit queued chunks to be meshed, return true if something was uploaded
+        [[nodiscard]] bool HandleChunkEdits(const std::unordered_set<ChunkHandle> &editedChunks, const DirtyChunkQueue::View &view);
+
+        // Queue newly edited chunks to be meshed
+        void QueueChunks(const std::unordered_set<ChunkHandle> &editedChunks);
+
+        // Mesh every queued chunk now and wait for them, ignoring the in flight limits
+        // The meshes are moved to meshes instead of being uploaded, for benchmarks (see EditReplay)
+        void MeshQueuedChunks(std::unordered_map<Chunk *, ChunkMesh> &meshes);
+
+        // Chunks waiting to be meshed, being meshed or waiting to be uploaded
+        void GetQueuedChunks(std::unordered_set<ChunkHandle> &chunks) const;
+
+        [[nodiscard]] std::size_t NumQueuedChunks() const { return m_dirtyChunks.Size() + m_meshingChunks.size() + m_meshedChunks.size(); }
+
+        [[nodiscard]] const DirtyChunkQueue &GetDirtyChunks() const { return m_dirtyChunks; }
+
+        // Wait for the mesh task of a chunk to finish, must be called before the chunk is unloaded or its storage is replaced
+        void WaitForMeshing(ChunkHandle handle) const;
+
+        void WaitForMeshing() const;
+
+        // Memory held by finished meshes waiting to be uploaded
+        [[nodiscard]] glm::u64 GetMeshedChunksMemoryUsage() const { return m_meshScratchMemory.Get(); }
+
+        // Upload meshes to the GPU and wait for the writes to finish
+        // parallelCopies - copy the meshes into the buffers on the task graph, otherwise on this thread
+        void UploadChunkMeshes(std::unordered_map<Chunk *, ChunkMesh> &meshedChunks, bool parallelCopies = true) const;
 
     private:
-        // Mesh a chunk on another thread
-        [[nodiscard]] std::future<ChunkMesh> Mesh(Chunk &chunk) const;
+        struct MeshingChunk {
+            ChunkMesh Mesh;
+            glm::u64 Version; // of the chunk when meshing started
+        };
+
+        // Move finished meshes to m_meshedChunks, waits for every mesh if wait is true
+        void CollectMeshes(bool wait);
+
+        // Upload finished meshes up to maxChunks and maxBytes, at least one mesh is uploaded if maxChunks isn't 0
+        // Returns the number of meshes uploaded
+        [[nodiscard]] std::size_t UploadMeshedChunks(std::size_t maxChunks, glm::u64 maxBytes);
+
+        // Submit the highest priority edited chunks until maxInFlight chunks are being meshed
+        // Returns the number of chunks submitted
+        std::size_t SubmitEditedChunks(std::size_t maxInFlight);
+
+        // Mesh a chunk on the task graph, after its generation task if it is still generating
+        [[nodiscard]] std::future<MeshingChunk> Mesh(Chunk &chunk) const;
 
         // Upload chunk mesh to GPU
         // voxelDataMemory - mapped memory for m_chunkVoxelDataBufferAllocator
         // chunkVertexBufferMemory - mapped memory for m_chunkVertexBufferAllocator
-        // futures - some steps are parallelized, void futures will be pushed to this vector and the function is only complete once all futures return.
-        // Until futures haven't returned:
+        // copies - the copies are run as Interactive tasks in this group and the function is only complete once the group is done
+        // if copies is null the steps run on this thread
+        // Until the group is done:
         // chunk, chunkVertexBufferMemory, mesh, and voxelDataMemory must be kept alive
         // the chunks vertex buffer and voxel data allocations must not be changed
         void UploadChunkMesh(Chunk &chunk, ChunkMesh &mesh, Spire::BufferAllocator::MappedMemory &voxelDataMemory, Spire::BufferAllocator::MappedMemory &aoDataMemory,
-                             Spire::BufferAllocator::MappedMemory &chunkVertexBufferMemory, std::vector<std::future<void> > &futures) const;
+                             Spire::BufferAllocator::MappedMemory &chunkVertexBufferMemory, Spire::TaskGroup *copies) const;
 
-        bool UploadData(Chunk &chunk, Spire::BufferAllocator::MappedMemory &mappedMemory, std::vector<std::future<void> > &futures, glm::u32 requestedSize, const void *data,
+        bool UploadData(Chunk &chunk, Spire::BufferAllocator::MappedMemory &mappedMemory, Spire::TaskGroup *copies, glm::u32 requestedSize, const void *data,
                         Spire::BufferAllocator::
                         Allocation &allocation, Spire::BufferAllocator &allocator) const;
 
+        // Run copy as an Interactive task in copies, or run it now if copies is null
+        static void Copy(Spire::TaskGroup *copies, std::function<void()> copy);
+
     private:
         glm::u32 m_numCPUThreads;
         VoxelWorld &m_world;
@@ -48,5 +103,11 @@ namespace SpireVoxel {
         Spire::BufferAllocator &m_chunkVoxelDataBufferAllocator;
         Spire::BufferAllocator &m_chunkAODataBufferAllocator;
         VoxelWorld::Settings m_settings;
+        glm::u32 m_maxMeshesInFlight;
+        FrameBudgetScheduler::JobType m_uploadJob;
+        DirtyChunkQueue m_dirtyChunks;
+        std::unordered_map<ChunkHandle, std::future<MeshingChunk> > m_meshingChunks;
+        std::unordered_map<ChunkHandle, ChunkMesh> m_meshedChunks; // finished, waiting to be uploaded
+        Spire::MemoryCounter m_meshScratchMemory{Spire::MemoryCategory::MeshScratch};
     };
 } // SpireVoxel
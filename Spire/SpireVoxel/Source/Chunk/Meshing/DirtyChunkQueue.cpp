@@ -0,0 +1,134 @@
+#include "DirtyChunkQueue.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    DirtyChunkQueue::DirtyChunkQueue() : DirtyChunkQueue(Settings{}) {
+    }
+
+    DirtyChunkQueue::DirtyChunkQueue(Settings settings) : m_settings(settings) {
+    }
+
+    void DirtyChunkQueue::SetView(const View &view) {
+        m_frame++;
+
+        glm::ivec3 cameraChunk = glm::ivec3(glm::floor(view.Position / static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE)));
+        glm::vec3 forward = glm::normalize(view.Forward);
+        bool moved = cameraChunk != m_cameraChunk;
+        bool turned = glm::dot(forward, m_forward) < glm::cos(glm::radians(m_settings.RekeyAngleDegrees));
+        bool frustumChanged = view.Frustum.has_value() != m_frustum.has_value();
+
+        // the frustum is kept up to date for chunks pushed later, but only a big enough change is worth recalculating every key
+        m_frustum = view.Frustum;
+        if (!moved && !turned && !frustumChanged) return;
+
+        m_cameraChunk = cameraChunk;
+        m_forward = forward;
+        Rekey();
+    }
+
+    void DirtyChunkQueue::Push(ChunkHandle handle, glm::ivec3 chunkPosition) {
+        auto [it, inserted] = m_entries.try_emplace(handle, Entry{chunkPosition, m_frame, m_nextPushId});
+        if (!inserted) return;
+
+        m_heap.push_back({CalculateKey(chunkPosition, m_frame), handle, m_nextPushId++});
+        std::push_heap(m_heap.begin(), m_heap.end());
+    }
+
+    bool DirtyChunkQueue::Remove(ChunkHandle handle) {
+        if (m_entries.erase(handle) == 0) return false;
+
+        // the heap entry is skipped when it is popped, rebuild once stale entries are most of the heap
+        if (m_heap.size() > 2 * m_entries.size() + 64) Rekey();
+        return true;
+    }
+
+    std::size_t DirtyChunkQueue::Take(std::size_t maxCount, const std::function<Selection(ChunkHandle handle, glm::ivec3 chunkPosition)> &select) {
+        std::size_t numTaken = 0;
+        std::vector<HeapEntry> kept;
+        // kept chunks are popped and pushed back, capping them too means a call never pops more than 2 * maxCount live entries
+        while (numTaken < maxCount && kept.size() < maxCount && !m_heap.empty()) {
+            std::pop_heap(m_heap.begin(), m_heap.end());
+            HeapEntry heapEntry = m_heap.back();
+            m_heap.pop_back();
+            if (IsStale(heapEntry)) continue;
+
+            switch (select(heapEntry.Handle, m_entries.at(heapEntry.Handle).ChunkPosition)) {
+                case Selection::TAKE:
+                    numTaken++;
+                    m_entries.erase(heapEntry.Handle);
+                    break;
+                case Selection::KEEP:
+                    kept.push_back(heapEntry);
+                    break;
+                case Selection::HOLD:
+                    m_entries.at(heapEntry.Handle).Held = true;
+                    break;
+                case Selection::DROP:
+                    m_entries.erase(heapEntry.Handle);
+                    break;
+            }
+        }
+
+        for (const HeapEntry &heapEntry : kept) {
+            m_heap.push_back(heapEntry);
+            std::push_heap(m_heap.begin(), m_heap.end());
+        }
+        return numTaken;
+    }
+
+    void DirtyChunkQueue::Release(ChunkHandle handle) {
+        auto it = m_entries.find(handle);
+        if (it == m_entries.end() || !it->second.Held) return;
+
+        it->second.Held = false;
+        m_heap.push_back({CalculateKey(it->second.ChunkPosition, it->second.FramePushed), handle, it->second.PushId});
+        std::push_heap(m_heap.begin(), m_heap.end());
+    }
+
+    std::vector<ChunkHandle> DirtyChunkQueue::Take(std::size_t maxCount) {
+        std::vector<ChunkHandle> taken;
+        Take(maxCount, [&](ChunkHandle handle, glm::ivec3) {
+            taken.push_back(handle);
+            return Selection::TAKE;
+        });
+        return taken;
+    }
+
+    void DirtyChunkQueue::GetChunks(std::unordered_set<ChunkHandle> &chunks) const {
+        for (const auto &[handle, _] : m_entries) chunks.insert(handle);
+    }
+
+    glm::u64 DirtyChunkQueue::CalculateMemoryUsage() const {
+        return Spire::EstimateHashContainerMemoryUsage(m_entries) + m_heap.capacity() * sizeof(HeapEntry);
+    }
+
+    float DirtyChunkQueue::CalculateKey(glm::ivec3 chunkPosition, glm::u64 framePushed) const {
+        // distance between chunk centres so it is the same for negative coordinates
+        float distance = glm::length(glm::vec3(chunkPosition - m_cameraChunk));
+        if (m_frustum) {
+            glm::vec3 min = glm::vec3(chunkPosition) * static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE);
+            if (!m_frustum->IsBoxVisible(min, min + static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE))) distance *= m_settings.OffscreenDistanceScale;
+        }
+        return distance + static_cast<float>(framePushed) / m_settings.FramesPerChunk;
+    }
+
+    bool DirtyChunkQueue::IsStale(const HeapEntry &heapEntry) const {
+        auto it = m_entries.find(heapEntry.Handle);
+        return it == m_entries.end() || it->second.PushId != heapEntry.PushId;
+    }
+
+    void DirtyChunkQueue::Rekey() {
+        Spire::Timer timer;
+        m_heap.clear();
+        m_heap.reserve(m_entries.size());
+        for (const auto &[handle, entry] : m_entries) {
+            if (entry.Held) continue;
+            m_heap.push_back({CalculateKey(entry.ChunkPosition, entry.FramePushed), handle, entry.PushId});
+        }
+        std::make_heap(m_heap.begin(), m_heap.end());
+        m_numRekeys++;
+
+        if (LOG) Spire::info("[DirtyChunkQueue] Recalculated {} keys in {} ms", m_entries.size(), timer.MillisSinceStart());
+    }
+} // SpireVoxel
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Utils/SlotMap.h"
+#include "../../../Assets/Shaders/ShaderInfo.h"
+
+namespace SpireVoxel {
+    using ChunkHandle = SlotMapHandle;
+
+    // Edited chunks waiting to be meshed, ordered by priority so the next N can be taken in O(N log M)
+    // Priority combines the distance from the camera, whether the chunk is in the frustum and how long it has waited:
+    // key = distance in chunks * (OffscreenDistanceScale if outside the frustum) - frames waited / FramesPerChunk
+    // Waiting lowers every key at the same rate, so the key is stored as distance + frame pushed / FramesPerChunk and never goes stale
+    // Keys are relative to the camera's chunk and view direction when they were calculated,
+    // they are only recalculated (an O(M) heapify) once the camera moves into another chunk or turns by more than RekeyAngleDegrees
+    // Owner thread only
+    class DirtyChunkQueue {
+    public:
+        struct Settings {
+            float OffscreenDistanceScale = 4.0f; // chunks outside the frustum are treated as this many times further away
+            float FramesPerChunk = 60.0f; // waiting this many frames is worth being one chunk closer
+            float RekeyAngleDegrees = 15.0f;
+        };
+
+        struct View {
+            glm::vec3 Position = {}; // in voxels
+            glm::vec3 Forward = {0, 0, 1};
+            std::optional<Spire::Frustum> Frustum; // nullopt if every chunk is visible
+        };
+
+        enum class Selection {
+            TAKE, // remove the chunk from the queue
+            KEEP, // leave the chunk in the queue with its age, e.g. it can't be meshed yet
+            HOLD, // leave the chunk in the queue with its age but don't offer it again until it is released, e.g. it is already being meshed
+            DROP // remove the chunk without taking it, e.g. it was unloaded
+        };
+
+    public:
+        DirtyChunkQueue();
+
+        explicit DirtyChunkQueue(Settings settings);
+
+    public:
+        // Call once per frame, advances the age of queued chunks and recalculates keys if the camera moved far enough
+        void SetView(const View &view);
+
+        // Queue a chunk, does nothing if it is already queued so it keeps its age
+        void Push(ChunkHandle handle, glm::ivec3 chunkPosition);
+
+        // Returns true if the chunk was queued
+        bool Remove(ChunkHandle handle);
+
+        // Offer chunks to select in priority order until it has taken or kept maxCount or the queue runs out, returns the number taken
+        std::size_t Take(std::size_t maxCount, const std::function<Selection(ChunkHandle handle, glm::ivec3 chunkPosition)> &select);
+
+        // Take the highest priority chunks
+        [[nodiscard]] std::vector<ChunkHandle> Take(std::size_t maxCount);
+
+        // Offer a held chunk again from the next Take, does nothing if the chunk isn't held
+        void Release(ChunkHandle handle);
+
+        [[nodiscard]] bool Contains(ChunkHandle handle) const { return m_entries.contains(handle); }
+
+        [[nodiscard]] std::size_t Size() const { return m_entries.size(); }
+
+        [[nodiscard]] bool Empty() const { return m_entries.empty(); }
+
+        void GetChunks(std::unordered_set<ChunkHandle> &chunks) const;
+
+        // Number of times every key was recalculated
+        [[nodiscard]] glm::u64 NumRekeys() const { return m_numRekeys; }
+
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const;
+
+    private:
+        struct Entry {
+            glm::ivec3 ChunkPosition;
+            glm::u64 FramePushed;
+            glm::u64 PushId;
+            bool Held = false; // not in the heap until released
+        };
+
+        struct HeapEntry {
+            float Key;
+            ChunkHandle Handle;
+            glm::u64 PushId; // an entry for a chunk that was removed (and maybe pushed again) is stale
+
+            // std heaps are max heaps, the lowest key must compare as the largest
+            bool operator<(const HeapEntry &other) const { return Key > other.Key; }
+        };
+
+        [[nodiscard]] float CalculateKey(glm::ivec3 chunkPosition, glm::u64 framePushed) const;
+
+        [[nodiscard]] bool IsStale(const HeapEntry &heapEntry) const;
+
+        void Rekey();
+
+    private:
+        Settings m_settings;
+        std::unordered_map<ChunkHandle, Entry> m_entries;
+        std::vector<HeapEntry> m_heap; // may contain stale entries of removed chunks, rebuilt once they outnumber the queued chunks
+        glm::u64 m_frame = 0;
+        glm::u64 m_nextPushId = 0;
+        // the view the keys were calculated with
+        glm::ivec3 m_cameraChunk = {};
+        glm::vec3 m_forward = {0, 0, 1};
+        std::optional<Spire::Frustum> m_frustum;
+        glm::u64 m_numRekeys = 0;
+    };
+} // SpireVoxel
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "../../Assets/Shaders/ShaderInfo.h"
+
+namespace SpireVoxel {
+    // One bit per voxel in a chunk, 1 = voxel is present, 0 = voxel is empty
+    // Stored as u64 words so it can be processed in bulk, since z is contiguous each word is a row of voxels along the z axis
+    class VoxelBitmask {
+    public:
+        static constexpr std::size_t BITS_PER_WORD = 64;
+        static constexpr std::size_t NUM_WORDS = SPIRE_VOXEL_CHUNK_VOLUME / BITS_PER_WORD;
+
+        static_assert(SPIRE_VOXEL_CHUNK_SIZE == BITS_PER_WORD); // a word is exactly one row
+
+    public:
+        [[nodiscard]] bool operator[](std::size_t index) const { return Test(index); }
+
+        [[nodiscard]] bool Test(std::size_t index) const {
+            assert(index < SPIRE_VOXEL_CHUNK_VOLUME);
+            return (m_words[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1;
+        }
+
+        void Set(std::size_t index, bool value) {
+            assert(index < SPIRE_VOXEL_CHUNK_VOLUME);
+            glm::u64 mask = glm::u64(1) << (index % BITS_PER_WORD);
+            glm::u64 &word = m_words[index / BITS_PER_WORD];
+            word = value ? word | mask : word & ~mask;
+        }
+
+        // Number of set bits
+        [[nodiscard]] std::size_t Count() const {
+            std::size_t count = 0;
+            for (glm::u64 word : m_words) count += std::popcount(word);
+            return count;
+        }
+
+        // Number of set bits in [startIndex, endIndex)
+        [[nodiscard]] std::size_t Count(std::size_t startIndex, std::size_t endIndex) const;
+
+        [[nodiscard]] glm::u64 GetWord(std::size_t wordIndex) const { return m_words[wordIndex]; }
+
+        [[nodiscard]] glm::u64 *GetWords() { return m_words.data(); }
+
+        [[nodiscard]] const glm::u64 *GetWords() const { return m_words.data(); }
+
+        [[nodiscard]] bool operator==(const VoxelBitmask &other) const = default;
+
+    private:
+        std::array<glm::u64, NUM_WORDS> m_words{};
+    };
+
+    inline std::size_t VoxelBitmask::Count(std::size_t startIndex, std::size_t endIndex) const {
+        assert(startIndex <= endIndex && endIndex <= SPIRE_VOXEL_CHUNK_VOLUME);
+        std::size_t count = 0;
+        while (startIndex < endIndex) {
+            std::size_t bit = startIndex % BITS_PER_WORD;
+            std::size_t bitsInWord = std::min(BITS_PER_WORD - bit, endIndex - startIndex);
+            glm::u64 mask = bitsInWord == BITS_PER_WORD ? ~glm::u64(0) : ((glm::u64(1) << bitsInWord) - 1) << bit;
+            count += std::popcount(m_words[startIndex / BITS_PER_WORD] & mask);
+            startIndex += bitsInWord;
+        }
+        return count;
+    }
+} // SpireVoxel
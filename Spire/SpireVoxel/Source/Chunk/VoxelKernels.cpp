@@ -0,0 +1,388 @@
+#include "VoxelKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SPIRE_VOXEL_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define SPIRE_VOXEL_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC allows intrinsics for any instruction set, GCC and Clang need the function to be marked
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SPIRE_TARGET_AVX2
+#else
+#define SPIRE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace SpireVoxel {
+    struct VoxelKernelTable {
+        VoxelKernels::InstructionSet InstructionSet;
+        void (*PackPresenceBits)(const VoxelType *voxels, glm::u64 *bits, std::size_t count);
+        void (*Fill)(VoxelType *voxels, std::size_t count, VoxelType type);
+        std::size_t (*CountNonAir)(const VoxelType *voxels, std::size_t count);
+        bool (*AllEqual)(const VoxelType *voxels, std::size_t count, VoxelType type);
+        bool (*Equal)(const VoxelType *a, const VoxelType *b, std::size_t count);
+    };
+
+    // Scalar
+
+    static void PackPresenceBitsScalar(const VoxelType *voxels, glm::u64 *bits, std::size_t count) {
+        for (std::size_t wordIndex = 0; wordIndex < count / 64; wordIndex++) {
+            glm::u64 word = 0;
+            for (glm::u32 bit = 0; bit < 64; bit++) {
+                word |= static_cast<glm::u64>(voxels[wordIndex * 64 + bit] != 0) << bit;
+            }
+            bits[wordIndex] = word;
+        }
+    }
+
+    static void FillScalar(VoxelType *voxels, std::size_t count, VoxelType type) {
+        std::fill_n(voxels, count, type);
+    }
+
+    static std::size_t CountNonAirScalar(const VoxelType *voxels, std::size_t count) {
+        return std::count_if(voxels, voxels + count, [](VoxelType type) { return type != 0; });
+    }
+
+    static bool AllEqualScalar(const VoxelType *voxels, std::size_t count, VoxelType type) {
+        return std::all_of(voxels, voxels + count, [type](VoxelType t) { return t == type; });
+    }
+
+    static bool EqualScalar(const VoxelType *a, const VoxelType *b, std::size_t count) {
+        return std::equal(a, a + count, b);
+    }
+
+    static constexpr VoxelKernelTable SCALAR_KERNELS = {
+        VoxelKernels::InstructionSet::SCALAR, PackPresenceBitsScalar, FillScalar, CountNonAirScalar, AllEqualScalar, EqualScalar
+    };
+
+#ifdef SPIRE_VOXEL_KERNELS_X86
+    // SSE2, always available on x64
+
+    static void PackPresenceBitsSSE2(const VoxelType *voxels, glm::u64 *bits, std::size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        for (std::size_t wordIndex = 0; wordIndex < count / 64; wordIndex++) {
+            const VoxelType *row = voxels + wordIndex * 64;
+            glm::u64 word = 0;
+            for (glm::u32 i = 0; i < 4; i++) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i * 16));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i * 16 + 8));
+                __m128i air = _mm_packs_epi16(_mm_cmpeq_epi16(a, zero), _mm_cmpeq_epi16(b, zero));
+                auto airBits = static_cast<glm::u64>(_mm_movemask_epi8(air));
+                word |= (~airBits & 0xFFFF) << (i * 16);
+            }
+            bits[wordIndex] = word;
+        }
+    }
+
+    static void FillSSE2(VoxelType *voxels, std::size_t count, VoxelType type) {
+        const __m128i value = _mm_set1_epi16(static_cast<short>(type));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(voxels + i), value);
+        }
+        FillScalar(voxels + i, count - i, type);
+    }
+
+    static std::size_t CountNonAirSSE2(const VoxelType *voxels, std::size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        std::size_t air = 0;
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(voxels + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(voxels + i + 8));
+            __m128i isAir = _mm_packs_epi16(_mm_cmpeq_epi16(a, zero), _mm_cmpeq_epi16(b, zero));
+            air += std::popcount(static_cast<glm::u32>(_mm_movemask_epi8(isAir)));
+        }
+        return i - air + CountNonAirScalar(voxels + i, count - i);
+    }
+
+    static bool AllEqualSSE2(const VoxelType *voxels, std::size_t count, VoxelType type) {
+        const __m128i value = _mm_set1_epi16(static_cast<short>(type));
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(voxels + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(v, value)) != 0xFFFF) return false;
+        }
+        return AllEqualScalar(voxels + i, count - i, type);
+    }
+
+    static bool EqualSSE2(const VoxelType *a, const VoxelType *b, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb)) != 0xFFFF) return false;
+        }
+        return EqualScalar(a + i, b + i, count - i);
+    }
+
+    static constexpr VoxelKernelTable SSE2_KERNELS = {
+        VoxelKernels::InstructionSet::SSE2, PackPresenceBitsSSE2, FillSSE2, CountNonAirSSE2, AllEqualSSE2, EqualSSE2
+    };
+
+    // AVX2
+
+    SPIRE_TARGET_AVX2 static void PackPresenceBitsAVX2(const VoxelType *voxels, glm::u64 *bits, std::size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        for (std::size_t wordIndex = 0; wordIndex < count / 64; wordIndex++) {
+            const VoxelType *row = voxels + wordIndex * 64;
+            glm::u64 word = 0;
+            for (glm::u32 i = 0; i < 2; i++) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i * 32));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i * 32 + 16));
+                // packs works within 128 bit lanes, permute to put the bytes back in voxel order
+                __m256i air = _mm256_packs_epi16(_mm256_cmpeq_epi16(a, zero), _mm256_cmpeq_epi16(b, zero));
+                air = _mm256_permute4x64_epi64(air, 0b11011000);
+                auto airBits = static_cast<glm::u32>(_mm256_movemask_epi8(air));
+                word |= static_cast<glm::u64>(~airBits) << (i * 32);
+            }
+            bits[wordIndex] = word;
+        }
+    }
+
+    SPIRE_TARGET_AVX2 static void FillAVX2(VoxelType *voxels, std::size_t count, VoxelType type) {
+        const __m256i value = _mm256_set1_epi16(static_cast<short>(type));
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(voxels + i), value);
+        }
+        FillScalar(voxels + i, count - i, type);
+    }
+
+    SPIRE_TARGET_AVX2 static std::size_t CountNonAirAVX2(const VoxelType *voxels, std::size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        std::size_t air = 0;
+        std::size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(voxels + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(voxels + i + 16));
+            // byte order doesn't matter when counting
+            __m256i isAir = _mm256_packs_epi16(_mm256_cmpeq_epi16(a, zero), _mm256_cmpeq_epi16(b, zero));
+            air += std::popcount(static_cast<glm::u32>(_mm256_movemask_epi8(isAir)));
+        }
+        return i - air + CountNonAirScalar(voxels + i, count - i);
+    }
+
+    SPIRE_TARGET_AVX2 static bool AllEqualAVX2(const VoxelType *voxels, std::size_t count, VoxelType type) {
+        const __m256i value = _mm256_set1_epi16(static_cast<short>(type));
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(voxels + i));
+            if (static_cast<glm::u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, value))) != 0xFFFFFFFF) return false;
+        }
+        return AllEqualScalar(voxels + i, count - i, type);
+    }
+
+    SPIRE_TARGET_AVX2 static bool EqualAVX2(const VoxelType *a, const VoxelType *b, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            if (static_cast<glm::u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb))) != 0xFFFFFFFF) return false;
+        }
+        return EqualScalar(a + i, b + i, count - i);
+    }
+
+    static constexpr VoxelKernelTable AVX2_KERNELS = {
+        VoxelKernels::InstructionSet::AVX2, PackPresenceBitsAVX2, FillAVX2, CountNonAirAVX2, AllEqualAVX2, EqualAVX2
+    };
+
+    static bool CpuSupportsAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        // the OS must save the AVX registers
+        __cpuid(info, 1);
+        bool osxsave = info[2] & (1 << 27);
+        bool avx = info[2] & (1 << 28);
+        if (!osxsave || !avx || (_xgetbv(0) & 0b110) != 0b110) return false;
+
+        __cpuidex(info, 7, 0);
+        return info[1] & (1 << 5);
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+#ifdef SPIRE_VOXEL_KERNELS_NEON
+    // NEON, always available on arm64
+
+    static void PackPresenceBitsNEON(const VoxelType *voxels, glm::u64 *bits, std::size_t count) {
+        static constexpr std::array<std::uint8_t, 8> BIT_WEIGHTS = {1, 2, 4, 8, 16, 32, 64, 128};
+        const uint8x8_t weights = vld1_u8(BIT_WEIGHTS.data());
+        for (std::size_t wordIndex = 0; wordIndex < count / 64; wordIndex++) {
+            const VoxelType *row = voxels + wordIndex * 64;
+            glm::u64 word = 0;
+            for (glm::u32 i = 0; i < 8; i++) {
+                uint16x8_t v = vld1q_u16(row + i * 8);
+                uint8x8_t present = vmovn_u16(vtstq_u16(v, v));
+                word |= static_cast<glm::u64>(vaddv_u8(vand_u8(present, weights))) << (i * 8);
+            }
+            bits[wordIndex] = word;
+        }
+    }
+
+    static void FillNEON(VoxelType *voxels, std::size_t count, VoxelType type) {
+        const uint16x8_t value = vdupq_n_u16(type);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            vst1q_u16(voxels + i, value);
+        }
+        FillScalar(voxels + i, count - i, type);
+    }
+
+    static std::size_t CountNonAirNEON(const VoxelType *voxels, std::size_t count) {
+        std::size_t nonAir = 0;
+        std::size_t i = 0;
+        while (i + 8 <= count) {
+            // flush the u16 accumulators before they can overflow
+            uint16x8_t accumulator = vdupq_n_u16(0);
+            for (glm::u32 iteration = 0; iteration < 8192 && i + 8 <= count; iteration++, i += 8) {
+                uint16x8_t v = vld1q_u16(voxels + i);
+                accumulator = vaddq_u16(accumulator, vshrq_n_u16(vtstq_u16(v, v), 15));
+            }
+            nonAir += vaddlvq_u16(accumulator);
+        }
+        return nonAir + CountNonAirScalar(voxels + i, count - i);
+    }
+
+    static bool AllEqualNEON(const VoxelType *voxels, std::size_t count, VoxelType type) {
+        const uint16x8_t value = vdupq_n_u16(type);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            if (vminvq_u16(vceqq_u16(vld1q_u16(voxels + i), value)) != 0xFFFF) return false;
+        }
+        return AllEqualScalar(voxels + i, count - i, type);
+    }
+
+    static bool EqualNEON(const VoxelType *a, const VoxelType *b, std::size_t count) {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            if (vminvq_u16(vceqq_u16(vld1q_u16(a + i), vld1q_u16(b + i))) != 0xFFFF) return false;
+        }
+        return EqualScalar(a + i, b + i, count - i);
+    }
+
+    static constexpr VoxelKernelTable NEON_KERNELS = {
+        VoxelKernels::InstructionSet::NEON, PackPresenceBitsNEON, FillNEON, CountNonAirNEON, AllEqualNEON, EqualNEON
+    };
+#endif
+
+    static const VoxelKernelTable *GetKernelTable(VoxelKernels::InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case VoxelKernels::InstructionSet::SCALAR:
+                return &SCALAR_KERNELS;
+#ifdef SPIRE_VOXEL_KERNELS_X86
+            case VoxelKernels::InstructionSet::SSE2:
+                return &SSE2_KERNELS;
+            case VoxelKernels::InstructionSet::AVX2:
+                return CpuSupportsAVX2() ? &AVX2_KERNELS : nullptr;
+#endif
+#ifdef SPIRE_VOXEL_KERNELS_NEON
+            case VoxelKernels::InstructionSet::NEON:
+                return &NEON_KERNELS;
+#endif
+            default:
+                return nullptr;
+        }
+    }
+
+    static const VoxelKernelTable *SelectBestKernelTable() {
+        for (auto instructionSet : {VoxelKernels::InstructionSet::AVX2, VoxelKernels::InstructionSet::SSE2, VoxelKernels::InstructionSet::NEON}) {
+            if (const VoxelKernelTable *table = GetKernelTable(instructionSet)) {
+                return table;
+            }
+        }
+        return &SCALAR_KERNELS;
+    }
+
+    static std::atomic<const VoxelKernelTable *> &ActiveKernels() {
+        static std::atomic<const VoxelKernelTable *> kernels = SelectBestKernelTable();
+        return kernels;
+    }
+
+    static const VoxelKernelTable &Kernels() {
+        return *ActiveKernels().load(std::memory_order_relaxed);
+    }
+
+    void VoxelKernels::PackPresenceBits(const VoxelType *voxels, glm::u64 *bits, std::size_t count) {
+        assert(count % 64 == 0);
+        Kernels().PackPresenceBits(voxels, bits, count);
+    }
+
+    void VoxelKernels::SetBitSpan(glm::u64 *bits, std::size_t startIndex, std::size_t endIndex, bool value) {
+        assert(startIndex <= endIndex);
+        if (startIndex == endIndex) return;
+
+        // whole words are filled, only the first and last words need masking
+        std::size_t firstWord = startIndex / 64;
+        std::size_t lastWord = (endIndex - 1) / 64;
+        glm::u64 firstMask = ~glm::u64(0) << (startIndex % 64);
+        glm::u64 lastMask = ~glm::u64(0) >> (63 - (endIndex - 1) % 64);
+
+        if (firstWord == lastWord) {
+            glm::u64 mask = firstMask & lastMask;
+            bits[firstWord] = value ? bits[firstWord] | mask : bits[firstWord] & ~mask;
+            return;
+        }
+
+        bits[firstWord] = value ? bits[firstWord] | firstMask : bits[firstWord] & ~firstMask;
+        std::fill(bits + firstWord + 1, bits + lastWord, value ? ~glm::u64(0) : glm::u64(0));
+        bits[lastWord] = value ? bits[lastWord] | lastMask : bits[lastWord] & ~lastMask;
+    }
+
+    void VoxelKernels::Fill(VoxelType *voxels, std::size_t count, VoxelType type) {
+        Kernels().Fill(voxels, count, type);
+    }
+
+    std::size_t VoxelKernels::CountNonAir(const VoxelType *voxels, std::size_t count) {
+        return Kernels().CountNonAir(voxels, count);
+    }
+
+    bool VoxelKernels::AllEqual(const VoxelType *voxels, std::size_t count, VoxelType type) {
+        return Kernels().AllEqual(voxels, count, type);
+    }
+
+    bool VoxelKernels::Equal(const VoxelType *a, const VoxelType *b, std::size_t count) {
+        return Kernels().Equal(a, b, count);
+    }
+
+    VoxelKernels::InstructionSet VoxelKernels::GetInstructionSet() {
+        return Kernels().InstructionSet;
+    }
+
+    bool VoxelKernels::IsSupported(InstructionSet instructionSet) {
+        return GetKernelTable(instructionSet) != nullptr;
+    }
+
+    bool VoxelKernels::SetInstructionSet(InstructionSet instructionSet) {
+        const VoxelKernelTable *table = GetKernelTable(instructionSet);
+        if (!table) return false;
+        ActiveKernels().store(table, std::memory_order_relaxed);
+        return true;
+    }
+
+    const char *VoxelKernels::ToString(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::SCALAR:
+                return "Scalar";
+            case InstructionSet::SSE2:
+                return "SSE2";
+            case InstructionSet::AVX2:
+                return "AVX2";
+            case InstructionSet::NEON:
+                return "NEON";
+            default:
+                assert(false);
+                return "Unknown";
+        }
+    }
+} // SpireVoxel
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "VoxelType.h"
+
+namespace SpireVoxel {
+    // Bulk operations on voxel data
+    // Each kernel has an AVX2, SSE2, NEON and scalar implementation, the best one supported by the CPU is picked at runtime
+    // Pointers don't need to be aligned
+    class VoxelKernels {
+    public:
+        VoxelKernels() = delete;
+
+        enum class InstructionSet {
+            SCALAR,
+            SSE2,
+            AVX2,
+            NEON
+        };
+
+    public:
+        // Write a presence bit for each voxel, bit i of bits is set if voxels[i] isn't air
+        // count must be a multiple of 64, bits must have space for count / 64 words
+        static void PackPresenceBits(const VoxelType *voxels, glm::u64 *bits, std::size_t count);
+
+        // Set or clear bits [startIndex, endIndex)
+        static void SetBitSpan(glm::u64 *bits, std::size_t startIndex, std::size_t endIndex, bool value);
+
+        static void Fill(VoxelType *voxels, std::size_t count, VoxelType type);
+
+        [[nodiscard]] static std::size_t CountNonAir(const VoxelType *voxels, std::size_t count);
+
+        // true if every voxel is type
+        [[nodiscard]] static bool AllEqual(const VoxelType *voxels, std::size_t count, VoxelType type);
+
+        // true if a and b contain the same voxels
+        [[nodiscard]] static bool Equal(const VoxelType *a, const VoxelType *b, std::size_t count);
+
+        // Instruction set used by the kernels
+        [[nodiscard]] static InstructionSet GetInstructionSet();
+
+        [[nodiscard]] static bool IsSupported(InstructionSet instructionSet);
+
+        // Force an instruction set, intended for testing and profiling
+        // Returns false and changes nothing if the CPU doesn't support it
+        static bool SetInstructionSet(InstructionSet instructionSet);
+
+        [[nodiscard]] static const char *ToString(InstructionSet instructionSet);
+    };
+} // SpireVoxel
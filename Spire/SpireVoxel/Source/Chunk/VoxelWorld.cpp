@@ -1,6 +1,8 @@
 #include "VoxelWorld.h"
 #include "Rendering/VoxelWorldRenderer.h"
 #include "LOD/SamplingOffsets.h"
+#include "Edits/EditQueue.h"
+#include "WorldTickVoxels.h"
 
 namespace SpireVoxel {
     VoxelWorld::VoxelWorld(
@@ -12,13 +14,22 @@ namespace SpireVoxel {
         IVoxelCamera &camera,
         Settings settings
     )
-        : m_engine(engine),
+        : m_ownerThread(std::this_thread::get_id()),
+          m_engine(engine),
           m_settings(settings) {
+        // subsystems register their work with the scheduler when they are created
+        m_frameScheduler = std::make_unique<FrameBudgetScheduler>(FrameBudgetScheduler::Settings{.BudgetMillis = settings.MaintenanceBudgetMillis});
         m_renderer = std::make_unique<VoxelWorldRenderer>(*this, engine.GetRenderingManager(), recreatePipelineCallback, camera, settings);
         m_proceduralGenerationManager = std::make_unique<ProceduralGenerationManager>(std::move(provider), std::move(controller), *this, camera);
         m_lodManager = std::unique_ptr<LODManager>(new LODManager(*this, samplingOffsets));
+        m_residencyManager = std::make_unique<ChunkResidencyManager>(*this, camera, settings.Residency);
+        m_editQueue = std::make_unique<EditQueue>();
+        m_tickVoxels = std::make_unique<WorldTickVoxels>(*this);
+        m_tickSystem = std::make_unique<ChunkTickSystem>(*m_tickVoxels, settings.Ticking);
     }
 
+    VoxelWorld::~VoxelWorld() = default;
+
     LODManager &VoxelWorld::GetLODManager() const {
         return *m_lodManager;
     }
@@ -27,25 +38,43 @@ namespace SpireVoxel {
         return *m_proceduralGenerationManager;
     }
 
+    ChunkResidencyManager &VoxelWorld::GetResidencyManager() const {
+        return *m_residencyManager;
+    }
+
+    EditQueue &VoxelWorld::GetEditQueue() const {
+        return *m_editQueue;
+    }
+
+    FrameBudgetScheduler &VoxelWorld::GetFrameScheduler() const {
+        return *m_frameScheduler;
+    }
+
+    ChunkTickSystem &VoxelWorld::GetTickSystem() const {
+        assert(IsOwnerThread());
+        return *m_tickSystem;
+    }
+
     Chunk &VoxelWorld::LoadChunk(glm::ivec3 chunkPosition) {
-        auto it = m_chunks.find(chunkPosition);
-        if (it != m_chunks.end()) return *it->second;
+        Chunk *loaded = TryGetLoadedChunk(chunkPosition);
+        if (loaded) return *loaded;
 
-        m_chunks.try_emplace(chunkPosition, std::make_unique<Chunk>(chunkPosition, *this));
+        assert(IsOwnerThread()); // only the owner thread can add chunks
+        auto [chunk, _] = m_chunks.TryEmplace(chunkPosition, [&] { return CreateChunk(chunkPosition); });
         m_renderer->NotifyChunkLoadedOrUnloaded();
-        return *m_chunks.find(chunkPosition)->second;
+        return *chunk;
     }
 
     void VoxelWorld::LoadChunks(const std::vector<glm::ivec3> &chunkPositions) {
+        assert(IsOwnerThread());
         bool loadedAnyChunks = false;
 
         for (auto chunkPosition : chunkPositions) {
             if (m_lodManager->TryGetLODChunk(chunkPosition)) continue;
-            if (m_chunks.size() + 1 > VoxelWorldRenderer::MAXIMUM_LOADED_CHUNKS) break;
-            m_chunks.try_emplace(chunkPosition, new Chunk(chunkPosition, *this)); // this constructs a unique ptr
-            auto &chunk = m_chunks.at(chunkPosition);
+            if (m_chunks.Size() + 1 > VoxelWorldRenderer::MAXIMUM_LOADED_CHUNKS) break;
+            auto [chunk, inserted] = m_chunks.TryEmplace(chunkPosition, [&] { return CreateChunk(chunkPosition); });
             assert(!chunk->IsCorrupted());
-            loadedAnyChunks = true;
+            loadedAnyChunks |= inserted;
         }
 
         if (loadedAnyChunks) {
@@ -54,13 +83,30 @@ namespace SpireVoxel {
     }
 
     void VoxelWorld::UnloadChunks(const std::vector<glm::ivec3> &chunkPositions) {
+        assert(IsOwnerThread());
         bool unloadedAnyChunks = false;
         for (auto chunkPosition : chunkPositions) {
-            auto it = m_chunks.find(chunkPosition);
-            if (it == m_chunks.end()) continue;
-            m_lodManager->OnChunkUnload(*it->second);
-            m_renderer->FreeChunkBuffers(*it->second);
-            m_chunks.erase(it);
+            Chunk *chunk = TryGetLoadedChunk(chunkPosition);
+            if (!chunk) continue;
+
+            // the generation and mesh tasks hold pointers to the chunk
+            m_proceduralGenerationManager->WaitForGeneration(chunkPosition);
+            m_renderer->WaitForMeshing(*chunk);
+            // mesh tasks of the neighbours read this chunk's voxels for faces and AO
+            for (glm::i32 x = -1; x <= 1; x++) {
+                for (glm::i32 y = -1; y <= 1; y++) {
+                    for (glm::i32 z = -1; z <= 1; z++) {
+                        if (x == 0 && y == 0 && z == 0) continue;
+                        Chunk *neighbour = TryGetLoadedChunk(chunkPosition + glm::ivec3(x, y, z));
+                        if (neighbour) m_renderer->WaitForMeshing(*neighbour);
+                    }
+                }
+            }
+
+            m_lodManager->OnChunkUnload(*chunk);
+            m_renderer->FreeChunkBuffers(*chunk);
+            m_chunkSlots.Remove(chunk->Handle); // invalidates handles to the chunk
+            m_chunks.Extract(chunkPosition); // destroys the chunk outside the shard lock
             unloadedAnyChunks = true;
         }
 
@@ -69,14 +115,50 @@ namespace SpireVoxel {
         }
     }
 
+    Chunk &VoxelWorld::CloneChunk(const Chunk &source, glm::ivec3 destination) {
+        assert(source.ChunkPosition != destination);
+        Chunk &chunk = LoadChunk(destination);
+        chunk.ShareVoxelsFrom(source);
+
+        m_renderer->NotifyChunkEdited(chunk);
+        for (glm::u32 face = 0; face < SPIRE_VOXEL_NUM_FACES; face++) {
+            Chunk *adjacent = TryGetLoadedChunk(destination + FaceToDirection(face));
+            if (adjacent) m_renderer->NotifyChunkEdited(*adjacent);
+        }
+        return chunk;
+    }
+
+    void VoxelWorld::CloneChunks(const std::vector<glm::ivec3> &sourcePositions, glm::ivec3 offset) {
+        if (offset == glm::ivec3(0)) return;
+
+        for (glm::ivec3 sourcePosition : sourcePositions) {
+            const Chunk *source = TryGetLoadedChunk(sourcePosition);
+            if (!source) continue;
+            if (m_chunks.Size() + 1 > VoxelWorldRenderer::MAXIMUM_LOADED_CHUNKS) {
+                Spire::warn("Stopped cloning chunks because the maximum number of chunks are loaded");
+                break;
+            }
+            CloneChunk(*source, sourcePosition + offset);
+        }
+    }
+
     Chunk *VoxelWorld::TryGetLoadedChunk(glm::ivec3 chunkPosition) {
-        auto it = m_chunks.find(chunkPosition);
-        return it != m_chunks.end() ? it->second.get() : nullptr;
+        return m_chunks.Visit(chunkPosition, static_cast<Chunk *>(nullptr), [](const std::unique_ptr<Chunk> &chunk) { return chunk.get(); });
     }
 
     const Chunk *VoxelWorld::TryGetLoadedChunk(glm::ivec3 chunkPosition) const {
-        auto it = m_chunks.find(chunkPosition);
-        return it != m_chunks.end() ? it->second.get() : nullptr;
+        return m_chunks.Visit(chunkPosition, static_cast<const Chunk *>(nullptr), [](const std::unique_ptr<Chunk> &chunk) { return chunk.get(); });
+    }
+
+    Chunk *VoxelWorld::TryGetChunk(ChunkHandle handle) const {
+        assert(IsOwnerThread());
+        Chunk *const *chunk = m_chunkSlots.TryGet(handle);
+        return chunk ? *chunk : nullptr;
+    }
+
+    std::size_t VoxelWorld::NumChunkSlots() const {
+        assert(IsOwnerThread());
+        return m_chunkSlots.NumSlots();
     }
 
     bool VoxelWorld::IsLoaded(const Chunk &chunk) {
@@ -87,14 +169,15 @@ namespace SpireVoxel {
     }
 
     std::size_t VoxelWorld::NumLoadedChunks() const {
-        return m_chunks.size();
+        return m_chunks.Size();
     }
 
-    std::unordered_map<glm::ivec3, std::unique_ptr<Chunk> >::iterator VoxelWorld::begin() {
+    VoxelWorld::ChunkMap::Iterator VoxelWorld::begin() {
+        assert(IsOwnerThread());
         return m_chunks.begin();
     }
 
-    std::unordered_map<glm::ivec3, std::unique_ptr<Chunk> >::iterator VoxelWorld::end() {
+    VoxelWorld::ChunkMap::Iterator VoxelWorld::end() {
         return m_chunks.end();
     }
 
@@ -108,6 +191,14 @@ namespace SpireVoxel {
         UnloadChunks(loadedChunks);
     }
 
+    bool VoxelWorld::IsOwnerThread() const {
+        return std::this_thread::get_id() == m_ownerThread.load(std::memory_order_relaxed);
+    }
+
+    void VoxelWorld::SetOwnerThread(std::thread::id ownerThread) {
+        m_ownerThread.store(ownerThread, std::memory_order_relaxed);
+    }
+
     VoxelWorldRenderer &VoxelWorld::GetRenderer() const {
         return *m_renderer;
     }
@@ -118,13 +209,27 @@ namespace SpireVoxel {
     }
 
     glm::u64 VoxelWorld::CalculateCPUMemoryUsageForChunks() const {
-        glm::u64 usage = 0;
+        glm::u64 usage = CalculateChunkMetadataMemoryUsage();
+        std::unordered_set<const void *> countedStorage;
         for (auto &pair : m_chunks) {
-            usage += sizeof(*pair.second);
+            const ChunkVoxelStorage &storage = pair.second->GetVoxelStorage();
+            if (countedStorage.insert(storage.GetDataIdentity()).second) {
+                usage += storage.GetMemoryUsage();
+            }
         }
         return usage;
     }
 
+    glm::u64 VoxelWorld::CalculateChunkMetadataMemoryUsage() const {
+        assert(IsOwnerThread());
+        return m_chunks.Size() * sizeof(Chunk) +
+               m_chunks.CalculateMemoryUsage() +
+               m_chunkSlots.CalculateMemoryUsage() +
+               m_lodManager->CalculateMemoryUsage() +
+               m_tickSystem->CalculateMemoryUsage() +
+               m_renderer->CalculateCPUMemoryUsage();
+    }
+
     bool VoxelWorld::IsVoxelAt(glm::ivec3 worldPosition) const {
         return GetVoxelAt(worldPosition) != VOXEL_TYPE_AIR;
     }
@@ -134,7 +239,7 @@ namespace SpireVoxel {
         glm::ivec3 positionInChunk = worldPosition - chunkPos * SPIRE_VOXEL_CHUNK_SIZE;
 
         const Chunk *chunk = TryGetLoadedChunk(chunkPos);
-        return chunk ? chunk->VoxelData[SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk)] : VOXEL_TYPE_AIR;
+        return chunk ? chunk->GetVoxel(SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk)) : VOXEL_TYPE_AIR;
     }
 
     bool VoxelWorld::TrySetVoxelAt(glm::ivec3 worldPosition, VoxelType voxelType) {
@@ -176,7 +281,21 @@ namespace SpireVoxel {
         return m_settings;
     }
 
-    void VoxelWorld::Update() const {
+    std::unique_ptr<Chunk> VoxelWorld::CreateChunk(glm::ivec3 chunkPosition) {
+        auto chunk = std::make_unique<Chunk>(chunkPosition, *this);
+        // set before the chunk is added to the table so other threads never see it without a handle
+        chunk->Handle = m_chunkSlots.Insert(chunk.get());
+        return chunk;
+    }
+
+    void VoxelWorld::Update() {
+        m_frameScheduler->BeginFrame();
+        // before generation starts new tasks so nothing else is using the chunks
+        m_residencyManager->Update();
+        m_editQueue->Update(*this);
+        // before generation starts new tasks, chunks that are already generating aren't ticked
+        m_tickSystem->Update();
         m_proceduralGenerationManager->Update();
+        m_chunkMetadataMemory.Set(CalculateChunkMetadataMemoryUsage());
     }
 } // SpireVoxel
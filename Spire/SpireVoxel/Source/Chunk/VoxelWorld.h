@@ -1,26 +1,52 @@
 #pragma once
 
 #include "EngineIncludes.h"
+#include "ChunkResidencyManager.h"
+#include "ChunkTickSystem.h"
 #include "VoxelType.h"
 #include "Generation/ProceduralGenerationManager.h"
 #include "LOD/ISamplingOffsets.h"
 #include "LOD/LODManager.h"
+#include "Utils/FrameBudgetScheduler.h"
+#include "Utils/ShardedMap.h"
+#include "Utils/SlotMap.h"
 
 namespace SpireVoxel {
     class VoxelWorldRenderer;
+    class EditQueue;
+    class WorldTickVoxels;
 }
 
 namespace SpireVoxel {
     struct Chunk;
+    using ChunkHandle = SlotMapHandle;
 
+    // Threading rules (see VOXELS.md):
+    // - Chunks are only loaded, unloaded or cloned on the thread that created the world
+    // - Any thread may look up loaded chunks (TryGetLoadedChunk), lookups only take a shared lock on one shard of the chunk table
+    // - Chunk pointers stay valid until the chunk is unloaded, unloading waits for the chunk to finish generating
+    // - Voxel reads/writes on a chunk are ordered by its version (see Chunk::BeginRead)
     class VoxelWorld {
         friend class VoxelRenderer;
 
+    public:
+        using ChunkMap = ShardedMap<glm::ivec3, std::unique_ptr<Chunk> >;
+
     public:
         struct Settings {
             bool LoadBalanceMeshing;
             bool AllowFrustumCulling;
             bool AllowBackfaceCulling;
+            ChunkResidencyManager::Settings Residency = {};
+            // Chunks being meshed at once, 0 is twice the number of threads (only used if LoadBalanceMeshing)
+            glm::u32 MaxMeshesInFlight = 0;
+            // Stop submitting chunks to mesh while finished meshes waiting to be uploaded use more than this
+            glm::u64 MaxPendingMeshBytes = 64 * 1024 * 1024;
+            // Mesh data uploaded each frame, at least one mesh is always uploaded (only used if LoadBalanceMeshing)
+            glm::u64 MaxMeshUploadBytesPerFrame = 16 * 1024 * 1024;
+            // Time each frame the owner thread spends on mesh uploads, compression and starting generation, see FrameBudgetScheduler
+            float MaintenanceBudgetMillis = 4.0f;
+            ChunkTickSystem::Settings Ticking = {};
         };
 
     public:
@@ -34,6 +60,8 @@ namespace SpireVoxel {
             Settings settings
         );
 
+        ~VoxelWorld();
+
     public:
         // Handles level of detail for the world
         [[nodiscard]] LODManager &GetLODManager() const;
@@ -41,36 +69,75 @@ namespace SpireVoxel {
         // Handles what chunks to generate/load
         [[nodiscard]] ProceduralGenerationManager &GetProceduralGenerationManager() const;
 
+        // Compresses chunks that aren't being used
+        [[nodiscard]] ChunkResidencyManager &GetResidencyManager() const;
+
+        // Edits submitted from any thread, applied at the start of each frame
+        [[nodiscard]] EditQueue &GetEditQueue() const;
+
+        // Shares the owner thread's per frame time between world maintenance work, the budget is reset by Update
+        [[nodiscard]] FrameBudgetScheduler &GetFrameScheduler() const;
+
+        // Per voxel simulation, register callbacks here, ticked by Update, owner thread only
+        [[nodiscard]] ChunkTickSystem &GetTickSystem() const;
+
+        // Returns the chunk if it is already loaded (thread safe), otherwise loads it (owner thread only)
         [[nodiscard]] Chunk &LoadChunk(glm::ivec3 chunkPosition);
 
+        // Owner thread only
         void LoadChunks(const std::vector<glm::ivec3> &chunkPositions);
 
+        // Owner thread only, waits for the chunks to finish generating first
         void UnloadChunks(const std::vector<glm::ivec3> &chunkPositions);
 
-        // Get chunk if loaded
+        // Load a chunk at destination that shares the voxels of source
+        // The voxels are only copied when either chunk is edited
+        Chunk &CloneChunk(const Chunk &source, glm::ivec3 destination);
+
+        // Clone each loaded chunk in sourcePositions to sourcePosition + offset (in chunk coordinates)
+        void CloneChunks(const std::vector<glm::ivec3> &sourcePositions, glm::ivec3 offset);
+
+        // Get chunk if loaded, thread safe
         // Use LODManager if using LODs
         [[nodiscard]] Chunk *TryGetLoadedChunk(glm::ivec3 chunkPosition);
 
         [[nodiscard]] const Chunk *TryGetLoadedChunk(glm::ivec3 chunkPosition) const;
 
+        // Get a chunk by handle in O(1), nullptr if the chunk has been unloaded, owner thread only
+        [[nodiscard]] Chunk *TryGetChunk(ChunkHandle handle) const;
+
+        // One past the highest chunk handle index in use (or used before), owner thread only
+        [[nodiscard]] std::size_t NumChunkSlots() const;
+
         [[nodiscard]] bool IsLoaded(const Chunk &chunk);
 
         [[nodiscard]] std::size_t NumLoadedChunks() const;
 
-        // Iterate over all loaded chunks
-        std::unordered_map<glm::ivec3, std::unique_ptr<Chunk> >::iterator begin();
+        // Iterate over all loaded chunks, owner thread only
+        ChunkMap::Iterator begin();
 
-        std::unordered_map<glm::ivec3, std::unique_ptr<Chunk> >::iterator end();
+        ChunkMap::Iterator end();
 
         void UnloadAllChunks();
 
+        // true if called from the thread that owns the chunk table (the thread that created the world unless it was handed over)
+        [[nodiscard]] bool IsOwnerThread() const;
+
+        // Hand the world to another thread, e.g. a simulation thread, the caller must make sure the old owner has stopped using it first
+        void SetOwnerThread(std::thread::id ownerThread);
+
         [[nodiscard]] VoxelWorldRenderer &GetRenderer() const;
 
         // Approx calculate memory usage, only considers the big stuff
+        // See Spire::MemoryAccounting for the process wide usage of every allocator
         [[nodiscard]] glm::u64 CalculateGPUMemoryUsageForChunks() const;
 
+        // Voxel storage (shared storage is only counted once) plus CalculateChunkMetadataMemoryUsage, owner thread only
         [[nodiscard]] glm::u64 CalculateCPUMemoryUsageForChunks() const;
 
+        // Chunk objects and the tables that track them (chunk table, handles, LOD, active chunks, edited chunks, chunk data cache), owner thread only
+        [[nodiscard]] glm::u64 CalculateChunkMetadataMemoryUsage() const;
+
         // returns true if a voxel is present at the world position
         // returns false if the voxel is air or the chunk is not loaded
         [[nodiscard]] bool IsVoxelAt(glm::ivec3 worldPosition) const;
@@ -94,15 +161,25 @@ namespace SpireVoxel {
         [[nodiscard]] Settings GetSettings() const;
 
     private:
-        void Update() const;
+        void Update();
+
+        [[nodiscard]] std::unique_ptr<Chunk> CreateChunk(glm::ivec3 chunkPosition);
 
     private:
-        // https://en.cppreference.com/w/cpp/container/unordered_map.html - always iterates in the same order if the map hasnt been changed
-        std::unordered_map<glm::ivec3, std::unique_ptr<Chunk> > m_chunks;
+        // always iterates in the same order if the map hasnt been changed
+        ChunkMap m_chunks;
+        SlotMap<Chunk *> m_chunkSlots; // owner thread only
+        std::atomic<std::thread::id> m_ownerThread;
         std::unique_ptr<VoxelWorldRenderer> m_renderer;
         std::unique_ptr<ProceduralGenerationManager> m_proceduralGenerationManager;
         Spire::Engine &m_engine;
         std::unique_ptr<LODManager> m_lodManager;
+        std::unique_ptr<ChunkResidencyManager> m_residencyManager;
+        std::unique_ptr<EditQueue> m_editQueue;
+        std::unique_ptr<FrameBudgetScheduler> m_frameScheduler;
+        std::unique_ptr<WorldTickVoxels> m_tickVoxels;
+        std::unique_ptr<ChunkTickSystem> m_tickSystem;
         Settings m_settings;
+        mutable Spire::MemoryCounter m_chunkMetadataMemory{Spire::MemoryCategory::ChunkMetadata}; // recalculated every Update
     };
 } // SpireVoxel
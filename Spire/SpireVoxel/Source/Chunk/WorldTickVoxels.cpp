@@ -0,0 +1,50 @@
+#include "WorldTickVoxels.h"
+
+#include "Chunk.h"
+#include "VoxelWorld.h"
+#include "Edits/IVoxelEdit.h"
+#include "Rendering/VoxelWorldRenderer.h"
+
+namespace SpireVoxel {
+    WorldTickVoxels::WorldTickVoxels(VoxelWorld &world) : m_world(world) {
+    }
+
+    ITickVoxels::ChunkState WorldTickVoxels::GetChunkState(glm::ivec3 chunkPosition) const {
+        assert(m_world.IsOwnerThread());
+        const Chunk *chunk = m_world.TryGetLoadedChunk(chunkPosition);
+        // a LOD chunk's voxels are a sample of several chunks, simulating them would be wrong
+        if (!chunk || chunk->LOD.Scale != 1) return ChunkState::UNAVAILABLE;
+        if (m_world.GetProceduralGenerationManager().IsGenerating(chunkPosition)) return ChunkState::NOT_READY;
+        return ChunkState::READY;
+    }
+
+    const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &WorldTickVoxels::ReadVoxels(glm::ivec3 chunkPosition) const {
+        const Chunk &chunk = GetChunk(chunkPosition);
+        chunk.Touch();
+        return chunk.GetVoxelData();
+    }
+
+    VoxelType WorldTickVoxels::GetVoxel(glm::ivec3 chunkPosition, glm::u32 index) const {
+        return GetChunk(chunkPosition).GetVoxel(index);
+    }
+
+    void WorldTickVoxels::SetVoxel(glm::ivec3 chunkPosition, glm::u32 index, VoxelType type) {
+        Chunk &chunk = GetChunk(chunkPosition);
+        glm::u32 changedNeighbours = IVoxelEdit::GetChangedNeighbours(chunk.GetVoxelData(), index, index + 1, type);
+        if (changedNeighbours == 0) return;
+        chunk.SetVoxel(index, type);
+
+        // this runs for every voxel a tick writes, so the mask is walked directly instead of collecting a set of chunks
+        for (glm::u32 bits = changedNeighbours; bits != 0; bits &= bits - 1) {
+            glm::ivec3 affectedChunkPosition = chunkPosition + IVoxelEdit::GetNeighbourOffset(static_cast<glm::u32>(std::countr_zero(bits)));
+            if (const Chunk *affected = m_world.TryGetLoadedChunk(affectedChunkPosition)) m_world.GetRenderer().NotifyChunkEdited(*affected);
+        }
+    }
+
+    Chunk &WorldTickVoxels::GetChunk(glm::ivec3 chunkPosition) const {
+        Chunk *chunk = m_world.TryGetLoadedChunk(chunkPosition);
+        // ready chunks can't be unloaded during a tick
+        assert(chunk);
+        return *chunk;
+    }
+} // SpireVoxel
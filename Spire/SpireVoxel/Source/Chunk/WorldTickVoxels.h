@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ChunkTickSystem.h"
+
+namespace SpireVoxel {
+    class VoxelWorld;
+    struct Chunk;
+
+    // ChunkTickSystem's view of a VoxelWorld, only full detail chunks that have finished generating are ticked
+    class WorldTickVoxels : public ITickVoxels {
+    public:
+        explicit WorldTickVoxels(VoxelWorld &world);
+
+    public:
+        [[nodiscard]] ChunkState GetChunkState(glm::ivec3 chunkPosition) const override;
+
+        [[nodiscard]] const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &ReadVoxels(glm::ivec3 chunkPosition) const override;
+
+        [[nodiscard]] VoxelType GetVoxel(glm::ivec3 chunkPosition, glm::u32 index) const override;
+
+        // Notifies the renderer for the chunk and any neighbours whose mesh the voxel touches
+        void SetVoxel(glm::ivec3 chunkPosition, glm::u32 index, VoxelType type) override;
+
+    private:
+        [[nodiscard]] Chunk &GetChunk(glm::ivec3 chunkPosition) const;
+
+    private:
+        VoxelWorld &m_world;
+    };
+} // SpireVoxel
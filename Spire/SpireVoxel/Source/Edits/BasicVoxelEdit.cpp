@@ -13,6 +13,7 @@ namespace SpireVoxel {
     }
 
     void BasicVoxelEdit::Apply(VoxelWorld &world) {
+        std::unordered_set<glm::ivec3> affectedChunks;
         for (const auto &edit : m_edits) {
             Chunk *chunk = world.TryGetLoadedChunk(world.GetChunkPositionOfVoxel(edit.Position));
             if (!chunk) {
@@ -23,8 +24,43 @@ namespace SpireVoxel {
 
             std::optional<std::size_t> index = Chunk::GetIndexOfVoxel(chunk->ChunkPosition, edit.Position);
             assert(index);
+            glm::u32 changedNeighbours = GetChangedNeighbours(chunk->GetVoxelData(), index.value(), index.value() + 1, edit.Type);
+            if (changedNeighbours == 0) continue;
             chunk->SetVoxel(index.value(), edit.Type);
-            NotifyChunkEdit(world, *chunk);
+            AddAffectedChunks(chunk->ChunkPosition, changedNeighbours, affectedChunks);
         }
+
+        NotifyChunkEdits(world, affectedChunks);
+    }
+
+    std::optional<std::vector<glm::ivec3> > BasicVoxelEdit::GetWrittenChunks() const {
+        std::unordered_set<glm::ivec3> chunks;
+        for (const auto &edit : m_edits) {
+            chunks.insert(VoxelWorld::GetChunkPositionOfVoxel(edit.Position));
+        }
+        return std::vector<glm::ivec3>(chunks.begin(), chunks.end());
+    }
+
+    void BasicVoxelEdit::Record(std::ostream &stream) const {
+        auto numEdits = static_cast<std::uint32_t>(m_edits.size());
+        stream.write(reinterpret_cast<const char *>(&numEdits), sizeof(numEdits));
+        for (const Edit &edit : m_edits) {
+            stream.write(reinterpret_cast<const char *>(&edit.Position), sizeof(edit.Position));
+            stream.write(reinterpret_cast<const char *>(&edit.Type), sizeof(edit.Type));
+        }
+    }
+
+    std::optional<BasicVoxelEdit> BasicVoxelEdit::ReadRecord(std::istream &stream) {
+        std::uint32_t numEdits{};
+        if (!stream.read(reinterpret_cast<char *>(&numEdits), sizeof(numEdits))) return std::nullopt;
+
+        std::vector<Edit> edits;
+        for (std::uint32_t i = 0; i < numEdits && stream; i++) {
+            Edit &edit = edits.emplace_back();
+            stream.read(reinterpret_cast<char *>(&edit.Position), sizeof(edit.Position));
+            stream.read(reinterpret_cast<char *>(&edit.Type), sizeof(edit.Type));
+        }
+        if (!stream) return std::nullopt;
+        return BasicVoxelEdit(edits);
     }
 } // SpireVoxel
@@ -22,6 +22,15 @@ namespace SpireVoxel {
     public:
         void Apply(VoxelWorld &world) override;
 
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+        [[nodiscard]] RecordedType GetRecordedType() const override { return RecordedType::BASIC; }
+
+        void Record(std::ostream &stream) const override;
+
+        // Recreate an edit written by Record, nullopt if the stream doesn't hold one
+        [[nodiscard]] static std::optional<BasicVoxelEdit> ReadRecord(std::istream &stream);
+
     private:
         std::vector<Edit> m_edits;
     };
@@ -0,0 +1,108 @@
+#include "BatchedVoxelEdit.h"
+
+namespace SpireVoxel {
+    BatchedVoxelEdit::BatchedVoxelEdit(const std::vector<Edit> &edits)
+        : m_chunkEdits(GroupEdits(edits)) {
+    }
+
+    void BatchedVoxelEdit::Apply(VoxelWorld &world) {
+        std::unordered_set<glm::ivec3> affectedChunks;
+        for (const ChunkEdit &chunkEdit : m_chunkEdits) {
+            Chunk *chunk = world.TryGetLoadedChunk(chunkEdit.ChunkPosition);
+            if (!chunk) {
+                Spire::warn("Failed to set {} runs of voxels in chunk {} {} {} because it wasn't loaded", chunkEdit.Runs.size(),
+                            chunkEdit.ChunkPosition.x, chunkEdit.ChunkPosition.y, chunkEdit.ChunkPosition.z);
+                continue;
+            }
+
+            glm::u32 changedNeighbours = 0;
+            for (const Run &run : chunkEdit.Runs) {
+                glm::u32 runChangedNeighbours = GetChangedNeighbours(chunk->GetVoxelData(), run.StartIndex, run.EndIndex, run.Type);
+                if (runChangedNeighbours == 0) continue;
+                changedNeighbours |= runChangedNeighbours;
+                if (run.EndIndex - run.StartIndex == 1) chunk->SetVoxel(run.StartIndex, run.Type);
+                else chunk->SetVoxels(run.StartIndex, run.EndIndex, run.Type);
+            }
+            assert(!chunk->IsCorrupted());
+            assert((changedNeighbours & ~chunkEdit.AffectedNeighbours) == 0);
+            AddAffectedChunks(chunkEdit.ChunkPosition, changedNeighbours, affectedChunks);
+        }
+
+        // notify after every write so each chunk is only queued for meshing once
+        NotifyChunkEdits(world, affectedChunks);
+    }
+
+    std::optional<std::vector<glm::ivec3> > BatchedVoxelEdit::GetWrittenChunks() const {
+        std::vector<glm::ivec3> chunks;
+        chunks.reserve(m_chunkEdits.size());
+        for (const ChunkEdit &chunkEdit : m_chunkEdits) {
+            chunks.push_back(chunkEdit.ChunkPosition);
+        }
+        return chunks;
+    }
+
+    std::vector<BatchedVoxelEdit::ChunkEdit> BatchedVoxelEdit::GroupEdits(const std::vector<Edit> &edits) {
+        struct IndexedEdit {
+            glm::u32 Index;
+            VoxelType Type;
+        };
+
+        // bucket by chunk, in the order the edits were given
+        std::unordered_map<glm::ivec3, std::size_t> bucketIndices;
+        std::vector<glm::ivec3> bucketPositions;
+        std::vector<std::vector<IndexedEdit> > buckets;
+        glm::ivec3 lastChunkPosition = {};
+        std::size_t lastBucket = std::numeric_limits<std::size_t>::max();
+        for (const Edit &edit : edits) {
+            glm::ivec3 chunkPosition = VoxelWorld::GetChunkPositionOfVoxel(edit.Position);
+            // consecutive edits are usually in the same chunk
+            if (lastBucket == std::numeric_limits<std::size_t>::max() || chunkPosition != lastChunkPosition) {
+                auto [it, inserted] = bucketIndices.try_emplace(chunkPosition, buckets.size());
+                if (inserted) {
+                    bucketPositions.push_back(chunkPosition);
+                    buckets.emplace_back();
+                }
+                lastChunkPosition = chunkPosition;
+                lastBucket = it->second;
+            }
+
+            glm::uvec3 positionInChunk = glm::uvec3(edit.Position - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE);
+            buckets[lastBucket].push_back({static_cast<glm::u32>(SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk)), edit.Type});
+        }
+
+        std::vector<ChunkEdit> chunkEdits(buckets.size());
+        for (std::size_t i = 0; i < buckets.size(); i++) {
+            std::vector<IndexedEdit> &bucket = buckets[i];
+            ChunkEdit &chunkEdit = chunkEdits[i];
+            chunkEdit.ChunkPosition = bucketPositions[i];
+            chunkEdit.AffectedNeighbours = OWN_CHUNK_NEIGHBOUR_BIT;
+
+            // stable so the last edit to a voxel is last among its duplicates
+            std::stable_sort(bucket.begin(), bucket.end(), [](const IndexedEdit &a, const IndexedEdit &b) { return a.Index < b.Index; });
+
+            for (std::size_t j = 0; j < bucket.size(); j++) {
+                if (j + 1 < bucket.size() && bucket[j + 1].Index == bucket[j].Index) continue; // overwritten by a later edit
+                const IndexedEdit &edit = bucket[j];
+
+                // extend the previous run if this voxel follows it in memory
+                if (!chunkEdit.Runs.empty() && chunkEdit.Runs.back().EndIndex == edit.Index && chunkEdit.Runs.back().Type == edit.Type) {
+                    chunkEdit.Runs.back().EndIndex++;
+                } else {
+                    chunkEdit.Runs.push_back({edit.Index, edit.Index + 1, edit.Type});
+                }
+
+                chunkEdit.AffectedNeighbours |= GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, edit.Index));
+            }
+        }
+
+        return chunkEdits;
+    }
+
+    std::unordered_set<glm::ivec3> BatchedVoxelEdit::CalculateAffectedChunkMeshes(const std::vector<ChunkEdit> &chunkEdits) {
+        std::unordered_set<glm::ivec3> affected;
+        for (const ChunkEdit &chunkEdit : chunkEdits) {
+            AddAffectedChunks(chunkEdit.ChunkPosition, chunkEdit.AffectedNeighbours, affected);
+        }
+        return affected;
+    }
+} // SpireVoxel
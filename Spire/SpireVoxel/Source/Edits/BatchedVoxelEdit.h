@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BasicVoxelEdit.h"
+
+namespace SpireVoxel {
+
+    // Changes many scattered voxels, faster than BasicVoxelEdit for large numbers of voxels (e.g. explosions or brushes)
+    // Edits are grouped by chunk so each chunk is looked up and notified once, contiguous voxels of the same type are written together
+    // If a voxel is edited more than once the last edit wins
+    // Can only edit voxels in loaded chunks
+    class BatchedVoxelEdit : public IVoxelEdit {
+    public:
+        using Edit = BasicVoxelEdit::Edit;
+
+        // Voxels [StartIndex, EndIndex) of a chunk set to Type
+        struct Run {
+            glm::u32 StartIndex;
+            glm::u32 EndIndex;
+            VoxelType Type;
+        };
+
+        struct ChunkEdit {
+            glm::ivec3 ChunkPosition;
+            std::vector<Run> Runs; // sorted by index, never overlap
+            glm::u32 AffectedNeighbours = 0; // see IVoxelEdit::GetAffectedNeighbours
+        };
+
+    public:
+        explicit BatchedVoxelEdit(const std::vector<Edit> &edits);
+
+    public:
+        void Apply(VoxelWorld &world) override;
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+        [[nodiscard]] const std::vector<ChunkEdit> &GetChunkEdits() const { return m_chunkEdits; }
+
+        [[nodiscard]] static std::vector<ChunkEdit> GroupEdits(const std::vector<Edit> &edits);
+
+        // The edited chunks and the neighbours whose meshes read the edited voxels (faces and AO read one voxel into adjacent chunks)
+        // Apply only notifies the ones whose meshes actually change, see IVoxelEdit::GetChangedNeighbours
+        [[nodiscard]] static std::unordered_set<glm::ivec3> CalculateAffectedChunkMeshes(const std::vector<ChunkEdit> &chunkEdits);
+
+    private:
+        std::vector<ChunkEdit> m_chunkEdits;
+    };
+} // SpireVoxel
@@ -2,12 +2,14 @@
 
 namespace SpireVoxel {
     CuboidVoxelEdit::CuboidVoxelEdit(glm::ivec3 origin, glm::uvec3 size, VoxelType voxelType)
-        : m_voxelType(voxelType),
-          m_edits(GenerateEdits(origin, size)),
-          m_affectedChunkMeshes(CalculateAffectedChunkMeshes(m_edits)) {
+        : m_origin(origin),
+          m_size(size),
+          m_voxelType(voxelType),
+          m_edits(GenerateEdits(origin, size)) {
     }
 
     void CuboidVoxelEdit::Apply(VoxelWorld &world) {
+        std::unordered_set<glm::ivec3> affectedChunks;
         for (const auto &edit : m_edits) {
             Chunk *chunk = world.TryGetLoadedChunk(edit.ChunkPosition);
             if (!chunk) {
@@ -15,39 +17,62 @@ namespace SpireVoxel {
                 continue;
             }
 
+            glm::u32 changedNeighbours = 0;
             static_assert(SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 0, 0) + 1 == SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 0, 1)); // continuous along the z axis
             for (glm::u32 x = edit.RectOrigin.x; x < edit.RectOrigin.x + edit.RectSize.x; x++) {
                 for (glm::u32 y = edit.RectOrigin.y; y < edit.RectOrigin.y + edit.RectSize.y; y++) {
-                    std::size_t startIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, edit.RectOrigin.z);
-                    std::size_t endIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, edit.RectOrigin.z + edit.RectSize.z);
+                    glm::u32 startIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, edit.RectOrigin.z);
+                    glm::u32 endIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, edit.RectOrigin.z + edit.RectSize.z);
                     assert(edit.RectOrigin.z + edit.RectSize.z - 1 < SPIRE_VOXEL_CHUNK_SIZE);
                     assert(startIndex < endIndex);
-                    assert(endIndex <= chunk->VoxelData.size());
+                    assert(endIndex <= chunk->GetVoxelData().size());
+
+                    // rows that are already the voxel type aren't written
+                    glm::u32 rowChangedNeighbours = GetChangedNeighbours(chunk->GetVoxelData(), startIndex, endIndex, m_voxelType);
+                    if (rowChangedNeighbours == 0) continue;
+                    changedNeighbours |= rowChangedNeighbours;
                     assert(!chunk->IsCorrupted());
                     chunk->SetVoxels(startIndex, endIndex, m_voxelType);
                     assert(!chunk->IsCorrupted());
                 }
             }
+            AddAffectedChunks(edit.ChunkPosition, changedNeighbours, affectedChunks);
         }
 
-        for (const auto &chunkPos : m_affectedChunkMeshes) {
-            Chunk *chunk = world.TryGetLoadedChunk(chunkPos);
-            if (chunk) {
-                NotifyChunkEdit(world, *chunk);
-            }
+        NotifyChunkEdits(world, affectedChunks);
+    }
+
+    std::optional<std::vector<glm::ivec3> > CuboidVoxelEdit::GetWrittenChunks() const {
+        std::vector<glm::ivec3> chunks;
+        chunks.reserve(m_edits.size());
+        for (const auto &edit : m_edits) {
+            chunks.push_back(edit.ChunkPosition);
         }
+        return chunks;
+    }
+
+    void CuboidVoxelEdit::Record(std::ostream &stream) const {
+        stream.write(reinterpret_cast<const char *>(&m_origin), sizeof(m_origin));
+        stream.write(reinterpret_cast<const char *>(&m_size), sizeof(m_size));
+        stream.write(reinterpret_cast<const char *>(&m_voxelType), sizeof(m_voxelType));
+    }
+
+    std::optional<CuboidVoxelEdit> CuboidVoxelEdit::ReadRecord(std::istream &stream) {
+        glm::ivec3 origin{};
+        glm::uvec3 size{};
+        VoxelType voxelType{};
+        stream.read(reinterpret_cast<char *>(&origin), sizeof(origin));
+        stream.read(reinterpret_cast<char *>(&size), sizeof(size));
+        stream.read(reinterpret_cast<char *>(&voxelType), sizeof(voxelType));
+        if (!stream) return std::nullopt;
+        return CuboidVoxelEdit(origin, size, voxelType);
     }
 
     std::unordered_set<glm::ivec3> CuboidVoxelEdit::CalculateAffectedChunkMeshes(const std::vector<Edit> &edits) {
         std::unordered_set<glm::ivec3> affected;
         for (auto &edit : edits) {
-            affected.insert(edit.ChunkPosition);
-            if (edit.RectOrigin.x == 0) affected.insert(edit.ChunkPosition + glm::ivec3{-1, 0, 0});
-            if (edit.RectOrigin.y == 0) affected.insert(edit.ChunkPosition + glm::ivec3{0, -1, 0});
-            if (edit.RectOrigin.z == 0) affected.insert(edit.ChunkPosition + glm::ivec3{0, 0, -1});
-            if (edit.RectSize.x + edit.RectOrigin.x >= SPIRE_VOXEL_CHUNK_SIZE - 1) affected.insert(edit.ChunkPosition + glm::ivec3{1, 0, 0});
-            if (edit.RectSize.y + edit.RectOrigin.y >= SPIRE_VOXEL_CHUNK_SIZE - 1) affected.insert(edit.ChunkPosition + glm::ivec3{0, 1, 0});
-            if (edit.RectSize.z + edit.RectOrigin.z >= SPIRE_VOXEL_CHUNK_SIZE - 1) affected.insert(edit.ChunkPosition + glm::ivec3{0, 0, 1});
+            if (edit.RectSize.x == 0 || edit.RectSize.y == 0 || edit.RectSize.z == 0) continue;
+            AddAffectedChunks(edit.ChunkPosition, GetAffectedNeighbours(edit.RectOrigin, edit.RectOrigin + edit.RectSize - glm::uvec3(1)), affected);
         }
 
         return affected;
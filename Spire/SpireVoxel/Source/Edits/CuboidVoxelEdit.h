@@ -18,13 +18,25 @@ namespace SpireVoxel {
     public:
         void Apply(VoxelWorld &world) override;
 
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+        [[nodiscard]] RecordedType GetRecordedType() const override { return RecordedType::CUBOID; }
+
+        void Record(std::ostream &stream) const override;
+
+        // Recreate an edit written by Record, nullopt if the stream doesn't hold one
+        [[nodiscard]] static std::optional<CuboidVoxelEdit> ReadRecord(std::istream &stream);
+
+        // The edited chunks and the neighbours whose meshes read the edited voxels
+        // Apply only notifies the ones whose meshes actually change, see IVoxelEdit::GetChangedNeighbours
         static std::unordered_set<glm::ivec3> CalculateAffectedChunkMeshes(const std::vector<Edit> &edits);
 
         static std::vector<Edit> GenerateEdits(glm::ivec3 origin, glm::uvec3 size);
 
     private:
+        glm::ivec3 m_origin;
+        glm::uvec3 m_size;
         VoxelType m_voxelType;
         std::vector<Edit> m_edits;
-        std::unordered_set<glm::ivec3> m_affectedChunkMeshes;
     };
 } // SpireVoxel
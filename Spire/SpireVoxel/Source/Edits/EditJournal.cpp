@@ -0,0 +1,198 @@
+#include "EditJournal.h"
+
+#include "WorldJournalVoxels.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    std::size_t EditJournal::ChunkDelta::GetMemoryUsage() const {
+        return sizeof(ChunkDelta) + (Before.capacity() + After.capacity()) * sizeof(Run);
+    }
+
+    EditJournal::EditJournal(IJournalVoxels &voxels, Settings settings)
+        : m_voxels(voxels),
+          m_settings(settings) {
+    }
+
+    void EditJournal::Apply(IVoxelEdit &edit) {
+        std::optional<std::vector<glm::ivec3> > writtenChunks = edit.GetWrittenChunks();
+        if (!writtenChunks) {
+            Spire::warn("[EditJournal] Can't record an edit that doesn't know which chunks it writes to, clearing the undo history");
+            m_voxels.ApplyEdit(edit);
+            Clear();
+            return;
+        }
+
+        // an edit outside of a stroke is its own stroke
+        BeginStroke();
+        for (const glm::ivec3 &chunkPosition : *writtenChunks) {
+            if (m_strokeSnapshots.contains(chunkPosition)) continue;
+            const ChunkVoxelStorage *voxels = m_voxels.TryGetVoxels(chunkPosition);
+            if (!voxels) continue;
+            m_strokeSnapshots.emplace(chunkPosition, Snapshot{*voxels, m_voxels.GetVersion(chunkPosition)});
+        }
+        m_voxels.ApplyEdit(edit);
+
+        // the snapshots of chunks the stroke has written hold a copy of their old voxels, that counts towards the budget until the stroke ends
+        m_snapshotMemoryUsage = CalculateSnapshotMemoryUsage();
+        Trim();
+        EndStroke();
+    }
+
+    void EditJournal::BeginStroke() {
+        m_strokeDepth++;
+    }
+
+    void EditJournal::EndStroke() {
+        assert(m_strokeDepth > 0);
+        if (--m_strokeDepth > 0) return;
+
+        Spire::Timer timer;
+        Entry entry;
+        for (auto &[chunkPosition, snapshot] : m_strokeSnapshots) {
+            const ChunkVoxelStorage *voxels = m_voxels.TryGetVoxels(chunkPosition);
+            // every write changes the version, so unchanged chunks don't need comparing
+            if (!voxels || m_voxels.GetVersion(chunkPosition) == snapshot.Version) continue;
+
+            std::optional<ChunkDelta> delta = CalculateDelta(chunkPosition, snapshot.Storage.Read().Voxels, voxels->Read().Voxels);
+            if (!delta) continue;
+            entry.MemoryUsage += delta->GetMemoryUsage();
+            entry.Chunks.push_back(std::move(delta.value()));
+        }
+        m_strokeSnapshots.clear();
+        m_snapshotMemoryUsage = 0;
+
+        if (LOG) Spire::info("[EditJournal] Recorded {} chunks ({} bytes) in {} ms", entry.Chunks.size(), entry.MemoryUsage, timer.MillisSinceStart());
+        if (!entry.Chunks.empty()) Record(std::move(entry));
+        else Trim();
+    }
+
+    bool EditJournal::Undo() {
+        assert(!IsInStroke());
+        if (m_undo.empty()) return false;
+
+        ApplyDeltas(m_undo.back(), true);
+        m_redo.push_back(std::move(m_undo.back()));
+        m_undo.pop_back();
+        return true;
+    }
+
+    bool EditJournal::Redo() {
+        assert(!IsInStroke());
+        if (m_redo.empty()) return false;
+
+        ApplyDeltas(m_redo.back(), false);
+        m_undo.push_back(std::move(m_redo.back()));
+        m_redo.pop_back();
+        return true;
+    }
+
+    void EditJournal::Clear() {
+        m_undo.clear();
+        m_redo.clear();
+        m_strokeSnapshots.clear();
+        m_snapshotMemoryUsage = 0;
+        Trim();
+    }
+
+    std::optional<EditJournal::ChunkDelta> EditJournal::CalculateDelta(glm::ivec3 chunkPosition,
+                                                                       const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &before,
+                                                                       const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &after) {
+        ChunkDelta delta = {chunkPosition, {}, {}};
+        auto pushRun = [](std::vector<Run> &runs, glm::u32 index, VoxelType type) {
+            if (!runs.empty() && runs.back().EndIndex == index && runs.back().Type == type) runs.back().EndIndex++;
+            else runs.push_back({index, index + 1, type});
+        };
+
+        // most of a chunk is usually unchanged so compare whole columns first
+        for (glm::u32 column = 0; column < SPIRE_VOXEL_CHUNK_VOLUME; column += SPIRE_VOXEL_CHUNK_SIZE) {
+            if (std::memcmp(before.data() + column, after.data() + column, SPIRE_VOXEL_CHUNK_SIZE * sizeof(VoxelType)) == 0) continue;
+
+            for (glm::u32 index = column; index < column + SPIRE_VOXEL_CHUNK_SIZE; index++) {
+                if (before[index] == after[index]) continue;
+                pushRun(delta.Before, index, before[index]);
+                pushRun(delta.After, index, after[index]);
+            }
+        }
+
+        if (delta.Before.empty()) return std::nullopt;
+        delta.Before.shrink_to_fit();
+        delta.After.shrink_to_fit();
+        return delta;
+    }
+
+    void EditJournal::Record(Entry &&entry) {
+        m_redo.clear();
+        m_undo.push_back(std::move(entry));
+        Trim();
+    }
+
+    void EditJournal::ApplyDeltas(const Entry &entry, bool undo) {
+        m_voxels.NotifyChunkEdits(DeltaVoxelEdit(entry.Chunks, undo).Write(m_voxels));
+    }
+
+    glm::u64 EditJournal::CalculateSnapshotMemoryUsage() const {
+        glm::u64 memoryUsage = 0;
+        for (const auto &[chunkPosition, snapshot] : m_strokeSnapshots) {
+            // until the chunk is written the snapshot shares its voxels
+            const ChunkVoxelStorage *voxels = m_voxels.TryGetVoxels(chunkPosition);
+            if (!voxels || !snapshot.Storage.SharesDataWith(*voxels)) memoryUsage += snapshot.Storage.GetMemoryUsage();
+        }
+        return memoryUsage;
+    }
+
+    void EditJournal::Trim() {
+        auto entryMemoryUsage = [](const Entry &entry) -> glm::u64 { return sizeof(Entry) + entry.MemoryUsage; };
+        glm::u64 memoryUsage = 0;
+        for (const Entry &entry : m_undo) memoryUsage += entryMemoryUsage(entry);
+        for (const Entry &entry : m_redo) memoryUsage += entryMemoryUsage(entry);
+
+        // the snapshots can't be forgotten while the stroke needs them, so entries make room for them
+        while (memoryUsage + m_snapshotMemoryUsage > m_settings.MaxMemory && (!m_undo.empty() || !m_redo.empty())) {
+            std::deque<Entry> &entries = m_undo.empty() ? m_redo : m_undo;
+            memoryUsage -= entryMemoryUsage(entries.front());
+            entries.pop_front();
+            if (LOG) Spire::info("[EditJournal] Forgot an entry, {} undo and {} redo entries left", m_undo.size(), m_redo.size());
+        }
+        m_memoryUsage.Set(memoryUsage);
+    }
+
+    DeltaVoxelEdit::DeltaVoxelEdit(const std::vector<EditJournal::ChunkDelta> &deltas, bool useBefore)
+        : m_deltas(deltas),
+          m_useBefore(useBefore) {
+    }
+
+    void DeltaVoxelEdit::Apply(VoxelWorld &world) {
+        WorldJournalVoxels voxels(world);
+        NotifyChunkEdits(world, Write(voxels));
+    }
+
+    std::unordered_set<glm::ivec3> DeltaVoxelEdit::Write(IJournalVoxels &voxels) const {
+        std::unordered_set<glm::ivec3> affectedChunks;
+        for (const EditJournal::ChunkDelta &delta : m_deltas) {
+            const ChunkVoxelStorage *storage = voxels.TryGetVoxels(delta.ChunkPosition);
+            if (!storage) {
+                Spire::warn("Failed to write the delta of chunk {} {} {} because it wasn't loaded", delta.ChunkPosition.x, delta.ChunkPosition.y, delta.ChunkPosition.z);
+                continue;
+            }
+
+            glm::u32 affectedNeighbours = 0;
+            for (const EditJournal::Run &run : m_useBefore ? delta.Before : delta.After) {
+                glm::u32 changedNeighbours = GetChangedNeighbours(storage->Read().Voxels, run.StartIndex, run.EndIndex, run.Type);
+                if (changedNeighbours == 0) continue;
+                voxels.SetVoxels(delta.ChunkPosition, run.StartIndex, run.EndIndex, run.Type);
+                affectedNeighbours |= changedNeighbours;
+            }
+            assert(!storage->IsCorrupted());
+            AddAffectedChunks(delta.ChunkPosition, affectedNeighbours, affectedChunks);
+        }
+        return affectedChunks;
+    }
+
+    std::optional<std::vector<glm::ivec3> > DeltaVoxelEdit::GetWrittenChunks() const {
+        std::vector<glm::ivec3> chunks;
+        chunks.reserve(m_deltas.size());
+        for (const EditJournal::ChunkDelta &delta : m_deltas) chunks.push_back(delta.ChunkPosition);
+        return chunks;
+    }
+} // SpireVoxel
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "IVoxelEdit.h"
+
+#include <deque>
+
+namespace SpireVoxel {
+    // The chunks EditJournal snapshots and writes, see WorldJournalVoxels
+    // Owner thread only
+    class IJournalVoxels {
+    public:
+        virtual ~IJournalVoxels() = default;
+
+        // nullptr if the chunk isn't loaded, copies of the storage share its voxels until either is written
+        [[nodiscard]] virtual const ChunkVoxelStorage *TryGetVoxels(glm::ivec3 chunkPosition) const = 0;
+
+        // Increases with every write to the chunk, only called for loaded chunks
+        [[nodiscard]] virtual glm::u64 GetVersion(glm::ivec3 chunkPosition) const = 0;
+
+        // Only called for loaded chunks
+        virtual void SetVoxels(glm::ivec3 chunkPosition, glm::u32 startIndex, glm::u32 endIndex, VoxelType type) = 0;
+
+        virtual void ApplyEdit(IVoxelEdit &edit) = 0;
+
+        // The chunks whose meshes changed when the journal wrote to them
+        virtual void NotifyChunkEdits(const std::unordered_set<glm::ivec3> &chunkPositions) = 0;
+    };
+
+    // Applies edits to a world and records what they changed so they can be undone and redone
+    // Each entry stores run length encoded before/after voxel types of only the voxels that changed, per chunk
+    // Edits applied between BeginStroke and EndStroke are recorded as a single entry (e.g. every dab of a brush while the mouse is held down)
+    // Owner thread only
+    class EditJournal {
+    public:
+        struct Settings {
+            // oldest entries are forgotten when the history and the voxels the current stroke's snapshots hold are over this
+            glm::u64 MaxMemory = 256 * 1024 * 1024;
+        };
+
+        // Voxels [StartIndex, EndIndex) of a chunk were Type
+        struct Run {
+            glm::u32 StartIndex;
+            glm::u32 EndIndex;
+            VoxelType Type;
+        };
+
+        // The changed voxels of one chunk, Before and After cover exactly the same voxels
+        struct ChunkDelta {
+            glm::ivec3 ChunkPosition;
+            std::vector<Run> Before;
+            std::vector<Run> After;
+
+            [[nodiscard]] std::size_t GetMemoryUsage() const;
+        };
+
+        struct Entry {
+            std::vector<ChunkDelta> Chunks;
+            std::size_t MemoryUsage = 0;
+        };
+
+    public:
+        // voxels - e.g. a WorldJournalVoxels, must outlive the journal
+        EditJournal(IJournalVoxels &voxels, Settings settings);
+
+        DISABLE_COPY_AND_MOVE(EditJournal)
+
+    public:
+        // Applies the edit and records its changes, clears the redo history
+        // Edits that don't know which chunks they write to (IVoxelEdit::GetWrittenChunks) can't be recorded, they are applied and the history is cleared
+        void Apply(IVoxelEdit &edit);
+
+        // Strokes can be nested, the entry is recorded when the outermost stroke ends
+        void BeginStroke();
+
+        void EndStroke();
+
+        [[nodiscard]] bool IsInStroke() const { return m_strokeDepth > 0; }
+
+        // Returns false if there was nothing to undo/redo
+        bool Undo();
+
+        bool Redo();
+
+        [[nodiscard]] std::size_t NumUndoEntries() const { return m_undo.size(); }
+
+        [[nodiscard]] std::size_t NumRedoEntries() const { return m_redo.size(); }
+
+        // Memory used by the entries, the snapshots of the current stroke are reported as voxel storage
+        [[nodiscard]] glm::u64 GetMemoryUsage() const { return m_memoryUsage.Get(); }
+
+        // Voxels held only by the current stroke's snapshots, because their chunks were written since
+        [[nodiscard]] glm::u64 GetSnapshotMemoryUsage() const { return m_snapshotMemoryUsage; }
+
+        void Clear();
+
+        // Runs of the voxels that differ between before and after, nullopt if nothing changed
+        [[nodiscard]] static std::optional<ChunkDelta> CalculateDelta(glm::ivec3 chunkPosition,
+                                                                     const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &before,
+                                                                     const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &after);
+
+    private:
+        // The chunk's voxels before the current stroke first wrote to it, copying storage is cheap until the chunk is written to
+        struct Snapshot {
+            ChunkVoxelStorage Storage;
+            glm::u64 Version;
+        };
+
+        void Record(Entry &&entry);
+
+        void ApplyDeltas(const Entry &entry, bool undo);
+
+        [[nodiscard]] glm::u64 CalculateSnapshotMemoryUsage() const;
+
+        // Forget the oldest undo entries, then the furthest redo entries, until under MaxMemory, and update the memory usage
+        void Trim();
+
+    private:
+        IJournalVoxels &m_voxels;
+        Settings m_settings;
+        std::deque<Entry> m_undo;
+        std::deque<Entry> m_redo; // the back is redone first
+        glm::u32 m_strokeDepth = 0;
+        std::unordered_map<glm::ivec3, Snapshot> m_strokeSnapshots;
+        glm::u64 m_snapshotMemoryUsage = 0;
+        Spire::MemoryCounter m_memoryUsage{Spire::MemoryCategory::EditHistory};
+    };
+
+    // Writes the before or after runs of deltas, notifies like any other edit
+    // deltas must outlive the edit
+    class DeltaVoxelEdit final : public IVoxelEdit {
+    public:
+        DeltaVoxelEdit(const std::vector<EditJournal::ChunkDelta> &deltas, bool useBefore);
+
+    public:
+        void Apply(VoxelWorld &world) override;
+
+        // Apply without notifying, returns the chunks whose meshes changed
+        [[nodiscard]] std::unordered_set<glm::ivec3> Write(IJournalVoxels &voxels) const;
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+    private:
+        const std::vector<EditJournal::ChunkDelta> &m_deltas;
+        bool m_useBefore;
+    };
+} // SpireVoxel
@@ -0,0 +1,111 @@
+#include "EditQueue.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    EditQueue::~EditQueue() {
+        Node *node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            Node *next = node->Next;
+            delete node;
+            node = next;
+        }
+    }
+
+    EditQueue::SequenceNumber EditQueue::Submit(std::unique_ptr<IVoxelEdit> edit, CompletionCallback onComplete) {
+        assert(edit);
+        SequenceNumber sequence = m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+        Node *node = new Node{{sequence, std::move(edit), std::move(onComplete)}, m_head.load(std::memory_order_relaxed)};
+
+        // push onto the front of the list, release so the taking thread sees the whole node
+        while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return sequence;
+    }
+
+    std::vector<EditQueue::Command> EditQueue::Take() {
+        Node *node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            m_outOfOrder.push_back(std::move(node->Queued));
+            Node *next = node->Next;
+            delete node;
+            node = next;
+        }
+        if (m_outOfOrder.empty()) return {};
+
+        // a producer can be between getting its sequence number and pushing, so only take up to the first missing edit
+        std::ranges::sort(m_outOfOrder, {}, &Command::Sequence);
+        std::size_t numReady = 0;
+        while (numReady < m_outOfOrder.size() && m_outOfOrder[numReady].Sequence == m_nextToTake) {
+            numReady++;
+            m_nextToTake++;
+        }
+
+        std::vector<Command> ready(std::make_move_iterator(m_outOfOrder.begin()), std::make_move_iterator(m_outOfOrder.begin() + numReady));
+        m_outOfOrder.erase(m_outOfOrder.begin(), m_outOfOrder.begin() + numReady);
+        return ready;
+    }
+
+    void EditQueue::Update(VoxelWorld &world) {
+        assert(world.IsOwnerThread());
+        FireCompletionCallbacks(world);
+
+        std::vector<Command> commands = Take();
+        if (commands.empty()) return;
+
+        Spire::Timer timer;
+        std::vector<std::unique_ptr<IVoxelEdit> > edits;
+        edits.reserve(commands.size());
+        std::size_t firstAwaiting = m_awaitingCompletion.size();
+        std::vector<std::optional<std::vector<glm::ivec3> > > writtenChunks;
+        for (Command &command : commands) {
+            if (command.OnComplete) {
+                m_awaitingCompletion.push_back({command.Sequence, std::move(command.OnComplete), std::nullopt});
+                writtenChunks.push_back(command.Edit->GetWrittenChunks());
+            }
+            edits.push_back(std::move(command.Edit));
+        }
+
+        // same result as applying them in order, but edits to different chunks are applied in parallel
+        MergedVoxelEdit(std::move(edits)).Apply(world);
+
+        // an edit also changes the meshes of neighbours that read its border voxels (faces and AO), so it waits for the chunks around what it wrote that are queued for remeshing
+        if (!writtenChunks.empty()) {
+            std::unordered_set<ChunkHandle> editedChunks = world.GetRenderer().GetEditedChunks();
+            for (std::size_t i = 0; i < writtenChunks.size(); i++) {
+                if (writtenChunks[i]) m_awaitingCompletion[firstAwaiting + i].Chunks = GetAffectedChunks(world, *writtenChunks[i], editedChunks);
+            }
+        }
+
+        if (LOG) Spire::info("[EditQueue] Applied edits {} to {} in {} ms", commands.front().Sequence, commands.back().Sequence, timer.MillisSinceStart());
+    }
+
+    std::vector<ChunkHandle> EditQueue::GetAffectedChunks(const VoxelWorld &world, const std::vector<glm::ivec3> &writtenChunks,
+                                                          const std::unordered_set<ChunkHandle> &editedChunks) {
+        std::unordered_set<ChunkHandle> affectedChunks;
+        for (const glm::ivec3 &chunkPosition : writtenChunks) {
+            for (glm::u32 bit = 0; bit < 27; bit++) {
+                const Chunk *chunk = world.TryGetLoadedChunk(chunkPosition + IVoxelEdit::GetNeighbourOffset(bit));
+                if (chunk && editedChunks.contains(chunk->Handle)) affectedChunks.insert(chunk->Handle);
+            }
+        }
+        return {affectedChunks.begin(), affectedChunks.end()};
+    }
+
+    void EditQueue::FireCompletionCallbacks(const VoxelWorld &world) {
+        if (m_awaitingCompletion.empty()) return;
+
+        // the edits were applied in an earlier Update and the frame after it was rendered, so chunks that aren't waiting to be remeshed are visible
+        std::unordered_set<ChunkHandle> editedChunks = world.GetRenderer().GetEditedChunks();
+        auto firstComplete = std::stable_partition(m_awaitingCompletion.begin(), m_awaitingCompletion.end(), [&](const AwaitingCompletion &awaiting) {
+            return awaiting.Chunks
+                       ? std::ranges::any_of(*awaiting.Chunks, [&](ChunkHandle handle) { return editedChunks.contains(handle); })
+                       : !editedChunks.empty();
+        });
+        std::vector<AwaitingCompletion> completed(std::make_move_iterator(firstComplete), std::make_move_iterator(m_awaitingCompletion.end()));
+        m_awaitingCompletion.erase(firstComplete, m_awaitingCompletion.end());
+
+        // a callback may submit more edits or read NumAwaitingCompletion, so they run once the list is up to date
+        for (const AwaitingCompletion &awaiting : completed) awaiting.OnComplete(awaiting.Sequence);
+    }
+} // SpireVoxel
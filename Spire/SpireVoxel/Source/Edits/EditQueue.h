@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MergedVoxelEdit.h"
+
+namespace SpireVoxel {
+
+    // Lets any thread (gameplay, networking, scripting...) submit edits, the world applies them on its owner thread in VoxelWorld::Update
+    // Submitting is lock-free, edits are pushed onto an atomic linked list which the owner thread takes all at once
+    // Every edit gets a sequence number when it is submitted and edits are always applied in sequence number order,
+    // an edit is held back until every edit submitted before it has arrived
+    class EditQueue {
+    public:
+        using SequenceNumber = glm::u64;
+
+        // Called on the owner thread once the meshes changed by the edit have been uploaded and rendered
+        using CompletionCallback = std::function<void(SequenceNumber)>;
+
+        struct Command {
+            SequenceNumber Sequence;
+            std::unique_ptr<IVoxelEdit> Edit;
+            CompletionCallback OnComplete;
+        };
+
+    public:
+        EditQueue() = default;
+
+        ~EditQueue();
+
+        DISABLE_COPY_AND_MOVE(EditQueue)
+
+    public:
+        // Thread safe and lock-free
+        SequenceNumber Submit(std::unique_ptr<IVoxelEdit> edit, CompletionCallback onComplete = {});
+
+        template<VoxelEditType T>
+        SequenceNumber Submit(const T &edit, CompletionCallback onComplete = {}) {
+            return Submit(std::make_unique<T>(edit), std::move(onComplete));
+        }
+
+        // Fires the callbacks of edits whose meshes are now visible, then applies every edit that is ready in a single MergedVoxelEdit
+        // Owner thread only, called by VoxelWorld::Update
+        void Update(VoxelWorld &world);
+
+        // Take the edits that are ready in sequence number order, only one thread may take
+        [[nodiscard]] std::vector<Command> Take();
+
+        // Number of edits waiting for their completion callbacks, owner thread only
+        [[nodiscard]] std::size_t NumAwaitingCompletion() const { return m_awaitingCompletion.size(); }
+
+    private:
+        struct Node {
+            Command Queued;
+            Node *Next;
+        };
+
+        // Applied edits waiting for their chunks to be remeshed
+        struct AwaitingCompletion {
+            SequenceNumber Sequence;
+            CompletionCallback OnComplete;
+            // the written chunks and neighbours whose meshes changed, nullopt if the edit doesn't know which chunks it writes to, waits for every chunk
+            std::optional<std::vector<ChunkHandle> > Chunks;
+        };
+
+        void FireCompletionCallbacks(const VoxelWorld &world);
+
+        // The written chunks and their neighbours that are waiting to be remeshed, called after the edit was applied
+        [[nodiscard]] static std::vector<ChunkHandle> GetAffectedChunks(const VoxelWorld &world, const std::vector<glm::ivec3> &writtenChunks,
+                                                                       const std::unordered_set<ChunkHandle> &editedChunks);
+
+    private:
+        std::atomic<Node *> m_head = nullptr;
+        std::atomic<SequenceNumber> m_nextSequence = 0;
+        // taking thread only
+        SequenceNumber m_nextToTake = 0;
+        std::vector<Command> m_outOfOrder; // arrived before an edit with a lower sequence number
+        // owner thread only
+        std::vector<AwaitingCompletion> m_awaitingCompletion;
+    };
+} // SpireVoxel
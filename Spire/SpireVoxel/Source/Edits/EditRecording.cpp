@@ -0,0 +1,230 @@
+#include "EditRecording.h"
+
+#include "BasicVoxelEdit.h"
+#include "CuboidVoxelEdit.h"
+
+#include <sstream>
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    void EditRecording::Apply(VoxelWorld &world, IVoxelEdit &edit) {
+        assert(world.IsOwnerThread());
+        float timeMillis = m_timer.MillisSinceStart();
+
+        Edit recorded = {timeMillis, {}, edit.GetRecordedType()};
+        if (recorded.Type != IVoxelEdit::RecordedType::NONE) recorded.Description = Describe(edit);
+
+        std::optional<std::vector<glm::ivec3> > writtenChunks = edit.GetWrittenChunks();
+        if (!writtenChunks && recorded.Type == IVoxelEdit::RecordedType::NONE) {
+            Spire::warn("[EditRecording] Can't record an edit that doesn't know which chunks it writes to, the replay will diverge");
+            edit.Apply(world);
+            return;
+        }
+
+        // copying storage is cheap until the chunk is written to, like EditJournal
+        std::vector<std::pair<const Chunk *, ChunkVoxelStorage> > snapshots;
+        for (const glm::ivec3 &chunkPosition : writtenChunks.value_or(std::vector<glm::ivec3>{})) {
+            const Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (chunk) snapshots.emplace_back(chunk, chunk->GetVoxelStorage());
+        }
+        edit.Apply(world);
+
+        for (const auto &[chunk, storage] : snapshots) {
+            std::optional<EditJournal::ChunkDelta> delta = EditJournal::CalculateDelta(chunk->ChunkPosition, storage.Read().Voxels, chunk->GetVoxelData());
+            if (delta) recorded.Chunks.push_back(std::move(delta.value()));
+        }
+        // edits that are replayed as themselves are kept even if they didn't change anything, replaying them still does the work
+        if (!recorded.Chunks.empty() || recorded.Type != IVoxelEdit::RecordedType::NONE) Add(std::move(recorded));
+    }
+
+    void EditRecording::Add(Edit edit) {
+        assert(m_edits.empty() || m_edits.back().TimeMillis <= edit.TimeMillis);
+        m_edits.push_back(std::move(edit));
+    }
+
+    std::size_t EditRecording::CountWrittenVoxels() const {
+        std::size_t count = 0;
+        for (const Edit &edit : m_edits) {
+            for (const EditJournal::ChunkDelta &delta : edit.Chunks) {
+                for (const EditJournal::Run &run : delta.After) count += run.EndIndex - run.StartIndex;
+            }
+        }
+        return count;
+    }
+
+    static void WriteRuns(std::ofstream &file, const std::vector<EditJournal::Run> &runs) {
+        auto numRuns = static_cast<std::uint32_t>(runs.size());
+        file.write(reinterpret_cast<const char *>(&numRuns), sizeof(numRuns));
+        for (const EditJournal::Run &run : runs) {
+            file.write(reinterpret_cast<const char *>(&run.StartIndex), sizeof(run.StartIndex));
+            file.write(reinterpret_cast<const char *>(&run.EndIndex), sizeof(run.EndIndex));
+            file.write(reinterpret_cast<const char *>(&run.Type), sizeof(run.Type));
+        }
+    }
+
+    static bool ReadRuns(std::ifstream &file, std::vector<EditJournal::Run> &runs) {
+        std::uint32_t numRuns{};
+        if (!file.read(reinterpret_cast<char *>(&numRuns), sizeof(numRuns))) return false;
+        runs.resize(numRuns);
+        for (EditJournal::Run &run : runs) {
+            file.read(reinterpret_cast<char *>(&run.StartIndex), sizeof(run.StartIndex));
+            file.read(reinterpret_cast<char *>(&run.EndIndex), sizeof(run.EndIndex));
+            file.read(reinterpret_cast<char *>(&run.Type), sizeof(run.Type));
+            if (!file || run.StartIndex >= run.EndIndex || run.EndIndex > SPIRE_VOXEL_CHUNK_VOLUME) return false;
+        }
+        return true;
+    }
+
+    bool EditRecording::ReadDescription(std::ifstream &file, std::uint32_t version, Edit &edit) {
+        std::uint32_t descriptionSize{};
+        if (!file.read(reinterpret_cast<char *>(&edit.Type), sizeof(edit.Type)) || !file.read(reinterpret_cast<char *>(&descriptionSize), sizeof(descriptionSize))) return false;
+        if (edit.Type > IVoxelEdit::RecordedType::CUBOID) return false;
+
+        edit.Description.resize(descriptionSize);
+        if (!file.read(edit.Description.data(), descriptionSize)) return false;
+        if (edit.Type == IVoxelEdit::RecordedType::NONE) return true;
+
+        // version 2 descriptions had no header, they were written by the first version of Record on a little endian machine
+        if (version == 2) {
+            std::ostringstream header;
+            WriteRecordHeader(header);
+            edit.Description.insert(0, std::move(header).str());
+        }
+        // make sure the edit can be recreated now rather than halfway through a replay
+        return CreateEdit(edit) != nullptr;
+    }
+
+    bool EditRecording::Save(const std::filesystem::path &path) const {
+        Spire::Timer timer;
+        if (path.has_parent_path() && !std::filesystem::exists(path.parent_path()) && !std::filesystem::create_directories(path.parent_path())) {
+            Spire::error("Failed to create directory {} to save edit recording", path.parent_path().string());
+            return false;
+        }
+
+        std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+        file.write(HEADER_IDENTIFIER.data(), HEADER_IDENTIFIER.size());
+        file.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+
+        auto numEdits = static_cast<std::uint32_t>(m_edits.size());
+        file.write(reinterpret_cast<const char *>(&numEdits), sizeof(numEdits));
+        for (const Edit &edit : m_edits) {
+            file.write(reinterpret_cast<const char *>(&edit.TimeMillis), sizeof(edit.TimeMillis));
+            file.write(reinterpret_cast<const char *>(&edit.Type), sizeof(edit.Type));
+            auto descriptionSize = static_cast<std::uint32_t>(edit.Description.size());
+            file.write(reinterpret_cast<const char *>(&descriptionSize), sizeof(descriptionSize));
+            file.write(edit.Description.data(), descriptionSize);
+            auto numChunks = static_cast<std::uint32_t>(edit.Chunks.size());
+            file.write(reinterpret_cast<const char *>(&numChunks), sizeof(numChunks));
+            for (const EditJournal::ChunkDelta &delta : edit.Chunks) {
+                file.write(reinterpret_cast<const char *>(&delta.ChunkPosition), sizeof(delta.ChunkPosition));
+                WriteRuns(file, delta.Before);
+                WriteRuns(file, delta.After);
+            }
+        }
+
+        file.close();
+        if (!file) {
+            Spire::error("Failed to write edit recording {}", path.string());
+            return false;
+        }
+        if (LOG) Spire::info("[EditRecording] Saved {} edits to {} in {} ms", m_edits.size(), path.string(), timer.MillisSinceStart());
+        return true;
+    }
+
+    std::optional<EditRecording> EditRecording::Load(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios_base::binary);
+        if (!file) {
+            Spire::error("Failed to open edit recording {}", path.string());
+            return std::nullopt;
+        }
+
+        std::remove_const_t<decltype(HEADER_IDENTIFIER)> identifier;
+        if (!file.read(identifier.data(), identifier.size()) || identifier != HEADER_IDENTIFIER) {
+            Spire::error("Failed to read edit recording - invalid identifier {}", path.string());
+            return std::nullopt;
+        }
+
+        std::uint32_t version{};
+        if (!file.read(reinterpret_cast<char *>(&version), sizeof(version)) || version > VERSION) {
+            Spire::error("Failed to read version of edit recording {}", path.string());
+            return std::nullopt;
+        }
+
+        EditRecording recording;
+        std::uint32_t numEdits{};
+        file.read(reinterpret_cast<char *>(&numEdits), sizeof(numEdits));
+        for (std::uint32_t i = 0; i < numEdits && file; i++) {
+            Edit edit = {};
+            std::uint32_t numChunks{};
+            file.read(reinterpret_cast<char *>(&edit.TimeMillis), sizeof(edit.TimeMillis));
+            // version 1 only had the voxels
+            if (version >= 2 && !ReadDescription(file, version, edit)) file.setstate(std::ios_base::failbit);
+            file.read(reinterpret_cast<char *>(&numChunks), sizeof(numChunks));
+            for (std::uint32_t chunk = 0; chunk < numChunks && file; chunk++) {
+                EditJournal::ChunkDelta &delta = edit.Chunks.emplace_back();
+                if (!file.read(reinterpret_cast<char *>(&delta.ChunkPosition), sizeof(delta.ChunkPosition)) ||
+                    !ReadRuns(file, delta.Before) || !ReadRuns(file, delta.After)) {
+                    file.setstate(std::ios_base::failbit);
+                }
+            }
+            if (file) recording.m_edits.push_back(std::move(edit));
+        }
+
+        if (!file) {
+            Spire::error("Failed to read edit {} of {} in edit recording {}", recording.m_edits.size(), numEdits, path.string());
+            return std::nullopt;
+        }
+        return recording;
+    }
+
+    std::unique_ptr<IVoxelEdit> EditRecording::CreateEdit(const Edit &edit) {
+        std::istringstream description(edit.Description);
+        if (edit.Type != IVoxelEdit::RecordedType::NONE && !ReadRecordHeader(description)) return nullptr;
+
+        switch (edit.Type) {
+            case IVoxelEdit::RecordedType::NONE:
+                return std::make_unique<DeltaVoxelEdit>(edit.Chunks, false);
+            case IVoxelEdit::RecordedType::BASIC:
+                if (std::optional<BasicVoxelEdit> basic = BasicVoxelEdit::ReadRecord(description)) return std::make_unique<BasicVoxelEdit>(std::move(basic.value()));
+                break;
+            case IVoxelEdit::RecordedType::CUBOID:
+                if (std::optional<CuboidVoxelEdit> cuboid = CuboidVoxelEdit::ReadRecord(description)) return std::make_unique<CuboidVoxelEdit>(std::move(cuboid.value()));
+                break;
+        }
+        return nullptr;
+    }
+
+    std::string EditRecording::Describe(const IVoxelEdit &edit) {
+        std::ostringstream description;
+        WriteRecordHeader(description);
+        edit.Record(description);
+        return std::move(description).str();
+    }
+
+    void EditRecording::WriteRecordHeader(std::ostream &stream) {
+        stream.write(RECORD_IDENTIFIER.data(), RECORD_IDENTIFIER.size());
+        stream.write(reinterpret_cast<const char *>(&IVoxelEdit::RECORD_VERSION), sizeof(IVoxelEdit::RECORD_VERSION));
+        stream.write(reinterpret_cast<const char *>(&RECORD_BYTE_ORDER_MARK), sizeof(RECORD_BYTE_ORDER_MARK));
+    }
+
+    bool EditRecording::ReadRecordHeader(std::istream &stream) {
+        std::remove_const_t<decltype(RECORD_IDENTIFIER)> identifier;
+        glm::u16 version{};
+        glm::u16 byteOrderMark{};
+        stream.read(identifier.data(), identifier.size());
+        stream.read(reinterpret_cast<char *>(&version), sizeof(version));
+        stream.read(reinterpret_cast<char *>(&byteOrderMark), sizeof(byteOrderMark));
+        if (!stream || identifier != RECORD_IDENTIFIER) return false;
+
+        if (byteOrderMark != RECORD_BYTE_ORDER_MARK) {
+            Spire::error("Edit record was written with a different byte order");
+            return false;
+        }
+        if (version != IVoxelEdit::RECORD_VERSION) {
+            Spire::error("Edit record version {} can't be read, expected {}", version, IVoxelEdit::RECORD_VERSION);
+            return false;
+        }
+        return true;
+    }
+} // SpireVoxel
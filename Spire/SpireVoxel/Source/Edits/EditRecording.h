@@ -0,0 +1,69 @@
+#pragma once
+
+#include "EditJournal.h"
+
+namespace SpireVoxel {
+
+    // A timestamped stream of edits that can be saved and replayed against the world it was recorded in (see EditReplay)
+    // Each edit is recorded as what it wrote (run length encoded like EditJournal)
+    // and as itself if it has an IVoxelEdit::RecordedType, so the replay runs the edit's own Apply instead of writing the voxels back
+    // See documentation (root directory of repo) for format spec
+    class EditRecording {
+    public:
+        struct Edit {
+            float TimeMillis; // since the recording started
+            std::vector<EditJournal::ChunkDelta> Chunks;
+            IVoxelEdit::RecordedType Type = IVoxelEdit::RecordedType::NONE;
+            std::string Description = {}; // written by IVoxelEdit::Record, empty if Type is NONE
+        };
+
+    public:
+        // Timestamps start from now
+        EditRecording() = default;
+
+    public:
+        // Applies the edit and records it and the voxels it changed, owner thread only
+        // The voxels can only be recorded for edits that know which chunks they write to (IVoxelEdit::GetWrittenChunks)
+        // an edit with neither those nor a RecordedType is applied but can't be recorded
+        void Apply(VoxelWorld &world, IVoxelEdit &edit);
+
+        void Add(Edit edit);
+
+        [[nodiscard]] const std::vector<Edit> &GetEdits() const { return m_edits; }
+
+        // Voxels written by every edit
+        [[nodiscard]] std::size_t CountWrittenVoxels() const;
+
+        // Overwrites any existing file, returns false if it couldn't be written
+        bool Save(const std::filesystem::path &path) const;
+
+        [[nodiscard]] static std::optional<EditRecording> Load(const std::filesystem::path &path);
+
+        // The edit to replay: the recorded edit itself, or one that writes the recorded voxels if it has no RecordedType
+        // The edit may reference edit, null if the description is invalid or its record header doesn't match this build
+        [[nodiscard]] static std::unique_ptr<IVoxelEdit> CreateEdit(const Edit &edit);
+
+        // The description Apply saves for an edit with a RecordedType, a record header then IVoxelEdit::Record
+        [[nodiscard]] static std::string Describe(const IVoxelEdit &edit);
+
+    public:
+        static constexpr std::uint32_t VERSION = 3;
+
+    private:
+        static constexpr std::array<char, 10> HEADER_IDENTIFIER{'S', 'P', 'R', 'V', 'X', 'L', 'E', 'D', 'I', 'T'};
+        // starts every description, the byte order mark reads back swapped if the file was written on a machine with the other byte order
+        static constexpr std::array<char, 4> RECORD_IDENTIFIER{'S', 'V', 'E', 'R'};
+        static constexpr glm::u16 RECORD_BYTE_ORDER_MARK = 0xFEFF;
+
+        static void WriteRecordHeader(std::ostream &stream);
+
+        // Returns false if the stream doesn't start with a record header this build can read
+        [[nodiscard]] static bool ReadRecordHeader(std::istream &stream);
+
+        // Read an edit's recorded type and description, false if it can't be recreated
+        [[nodiscard]] static bool ReadDescription(std::ifstream &file, std::uint32_t version, Edit &edit);
+
+        Spire::Timer m_timer;
+        std::vector<Edit> m_edits;
+    };
+} // SpireVoxel
@@ -0,0 +1,117 @@
+#include "EditReplay.h"
+
+#include "Rendering/VoxelWorldRenderer.h"
+
+#include <thread>
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    void NullChunkMeshUploader::Upload(std::unordered_map<Chunk *, ChunkMesh> &meshes) {
+        for (const auto &[chunk, mesh] : meshes) {
+            std::size_t size = mesh.CountVertices() * sizeof(VertexData) + mesh.VoxelTypes.size() * sizeof(VoxelType) + mesh.AOData.size() * sizeof(glm::u32);
+            if (m_staging.size() < size) m_staging.resize(size);
+
+            std::byte *destination = m_staging.data();
+            for (const std::vector<VertexData> &vertices : mesh.Vertices) {
+                std::memcpy(destination, vertices.data(), vertices.size() * sizeof(VertexData));
+                destination += vertices.size() * sizeof(VertexData);
+            }
+            std::memcpy(destination, mesh.VoxelTypes.data(), mesh.VoxelTypes.size() * sizeof(VoxelType));
+            destination += mesh.VoxelTypes.size() * sizeof(VoxelType);
+            std::memcpy(destination, mesh.AOData.data(), mesh.AOData.size() * sizeof(glm::u32));
+            m_uploadedBytes += size;
+        }
+    }
+
+    void RendererChunkMeshUploader::Upload(std::unordered_map<Chunk *, ChunkMesh> &meshes) {
+        m_renderer.UploadChunkMeshes(meshes);
+    }
+
+    EditReplay::Result EditReplay::Replay(VoxelWorld &world, const EditRecording &recording, IChunkMeshUploader &uploader) {
+        return Replay(world, recording, uploader, Settings{});
+    }
+
+    EditReplay::Result EditReplay::Replay(VoxelWorld &world, const EditRecording &recording, IChunkMeshUploader &uploader, Settings settings) {
+        assert(world.IsOwnerThread());
+
+        // recreate every edit first, a record from another format version or byte order stops the replay before anything is applied
+        std::vector<std::unique_ptr<IVoxelEdit> > voxelEdits;
+        voxelEdits.reserve(recording.GetEdits().size());
+        for (const EditRecording::Edit &edit : recording.GetEdits()) {
+            voxelEdits.push_back(EditRecording::CreateEdit(edit));
+            if (!voxelEdits.back()) {
+                Spire::error("[EditReplay] Edit {} of the recording can't be recreated, not replaying", voxelEdits.size() - 1);
+                return {};
+            }
+        }
+
+        // start from nothing queued so every edit only meshes its own chunks
+        VoxelWorldRenderer &renderer = world.GetRenderer();
+        renderer.QueueEditedChunks();
+        std::unordered_map<Chunk *, ChunkMesh> pendingMeshes = renderer.MeshQueuedChunks();
+        uploader.Upload(pendingMeshes);
+
+        Result result;
+        result.NumEdits = recording.GetEdits().size();
+        for (std::vector<float> &millis : result.StageMillis) millis.reserve(result.NumEdits);
+
+        Spire::Timer replayTimer;
+        Spire::Timer stageTimer;
+        for (std::size_t i = 0; i < voxelEdits.size(); i++) {
+            const EditRecording::Edit &edit = recording.GetEdits()[i];
+            IVoxelEdit &voxelEdit = *voxelEdits[i];
+            if (settings.FollowTimestamps) {
+                float waitMillis = edit.TimeMillis - replayTimer.MillisSinceStart();
+                if (waitMillis > 0) std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(waitMillis));
+            }
+
+            // the edit's own Apply, which notifies the renderer of the chunks whose meshes changed
+            stageTimer.Restart();
+            voxelEdit.Apply(world);
+            result.StageMillis[STAGE_APPLY].push_back(stageTimer.MillisSinceStart());
+
+            stageTimer.Restart();
+            renderer.QueueEditedChunks();
+            result.StageMillis[STAGE_NOTIFY].push_back(stageTimer.MillisSinceStart());
+
+            stageTimer.Restart();
+            std::unordered_map<Chunk *, ChunkMesh> meshes = renderer.MeshQueuedChunks();
+            result.StageMillis[STAGE_REMESH].push_back(stageTimer.MillisSinceStart());
+
+            stageTimer.Restart();
+            uploader.Upload(meshes);
+            result.StageMillis[STAGE_UPLOAD].push_back(stageTimer.MillisSinceStart());
+
+            float total = 0;
+            for (glm::u32 stage = 0; stage < STAGE_TOTAL; stage++) total += result.StageMillis[stage].back();
+            result.StageMillis[STAGE_TOTAL].push_back(total);
+            result.NumMeshedChunks += meshes.size();
+        }
+        result.TimeMillis = replayTimer.MillisSinceStart();
+
+        if (LOG) Spire::info("[EditReplay] Replayed {} edits in {} ms: {}", result.NumEdits, result.TimeMillis, result.ToJson());
+        return result;
+    }
+
+    EditReplay::Percentiles EditReplay::CalculatePercentiles(std::vector<float> millis) {
+        if (millis.empty()) return {};
+        std::ranges::sort(millis);
+
+        auto percentile = [&](float p) {
+            auto rank = static_cast<std::size_t>(std::ceil(p / 100.0f * static_cast<float>(millis.size())));
+            return millis[std::clamp<std::size_t>(rank, 1, millis.size()) - 1];
+        };
+        return {percentile(50), percentile(90), percentile(99), millis.back()};
+    }
+
+    std::string EditReplay::Result::ToJson() const {
+        std::string json = std::format(R"({{"edits": {}, "meshed_chunks": {}, "time_ms": {})", NumEdits, NumMeshedChunks, TimeMillis);
+        for (glm::u32 stage = 0; stage < NUM_STAGES; stage++) {
+            Percentiles percentiles = GetPercentiles(static_cast<Stage>(stage));
+            json += std::format(R"(, "{}": {{"p50_ms": {}, "p90_ms": {}, "p99_ms": {}, "max_ms": {}}})",
+                                STAGE_NAMES[stage], percentiles.P50, percentiles.P90, percentiles.P99, percentiles.Max);
+        }
+        return json + "}";
+    }
+} // SpireVoxel
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "EditRecording.h"
+#include "Chunk/Meshing/ChunkMesh.h"
+
+namespace SpireVoxel {
+
+    // Receives the meshes EditReplay generates
+    class IChunkMeshUploader {
+    public:
+        virtual ~IChunkMeshUploader() = default;
+
+    public:
+        // The meshes can be freed once this returns
+        virtual void Upload(std::unordered_map<Chunk *, ChunkMesh> &meshes) = 0;
+    };
+
+    // Copies the meshes into reused CPU memory, measures an upload without a GPU
+    class NullChunkMeshUploader : public IChunkMeshUploader {
+    public:
+        void Upload(std::unordered_map<Chunk *, ChunkMesh> &meshes) override;
+
+        [[nodiscard]] glm::u64 GetUploadedBytes() const { return m_uploadedBytes; }
+
+    private:
+        std::vector<std::byte> m_staging;
+        glm::u64 m_uploadedBytes = 0;
+    };
+
+    // Uploads to the GPU through the world's renderer, like meshes from edits made while playing
+    class RendererChunkMeshUploader : public IChunkMeshUploader {
+    public:
+        explicit RendererChunkMeshUploader(VoxelWorldRenderer &renderer) : m_renderer(renderer) {
+        }
+
+        void Upload(std::unordered_map<Chunk *, ChunkMesh> &meshes) override;
+
+    private:
+        VoxelWorldRenderer &m_renderer;
+    };
+
+    // Replays an EditRecording against the world it was recorded in (e.g. just loaded with VoxelSerializer::ClearAndDeserialize)
+    // Every edit is taken through the same path as edits made while playing, synchronously, and each stage is timed:
+    // - Apply: the recorded edit's IVoxelEdit::Apply (see EditRecording::CreateEdit), which notifies the renderer
+    // - Notify: moving the notified chunks into the ChunkMesher's queue
+    // - Remesh: the ChunkMesher meshing them on the task graph
+    // - Upload: passing the meshes to the uploader
+    // Nothing is left for the renderer to remesh, so this doesn't need frames to be rendered
+    class EditReplay {
+    public:
+        enum Stage {
+            STAGE_APPLY,
+            STAGE_NOTIFY,
+            STAGE_REMESH,
+            STAGE_UPLOAD,
+            STAGE_TOTAL,
+            NUM_STAGES
+        };
+
+        static constexpr std::array<const char *, NUM_STAGES> STAGE_NAMES = {"apply", "notify", "remesh", "upload", "total"};
+
+        struct Settings {
+            bool FollowTimestamps = false; // wait until each edit's time in the recording, otherwise replay as fast as possible
+        };
+
+        struct Percentiles {
+            float P50 = 0;
+            float P90 = 0;
+            float P99 = 0;
+            float Max = 0;
+        };
+
+        struct Result {
+            std::size_t NumEdits = 0;
+            std::size_t NumMeshedChunks = 0;
+            float TimeMillis = 0; // includes waiting for timestamps
+            std::array<std::vector<float>, NUM_STAGES> StageMillis; // per edit
+
+            [[nodiscard]] Percentiles GetPercentiles(Stage stage) const { return CalculatePercentiles(StageMillis[stage]); }
+
+            // Percentiles of every stage as a json object
+            [[nodiscard]] std::string ToJson() const;
+        };
+
+    public:
+        // Owner thread only
+        [[nodiscard]] static Result Replay(VoxelWorld &world, const EditRecording &recording, IChunkMeshUploader &uploader);
+
+        [[nodiscard]] static Result Replay(VoxelWorld &world, const EditRecording &recording, IChunkMeshUploader &uploader, Settings settings);
+
+        // Nearest rank percentiles
+        [[nodiscard]] static Percentiles CalculatePercentiles(std::vector<float> millis);
+    };
+} // SpireVoxel
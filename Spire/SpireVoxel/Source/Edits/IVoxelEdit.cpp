@@ -0,0 +1,136 @@
+#include "IVoxelEdit.h"
+
+#include "Chunk/VoxelKernels.h"
+#include "Utils/TaskGraph.h"
+
+namespace SpireVoxel {
+    static thread_local bool t_applyingInParallel = false;
+
+    void IVoxelEdit::ParallelFor(std::size_t count, const std::function<void(std::size_t)> &function) {
+        if (count <= 1 || t_applyingInParallel) {
+            for (std::size_t i = 0; i < count; i++) function(i);
+            return;
+        }
+
+        // the player is waiting on the edit
+        Spire::TaskGraph::Instance().ParallelFor(0, count, [&](std::size_t i) {
+            bool wasApplyingInParallel = t_applyingInParallel;
+            t_applyingInParallel = true;
+            function(i);
+            t_applyingInParallel = wasApplyingInParallel;
+        }, Spire::TaskPriority::Interactive);
+    }
+
+    glm::u32 IVoxelEdit::GetAffectedNeighbours(glm::uvec3 positionInChunk) {
+        return GetAffectedNeighbours(positionInChunk, positionInChunk);
+    }
+
+    glm::u32 IVoxelEdit::GetAffectedNeighbours(glm::uvec3 min, glm::uvec3 max) {
+        assert(max.x < SPIRE_VOXEL_CHUNK_SIZE && max.y < SPIRE_VOXEL_CHUNK_SIZE && max.z < SPIRE_VOXEL_CHUNK_SIZE);
+        assert(min.x <= max.x && min.y <= max.y && min.z <= max.z);
+
+        // per axis, the offsets of the chunks that read the voxels
+        glm::ivec3 minOffset = {};
+        glm::ivec3 maxOffset = {};
+        for (glm::u32 axis = 0; axis < 3; axis++) {
+            if (min[axis] == 0) minOffset[axis] = -1;
+            if (max[axis] == SPIRE_VOXEL_CHUNK_SIZE - 1) maxOffset[axis] = 1;
+        }
+        // interior voxels are only read by their own chunk
+        if (minOffset == glm::ivec3(0) && maxOffset == glm::ivec3(0)) return OWN_CHUNK_NEIGHBOUR_BIT;
+
+        glm::u32 affected = 0;
+        for (glm::i32 x = minOffset.x; x <= maxOffset.x; x++) {
+            for (glm::i32 y = minOffset.y; y <= maxOffset.y; y++) {
+                for (glm::i32 z = minOffset.z; z <= maxOffset.z; z++) {
+                    affected |= 1u << ((x + 1) * 9 + (y + 1) * 3 + (z + 1));
+                }
+            }
+        }
+        return affected;
+    }
+
+    glm::u32 IVoxelEdit::GetAffectedNeighbours(glm::u32 startIndex, glm::u32 endIndex) {
+        assert(startIndex < endIndex && endIndex <= SPIRE_VOXEL_CHUNK_VOLUME);
+
+        // within a Z column only the first and last voxel can be on a Z boundary, and the X/Y boundaries are the same for the whole column
+        glm::u32 affected = 0;
+        glm::u32 columnStart = startIndex;
+        while (columnStart < endIndex) {
+            glm::u32 columnEnd = std::min(endIndex, (columnStart / SPIRE_VOXEL_CHUNK_SIZE + 1) * SPIRE_VOXEL_CHUNK_SIZE);
+            affected |= GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, columnStart));
+            affected |= GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, columnEnd - 1));
+            columnStart = columnEnd;
+        }
+        return affected;
+    }
+
+    // columnUnchanged(start, end) is true if no voxel in [start, end) would change, presenceChanges(index) if the voxel would change between air and not air
+    template<typename ColumnUnchanged, typename PresenceChanges>
+    static glm::u32 CalculateChangedNeighbours(glm::u32 startIndex, glm::u32 endIndex, ColumnUnchanged columnUnchanged, PresenceChanges presenceChanges) {
+        assert(startIndex < endIndex && endIndex <= SPIRE_VOXEL_CHUNK_VOLUME);
+
+        glm::u32 changed = 0;
+        glm::u32 columnStart = startIndex;
+        while (columnStart < endIndex) {
+            glm::u32 columnEnd = std::min(endIndex, (columnStart / SPIRE_VOXEL_CHUNK_SIZE + 1) * SPIRE_VOXEL_CHUNK_SIZE);
+            if (columnUnchanged(columnStart, columnEnd)) {
+                columnStart = columnEnd;
+                continue;
+            }
+            changed |= IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT;
+
+            glm::uvec3 columnPosition = SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, columnStart);
+            bool onBoundary = columnPosition.x == 0 || columnPosition.x == SPIRE_VOXEL_CHUNK_SIZE - 1 ||
+                              columnPosition.y == 0 || columnPosition.y == SPIRE_VOXEL_CHUNK_SIZE - 1;
+            if (onBoundary) {
+                // every voxel of the column is on an X/Y face, the ends may also be on a Z face
+                glm::u32 columnAffected = IVoxelEdit::GetAffectedNeighbours(glm::uvec3(columnPosition.x, columnPosition.y, 1));
+                for (glm::u32 index = columnStart; index < columnEnd; index++) {
+                    if (!presenceChanges(index)) continue;
+                    glm::u32 z = index % SPIRE_VOXEL_CHUNK_SIZE;
+                    changed |= z == 0 || z == SPIRE_VOXEL_CHUNK_SIZE - 1 ? IVoxelEdit::GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, index)) : columnAffected;
+                }
+            } else {
+                // only the ends of the column can be on a face
+                if (columnStart % SPIRE_VOXEL_CHUNK_SIZE == 0 && presenceChanges(columnStart)) {
+                    changed |= IVoxelEdit::GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, columnStart));
+                }
+                if (columnEnd % SPIRE_VOXEL_CHUNK_SIZE == 0 && presenceChanges(columnEnd - 1)) {
+                    changed |= IVoxelEdit::GetAffectedNeighbours(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, columnEnd - 1));
+                }
+            }
+            columnStart = columnEnd;
+        }
+        return changed;
+    }
+
+    glm::u32 IVoxelEdit::GetChangedNeighbours(const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels, glm::u32 startIndex, glm::u32 endIndex, VoxelType type) {
+        bool present = type != VOXEL_TYPE_AIR;
+        return CalculateChangedNeighbours(startIndex, endIndex,
+                                          [&](glm::u32 start, glm::u32 end) { return VoxelKernels::AllEqual(voxels.data() + start, end - start, type); },
+                                          [&](glm::u32 index) { return (voxels[index] != VOXEL_TYPE_AIR) != present; });
+    }
+
+    glm::u32 IVoxelEdit::GetChangedNeighbours(const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels, glm::u32 startIndex, std::span<const VoxelType> types) {
+        return CalculateChangedNeighbours(startIndex, startIndex + static_cast<glm::u32>(types.size()),
+                                          [&](glm::u32 start, glm::u32 end) { return VoxelKernels::Equal(voxels.data() + start, types.data() + (start - startIndex), end - start); },
+                                          [&](glm::u32 index) { return (voxels[index] != VOXEL_TYPE_AIR) != (types[index - startIndex] != VOXEL_TYPE_AIR); });
+    }
+
+    void IVoxelEdit::AddAffectedChunks(glm::ivec3 chunkPosition, glm::u32 affectedNeighbours, std::unordered_set<glm::ivec3> &affectedChunks) {
+        for (glm::u32 bit = 0; bit < 27; bit++) {
+            if (!(affectedNeighbours & (1u << bit))) continue;
+            affectedChunks.insert(chunkPosition + GetNeighbourOffset(bit));
+        }
+    }
+
+    void IVoxelEdit::NotifyChunkEdits(VoxelWorld &world, const std::unordered_set<glm::ivec3> &chunkPositions) {
+        for (const glm::ivec3 &chunkPosition : chunkPositions) {
+            Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (chunk) {
+                NotifyChunkEdit(world, *chunk);
+            }
+        }
+    }
+} // SpireVoxel
@@ -9,15 +9,71 @@ namespace SpireVoxel {
     // Represents a bulk edit operation which can be applied
     // This API avoids regenerating meshes every single time a voxel is changed if you need to change a voxel many times
     class IVoxelEdit {
+    public:
+        // Edits an EditRecording can save as themselves and recreate to replay, other edits are recorded as the voxels they changed
+        enum class RecordedType : glm::u8 {
+            NONE,
+            BASIC,
+            CUBOID
+        };
+
     public:
         virtual ~IVoxelEdit() = default;
 
     public:
         virtual void Apply(VoxelWorld &world) = 0;
 
+        // Chunks whose voxels Apply writes to, edits that write to different chunks can be applied at the same time (see MergedVoxelEdit)
+        // nullopt if it isn't known before applying, the edit is then never applied at the same time as another edit
+        [[nodiscard]] virtual std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const { return std::nullopt; }
+
+        [[nodiscard]] virtual RecordedType GetRecordedType() const { return RecordedType::NONE; }
+
+        // Write what the edit's ReadRecord needs to recreate it (see EditRecording), only called if GetRecordedType isn't NONE
+        // Values are written raw in the machine's byte order, EditRecording puts a header with RECORD_VERSION and the byte order before it
+        virtual void Record(std::ostream &stream) const {
+        }
+
+        // Bump when the layout written by any edit's Record changes
+        static constexpr glm::u16 RECORD_VERSION = 1;
+
+        // Meshes read one voxel into adjacent chunks (faces and AO), so editing a voxel on the boundary of a chunk can change up to 7 other meshes
+        // Bit (x + 1) * 9 + (y + 1) * 3 + (z + 1) is set for each offset (x, y, z) in [-1, 1] of a chunk whose mesh reads the voxel
+        // The voxel's own chunk (OWN_CHUNK_NEIGHBOUR_BIT) is always set
+        [[nodiscard]] static glm::u32 GetAffectedNeighbours(glm::uvec3 positionInChunk);
+
+        // GetAffectedNeighbours of every voxel in [startIndex, endIndex)
+        [[nodiscard]] static glm::u32 GetAffectedNeighbours(glm::u32 startIndex, glm::u32 endIndex);
+
+        // GetAffectedNeighbours of every voxel in the box from min to max (inclusive)
+        [[nodiscard]] static glm::u32 GetAffectedNeighbours(glm::uvec3 min, glm::uvec3 max);
+
+        // The chunks whose meshes actually change if voxels [startIndex, endIndex) are set to type, must be called before writing them, 0 if no voxel would change
+        // A chunk's own mesh depends on the types of its voxels, but neighbours only read whether a voxel is air (for AO)
+        // so neighbours are only included for border voxels that change between air and not air
+        [[nodiscard]] static glm::u32 GetChangedNeighbours(const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels, glm::u32 startIndex, glm::u32 endIndex, VoxelType type);
+
+        // GetChangedNeighbours if types are copied to voxels [startIndex, startIndex + types.size())
+        [[nodiscard]] static glm::u32 GetChangedNeighbours(const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels, glm::u32 startIndex, std::span<const VoxelType> types);
+
+        // The chunk offset of a bit in a GetAffectedNeighbours / GetChangedNeighbours mask
+        [[nodiscard]] static glm::ivec3 GetNeighbourOffset(glm::u32 bit) { return glm::ivec3(bit / 9, (bit / 3) % 3, bit % 3) - glm::ivec3(1); }
+
+        // Insert the chunk and its neighbours set in affectedNeighbours
+        static void AddAffectedChunks(glm::ivec3 chunkPosition, glm::u32 affectedNeighbours, std::unordered_set<glm::ivec3> &affectedChunks);
+
+        static constexpr glm::u32 OWN_CHUNK_NEIGHBOUR_BIT = 1 << 13;
+
     protected:
         static void NotifyChunkEdit(const VoxelWorld& world, Chunk& chunk) {
             world.GetRenderer().NotifyChunkEdited(chunk);
         }
+
+        // NotifyChunkEdit for each of the chunks that is loaded
+        static void NotifyChunkEdits(VoxelWorld &world, const std::unordered_set<glm::ivec3> &chunkPositions);
+
+        // Calls function for [0, count) as Interactive tasks on the task graph and waits for them to finish
+        // Runs serially if this edit is already being applied in parallel (e.g. inside a MergedVoxelEdit), the outer loop already uses the workers
+        static void ParallelFor(std::size_t count, const std::function<void(std::size_t)> &function);
     };
 } // SpireVoxel
@@ -0,0 +1,66 @@
+#include "MaskVoxelEdit.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    MaskVoxelEdit::MaskVoxelEdit(std::shared_ptr<const FloodFill::ChunkMasks> masks, VoxelType type)
+        : m_masks(std::move(masks)),
+          m_type(type) {
+        assert(m_masks);
+    }
+
+    void MaskVoxelEdit::Apply(VoxelWorld &world) {
+        Spire::Timer timer;
+
+        std::vector<std::pair<Chunk *, const VoxelBitmask *> > chunks;
+        for (const auto &[chunkPosition, mask] : *m_masks) {
+            Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (!chunk) {
+                Spire::warn("Failed to apply mask to chunk {} {} {} because it wasn't loaded", chunkPosition.x, chunkPosition.y, chunkPosition.z);
+                continue;
+            }
+            chunks.emplace_back(chunk, &mask);
+        }
+
+        std::vector<glm::u32> changedNeighbours(chunks.size(), 0);
+        ParallelFor(chunks.size(), [&](std::size_t i) {
+            Chunk &chunk = *chunks[i].first;
+            ForEachRun(*chunks[i].second, [&](glm::u32 startIndex, glm::u32 endIndex) {
+                glm::u32 changed = GetChangedNeighbours(chunk.GetVoxelData(), startIndex, endIndex, m_type);
+                if (changed == 0) return;
+                chunk.SetVoxels(startIndex, endIndex, m_type);
+                changedNeighbours[i] |= changed;
+            });
+            assert(!chunk.IsCorrupted());
+        });
+
+        std::unordered_set<glm::ivec3> affectedChunks;
+        for (std::size_t i = 0; i < chunks.size(); i++) {
+            AddAffectedChunks(chunks[i].first->ChunkPosition, changedNeighbours[i], affectedChunks);
+        }
+        NotifyChunkEdits(world, affectedChunks);
+
+        if (LOG) Spire::info("[MaskVoxelEdit] Applied masks to {} chunks in {} ms", chunks.size(), timer.MillisSinceStart());
+    }
+
+    std::optional<std::vector<glm::ivec3> > MaskVoxelEdit::GetWrittenChunks() const {
+        std::vector<glm::ivec3> chunks;
+        chunks.reserve(m_masks->size());
+        for (const auto &[chunkPosition, _] : *m_masks) chunks.push_back(chunkPosition);
+        return chunks;
+    }
+
+    void MaskVoxelEdit::ForEachRun(const VoxelBitmask &mask, const std::function<void(glm::u32 startIndex, glm::u32 endIndex)> &onRun) {
+        for (std::size_t word = 0; word < VoxelBitmask::NUM_WORDS; word++) {
+            glm::u64 row = mask.GetWord(word);
+            auto rowStart = static_cast<glm::u32>(word * VoxelBitmask::BITS_PER_WORD);
+            while (row != 0) {
+                auto start = static_cast<glm::u32>(std::countr_zero(row));
+                auto length = static_cast<glm::u32>(std::countr_one(row >> start));
+                onRun(rowStart + start, rowStart + start + length);
+                if (start + length == VoxelBitmask::BITS_PER_WORD) break;
+                row &= ~glm::u64(0) << (start + length);
+            }
+        }
+    }
+} // SpireVoxel
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "IVoxelEdit.h"
+#include "Utils/FloodFill.h"
+
+namespace SpireVoxel {
+
+    // Sets every voxel in per chunk masks (e.g. the result of a FloodFill) to a type
+    // Each run of set bits in a row is written with a single SetVoxels, chunks are written in parallel on the task graph
+    // Can only edit voxels in loaded chunks
+    class MaskVoxelEdit : public IVoxelEdit {
+    public:
+        MaskVoxelEdit(std::shared_ptr<const FloodFill::ChunkMasks> masks, VoxelType type);
+
+    public:
+        void Apply(VoxelWorld &world) override;
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+        // Calls onRun(startIndex, endIndex) for each run of set bits in the mask
+        static void ForEachRun(const VoxelBitmask &mask, const std::function<void(glm::u32 startIndex, glm::u32 endIndex)> &onRun);
+
+    private:
+        std::shared_ptr<const FloodFill::ChunkMasks> m_masks;
+        VoxelType m_type;
+    };
+} // SpireVoxel
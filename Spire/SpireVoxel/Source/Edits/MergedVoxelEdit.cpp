@@ -1,19 +1,94 @@
 #include "MergedVoxelEdit.h"
 
+#include <numeric>
+
 namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
     MergedVoxelEdit::MergedVoxelEdit(std::vector<std::unique_ptr<IVoxelEdit> > &&edits)
         : m_edits(std::move(edits)) {
     }
 
     void MergedVoxelEdit::Apply(VoxelWorld &world) {
         if (m_edits.empty()) Spire::warn("Applying MergedVoxelEdit with no edits");
+
+        std::vector<std::optional<std::vector<glm::ivec3> > > writtenChunks;
+        writtenChunks.reserve(m_edits.size());
+        for (auto &edit : m_edits) {
+            writtenChunks.push_back(edit->GetWrittenChunks());
+        }
+
+        Spire::Timer timer;
+        ApplyPartitioned(writtenChunks, [&](std::size_t i) {
+            m_edits[i]->Apply(world);
+        });
+        if (LOG) Spire::info("[MergedVoxelEdit] Applied {} edits in {} ms", m_edits.size(), timer.MillisSinceStart());
+    }
+
+    std::optional<std::vector<glm::ivec3> > MergedVoxelEdit::GetWrittenChunks() const {
+        std::unordered_set<glm::ivec3> chunks;
         for (auto &edit : m_edits) {
-            edit->Apply(world);
+            std::optional<std::vector<glm::ivec3> > editChunks = edit->GetWrittenChunks();
+            if (!editChunks) return std::nullopt;
+            chunks.insert(editChunks->begin(), editChunks->end());
         }
+        return std::vector<glm::ivec3>(chunks.begin(), chunks.end());
     }
 
     MergedVoxelEdit &MergedVoxelEdit::With(std::unique_ptr<IVoxelEdit> edit) {
         m_edits.push_back(std::move(edit));
         return *this;
     }
+
+    void MergedVoxelEdit::ApplyPartitioned(const std::vector<std::optional<std::vector<glm::ivec3> > > &writtenChunks, const std::function<void(std::size_t)> &apply) {
+        std::size_t begin = 0;
+        while (begin < writtenChunks.size()) {
+            // edits up to the next one with unknown chunks can be partitioned
+            std::size_t end = begin;
+            std::vector<const std::vector<glm::ivec3> *> segment;
+            while (end < writtenChunks.size() && writtenChunks[end]) {
+                segment.push_back(&writtenChunks[end].value());
+                end++;
+            }
+
+            std::vector<std::vector<std::size_t> > groups = PartitionEdits(segment);
+            ParallelFor(groups.size(), [&](std::size_t group) {
+                for (std::size_t i : groups[group]) apply(begin + i);
+            });
+
+            if (end < writtenChunks.size()) apply(end);
+            begin = end + 1;
+        }
+    }
+
+    std::vector<std::vector<std::size_t> > MergedVoxelEdit::PartitionEdits(const std::vector<const std::vector<glm::ivec3> *> &writtenChunks) {
+        // union-find, edits are joined when they write to the same chunk
+        std::vector<std::size_t> parents(writtenChunks.size());
+        std::iota(parents.begin(), parents.end(), 0);
+        auto find = [&](std::size_t i) {
+            while (parents[i] != i) {
+                parents[i] = parents[parents[i]];
+                i = parents[i];
+            }
+            return i;
+        };
+
+        std::unordered_map<glm::ivec3, std::size_t> chunkEdits;
+        for (std::size_t i = 0; i < writtenChunks.size(); i++) {
+            for (const glm::ivec3 &chunk : *writtenChunks[i]) {
+                auto [it, inserted] = chunkEdits.try_emplace(chunk, i);
+                if (!inserted) parents[find(i)] = find(it->second);
+            }
+        }
+
+        // edits are visited in order so every group stays sorted
+        std::vector<std::vector<std::size_t> > groups;
+        std::unordered_map<std::size_t, std::size_t> rootGroups;
+        for (std::size_t i = 0; i < writtenChunks.size(); i++) {
+            auto [it, inserted] = rootGroups.try_emplace(find(i), groups.size());
+            if (inserted) groups.emplace_back();
+            groups[it->second].push_back(i);
+        }
+        return groups;
+    }
 } // SpireVoxel
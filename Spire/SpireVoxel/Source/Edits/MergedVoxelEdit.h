@@ -6,6 +6,8 @@ namespace SpireVoxel {
     concept VoxelEditType = std::is_base_of_v<IVoxelEdit, T>;
 
     // Combines multiple IVoxelEdit into a single edit
+    // Edits that write to different chunks are applied in parallel on the task graph
+    // The result is the same as applying the edits in order, edits writing to the same chunk are applied in order on the same thread
     class MergedVoxelEdit final : public IVoxelEdit {
     public:
         explicit MergedVoxelEdit(std::vector<std::unique_ptr<IVoxelEdit> > &&edits);
@@ -18,6 +20,9 @@ namespace SpireVoxel {
     public:
         void Apply(VoxelWorld &world) override;
 
+        // Every chunk written to by the edits, nullopt if any edit doesn't know
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
         MergedVoxelEdit &With(std::unique_ptr<IVoxelEdit> edit);
 
         template<typename VoxelEditType>
@@ -26,6 +31,13 @@ namespace SpireVoxel {
             return *this;
         }
 
+        // Calls apply for each edit index so the result is the same as calling it for 0, 1, 2... in order
+        // writtenChunks[i] is the chunks edit i writes to, edits with nullopt are applied on their own after every earlier edit
+        static void ApplyPartitioned(const std::vector<std::optional<std::vector<glm::ivec3> > > &writtenChunks, const std::function<void(std::size_t)> &apply);
+
+        // Splits edits into groups where no two groups write to the same chunk, each group is sorted so it can be applied in order
+        [[nodiscard]] static std::vector<std::vector<std::size_t> > PartitionEdits(const std::vector<const std::vector<glm::ivec3> *> &writtenChunks);
+
     private:
         std::vector<std::unique_ptr<IVoxelEdit>> m_edits;
     };
@@ -0,0 +1,71 @@
+#include "PasteVoxelEdit.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    PasteVoxelEdit::PasteVoxelEdit(std::shared_ptr<const VoxelRegion> region, glm::ivec3 origin, bool pasteAir)
+        : m_region(std::move(region)),
+          m_origin(origin),
+          m_pasteAir(pasteAir) {
+        assert(m_region);
+    }
+
+    void PasteVoxelEdit::Apply(VoxelWorld &world) {
+        Spire::Timer timer;
+
+        std::vector<Chunk *> chunks;
+        for (const glm::ivec3 &chunkPosition : VoxelRegion::GetChunksInBox(m_origin, m_region->GetSize())) {
+            Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (!chunk) {
+                Spire::warn("Failed to paste part of a region in chunk {} {} {} because it wasn't loaded", chunkPosition.x, chunkPosition.y, chunkPosition.z);
+                continue;
+            }
+            chunks.push_back(chunk);
+        }
+
+        std::span<const VoxelType> regionVoxels = m_region->GetVoxels();
+        std::vector<glm::u32> changedNeighbours(chunks.size(), 0);
+        ParallelFor(chunks.size(), [&](std::size_t i) {
+            Chunk &chunk = *chunks[i];
+            auto write = [&](glm::u32 chunkIndex, std::span<const VoxelType> types) {
+                glm::u32 changed = GetChangedNeighbours(chunk.GetVoxelData(), chunkIndex, types);
+                if (changed == 0) return;
+                chunk.SetVoxels(chunkIndex, types);
+                changedNeighbours[i] |= changed;
+            };
+
+            VoxelRegion::ForEachRowInChunk(m_origin, m_region->GetSize(), chunk.ChunkPosition, [&](glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length) {
+                std::span<const VoxelType> row = regionVoxels.subspan(regionIndex, length);
+                if (m_pasteAir) {
+                    write(chunkIndex, row);
+                    return;
+                }
+
+                // only write the parts of the row that aren't air
+                glm::u32 index = 0;
+                while (index < length) {
+                    if (row[index] == VOXEL_TYPE_AIR) {
+                        index++;
+                        continue;
+                    }
+                    glm::u32 runStart = index;
+                    while (index < length && row[index] != VOXEL_TYPE_AIR) index++;
+                    write(chunkIndex + runStart, row.subspan(runStart, index - runStart));
+                }
+            });
+            assert(!chunk.IsCorrupted());
+        });
+
+        std::unordered_set<glm::ivec3> affectedChunks;
+        for (std::size_t i = 0; i < chunks.size(); i++) {
+            AddAffectedChunks(chunks[i]->ChunkPosition, changedNeighbours[i], affectedChunks);
+        }
+        NotifyChunkEdits(world, affectedChunks);
+
+        if (LOG) Spire::info("[PasteVoxelEdit] Pasted {} voxels into {} chunks in {} ms", m_region->GetVolume(), chunks.size(), timer.MillisSinceStart());
+    }
+
+    std::optional<std::vector<glm::ivec3> > PasteVoxelEdit::GetWrittenChunks() const {
+        return VoxelRegion::GetChunksInBox(m_origin, m_region->GetSize());
+    }
+} // SpireVoxel
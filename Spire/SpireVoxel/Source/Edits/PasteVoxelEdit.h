@@ -0,0 +1,26 @@
+#pragma once
+
+#include "IVoxelEdit.h"
+#include "VoxelRegion.h"
+
+namespace SpireVoxel {
+
+    // Writes a VoxelRegion into the world with its minimum corner at origin
+    // Each row of the region inside a chunk is written with a single SetVoxels, chunks are written in parallel on the task graph
+    // Can only edit voxels in loaded chunks
+    class PasteVoxelEdit : public IVoxelEdit {
+    public:
+        // If pasteAir is false air in the region leaves the world's voxels unchanged (e.g. pasting a tree without clearing around it)
+        PasteVoxelEdit(std::shared_ptr<const VoxelRegion> region, glm::ivec3 origin, bool pasteAir = true);
+
+    public:
+        void Apply(VoxelWorld &world) override;
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+    private:
+        std::shared_ptr<const VoxelRegion> m_region;
+        glm::ivec3 m_origin;
+        bool m_pasteAir;
+    };
+} // SpireVoxel
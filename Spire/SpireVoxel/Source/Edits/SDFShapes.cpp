@@ -0,0 +1,136 @@
+#include "SDFShapes.h"
+
+// Distance functions from https://iquilezles.org/articles/distfunctions/
+
+namespace SpireVoxel {
+    SphereSDF::SphereSDF(glm::vec3 center, float radius)
+        : m_center(center),
+          m_radius(radius) {
+    }
+
+    float SphereSDF::Distance(glm::vec3 position) const {
+        return glm::length(position - m_center) - m_radius;
+    }
+
+    SDFBounds SphereSDF::GetBounds() const {
+        return {m_center - m_radius, m_center + m_radius};
+    }
+
+    CapsuleSDF::CapsuleSDF(glm::vec3 a, glm::vec3 b, float radius)
+        : m_a(a),
+          m_b(b),
+          m_radius(radius) {
+    }
+
+    float CapsuleSDF::Distance(glm::vec3 position) const {
+        glm::vec3 pa = position - m_a;
+        glm::vec3 ba = m_b - m_a;
+        float baba = glm::dot(ba, ba);
+        float h = baba > 0.0f ? glm::clamp(glm::dot(pa, ba) / baba, 0.0f, 1.0f) : 0.0f;
+        return glm::length(pa - ba * h) - m_radius;
+    }
+
+    SDFBounds CapsuleSDF::GetBounds() const {
+        return {glm::min(m_a, m_b) - m_radius, glm::max(m_a, m_b) + m_radius};
+    }
+
+    CylinderSDF::CylinderSDF(glm::vec3 a, glm::vec3 b, float radius)
+        : m_a(a),
+          m_b(b),
+          m_radius(radius) {
+        assert(a != b);
+    }
+
+    float CylinderSDF::Distance(glm::vec3 position) const {
+        glm::vec3 ba = m_b - m_a;
+        glm::vec3 pa = position - m_a;
+        float baba = glm::dot(ba, ba);
+        float paba = glm::dot(pa, ba);
+        float x = glm::length(pa * baba - ba * paba) - m_radius * baba;
+        float y = std::abs(paba - baba * 0.5f) - baba * 0.5f;
+        float x2 = x * x;
+        float y2 = y * y * baba;
+        float d = std::max(x, y) < 0.0f ? -std::min(x2, y2) : (x > 0.0f ? x2 : 0.0f) + (y > 0.0f ? y2 : 0.0f);
+        return std::copysign(std::sqrt(std::abs(d)), d) / baba;
+    }
+
+    SDFBounds CylinderSDF::GetBounds() const {
+        // the cylinder is inside the capsule with the same radius
+        return {glm::min(m_a, m_b) - m_radius, glm::max(m_a, m_b) + m_radius};
+    }
+
+    ConeSDF::ConeSDF(glm::vec3 a, glm::vec3 b, float radiusA, float radiusB)
+        : m_a(a),
+          m_b(b),
+          m_radiusA(radiusA),
+          m_radiusB(radiusB) {
+        assert(a != b);
+    }
+
+    float ConeSDF::Distance(glm::vec3 position) const {
+        float rba = m_radiusB - m_radiusA;
+        float baba = glm::dot(m_b - m_a, m_b - m_a);
+        float papa = glm::dot(position - m_a, position - m_a);
+        float paba = glm::dot(position - m_a, m_b - m_a) / baba;
+        float x = std::sqrt(std::max(0.0f, papa - paba * paba * baba));
+        float cax = std::max(0.0f, x - (paba < 0.5f ? m_radiusA : m_radiusB));
+        float cay = std::abs(paba - 0.5f) - 0.5f;
+        float k = rba * rba + baba;
+        float f = glm::clamp((rba * (x - m_radiusA) + paba * baba) / k, 0.0f, 1.0f);
+        float cbx = x - m_radiusA - f * rba;
+        float cby = paba - f;
+        float s = cbx < 0.0f && cay < 0.0f ? -1.0f : 1.0f;
+        return s * std::sqrt(std::min(cax * cax + cay * cay * baba, cbx * cbx + cby * cby * baba));
+    }
+
+    SDFBounds ConeSDF::GetBounds() const {
+        float radius = std::max(m_radiusA, m_radiusB);
+        return {glm::min(m_a, m_b) - radius, glm::max(m_a, m_b) + radius};
+    }
+
+    SmoothUnionSDF::SmoothUnionSDF(std::shared_ptr<const ISDFShape> a, std::shared_ptr<const ISDFShape> b, float smoothness)
+        : m_a(std::move(a)),
+          m_b(std::move(b)),
+          m_smoothness(smoothness) {
+        assert(m_a && m_b);
+    }
+
+    float SmoothUnionSDF::Distance(glm::vec3 position) const {
+        float a = m_a->Distance(position);
+        float b = m_b->Distance(position);
+        if (m_smoothness <= 0.0f) return std::min(a, b);
+        float h = glm::clamp(0.5f + 0.5f * (b - a) / m_smoothness, 0.0f, 1.0f);
+        return glm::mix(b, a, h) - m_smoothness * h * (1.0f - h);
+    }
+
+    SDFBounds SmoothUnionSDF::GetBounds() const {
+        // blending moves the surface outwards by at most smoothness / 4
+        return SDFBounds::Union(m_a->GetBounds(), m_b->GetBounds()).Expanded(std::max(0.0f, m_smoothness) * 0.25f);
+    }
+
+    SmoothSubtractSDF::SmoothSubtractSDF(std::shared_ptr<const ISDFShape> a, std::shared_ptr<const ISDFShape> b, float smoothness)
+        : m_a(std::move(a)),
+          m_b(std::move(b)),
+          m_smoothness(smoothness) {
+        assert(m_a && m_b);
+    }
+
+    float SmoothSubtractSDF::Distance(glm::vec3 position) const {
+        float a = m_a->Distance(position);
+        float b = m_b->Distance(position);
+        if (m_smoothness <= 0.0f) return std::max(a, -b);
+        float h = glm::clamp(0.5f - 0.5f * (a + b) / m_smoothness, 0.0f, 1.0f);
+        float distance = glm::mix(a, -b, h) + m_smoothness * h * (1.0f - h);
+
+        // the blended value can be up to smoothness / 4 more than max(a, -b), which is where the surface is measured from,
+        // so shrink it by that much to keep it a lower bound without moving the surface
+        float margin = m_smoothness * 0.25f;
+        if (distance > 0.0f) return std::max(distance - margin, std::numeric_limits<float>::min());
+        return std::min(distance + margin, 0.0f);
+    }
+
+    SDFBounds SmoothSubtractSDF::GetBounds() const {
+        // blending only moves the surface inwards
+        return m_a->GetBounds();
+    }
+} // SpireVoxel
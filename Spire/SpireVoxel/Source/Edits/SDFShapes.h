@@ -0,0 +1,116 @@
+#pragma once
+
+#include "EngineIncludes.h"
+
+namespace SpireVoxel {
+    // World space box containing every point where a shape's distance is <= 0
+    struct SDFBounds {
+        glm::vec3 Min;
+        glm::vec3 Max;
+
+        [[nodiscard]] SDFBounds Expanded(float amount) const { return {Min - amount, Max + amount}; }
+
+        [[nodiscard]] static SDFBounds Union(const SDFBounds &a, const SDFBounds &b) { return {glm::min(a.Min, b.Min), glm::max(a.Max, b.Max)}; }
+    };
+
+    // Signed distance function for SDFVoxelEdit, negative inside the shape and positive outside
+    // Distance must never be more than the true distance to the surface (it is used to skip empty space)
+    class ISDFShape {
+    public:
+        virtual ~ISDFShape() = default;
+
+    public:
+        [[nodiscard]] virtual float Distance(glm::vec3 position) const = 0;
+
+        [[nodiscard]] virtual SDFBounds GetBounds() const = 0;
+    };
+
+    class SphereSDF final : public ISDFShape {
+    public:
+        SphereSDF(glm::vec3 center, float radius);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        glm::vec3 m_center;
+        float m_radius;
+    };
+
+    // Line segment from a to b with rounded ends
+    class CapsuleSDF final : public ISDFShape {
+    public:
+        CapsuleSDF(glm::vec3 a, glm::vec3 b, float radius);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        glm::vec3 m_a;
+        glm::vec3 m_b;
+        float m_radius;
+    };
+
+    // Cylinder with flat ends at a and b
+    class CylinderSDF final : public ISDFShape {
+    public:
+        CylinderSDF(glm::vec3 a, glm::vec3 b, float radius);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        glm::vec3 m_a;
+        glm::vec3 m_b;
+        float m_radius;
+    };
+
+    // Cone with flat ends, radiusA at a and radiusB at b (0 for a pointed cone)
+    class ConeSDF final : public ISDFShape {
+    public:
+        ConeSDF(glm::vec3 a, glm::vec3 b, float radiusA, float radiusB);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        glm::vec3 m_a;
+        glm::vec3 m_b;
+        float m_radiusA;
+        float m_radiusB;
+    };
+
+    // Union of two shapes blended over smoothness voxels, 0 for a hard union
+    class SmoothUnionSDF final : public ISDFShape {
+    public:
+        SmoothUnionSDF(std::shared_ptr<const ISDFShape> a, std::shared_ptr<const ISDFShape> b, float smoothness);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        std::shared_ptr<const ISDFShape> m_a;
+        std::shared_ptr<const ISDFShape> m_b;
+        float m_smoothness;
+    };
+
+    // a with b cut out of it, blended over smoothness voxels, 0 for a hard subtraction
+    class SmoothSubtractSDF final : public ISDFShape {
+    public:
+        SmoothSubtractSDF(std::shared_ptr<const ISDFShape> a, std::shared_ptr<const ISDFShape> b, float smoothness);
+
+        [[nodiscard]] float Distance(glm::vec3 position) const override;
+
+        [[nodiscard]] SDFBounds GetBounds() const override;
+
+    private:
+        std::shared_ptr<const ISDFShape> m_a;
+        std::shared_ptr<const ISDFShape> m_b;
+        float m_smoothness;
+    };
+} // SpireVoxel
@@ -0,0 +1,142 @@
+#include "SDFVoxelEdit.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    // allowance for float error when skipping voxels using the distance to the surface
+    static constexpr float SKIP_EPSILON = 1e-3f;
+
+    SDFVoxelEdit::SDFVoxelEdit(std::shared_ptr<const ISDFShape> shape, VoxelType voxelType, std::vector<VoxelType> replaceOnlyTypes)
+        : m_shape(std::move(shape)),
+          m_voxelType(voxelType),
+          m_replaceOnlyTypes(std::move(replaceOnlyTypes)) {
+        assert(m_shape);
+    }
+
+    void SDFVoxelEdit::Apply(VoxelWorld &world) {
+        Spire::Timer timer;
+
+        std::vector<Chunk *> chunks;
+        for (const glm::ivec3 &chunkPosition : GetChunksInBounds(m_shape->GetBounds())) {
+            Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (chunk) chunks.push_back(chunk);
+        }
+
+        // 0 if nothing in the chunk changed
+        std::vector<glm::u32> affectedNeighbours(chunks.size(), 0);
+        ParallelFor(chunks.size(), [&](std::size_t i) {
+            Chunk &chunk = *chunks[i];
+            RasteriseChunk(*m_shape, chunk.ChunkPosition, [&](glm::u32 startIndex, glm::u32 endIndex) {
+                // find the parts of the run that change, the voxels can't be read while writing because writing may copy the storage
+                std::vector<std::pair<glm::u32, glm::u32> > writes;
+                const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels = chunk.GetVoxelData();
+                if (m_replaceOnlyTypes.empty()) {
+                    writes.emplace_back(startIndex, endIndex);
+                } else {
+                    glm::u32 index = startIndex;
+                    while (index < endIndex) {
+                        if (voxels[index] == m_voxelType || !CanReplace(voxels[index])) {
+                            index++;
+                            continue;
+                        }
+                        glm::u32 writeStart = index;
+                        while (index < endIndex && voxels[index] != m_voxelType && CanReplace(voxels[index])) index++;
+                        writes.emplace_back(writeStart, index);
+                    }
+                }
+
+                for (const auto &[writeStart, writeEnd] : writes) {
+                    // runs that wouldn't change anything aren't written
+                    glm::u32 changedNeighbours = GetChangedNeighbours(chunk.GetVoxelData(), writeStart, writeEnd, m_voxelType);
+                    if (changedNeighbours == 0) continue;
+                    chunk.SetVoxels(writeStart, writeEnd, m_voxelType);
+                    affectedNeighbours[i] |= changedNeighbours;
+                }
+            });
+            assert(!chunk.IsCorrupted());
+        });
+
+        m_changedChunks.clear();
+        std::unordered_set<glm::ivec3> affectedChunks;
+        for (std::size_t i = 0; i < chunks.size(); i++) {
+            if (affectedNeighbours[i] == 0) continue;
+            m_changedChunks.push_back(chunks[i]->ChunkPosition);
+            AddAffectedChunks(chunks[i]->ChunkPosition, affectedNeighbours[i], affectedChunks);
+        }
+
+        NotifyChunkEdits(world, affectedChunks);
+
+        if (LOG) Spire::info("[SDFVoxelEdit] Rasterised {} chunks in {} ms, {} changed", chunks.size(), timer.MillisSinceStart(), m_changedChunks.size());
+    }
+
+    std::optional<std::vector<glm::ivec3> > SDFVoxelEdit::GetWrittenChunks() const {
+        return GetChunksInBounds(m_shape->GetBounds());
+    }
+
+    std::vector<glm::ivec3> SDFVoxelEdit::GetChunksInBounds(const SDFBounds &bounds) {
+        // voxels are inside when their center is inside
+        glm::ivec3 min = VoxelWorld::GetChunkPositionOfVoxel(glm::ivec3(glm::floor(bounds.Min - 0.5f)));
+        glm::ivec3 max = VoxelWorld::GetChunkPositionOfVoxel(glm::ivec3(glm::floor(bounds.Max - 0.5f)));
+
+        std::vector<glm::ivec3> chunks;
+        for (glm::i32 x = min.x; x <= max.x; x++) {
+            for (glm::i32 y = min.y; y <= max.y; y++) {
+                for (glm::i32 z = min.z; z <= max.z; z++) {
+                    chunks.emplace_back(x, y, z);
+                }
+            }
+        }
+        return chunks;
+    }
+
+    void SDFVoxelEdit::RasteriseChunk(const ISDFShape &shape, glm::ivec3 chunkPosition, const std::function<void(glm::u32, glm::u32)> &onRun) {
+        // center of voxel (0, 0, 0)
+        glm::vec3 origin = glm::vec3(chunkPosition * SPIRE_VOXEL_CHUNK_SIZE) + 0.5f;
+
+        // every voxel center is within this distance of the center of the chunk
+        static const float CHUNK_RADIUS = glm::length(glm::vec3(SPIRE_VOXEL_CHUNK_SIZE - 1) * 0.5f);
+        float centerDistance = shape.Distance(origin + glm::vec3(SPIRE_VOXEL_CHUNK_SIZE - 1) * 0.5f);
+        if (centerDistance > CHUNK_RADIUS + SKIP_EPSILON) return;
+        if (centerDistance < -CHUNK_RADIUS - SKIP_EPSILON) {
+            onRun(0, SPIRE_VOXEL_CHUNK_VOLUME);
+            return;
+        }
+
+        // runs in neighbouring columns are joined so fully covered areas are written together
+        glm::u32 runStart = 0;
+        glm::u32 runEnd = 0;
+        auto pushRun = [&](glm::u32 start, glm::u32 end) {
+            if (runEnd > runStart && runEnd == start) {
+                runEnd = end;
+                return;
+            }
+            if (runEnd > runStart) onRun(runStart, runEnd);
+            runStart = start;
+            runEnd = end;
+        };
+
+        static_assert(SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 0, 0) + 1 == SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 0, 1)); // continuous along the z axis
+        for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE; x++) {
+            for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE; y++) {
+                glm::vec3 columnOrigin = origin + glm::vec3(x, y, 0);
+                glm::u32 columnIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, 0);
+
+                // no voxel within |distance| of a voxel center can be on the other side of the surface, so they can all be skipped/filled
+                glm::u32 z = 0;
+                while (z < SPIRE_VOXEL_CHUNK_SIZE) {
+                    float distance = shape.Distance(columnOrigin + glm::vec3(0, 0, z));
+                    float skip = glm::clamp(std::ceil(std::abs(distance) - SKIP_EPSILON), 1.0f, static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE - z));
+                    glm::u32 steps = static_cast<glm::u32>(skip);
+                    if (distance <= 0.0f) pushRun(columnIndex + z, columnIndex + z + steps);
+                    z += steps;
+                }
+            }
+        }
+
+        if (runEnd > runStart) onRun(runStart, runEnd);
+    }
+
+    bool SDFVoxelEdit::CanReplace(VoxelType type) const {
+        return m_replaceOnlyTypes.empty() || std::find(m_replaceOnlyTypes.begin(), m_replaceOnlyTypes.end(), type) != m_replaceOnlyTypes.end();
+    }
+} // SpireVoxel
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "IVoxelEdit.h"
+#include "SDFShapes.h"
+
+namespace SpireVoxel {
+
+    // Sets every voxel whose center is inside a signed distance function (see SDFShapes.h) to a voxel type
+    // Use VOXEL_TYPE_AIR to carve the shape out of the world
+    // Chunks outside the shape's bounds are skipped, chunks are rasterised in parallel on the task graph and written in runs along the Z axis
+    // Can only edit voxels in loaded chunks
+    class SDFVoxelEdit : public IVoxelEdit {
+    public:
+        // If replaceOnlyTypes isn't empty only voxels of those types are changed (e.g. {VOXEL_TYPE_AIR} to fill without overwriting)
+        SDFVoxelEdit(std::shared_ptr<const ISDFShape> shape, VoxelType voxelType, std::vector<VoxelType> replaceOnlyTypes = {});
+
+    public:
+        void Apply(VoxelWorld &world) override;
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override;
+
+        // Chunks where at least one voxel changed during the last Apply
+        [[nodiscard]] const std::vector<glm::ivec3> &GetChangedChunks() const { return m_changedChunks; }
+
+        [[nodiscard]] static std::vector<glm::ivec3> GetChunksInBounds(const SDFBounds &bounds);
+
+        // Calls onRun(startIndex, endIndex) for each run of voxels in the chunk that are inside the shape, in index order
+        // Empty space is skipped using the distance to the surface so most voxels are never evaluated
+        static void RasteriseChunk(const ISDFShape &shape, glm::ivec3 chunkPosition, const std::function<void(glm::u32, glm::u32)> &onRun);
+
+    private:
+        [[nodiscard]] bool CanReplace(VoxelType type) const;
+
+    private:
+        std::shared_ptr<const ISDFShape> m_shape;
+        VoxelType m_voxelType;
+        std::vector<VoxelType> m_replaceOnlyTypes;
+        std::vector<glm::ivec3> m_changedChunks;
+    };
+} // SpireVoxel
@@ -0,0 +1,150 @@
+#include "VoxelRegion.h"
+
+#include "PasteVoxelEdit.h"
+#include "Utils/TaskGraph.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    // transforms are done in tiles of this size so reading across the source's rows stays within a few cache lines
+    static constexpr glm::u32 TRANSFORM_TILE_SIZE = 16;
+
+    VoxelRegion::VoxelRegion(glm::uvec3 size, VoxelType fill)
+        : m_size(size),
+          m_voxels(static_cast<std::size_t>(size.x) * size.y * size.z, fill) {
+    }
+
+    VoxelRegion VoxelRegion::Copy(VoxelWorld &world, glm::ivec3 origin, glm::uvec3 size) {
+        Spire::Timer timer;
+        VoxelRegion region(size);
+        if (region.GetVolume() == 0) return region;
+
+        for (const glm::ivec3 &chunkPosition : GetChunksInBox(origin, size)) {
+            const Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (!chunk) continue;
+            region.CopyFromChunk(origin, chunkPosition, chunk->GetVoxelData());
+        }
+
+        if (LOG) Spire::info("[VoxelRegion] Copied {} voxels in {} ms", region.GetVolume(), timer.MillisSinceStart());
+        return region;
+    }
+
+    VoxelRegion VoxelRegion::Cut(VoxelWorld &world, glm::ivec3 origin, glm::uvec3 size) {
+        VoxelRegion region = Copy(world, origin, size);
+        PasteVoxelEdit(std::make_shared<VoxelRegion>(size), origin).Apply(world);
+        return region;
+    }
+
+    VoxelRegion VoxelRegion::Rotated(glm::u32 axis, glm::i32 quarterTurns) const {
+        assert(axis < 3);
+        std::array<glm::u32, 3> sourceAxes = {0, 1, 2};
+        std::array<bool, 3> flips = {};
+
+        // a quarter turn takes axis u to axis v and v to -u
+        glm::u32 u = (axis + 1) % 3;
+        glm::u32 v = (axis + 2) % 3;
+        glm::i32 turns = (quarterTurns % 4 + 4) % 4;
+        for (glm::i32 turn = 0; turn < turns; turn++) {
+            std::array<glm::u32, 3> previousAxes = sourceAxes;
+            std::array<bool, 3> previousFlips = flips;
+            sourceAxes[v] = previousAxes[u];
+            flips[v] = previousFlips[u];
+            sourceAxes[u] = previousAxes[v];
+            flips[u] = !previousFlips[v];
+        }
+        return Transformed(sourceAxes, flips);
+    }
+
+    VoxelRegion VoxelRegion::Mirrored(glm::u32 axis) const {
+        assert(axis < 3);
+        std::array<bool, 3> flips = {};
+        flips[axis] = true;
+        return Transformed({0, 1, 2}, flips);
+    }
+
+    void VoxelRegion::CopyFromChunk(glm::ivec3 origin, glm::ivec3 chunkPosition, const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels) {
+        ForEachRowInChunk(origin, m_size, chunkPosition, [&](glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length) {
+            std::copy_n(voxels.data() + chunkIndex, length, m_voxels.data() + regionIndex);
+        });
+    }
+
+    void VoxelRegion::ForEachRowInChunk(glm::ivec3 origin, glm::uvec3 size, glm::ivec3 chunkPosition,
+                                        const std::function<void(glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length)> &onRow) {
+        glm::ivec3 chunkOrigin = chunkPosition * SPIRE_VOXEL_CHUNK_SIZE;
+        glm::ivec3 min = glm::max(origin, chunkOrigin);
+        glm::ivec3 max = glm::min(origin + glm::ivec3(size), chunkOrigin + glm::ivec3(SPIRE_VOXEL_CHUNK_SIZE)); // exclusive
+        if (min.x >= max.x || min.y >= max.y || min.z >= max.z) return;
+
+        auto length = static_cast<glm::u32>(max.z - min.z);
+        for (glm::i32 x = min.x; x < max.x; x++) {
+            for (glm::i32 y = min.y; y < max.y; y++) {
+                glm::uvec3 positionInChunk = glm::uvec3(glm::ivec3(x, y, min.z) - chunkOrigin);
+                glm::uvec3 positionInRegion = glm::uvec3(glm::ivec3(x, y, min.z) - origin);
+                std::size_t regionIndex = (static_cast<std::size_t>(positionInRegion.x) * size.y + positionInRegion.y) * size.z + positionInRegion.z;
+                onRow(SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk), regionIndex, length);
+            }
+        }
+    }
+
+    std::vector<glm::ivec3> VoxelRegion::GetChunksInBox(glm::ivec3 origin, glm::uvec3 size) {
+        if (size.x == 0 || size.y == 0 || size.z == 0) return {};
+        glm::ivec3 min = VoxelWorld::GetChunkPositionOfVoxel(origin);
+        glm::ivec3 max = VoxelWorld::GetChunkPositionOfVoxel(origin + glm::ivec3(size) - glm::ivec3(1));
+
+        std::vector<glm::ivec3> chunks;
+        for (glm::i32 x = min.x; x <= max.x; x++) {
+            for (glm::i32 y = min.y; y <= max.y; y++) {
+                for (glm::i32 z = min.z; z <= max.z; z++) {
+                    chunks.emplace_back(x, y, z);
+                }
+            }
+        }
+        return chunks;
+    }
+
+    VoxelRegion VoxelRegion::Transformed(std::array<glm::u32, 3> sourceAxes, std::array<bool, 3> flips) const {
+        Spire::Timer timer;
+        VoxelRegion result({m_size[sourceAxes[0]], m_size[sourceAxes[1]], m_size[sourceAxes[2]]});
+        if (result.GetVolume() == 0) return result;
+
+        // walking one voxel along each axis of the result moves this far through the source
+        std::array<glm::i64, 3> sourceAxisStrides = {static_cast<glm::i64>(m_size.y) * m_size.z, m_size.z, 1};
+        std::array<glm::i64, 3> strides = {};
+        glm::i64 start = 0;
+        for (glm::u32 axis = 0; axis < 3; axis++) {
+            strides[axis] = sourceAxisStrides[sourceAxes[axis]];
+            if (flips[axis]) {
+                start += static_cast<glm::i64>(result.m_size[axis] - 1) * strides[axis];
+                strides[axis] = -strides[axis];
+            }
+        }
+
+        glm::uvec3 size = result.m_size;
+        glm::u32 numTilesX = (size.x + TRANSFORM_TILE_SIZE - 1) / TRANSFORM_TILE_SIZE;
+        // transforms are done while the player is placing a region
+        Spire::TaskGraph::Instance().ParallelFor(0, numTilesX, [&](std::size_t tileX) {
+            glm::u32 xStart = static_cast<glm::u32>(tileX) * TRANSFORM_TILE_SIZE;
+            glm::u32 xEnd = std::min(xStart + TRANSFORM_TILE_SIZE, size.x);
+            for (glm::u32 yStart = 0; yStart < size.y; yStart += TRANSFORM_TILE_SIZE) {
+                glm::u32 yEnd = std::min(yStart + TRANSFORM_TILE_SIZE, size.y);
+                for (glm::u32 zStart = 0; zStart < size.z; zStart += TRANSFORM_TILE_SIZE) {
+                    glm::u32 zEnd = std::min(zStart + TRANSFORM_TILE_SIZE, size.z);
+
+                    for (glm::u32 x = xStart; x < xEnd; x++) {
+                        for (glm::u32 y = yStart; y < yEnd; y++) {
+                            glm::i64 source = start + x * strides[0] + y * strides[1] + zStart * strides[2];
+                            VoxelType *destination = result.m_voxels.data() + result.GetIndex({x, y, zStart});
+                            for (glm::u32 z = zStart; z < zEnd; z++) {
+                                *destination++ = m_voxels[static_cast<std::size_t>(source)];
+                                source += strides[2];
+                            }
+                        }
+                    }
+                }
+            }
+        }, Spire::TaskPriority::Interactive);
+
+        if (LOG) Spire::info("[VoxelRegion] Transformed {} voxels in {} ms", result.GetVolume(), timer.MillisSinceStart());
+        return result;
+    }
+} // SpireVoxel
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Chunk/VoxelWorld.h"
+
+namespace SpireVoxel {
+
+    // A box of voxels copied out of a world (a clipboard), see PasteVoxelEdit to paste it back
+    // Stored like a chunk, voxels are contiguous along the Z axis so whole rows are copied at a time
+    class VoxelRegion {
+    public:
+        VoxelRegion() = default;
+
+        // All voxels are fill
+        explicit VoxelRegion(glm::uvec3 size, VoxelType fill = VOXEL_TYPE_AIR);
+
+    public:
+        // Copy the voxels in [origin, origin + size) from the world, voxels in chunks that aren't loaded are air
+        [[nodiscard]] static VoxelRegion Copy(VoxelWorld &world, glm::ivec3 origin, glm::uvec3 size);
+
+        // Copy then set the voxels to air
+        // To be able to undo the cut, Copy then apply a PasteVoxelEdit of an air region with an EditJournal instead
+        [[nodiscard]] static VoxelRegion Cut(VoxelWorld &world, glm::ivec3 origin, glm::uvec3 size);
+
+        // Rotates quarterTurns * 90 degrees around axis (0 = X, 1 = Y, 2 = Z), right handed so 1 turn around Y turns +Z into +X
+        // The result starts at the same corner, its size is swizzled
+        [[nodiscard]] VoxelRegion Rotated(glm::u32 axis, glm::i32 quarterTurns) const;
+
+        // Reverse the voxels along axis
+        [[nodiscard]] VoxelRegion Mirrored(glm::u32 axis) const;
+
+        [[nodiscard]] glm::uvec3 GetSize() const { return m_size; }
+
+        [[nodiscard]] std::size_t GetVolume() const { return m_voxels.size(); }
+
+        [[nodiscard]] std::size_t GetIndex(glm::uvec3 position) const {
+            assert(position.x < m_size.x && position.y < m_size.y && position.z < m_size.z);
+            return (static_cast<std::size_t>(position.x) * m_size.y + position.y) * m_size.z + position.z;
+        }
+
+        [[nodiscard]] VoxelType GetVoxel(glm::uvec3 position) const { return m_voxels[GetIndex(position)]; }
+
+        void SetVoxel(glm::uvec3 position, VoxelType type) { m_voxels[GetIndex(position)] = type; }
+
+        [[nodiscard]] std::span<const VoxelType> GetVoxels() const { return m_voxels; }
+
+        // Copy the part of a chunk inside the region, with the region placed at origin
+        void CopyFromChunk(glm::ivec3 origin, glm::ivec3 chunkPosition, const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels);
+
+        // Calls onRow(chunkIndex, regionIndex, length) for each Z row of the part of the box [origin, origin + size) inside the chunk
+        // Voxels [chunkIndex, chunkIndex + length) of the chunk are voxels [regionIndex, regionIndex + length) of a region of that size at origin
+        static void ForEachRowInChunk(glm::ivec3 origin, glm::uvec3 size, glm::ivec3 chunkPosition,
+                                      const std::function<void(glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length)> &onRow);
+
+        // Chunks overlapping the box [origin, origin + size)
+        [[nodiscard]] static std::vector<glm::ivec3> GetChunksInBox(glm::ivec3 origin, glm::uvec3 size);
+
+        [[nodiscard]] bool operator==(const VoxelRegion &other) const = default;
+
+    private:
+        // Voxel p of the result is voxel q of this region, q[sourceAxes[i]] = p[i] (or size - 1 - p[i] if flips[i])
+        [[nodiscard]] VoxelRegion Transformed(std::array<glm::u32, 3> sourceAxes, std::array<bool, 3> flips) const;
+
+    private:
+        glm::uvec3 m_size = {};
+        std::vector<VoxelType> m_voxels;
+    };
+} // SpireVoxel
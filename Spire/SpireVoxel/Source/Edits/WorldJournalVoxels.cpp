@@ -0,0 +1,41 @@
+#include "WorldJournalVoxels.h"
+
+#include "Chunk/Chunk.h"
+#include "Chunk/VoxelWorld.h"
+#include "Rendering/VoxelWorldRenderer.h"
+
+namespace SpireVoxel {
+    WorldJournalVoxels::WorldJournalVoxels(VoxelWorld &world) : m_world(world) {
+    }
+
+    const ChunkVoxelStorage *WorldJournalVoxels::TryGetVoxels(glm::ivec3 chunkPosition) const {
+        assert(m_world.IsOwnerThread());
+        const Chunk *chunk = m_world.TryGetLoadedChunk(chunkPosition);
+        return chunk ? &chunk->GetVoxelStorage() : nullptr;
+    }
+
+    glm::u64 WorldJournalVoxels::GetVersion(glm::ivec3 chunkPosition) const {
+        return GetChunk(chunkPosition).GetVersion();
+    }
+
+    void WorldJournalVoxels::SetVoxels(glm::ivec3 chunkPosition, glm::u32 startIndex, glm::u32 endIndex, VoxelType type) {
+        GetChunk(chunkPosition).SetVoxels(startIndex, endIndex, type);
+    }
+
+    void WorldJournalVoxels::ApplyEdit(IVoxelEdit &edit) {
+        assert(m_world.IsOwnerThread());
+        edit.Apply(m_world);
+    }
+
+    void WorldJournalVoxels::NotifyChunkEdits(const std::unordered_set<glm::ivec3> &chunkPositions) {
+        for (const glm::ivec3 &chunkPosition : chunkPositions) {
+            if (const Chunk *chunk = m_world.TryGetLoadedChunk(chunkPosition)) m_world.GetRenderer().NotifyChunkEdited(*chunk);
+        }
+    }
+
+    Chunk &WorldJournalVoxels::GetChunk(glm::ivec3 chunkPosition) const {
+        Chunk *chunk = m_world.TryGetLoadedChunk(chunkPosition);
+        assert(chunk);
+        return *chunk;
+    }
+} // SpireVoxel
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "EditJournal.h"
+
+namespace SpireVoxel {
+    class VoxelWorld;
+    struct Chunk;
+
+    // EditJournal's view of a VoxelWorld
+    class WorldJournalVoxels : public IJournalVoxels {
+    public:
+        explicit WorldJournalVoxels(VoxelWorld &world);
+
+    public:
+        [[nodiscard]] const ChunkVoxelStorage *TryGetVoxels(glm::ivec3 chunkPosition) const override;
+
+        [[nodiscard]] glm::u64 GetVersion(glm::ivec3 chunkPosition) const override;
+
+        void SetVoxels(glm::ivec3 chunkPosition, glm::u32 startIndex, glm::u32 endIndex, VoxelType type) override;
+
+        void ApplyEdit(IVoxelEdit &edit) override;
+
+        // Notifies the renderer for each of the chunks that is loaded
+        void NotifyChunkEdits(const std::unordered_set<glm::ivec3> &chunkPositions) override;
+
+    private:
+        [[nodiscard]] Chunk &GetChunk(glm::ivec3 chunkPosition) const;
+
+    private:
+        VoxelWorld &m_world;
+    };
+} // SpireVoxel
@@ -2,7 +2,6 @@
 
 #include "Chunk/VoxelWorld.h"
 #include "Rendering/VoxelWorldRenderer.h"
-#include "Utils/ThreadPool.h"
 
 namespace SpireVoxel {
     static constexpr bool LOG = false;
@@ -17,40 +16,75 @@ namespace SpireVoxel {
           m_world(world),
           m_camera(camera) {
         m_numCPUThreads = std::thread::hardware_concurrency();
+        m_loadJob = m_world.GetFrameScheduler().Register("Chunk load", 0.05f);
+    }
+
+    ProceduralGenerationManager::~ProceduralGenerationManager() {
+        WaitForAllGeneration();
     }
 
     void ProceduralGenerationManager::Update() {
-        glm::u32 numToGenerate = std::max(0, static_cast<glm::i32>(m_numCPUThreads) - static_cast<glm::i32>(m_world.GetRenderer().NumEditedChunks()));
+        assert(m_world.IsOwnerThread());
+
+        // forget about finished chunks
+        m_generationTasks.Prune();
+
+        glm::i32 busy = static_cast<glm::i32>(m_world.GetRenderer().NumEditedChunks()) + static_cast<glm::i32>(m_generationTasks.Size());
+        glm::u32 numToGenerate = std::max(0, static_cast<glm::i32>(m_numCPUThreads) - busy);
+        // generation runs on the task graph, only picking, loading and submitting the chunks is charged to the frame
+        FrameBudgetScheduler &scheduler = m_world.GetFrameScheduler();
+        numToGenerate = scheduler.Admit(m_loadJob, numToGenerate, 1);
+        if (numToGenerate == 0) {
+            m_numChunksGeneratedThisFrame = 0;
+            return;
+        }
 
+        Spire::Timer loadTimer;
         std::vector<glm::ivec3> coordsToLoad = m_controller->GetChunkCoordsToLoad(m_world, m_camera, numToGenerate);
         m_numChunksGeneratedThisFrame = coordsToLoad.size();
         m_world.LoadChunks(coordsToLoad);
 
-        std::vector<Chunk *> chunksToGenerate;
         for (glm::ivec3 coord : coordsToLoad) {
             Chunk *chunk = m_world.TryGetLoadedChunk(coord);
-            if (chunk) {
-                chunksToGenerate.push_back(chunk);
-            }
-        }
-
-        Spire::Timer timer;
-        Spire::ThreadPool::Instance().submit_loop(0, chunksToGenerate.size(), [this, &chunksToGenerate](glm::u32 i) {
-            if (chunksToGenerate[i] == nullptr) {
-                Spire::error("Failed to generate a chunk because it was nullptr");
-                return;
-            }
+            if (!chunk) continue;
+            if (m_generationTasks.IsRunning(coord)) continue;
 
-            //  Spire::info("generating chunk {} {} {}", chunksToGenerate[i]->ChunkPosition.x, chunksToGenerate[i]->ChunkPosition.y,chunksToGenerate[i]->ChunkPosition.z);
-            m_provider->GenerateChunk(m_world, *chunksToGenerate[i]);
-        }).get();
-
-        if (LOG && !chunksToGenerate.empty()) {
-            Spire::info("[ProceduralGenerationManager] Generated {} chunks in {} ms", chunksToGenerate.size(), timer.MillisSinceStart());
+            // the chunk can't be unloaded until this finishes, see VoxelWorld::UnloadChunks
+            m_generationTasks.Submit(coord, [this, chunk] {
+                Spire::Timer timer;
+                m_provider->GenerateChunk(m_world, *chunk);
+                if (LOG) {
+                    Spire::info("[ProceduralGenerationManager] Generated chunk {} {} {} in {} ms", chunk->ChunkPosition.x, chunk->ChunkPosition.y,
+                                chunk->ChunkPosition.z, timer.MillisSinceStart());
+                }
+            }, nullptr, {}, Spire::TaskPriority::Background);
         }
+        scheduler.Report(m_loadJob, static_cast<glm::u32>(coordsToLoad.size()), loadTimer.MillisSinceStart());
     }
 
     glm::u32 ProceduralGenerationManager::NumChunksGeneratedThisFrame() const {
         return m_numChunksGeneratedThisFrame;
     }
+
+    glm::u32 ProceduralGenerationManager::NumChunksGenerating() const {
+        return m_generationTasks.Size();
+    }
+
+    bool ProceduralGenerationManager::IsGenerating(glm::ivec3 chunkPosition) const {
+        return m_generationTasks.IsRunning(chunkPosition);
+    }
+
+    Spire::TaskGraph::TaskHandle ProceduralGenerationManager::GetGenerationTask(glm::ivec3 chunkPosition) const {
+        assert(m_world.IsOwnerThread());
+        return m_generationTasks.GetLast(chunkPosition);
+    }
+
+    void ProceduralGenerationManager::WaitForGeneration(glm::ivec3 chunkPosition) {
+        assert(m_world.IsOwnerThread());
+        m_generationTasks.Wait(chunkPosition);
+    }
+
+    void ProceduralGenerationManager::WaitForAllGeneration() {
+        m_generationTasks.WaitForAll();
+    }
 } // SpireVoxel
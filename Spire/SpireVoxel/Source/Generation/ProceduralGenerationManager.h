@@ -1,6 +1,8 @@
 #pragma once
 #include "../ChunkOrderControllers/IChunkOrderController.h"
 #include "Providers/IProceduralGenerationProvider.h"
+#include "Utils/FrameBudgetScheduler.h"
+#include "Utils/TaskGraph.h"
 
 namespace SpireVoxel {
     class ProceduralGenerationManager {
@@ -11,11 +13,30 @@ namespace SpireVoxel {
             VoxelWorld &world,
             IVoxelCamera &camera);
 
+        ~ProceduralGenerationManager();
+
+        DISABLE_COPY(ProceduralGenerationManager)
+
     public:
+        // Start generating new chunks, generation runs on the task graph and can take multiple frames
+        // Chunks can be edited while they are generating, meshing a generating chunk waits for its generation task
         void Update();
 
         [[nodiscard]] glm::u32 NumChunksGeneratedThisFrame() const;
 
+        [[nodiscard]] glm::u32 NumChunksGenerating() const;
+
+        [[nodiscard]] bool IsGenerating(glm::ivec3 chunkPosition) const;
+
+        // The chunk's generation task, null if it isn't generating
+        // Tasks that need the chunk to be generated can depend on it instead of waiting
+        [[nodiscard]] Spire::TaskGraph::TaskHandle GetGenerationTask(glm::ivec3 chunkPosition) const;
+
+        // Block until the chunk has finished generating, does nothing if it isn't generating
+        void WaitForGeneration(glm::ivec3 chunkPosition);
+
+        void WaitForAllGeneration();
+
     private:
         std::unique_ptr<IProceduralGenerationProvider> m_provider;
         std::unique_ptr<IChunkOrderController> m_controller;
@@ -23,5 +44,8 @@ namespace SpireVoxel {
         IVoxelCamera &m_camera;
         glm::u32 m_numCPUThreads;
         glm::u32 m_numChunksGeneratedThisFrame = 0;
+        FrameBudgetScheduler::JobType m_loadJob;
+        // only accessed from the world's owner thread
+        Spire::TaskChains<glm::ivec3> m_generationTasks{Spire::TaskGraph::Instance()};
     };
 } // SpireVoxel
@@ -1,48 +1,57 @@
 #include "LODManager.h"
 
 #include "ISamplingOffsets.h"
+#include "Chunk/VoxelKernels.h"
 #include "Chunk/VoxelWorld.h"
 #include "Rendering/VoxelWorldRenderer.h"
+#include "Utils/TaskGraph.h"
 
 namespace SpireVoxel {
-    void ReduceDetail(ISamplingOffsets &samplingOffsets, Chunk &reduceInto, const Chunk &target, glm::u32 newLODScale) {
-        const bool same = &reduceInto == &target;
-
-        std::unique_ptr<std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> > srcData{};
-        const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> *src = &target.VoxelData;
-
-        if (same) {
-            srcData = std::make_unique<std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> >(reduceInto.VoxelData);
-            src = srcData.get();
-            reduceInto.VoxelData = {};
-        }
-
-        glm::uvec3 offset = static_cast<glm::vec3>(target.ChunkPosition - reduceInto.ChunkPosition) * static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE / newLODScale);
-
-        for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE / newLODScale; x++) {
-            for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE / newLODScale; y++) {
-                for (glm::u32 z = 0; z < SPIRE_VOXEL_CHUNK_SIZE / newLODScale; z++) {
-                    auto sampleOffset = static_cast<glm::u32>(samplingOffsets.GetOffset(x, y, z) * static_cast<float>(newLODScale));
-                    glm::u32 readIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(
-                        x * newLODScale + sampleOffset,
-                        y * newLODScale + sampleOffset,
-                        z * newLODScale + sampleOffset
-                    );
-                    assert(readIndex < SPIRE_VOXEL_CHUNK_VOLUME);
-                    VoxelType type = (*src)[readIndex];
-
-                    glm::u32 writeIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(
-                        x + offset.x,
-                        y + offset.y,
-                        z + offset.z
-                    );
-                    assert(writeIndex < SPIRE_VOXEL_CHUNK_VOLUME);
-                    reduceInto.VoxelData[writeIndex] = type;
+    // Writes a reduced copy of src, the voxels of the chunk at srcPosition, into dst, the voxels of the chunk at dstPosition
+    // Only writes the region of dst that src reduces into, so chunks covered by the same chunk can be reduced in parallel
+    static void ReduceVoxels(ISamplingOffsets &samplingOffsets, std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &dst, glm::ivec3 dstPosition,
+                             const ChunkVoxelStorage::Data &src, glm::ivec3 srcPosition, glm::u32 newLODScale) {
+        const ChunkOccupancy &srcOccupancy = src.Occupancy;
+        if (srcOccupancy.IsEmpty()) return;
+
+        glm::uvec3 offset = static_cast<glm::vec3>(srcPosition - dstPosition) * static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE / newLODScale);
+
+        // reduced voxels are processed in blocks which each read from at least one whole brick
+        const glm::u32 reducedSize = SPIRE_VOXEL_CHUNK_SIZE / newLODScale;
+        const glm::u32 blockSize = std::max(1u, ChunkOccupancy::BRICK_SIZE / newLODScale);
+
+        for (glm::u32 blockX = 0; blockX < reducedSize; blockX += blockSize) {
+            for (glm::u32 blockY = 0; blockY < reducedSize; blockY += blockSize) {
+                for (glm::u32 blockZ = 0; blockZ < reducedSize; blockZ += blockSize) {
+                    glm::uvec3 blockStart = {blockX, blockY, blockZ};
+                    glm::uvec3 blockEnd = glm::min(blockStart + glm::uvec3(blockSize), glm::uvec3(reducedSize));
+                    if (srcOccupancy.IsRegionEmpty(blockStart * newLODScale, blockEnd * newLODScale)) continue;
+
+                    for (glm::u32 x = blockStart.x; x < blockEnd.x; x++) {
+                        for (glm::u32 y = blockStart.y; y < blockEnd.y; y++) {
+                            for (glm::u32 z = blockStart.z; z < blockEnd.z; z++) {
+                                auto sampleOffset = static_cast<glm::u32>(samplingOffsets.GetOffset(x, y, z) * static_cast<float>(newLODScale));
+                                glm::u32 readIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(
+                                    x * newLODScale + sampleOffset,
+                                    y * newLODScale + sampleOffset,
+                                    z * newLODScale + sampleOffset
+                                );
+                                assert(readIndex < SPIRE_VOXEL_CHUNK_VOLUME);
+                                VoxelType type = src.Voxels[readIndex];
+
+                                glm::u32 writeIndex = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(
+                                    x + offset.x,
+                                    y + offset.y,
+                                    z + offset.z
+                                );
+                                assert(writeIndex < SPIRE_VOXEL_CHUNK_VOLUME);
+                                dst[writeIndex] = type;
+                            }
+                        }
+                    }
                 }
             }
         }
-
-        assert(!reduceInto.IsCorrupted());
     }
 
     LODManager::LODManager(
@@ -93,32 +102,39 @@ namespace SpireVoxel {
                 }
             }
         }
-        if (PROFILING_LOD) Spire::info("Find chunks: {} ms", timer.MillisSinceStart());
-        timer.Restart();
-
-        // Reduce detail
-        ReduceDetail(*m_samplingOffsets, chunk, chunk, newLODScale);
-
-        if (PROFILING_LOD) Spire::info("Reduce detail of main chunk: {} ms", timer.MillisSinceStart());
-        timer.Restart();
-
-        // set everything in main chunk except squished main chunk voxels to air
-        for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE; x++) {
-            for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE; y++) {
-                for (glm::u32 z = 0; z < SPIRE_VOXEL_CHUNK_SIZE; z++) {
-                    if (x < SPIRE_VOXEL_CHUNK_SIZE / newLODScale && y < SPIRE_VOXEL_CHUNK_SIZE / newLODScale && z < SPIRE_VOXEL_CHUNK_SIZE / newLODScale) continue;
-                    glm::u32 index = SPIRE_VOXEL_POSITION_TO_INDEX((glm::uvec3{x, y, z} ));
-                    chunk.VoxelData[index] = 0;
-                }
-            }
+        // generation writes to the chunks on the task graph, make sure it is finished before reading them
+        ProceduralGenerationManager &generationManager = m_world.GetProceduralGenerationManager();
+        generationManager.WaitForGeneration(chunk.ChunkPosition);
+        for (glm::ivec3 coveredChunkPosition : coveredChunkPositions) {
+            generationManager.WaitForGeneration(coveredChunkPosition);
         }
 
-        if (PROFILING_LOD) Spire::info("Set to air: {} ms", timer.MillisSinceStart());
+        if (PROFILING_LOD) Spire::info("Find chunks: {} ms", timer.MillisSinceStart());
         timer.Restart();
 
-        for (Chunk *coveredChunk : coveredChunks) {
-            ReduceDetail(*m_samplingOffsets, chunk, *coveredChunk, newLODScale);
-        }
+        // the version stays odd until every covered chunk has been reduced and the bits regenerated, so readers discard what they see until then
+        // keep a reference to the old storage to read from, writing detaches the chunk from it
+        ChunkVoxelStorage srcStorage = chunk.GetVoxelStorage();
+        chunk.ModifyVoxels([&](std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &chunkVoxels) {
+            // everything except the reduced main chunk voxels becomes air
+            VoxelKernels::Fill(chunkVoxels.data(), chunkVoxels.size(), VOXEL_TYPE_AIR);
+            ReduceVoxels(*m_samplingOffsets, chunkVoxels, chunk.ChunkPosition, srcStorage.Read(), chunk.ChunkPosition, newLODScale);
+
+            if (PROFILING_LOD) Spire::info("Reduce detail of main chunk: {} ms", timer.MillisSinceStart());
+            timer.Restart();
+
+            // each covered chunk reduces into its own region of the main chunk
+            // the storages are copied here so paging them in happens on this thread, the copies only share the data
+            Spire::TaskGraph &taskGraph = Spire::TaskGraph::Instance();
+            Spire::TaskGroup reduceGroup;
+            for (Chunk *coveredChunk : coveredChunks) {
+                taskGraph.Submit([this, &chunkVoxels, &chunk, storage = coveredChunk->GetVoxelStorage(), position = coveredChunk->ChunkPosition, newLODScale] {
+                    ReduceVoxels(*m_samplingOffsets, chunkVoxels, chunk.ChunkPosition, storage.Read(), position, newLODScale);
+                }, {}, &reduceGroup, Spire::TaskPriority::Background);
+            }
+            taskGraph.Wait(reduceGroup);
+        });
+        assert(!chunk.IsCorrupted());
 
         if (PROFILING_LOD) Spire::info("Reduce detail: {} ms", timer.MillisSinceStart());
         timer.Restart();
@@ -126,7 +142,7 @@ namespace SpireVoxel {
         chunk.LOD.Scale = newLODScale;
         m_world.UnloadChunks(coveredChunkPositions);
         for (glm::ivec3 chunkCoord : coveredChunkPositions) {
-             m_coveredToPrimaryChunk[chunkCoord] = &chunk;
+            m_coveredToPrimaryChunk[chunkCoord] = chunk.Handle;
             // Spire::info("{} {} {} is now covered by {} {} {}", chunkCoord.x, chunkCoord.y, chunkCoord.z,
             //             chunk.ChunkPosition.x, chunk.ChunkPosition.y, chunk.ChunkPosition.z);
         }
@@ -134,9 +150,6 @@ namespace SpireVoxel {
         if (PROFILING_LOD) Spire::info("Unload chunks: {} ms", timer.MillisSinceStart());
         timer.Restart();
 
-        chunk.RegenerateVoxelBits();
-        if (PROFILING_LOD) Spire::info("Regenerate chunks: {} ms", timer.MillisSinceStart());
-        timer.Restart();
         m_world.GetRenderer().NotifyChunkEdited(chunk);
 
         if (PROFILING_LOD) Spire::info("Notify edit: {} ms", timer.MillisSinceStart());
@@ -150,6 +163,10 @@ namespace SpireVoxel {
         auto it = m_coveredToPrimaryChunk.find(chunkCoords);
         if (it == m_coveredToPrimaryChunk.end()) return nullptr;
 
-        return it->second;
+        return m_world.TryGetChunk(it->second);
+    }
+
+    glm::u64 LODManager::CalculateMemoryUsage() const {
+        return Spire::EstimateHashContainerMemoryUsage(m_coveredToPrimaryChunk);
     }
 } // SpireVoxel
@@ -22,11 +22,16 @@ namespace SpireVoxel {
 
         // Get a chunk if it is loaded
         // If the chunk is covered by a LOD chunk, get that instead
+        // Owner thread only
         [[nodiscard]] Chunk* TryGetLODChunk(glm::ivec3 chunkCoords);
 
+        // Approximate heap usage of the covered chunk map
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const;
+
     private:
         VoxelWorld &m_world;
         std::shared_ptr<ISamplingOffsets> m_samplingOffsets;
-        std::unordered_map<glm::ivec3, Chunk* > m_coveredToPrimaryChunk;
+        // handles so a covered position never resolves to a primary chunk that has since been unloaded
+        std::unordered_map<glm::ivec3, ChunkHandle> m_coveredToPrimaryChunk;
     };
 } // SpireVoxel
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Chunk/ChunkDrawParams.h"
+
+namespace SpireVoxel {
+    // What the renderer needs to draw the world's chunks at one point in time
+    // Built on the world's owner thread and handed to the render thread through a TripleBuffer, never changed once published
+    struct ChunkDrawSnapshot {
+        glm::u64 Version = 0; // increases with every snapshot, 0 before the first
+        std::vector<ChunkData> ChunkDatas; // indexed by chunk handle index
+        std::vector<ChunkDrawParams> DrawCommands;
+    };
+} // SpireVoxel
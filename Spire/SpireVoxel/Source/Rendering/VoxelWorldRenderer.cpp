@@ -3,7 +3,6 @@
 #include "Chunk/VoxelWorld.h"
 #include "Chunk/Meshing/ChunkMesher.h"
 #include "Rendering/Memory/BufferManager.h"
-#include "Utils/ThreadPool.h"
 #include "../../Assets/Shaders/PushConstants.h"
 #include "Chunk/ChunkDrawParams.h"
 #include "Utils/IVoxelCamera.h"
@@ -21,11 +20,11 @@ namespace SpireVoxel {
           m_renderingManager(renderingManager),
           m_onWorldEditedDelegate(),
           m_chunkVertexBufferAllocator(m_renderingManager, recreatePipelineCallback, sizeof(VertexData), m_renderingManager.GetSwapchain().GetNumImages(),
-                                       sizeof(VertexData) * (1024 * 1024 * 32), 1, true),
+                                       sizeof(VertexData) * (1024 * 1024 * 32), 1, true, Spire::MemoryCategory::GPUVertex),
           m_chunkVoxelDataBufferAllocator(m_renderingManager, recreatePipelineCallback, sizeof(VoxelType), m_renderingManager.GetSwapchain().GetNumImages(),
-                                          1024 * 1024 * 128, 1, true),
+                                          1024 * 1024 * 128, 1, true, Spire::MemoryCategory::GPUVoxelData),
           m_chunkAOBufferAllocator(m_renderingManager, recreatePipelineCallback, sizeof(glm::u32), m_renderingManager.GetSwapchain().GetNumImages(),
-                                   1024 * 1024 * 128, 1, true),
+                                   1024 * 1024 * 128, 1, true, Spire::MemoryCategory::GPUVoxelData),
           m_camera(camera),
           m_settings(settings) {
         Spire::info("Allocated {} mb BufferAllocator on GPU to store world vertices", m_chunkVertexBufferAllocator.GetTotalSize() / 1024 / 1024);
@@ -52,12 +51,13 @@ namespace SpireVoxel {
         );
         Spire::info("Allocated {} kb buffer for each swapchain image on GPU to store chunk datas", sizeof(ChunkData) * MAXIMUM_LOADED_CHUNKS / 1024);
 
-        m_dirtyChunkDataBuffers.resize(renderingManager.GetSwapchain().GetNumImages());
+        m_uploadedSnapshotVersions.resize(renderingManager.GetSwapchain().GetNumImages());
 
         m_chunkMesher = std::make_unique<ChunkMesher>(m_world, m_chunkVertexBufferAllocator, m_chunkVoxelDataBufferAllocator, m_chunkAOBufferAllocator, settings);
     }
 
-    void VoxelWorldRenderer::Render(glm::u32 swapchainImageIndex, glm::vec3 cameraPos) {
+    void VoxelWorldRenderer::Simulate(glm::vec3 cameraPos) {
+        assert(m_world.IsOwnerThread());
         HandleChunkEdits(cameraPos);
 
         // Frustum culling
@@ -65,23 +65,28 @@ namespace SpireVoxel {
             m_cameraInfoLastFrame = m_camera.GetCameraInfo();
             UpdateChunkDatasBuffer();
         }
+    }
+
+    void VoxelWorldRenderer::Render(glm::u32 swapchainImageIndex) {
+        m_snapshots.Acquire();
+        const ChunkDrawSnapshot &snapshot = m_snapshots.GetFront();
 
         // if empty we aren't issuing render commands so don't need to update the gpu buffer
-        if (!m_latestCachedChunkData.empty() && m_dirtyChunkDataBuffers[swapchainImageIndex]) {
-            m_dirtyChunkDataBuffers[swapchainImageIndex] = false;
+        if (!snapshot.ChunkDatas.empty() && m_uploadedSnapshotVersions[swapchainImageIndex] != snapshot.Version) {
+            m_uploadedSnapshotVersions[swapchainImageIndex] = snapshot.Version;
 
-            const glm::u32 chunkDataWriteSize = sizeof(m_latestCachedChunkData[0]) * m_latestCachedChunkData.size();
+            const glm::u32 chunkDataWriteSize = sizeof(snapshot.ChunkDatas[0]) * snapshot.ChunkDatas.size();
             m_renderingManager.GetBufferManager().UpdateBuffer(
                 m_chunkDatasBuffer->GetBuffer(swapchainImageIndex),
-                m_latestCachedChunkData.data(),
+                snapshot.ChunkDatas.data(),
                 chunkDataWriteSize,
                 0
             );
 
-            const glm::u32 chunkDrawParamsWriteSize = sizeof(m_latestCachedChunkDrawCommands[0]) * m_latestCachedChunkDrawCommands.size();
+            const glm::u32 chunkDrawParamsWriteSize = sizeof(snapshot.DrawCommands[0]) * snapshot.DrawCommands.size();
             m_renderingManager.GetBufferManager().UpdateBuffer(
                 m_chunkDrawCommandsBuffer->GetBuffer(swapchainImageIndex),
-                m_latestCachedChunkDrawCommands.data(),
+                snapshot.DrawCommands.data(),
                 chunkDrawParamsWriteSize,
                 0
             );
@@ -96,14 +101,15 @@ namespace SpireVoxel {
     }
 
     void VoxelWorldRenderer::CmdRender(VkCommandBuffer commandBuffer, glm::u32 swapchainImage, const Spire::Pipeline &pipeline) const {
-        if (!m_latestCachedChunkData.empty()) {
+        const ChunkDrawSnapshot &snapshot = m_snapshots.GetFront();
+        if (!snapshot.ChunkDatas.empty()) {
             PushConstantsData pushConstants = CreatePushConstants();
             pipeline.CmdSetPushConstants(commandBuffer, &pushConstants, sizeof(PushConstantsData));
             vkCmdDrawIndirect(
                 commandBuffer,
                 m_chunkDrawCommandsBuffer->GetBuffer(swapchainImage).Buffer,
                 0,
-                m_latestCachedChunkDrawCommands.size() * ChunkDrawParams::COMMANDS_PER_CHUNK,
+                snapshot.DrawCommands.size() * ChunkDrawParams::COMMANDS_PER_CHUNK,
                 ChunkDrawParams::STRIDE
             );
         }
@@ -130,30 +136,85 @@ namespace SpireVoxel {
     }
 
     void VoxelWorldRenderer::UpdateChunkDatasBuffer() {
+        assert(m_world.IsOwnerThread());
         UpdateChunkDataCache();
-
-        for (std::size_t i = 0; i < m_dirtyChunkDataBuffers.size(); i++) {
-            m_dirtyChunkDataBuffers[i] = true;
-        }
+        m_snapshots.Publish();
     }
 
     void VoxelWorldRenderer::NotifyChunkEdited(const Chunk &chunk) {
-        std::unique_lock lock(m_chunkEditNotifyMutex);
         assert(m_world.IsLoaded(chunk));
         assert(m_world.TryGetLoadedChunk(chunk.ChunkPosition) == &chunk);
-        m_editedChunks.insert(chunk.ChunkPosition);
+        m_editedChunks.Push(chunk.Handle, chunk.GetDirtyFlag());
+    }
+
+    std::unordered_set<ChunkHandle> VoxelWorldRenderer::TakeEditedChunks() {
+        // take the edited chunks so other threads can keep notifying while we mesh, edits from here on notify the chunk again
+        std::unordered_set<ChunkHandle> editedChunks;
+        for (ChunkHandle handle : m_editedChunks.TakeAll()) {
+            // unloaded chunks are dropped by the mesher
+            if (Chunk *chunk = m_world.TryGetChunk(handle)) {
+                ChunkDirtyList::Clear(chunk->GetDirtyFlag());
+                // an edit may have woken up the voxels around it
+                m_world.GetTickSystem().Activate(chunk->ChunkPosition);
+            }
+            editedChunks.insert(handle);
+        }
+        return editedChunks;
     }
 
     void VoxelWorldRenderer::HandleChunkEdits(glm::vec3 cameraPos) {
-        std::unique_lock lock(m_chunkEditNotifyMutex);
-        if (m_chunkMesher->HandleChunkEdits(m_editedChunks, cameraPos)) {
+        DirtyChunkQueue::View view = {cameraPos, m_camera.GetForward()};
+        if (m_settings.AllowFrustumCulling) view.Frustum = m_camera.CalculateFrustum();
+        bool remeshed = m_chunkMesher->HandleChunkEdits(TakeEditedChunks(), view);
+
+        if (remeshed) {
             UpdateChunkDatasBuffer();
             m_onWorldEditedDelegate.Broadcast();
         }
     }
 
+    void VoxelWorldRenderer::WaitForMeshing(const Chunk &chunk) const {
+        m_chunkMesher->WaitForMeshing(chunk.Handle);
+    }
+
+    void VoxelWorldRenderer::WaitForMeshing() const {
+        m_chunkMesher->WaitForMeshing();
+    }
+
+    void VoxelWorldRenderer::QueueEditedChunks() {
+        m_chunkMesher->QueueChunks(TakeEditedChunks());
+    }
+
+    std::unordered_map<Chunk *, ChunkMesh> VoxelWorldRenderer::MeshQueuedChunks() {
+        std::unordered_map<Chunk *, ChunkMesh> meshes;
+        m_chunkMesher->MeshQueuedChunks(meshes);
+        return meshes;
+    }
+
+    void VoxelWorldRenderer::UploadChunkMeshes(std::unordered_map<Chunk *, ChunkMesh> &meshes) {
+        if (meshes.empty()) return;
+        m_chunkMesher->UploadChunkMeshes(meshes);
+        UpdateChunkDatasBuffer();
+        m_onWorldEditedDelegate.Broadcast();
+    }
+
     glm::u32 VoxelWorldRenderer::NumEditedChunks() const {
-        return m_editedChunks.size();
+        return m_editedChunks.Size() + m_chunkMesher->NumQueuedChunks();
+    }
+
+    std::unordered_set<ChunkHandle> VoxelWorldRenderer::GetEditedChunks() const {
+        std::unordered_set<ChunkHandle> editedChunks;
+        m_editedChunks.ForEach([&](ChunkHandle handle) { editedChunks.insert(handle); });
+        m_chunkMesher->GetQueuedChunks(editedChunks);
+        return editedChunks;
+    }
+
+    glm::u64 VoxelWorldRenderer::CalculateCPUMemoryUsage() const {
+        // the other two snapshots are about the same size as the one being built
+        const ChunkDrawSnapshot &snapshot = m_snapshots.PeekBack();
+        glm::u64 usage = 3 * (snapshot.ChunkDatas.capacity() * sizeof(ChunkData) + snapshot.DrawCommands.capacity() * sizeof(ChunkDrawParams));
+        usage += m_chunkMesher->GetDirtyChunks().CalculateMemoryUsage();
+        return usage + m_editedChunks.CalculateMemoryUsage();
     }
 
     glm::u32 VoxelWorldRenderer::GetNumChunksOutsideFrustum() const {
@@ -181,14 +242,19 @@ namespace SpireVoxel {
     }
 
     void VoxelWorldRenderer::NotifyChunkLoadedOrUnloaded() {
-        std::unique_lock lock(m_chunkEditNotifyMutex);
+        assert(m_world.IsOwnerThread());
         UpdateChunkDatasBuffer();
         m_onWorldEditedDelegate.Broadcast();
     }
 
     void VoxelWorldRenderer::UpdateChunkDataCache() {
-        m_latestCachedChunkData.clear();
-        m_latestCachedChunkDrawCommands.clear();
+        // the back snapshot was last published two snapshots ago, reuse its capacity
+        ChunkDrawSnapshot &snapshot = m_snapshots.GetBack();
+        snapshot.Version = ++m_snapshotVersion;
+        std::vector<ChunkData> &chunkDatas = snapshot.ChunkDatas;
+        std::vector<ChunkDrawParams> &drawCommands = snapshot.DrawCommands;
+        chunkDatas.clear();
+        drawCommands.clear();
 
         Spire::Frustum cameraFrustum = m_camera.CalculateFrustum();
         m_numChunksOutsideFrustum = 0;
@@ -198,13 +264,23 @@ namespace SpireVoxel {
         m_numRenderedFaces = 0;
         m_numFaces = 0;
 
+        // chunk datas are indexed by the chunk handle index, only upload up to the highest one in use
+        chunkDatas.resize(std::min<std::size_t>(m_world.NumChunkSlots(), MAXIMUM_LOADED_CHUNKS));
+        glm::u32 numChunkDataSlots = 0;
+
         for (const auto &[_, chunk] : m_world) {
-            auto chunkIndex = static_cast<glm::u32>(m_latestCachedChunkData.size());
+            glm::u32 chunkIndex = chunk->Handle.Index;
             if (chunk->VertexAllocation.Size == 0) continue;
+            if (chunkIndex >= MAXIMUM_LOADED_CHUNKS) {
+                Spire::error("Chunk {} {} {} has no space in the chunk data buffer", chunk->ChunkPosition.x, chunk->ChunkPosition.y, chunk->ChunkPosition.z);
+                assert(false);
+                continue;
+            }
             m_numNonEmptyChunks++;
 
-            m_latestCachedChunkData.push_back(chunk->GenerateChunkData());
-            m_latestCachedChunkDrawCommands.push_back(chunk->GenerateDrawParams(chunkIndex));
+            chunkDatas[chunkIndex] = chunk->GenerateChunkData();
+            numChunkDataSlots = std::max(numChunkDataSlots, chunkIndex + 1);
+            drawCommands.push_back(chunk->GenerateDrawParams(chunkIndex));
 
             glm::vec3 worldPosition = VoxelWorld::GetWorldVoxelPositionInChunk(chunk->ChunkPosition, {0, 0, 0});
             float cameraScale = m_camera.GetCameraInfo().Scale;
@@ -228,8 +304,8 @@ namespace SpireVoxel {
                                             : centerOfOppositeFace[index] <= m_camera.GetPosition()[index];
                 if (!m_settings.AllowBackfaceCulling) shouldRenderFace = true;
 
-                m_latestCachedChunkDrawCommands.back().Commands[face].instanceCount = shouldRenderChunk && shouldRenderFace ? 1 : 0;
-                if (m_latestCachedChunkDrawCommands.back().Commands[face].instanceCount == 1) {
+                drawCommands.back().Commands[face].instanceCount = shouldRenderChunk && shouldRenderFace ? 1 : 0;
+                if (drawCommands.back().Commands[face].instanceCount == 1) {
                     m_numRenderedFaces += chunk->NumVertices[face] / Chunk::VERTICES_PER_FACE;
                 }
 
@@ -240,6 +316,8 @@ namespace SpireVoxel {
             }
             if (!shouldRenderChunk) m_numChunksOutsideFrustum++;
         }
+
+        chunkDatas.resize(numChunkDataSlots);
     }
 
     void VoxelWorldRenderer::FreeChunkBuffers(Chunk &chunk) {
@@ -4,8 +4,11 @@
 #include "Chunk/Chunk.h"
 #include "Chunk/ChunkDrawParams.h"
 #include "Chunk/VoxelWorld.h"
+#include "Chunk/Meshing/ChunkDirtyList.h"
 #include "Chunk/Meshing/ChunkMesh.h"
 #include "Chunk/Meshing/ChunkMesher.h"
+#include "Rendering/ChunkDrawSnapshot.h"
+#include "Utils/TripleBuffer.h"
 
 namespace SpireVoxel {
     struct PushConstantsData;
@@ -27,26 +30,54 @@ namespace SpireVoxel {
         );
 
     public:
-        // Call once per frame
-        void Render(glm::u32 swapchainImageIndex, glm::vec3 cameraPos);
+        // Call once per frame on the world's owner thread, handles chunk edits and publishes a new ChunkDrawSnapshot if the draw state changed
+        void Simulate(glm::vec3 cameraPos);
+
+        // Call once per frame on the render thread, uploads the latest published snapshot, doesn't touch the world
+        // The render thread can run this while the owner thread is simulating
+        void Render(glm::u32 swapchainImageIndex);
+
+        // The snapshot taken by the last Render, render thread only
+        [[nodiscard]] const ChunkDrawSnapshot &GetSnapshot() const { return m_snapshots.GetFront(); }
 
         DelegateSubscribers<> &GetOnWorldEditSubscribers();
 
-        // Record draw commands
+        // Record draw commands for the snapshot taken by the last Render, render thread only
         void CmdRender(VkCommandBuffer commandBuffer, glm::u32 swapchainImage, const Spire::Pipeline &pipeline) const;
 
         void PushDescriptors(Spire::PerImageDescriptorSetLayout &perFrameSet, Spire::DescriptorSetLayout &chunkVertexBuffersLayout);
 
-        // Update chunk data buffer, needs to be called whenever a chunk is loaded or unloaded
+        // Rebuild and publish the chunk draw snapshot, needs to be called whenever a chunk is loaded or unloaded, owner thread only
         void UpdateChunkDatasBuffer();
 
-        // Replicate edits to chunks to the GPU
+        // Replicate edits to chunks to the GPU, thread safe
         void NotifyChunkEdited(const Chunk &chunk);
 
+        // Upload finished meshes and submit edited chunks to be meshed, owner thread only
+        // Meshing runs across frames and other threads can keep notifying edits meanwhile, see ChunkMesher
         void HandleChunkEdits(glm::vec3 cameraPos);
 
+        // Wait for the chunk's mesh task to finish, owner thread only
+        void WaitForMeshing(const Chunk &chunk) const;
+
+        void WaitForMeshing() const;
+
+        // Move the chunks notified since the last HandleChunkEdits into the mesher's queue, HandleChunkEdits does this first, owner thread only
+        void QueueEditedChunks();
+
+        // Mesh every queued chunk now and return the meshes instead of uploading them (see EditReplay), owner thread only
+        [[nodiscard]] std::unordered_map<Chunk *, ChunkMesh> MeshQueuedChunks();
+
+        // Upload meshes made outside of HandleChunkEdits (see EditReplay), owner thread only
+        void UploadChunkMeshes(std::unordered_map<Chunk *, ChunkMesh> &meshes);
+
+        // Includes chunks being meshed, owner thread only
         [[nodiscard]] glm::u32 NumEditedChunks() const;
 
+        // Chunks waiting to be meshed, being meshed or waiting to be uploaded, owner thread only
+        // May contain chunks that have since been unloaded
+        [[nodiscard]] std::unordered_set<ChunkHandle> GetEditedChunks() const;
+
         [[nodiscard]] glm::u32 GetNumChunksOutsideFrustum() const;
 
         [[nodiscard]] glm::u32 GetNumNonEmptyChunks() const;
@@ -59,7 +90,13 @@ namespace SpireVoxel {
 
         [[nodiscard]] glm::u32 NumFaces() const;
 
+        // Approximate heap usage of the edited chunk set, the dirty chunk queue and the CPU copies of the chunk data and draw commands
+        [[nodiscard]] glm::u64 CalculateCPUMemoryUsage() const;
+
     private:
+        // Take the chunks notified since the last call
+        [[nodiscard]] std::unordered_set<ChunkHandle> TakeEditedChunks();
+
         void NotifyChunkLoadedOrUnloaded();
 
         void UpdateChunkDataCache();
@@ -86,14 +123,13 @@ namespace SpireVoxel {
         // see ChunkData
         std::unique_ptr<Spire::PerImageBuffer> m_chunkDatasBuffer;
         std::unique_ptr<Spire::PerImageBuffer> m_chunkDrawCommandsBuffer;
-        // if {true,false,false} it means we need to update buffer 0 on swapchain image index 0
-        // so next time frame % num swapchain images == 0, we'll upload the new data
-        std::vector<bool> m_dirtyChunkDataBuffers;
-        std::vector<ChunkData> m_latestCachedChunkData;
-        std::vector<ChunkDrawParams> m_latestCachedChunkDrawCommands;
-        std::unordered_set<glm::ivec3> m_editedChunks;
+        // written by the owner thread, read by the render thread
+        Spire::TripleBuffer<ChunkDrawSnapshot> m_snapshots;
+        glm::u64 m_snapshotVersion = 0; // owner thread only
+        // version of the snapshot last uploaded to each swapchain image's buffers, render thread only
+        std::vector<glm::u64> m_uploadedSnapshotVersions;
+        ChunkDirtyList m_editedChunks; // notified since the last HandleChunkEdits, which moves them into the mesher's DirtyChunkQueue
         std::unique_ptr<ChunkMesher> m_chunkMesher;
-        std::mutex m_chunkEditNotifyMutex;
         const IVoxelCamera &m_camera;
         glm::u32 m_numChunksOutsideFrustum;
         glm::u32 m_numNonEmptyChunks;
@@ -0,0 +1,65 @@
+#include "ChunkSwapStore.h"
+
+#include "VoxelSerializer.h"
+
+namespace SpireVoxel {
+    static constexpr glm::u64 CHUNK_FILE_VOXEL_BYTES = SPIRE_VOXEL_CHUNK_VOLUME * sizeof(VoxelType);
+
+    ChunkSwapStore::ChunkSwapStore(const std::filesystem::path &rootDirectory)
+        : m_files(std::make_shared<SwapFiles>()) {
+        std::filesystem::path root = rootDirectory.empty() ? std::filesystem::temp_directory_path() : rootDirectory;
+        // unique per store so multiple worlds (or processes) don't share files
+        auto unique = static_cast<glm::u64>(std::chrono::steady_clock::now().time_since_epoch().count()) ^ reinterpret_cast<std::uintptr_t>(m_files.get());
+        m_files->Directory = root / std::format("SpireVoxelSwap_{:x}", unique);
+    }
+
+    bool ChunkSwapStore::PageOut(ChunkVoxelStorage &storage, glm::ivec3 chunkPosition, bool fileIsCurrent) {
+        if (storage.IsPagedOut()) return true;
+        if (storage.IsShared()) return false;
+
+        std::filesystem::path path = VoxelSerializer::GetFilePath(chunkPosition, m_files->Directory);
+        if (fileIsCurrent && std::filesystem::exists(path)) {
+            m_files->SkippedWrites.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            std::call_once(m_files->CreateDirectoryFlag, [&] {
+                std::error_code error;
+                std::filesystem::create_directories(m_files->Directory, error);
+                if (error) Spire::error("Failed to create swap directory {}: {}", m_files->Directory.string(), error.message());
+            });
+
+            if (!VoxelSerializer::WriteChunkFile(path, chunkPosition, storage.Read().Voxels)) return false;
+            m_files->BytesWritten.fetch_add(CHUNK_FILE_VOXEL_BYTES, std::memory_order_relaxed);
+        }
+
+        bool pagedOut = storage.PageOut([files = m_files, path, chunkPosition](std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels) {
+            glm::ivec3 filePosition;
+            if (!VoxelSerializer::ReadChunkFile(path, filePosition, voxels) || filePosition != chunkPosition) {
+                files->FailedPageIns.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            files->PageIns.fetch_add(1, std::memory_order_relaxed);
+            files->BytesRead.fetch_add(CHUNK_FILE_VOXEL_BYTES, std::memory_order_relaxed);
+            return true;
+        });
+        if (pagedOut) m_files->PageOuts.fetch_add(1, std::memory_order_relaxed);
+        return pagedOut;
+    }
+
+    ChunkSwapStore::Stats ChunkSwapStore::GetStats() const {
+        return {
+            .PageOuts = m_files->PageOuts.load(std::memory_order_relaxed),
+            .SkippedWrites = m_files->SkippedWrites.load(std::memory_order_relaxed),
+            .PageIns = m_files->PageIns.load(std::memory_order_relaxed),
+            .FailedPageIns = m_files->FailedPageIns.load(std::memory_order_relaxed),
+            .BytesWritten = m_files->BytesWritten.load(std::memory_order_relaxed),
+            .BytesRead = m_files->BytesRead.load(std::memory_order_relaxed)
+        };
+    }
+
+    ChunkSwapStore::SwapFiles::~SwapFiles() {
+        std::error_code error;
+        std::filesystem::remove_all(Directory, error);
+        if (error) Spire::warn("Failed to remove swap directory {}: {}", Directory.string(), error.message());
+    }
+} // SpireVoxel
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Chunk/ChunkVoxelStorage.h"
+
+#include <mutex>
+
+namespace SpireVoxel {
+    // Where paged out chunk voxels are kept, one VoxelSerializer chunk file per chunk position
+    // The files are deleted once the store and every storage paged out to it have been destroyed
+    class ChunkSwapStore {
+    public:
+        struct Stats {
+            glm::u64 PageOuts = 0;
+            glm::u64 SkippedWrites = 0; // page outs where the swap file was already up to date
+            glm::u64 PageIns = 0;
+            glm::u64 FailedPageIns = 0;
+            glm::u64 BytesWritten = 0;
+            glm::u64 BytesRead = 0;
+        };
+
+        // The store uses a new directory inside rootDirectory, the system temp directory if empty
+        explicit ChunkSwapStore(const std::filesystem::path &rootDirectory = {});
+
+        DISABLE_COPY(ChunkSwapStore)
+
+        // Write the voxels to the chunk's swap file (unless fileIsCurrent) and page out the storage
+        // The storage reads the file back the next time it is accessed, from any thread
+        // Nothing else can be using the storage, storages for different chunk positions can be paged out in parallel
+        bool PageOut(ChunkVoxelStorage &storage, glm::ivec3 chunkPosition, bool fileIsCurrent);
+
+        [[nodiscard]] Stats GetStats() const;
+
+        [[nodiscard]] const std::filesystem::path &GetDirectory() const { return m_files->Directory; }
+
+    private:
+        // Shared with the page in functions of paged out storages so the files outlive the store if needed
+        struct SwapFiles {
+            std::filesystem::path Directory;
+            std::once_flag CreateDirectoryFlag;
+            std::atomic<glm::u64> PageOuts = 0;
+            std::atomic<glm::u64> SkippedWrites = 0;
+            std::atomic<glm::u64> PageIns = 0;
+            std::atomic<glm::u64> FailedPageIns = 0;
+            std::atomic<glm::u64> BytesWritten = 0;
+            std::atomic<glm::u64> BytesRead = 0;
+
+            ~SwapFiles();
+        };
+
+        std::shared_ptr<SwapFiles> m_files;
+    };
+} // SpireVoxel
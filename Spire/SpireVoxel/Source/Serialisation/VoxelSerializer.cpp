@@ -4,12 +4,27 @@
 #include "Chunk/VoxelWorld.h"
 #include "Rendering/VoxelWorldRenderer.h"
 #include "Utils/FileIO.h"
+#include "Utils/TaskGraph.h"
 
 namespace SpireVoxel {
     void VoxelSerializer::Serialize(VoxelWorld &world, const std::filesystem::path &directory) {
+        // don't save half generated chunks
+        world.GetProceduralGenerationManager().WaitForAllGeneration();
+
+        // created once here, chunks racing to create it could fail
+        if (!std::filesystem::exists(directory) && !std::filesystem::create_directories(directory)) {
+            Spire::error("Failed to create directory {} to serialize world", directory.string());
+            return;
+        }
+
+        // writing is mostly waiting on the disk, IO tasks are limited to a few workers so generation and meshing keep running
+        Spire::TaskGraph &taskGraph = Spire::TaskGraph::Instance();
+        Spire::TaskGroup writeGroup;
         for (const auto &[_, chunk] : world) {
-            SerializeChunk(*chunk, directory);
+            const Chunk *serialized = chunk.get();
+            taskGraph.Submit([serialized, &directory] { SerializeChunk(*serialized, directory); }, {}, &writeGroup, Spire::TaskPriority::IO);
         }
+        taskGraph.Wait(writeGroup);
 
         Spire::info("Saved {} chunks to {}", world.NumLoadedChunks(), directory.string());
     }
@@ -26,15 +41,95 @@ namespace SpireVoxel {
             return;
         }
 
-        std::filesystem::path path = GetFilePath(chunk.ChunkPosition, directory);
+        chunk.Touch();
+        WriteChunkFile(GetFilePath(chunk.ChunkPosition, directory), chunk.ChunkPosition, chunk.GetVoxelData());
+    }
+
+    bool VoxelSerializer::WriteChunkFile(const std::filesystem::path &path, glm::ivec3 chunkPosition, const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels) {
         std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
 
         file.write(HEADER_IDENTIFIER.data(), HEADER_IDENTIFIER.size());
         file.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
-        file.write(reinterpret_cast<const char *>(&chunk.ChunkPosition), sizeof(chunk.ChunkPosition));
-        file.write(reinterpret_cast<const char *>(chunk.VoxelData.data()), chunk.VoxelData.size() * sizeof(chunk.VoxelData[0]));
+        file.write(reinterpret_cast<const char *>(&chunkPosition), sizeof(chunkPosition));
+        file.write(reinterpret_cast<const char *>(voxels.data()), voxels.size() * sizeof(voxels[0]));
 
         file.close();
+        if (!file) {
+            Spire::error("Failed to write chunk file {}", path.string());
+            return false;
+        }
+        return true;
+    }
+
+    bool VoxelSerializer::ReadChunkFile(const std::filesystem::path &path, glm::ivec3 &chunkPosition, std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels) {
+        std::ifstream file(path, std::ios_base::binary);
+        if (!file) return false;
+
+        std::uint32_t version{};
+        if (!ReadChunkFileHeader(file, path, version, chunkPosition)) return false;
+
+        bool migrated = false;
+        return ReadChunkFileVoxels(file, path, version, chunkPosition, voxels, migrated);
+    }
+
+    bool VoxelSerializer::ReadChunkFileHeader(std::ifstream &file, const std::filesystem::path &filePath, std::uint32_t &version, glm::ivec3 &chunkPosition) {
+        std::remove_const_t<decltype(HEADER_IDENTIFIER)> identifier;
+        if (!file.read(identifier.data(), identifier.size()) || identifier != HEADER_IDENTIFIER) {
+            Spire::error("Failed to read .sprc file - invalid identifier {}", filePath.string());
+            return false;
+        }
+
+        if (!file.read(reinterpret_cast<char *>(&version), sizeof(version)) || version > VERSION) {
+            Spire::error("Failed to read version of {}", filePath.string());
+            return false;
+        }
+
+        if (!file.read(reinterpret_cast<char *>(&chunkPosition), sizeof(chunkPosition))) {
+            Spire::error("Failed to read chunk position of {}", filePath.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool VoxelSerializer::ReadChunkFileVoxels(
+        std::ifstream &file,
+        const std::filesystem::path &filePath,
+        std::uint32_t version,
+        glm::ivec3 chunkPosition,
+        std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxelData,
+        bool &migrated
+    ) {
+        if (version < VOXEL_TYPE_U32_TO_U16_VERSION) {
+            std::vector<std::uint32_t> legacy(voxelData.size());
+            if (!file.read(reinterpret_cast<char *>(legacy.data()), legacy.size() * sizeof(std::uint32_t))) {
+                Spire::error("Failed to read legacy voxel data of {}", filePath.string());
+                return false;
+            }
+
+            for (std::size_t i = 0; i < legacy.size(); ++i) {
+                voxelData[i] = static_cast<std::uint16_t>(legacy[i]);
+            }
+
+            migrated = true;
+
+            Spire::info(
+                "Migrated chunk {} {} {} to latest voxel format",
+                chunkPosition.x, chunkPosition.y, chunkPosition.z
+            );
+        } else {
+            if (!file.read(reinterpret_cast<char *>(voxelData.data()),
+                           voxelData.size() * sizeof(voxelData[0]))) {
+                Spire::error(
+                    "Failed to read chunk voxel data of {} (chunk {} {} {})",
+                    filePath.string(),
+                    chunkPosition.x, chunkPosition.y, chunkPosition.z
+                );
+                return false;
+            }
+        }
+
+        return true;
     }
 
     void VoxelSerializer::ClearAndDeserialize(
@@ -89,56 +184,16 @@ namespace SpireVoxel {
         std::ifstream file(filePath, std::ios_base::binary);
         if (!file) return result;
 
-        std::remove_const_t<decltype(HEADER_IDENTIFIER)> identifier;
-        if (!file.read(identifier.data(), identifier.size()) || identifier != HEADER_IDENTIFIER) {
-            Spire::error("Failed to read .sprc file - invalid identifier {}", filePath.string());
-            return result;
-        }
-
         std::uint32_t version{};
-        if (!file.read(reinterpret_cast<char *>(&version), sizeof(version)) || version > VERSION) {
-            Spire::error("Failed to read version of {}", filePath.string());
-            return result;
-        }
-
-        if (!file.read(reinterpret_cast<char *>(&result.ChunkPos), sizeof(result.ChunkPos))) {
-            Spire::error("Failed to read chunk position of {}", filePath.string());
-            return result;
-        }
+        if (!ReadChunkFileHeader(file, filePath, version, result.ChunkPos)) return result;
 
         Chunk &chunk = world.LoadChunk(result.ChunkPos);
         assert(!chunk.IsCorrupted());
-
-        if (version < VOXEL_TYPE_U32_TO_U16_VERSION) {
-            std::vector<std::uint32_t> legacy(chunk.VoxelData.size());
-            if (!file.read(reinterpret_cast<char *>(legacy.data()), legacy.size() * sizeof(std::uint32_t))) {
-                Spire::error("Failed to read legacy voxel data of {}", filePath.string());
-                return result;
-            }
-
-            for (std::size_t i = 0; i < legacy.size(); ++i) {
-                chunk.VoxelData[i] = static_cast<std::uint16_t>(legacy[i]);
-            }
-
-            result.Migrated = true;
-
-            Spire::info(
-                "Migrated chunk {} {} {} to latest voxel format",
-                result.ChunkPos.x, result.ChunkPos.y, result.ChunkPos.z
-            );
-        } else {
-            if (!file.read(reinterpret_cast<char *>(chunk.VoxelData.data()),
-                           chunk.VoxelData.size() * sizeof(chunk.VoxelData[0]))) {
-                Spire::error(
-                    "Failed to read chunk voxel data of {} (chunk {} {} {})",
-                    filePath.string(),
-                    result.ChunkPos.x, result.ChunkPos.y, result.ChunkPos.z
-                );
-                return result;
-            }
-        }
-
-        chunk.RegenerateVoxelBits();
+        bool read = false;
+        chunk.ModifyVoxels([&](std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxelData) {
+            read = ReadChunkFileVoxels(file, filePath, version, result.ChunkPos, voxelData, result.Migrated);
+        });
+        if (!read) return result;
         assert(!chunk.IsCorrupted());
 
         world.GetRenderer().NotifyChunkEdited(chunk);
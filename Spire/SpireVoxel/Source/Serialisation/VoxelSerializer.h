@@ -32,10 +32,28 @@ namespace SpireVoxel {
 
         [[nodiscard]] static std::filesystem::path GetFilePath(glm::ivec3 chunkCoords, const std::filesystem::path &directory);
 
+        // Write/read a single chunk file without going through a world (used by ChunkSwapStore)
+        // Reading migrates old versions but doesn't rewrite the file
+        static bool WriteChunkFile(const std::filesystem::path &path, glm::ivec3 chunkPosition, const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels);
+
+        static bool ReadChunkFile(const std::filesystem::path &path, glm::ivec3 &chunkPosition, std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels);
+
     public:
         static constexpr std::uint32_t VERSION = 2;
         static constexpr std::uint32_t VOXEL_TYPE_U32_TO_U16_VERSION = 2; // this version changes voxel types from u32 to u16
 
+    private:
+        static bool ReadChunkFileHeader(std::ifstream &file, const std::filesystem::path &filePath, std::uint32_t &version, glm::ivec3 &chunkPosition);
+
+        static bool ReadChunkFileVoxels(
+            std::ifstream &file,
+            const std::filesystem::path &filePath,
+            std::uint32_t version,
+            glm::ivec3 chunkPosition,
+            std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxelData,
+            bool &migrated
+        );
+
     private:
         static constexpr std::array<char, 10> HEADER_IDENTIFIER{'S', 'P', 'R', 'V', 'X', 'L', 'C', 'H', 'N', 'K'};
     };
@@ -7,16 +7,16 @@ namespace SpireVoxel {
     public:
         ClosestUtil() = delete;
 
-        // Container should be a collection of glm::uvec3
+        // Container should be a collection of glm::ivec3 (e.g. chunk positions, which can be negative)
         // Return the closest std::min(maxCount, coords.length()) coords to origin
         template<typename Container>
-        [[nodiscard]] static std::vector<glm::uvec3> GetClosestCoords(
+        [[nodiscard]] static std::vector<glm::ivec3> GetClosestCoords(
             const Container &coords,
             glm::vec3 origin,
             std::size_t maxCount
         ) {
             struct Entry {
-                glm::uvec3 coords;
+                glm::ivec3 coords;
                 float distanceSquared;
 
                 bool operator<(const Entry &other) const {
@@ -26,7 +26,7 @@ namespace SpireVoxel {
 
             std::priority_queue<Entry> queue;
 
-            for (const glm::uvec3 &c : coords) {
+            for (const glm::ivec3 &c : coords) {
                 glm::vec3 delta = static_cast<glm::vec3>(c) - origin;
 
                 float distanceSquared = glm::dot(delta, delta);
@@ -39,7 +39,7 @@ namespace SpireVoxel {
                 }
             }
 
-            std::vector<glm::uvec3> result;
+            std::vector<glm::ivec3> result;
             result.reserve(queue.size());
 
             while (!queue.empty()) {
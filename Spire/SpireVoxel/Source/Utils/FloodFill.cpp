@@ -0,0 +1,209 @@
+#include "FloodFill.h"
+
+#include "Chunk/Chunk.h"
+#include "Chunk/VoxelWorld.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    // word index of a row is x * 64 + y
+    static constexpr glm::u32 ROW_STRIDE_X = SPIRE_VOXEL_CHUNK_SIZE;
+    static constexpr glm::u32 LAST = SPIRE_VOXEL_CHUNK_SIZE - 1;
+
+    FloodFill::Result FloodFill::Fill(const VoxelWorld &world, glm::ivec3 start, Through through) {
+        return Fill(world, start, through, Settings{});
+    }
+
+    FloodFill::Result FloodFill::Fill(const VoxelWorld &world, glm::ivec3 start, Through through, Settings settings) {
+        assert(world.IsOwnerThread());
+        VoxelType startType = world.GetVoxelAt(start);
+
+        // masks are built the first time the fill reaches a chunk
+        std::unordered_map<glm::ivec3, VoxelBitmask> passableMasks;
+        auto passable = [&](glm::ivec3 chunkPosition) -> const VoxelBitmask * {
+            const Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+            if (!chunk || chunk->LOD.Scale != 1) return nullptr;
+
+            VoxelBitmask &mask = passableMasks[chunkPosition];
+            const VoxelBitmask &bits = chunk->GetVoxelBits();
+            switch (through) {
+                case Through::AIR:
+                    for (std::size_t word = 0; word < VoxelBitmask::NUM_WORDS; word++) mask.GetWords()[word] = ~bits.GetWord(word);
+                    break;
+                case Through::SOLID:
+                    mask = bits;
+                    break;
+                case Through::SAME_TYPE: {
+                    const std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels = chunk->GetVoxelData();
+                    for (std::size_t word = 0; word < VoxelBitmask::NUM_WORDS; word++) {
+                        glm::u64 row = 0;
+                        for (glm::u32 z = 0; z < SPIRE_VOXEL_CHUNK_SIZE; z++) {
+                            row |= static_cast<glm::u64>(voxels[word * SPIRE_VOXEL_CHUNK_SIZE + z] == startType) << z;
+                        }
+                        mask.GetWords()[word] = row;
+                    }
+                    break;
+                }
+            }
+            return &mask;
+        };
+
+        return Fill(passable, start, settings);
+    }
+
+    FloodFill::Result FloodFill::Fill(const PassableLookup &passable, glm::ivec3 start, Settings settings) {
+        Spire::Timer timer;
+        Result result;
+
+        struct ChunkFill {
+            const VoxelBitmask *Passable = nullptr;
+            VoxelBitmask Filled;
+            glm::u64 NumFilled = 0;
+            bool Queued = false;
+        };
+
+        // references to elements of an unordered_map stay valid when it grows
+        std::unordered_map<glm::ivec3, ChunkFill> fills;
+        std::vector<glm::ivec3> queue;
+
+        glm::ivec3 startChunk = VoxelWorld::GetChunkPositionOfVoxel(start);
+        glm::u32 startIndex = SPIRE_VOXEL_POSITION_TO_INDEX(start - startChunk * SPIRE_VOXEL_CHUNK_SIZE);
+        const VoxelBitmask *startPassable = passable(startChunk);
+        if (!startPassable) {
+            result.ReachedUnloadedChunk = true;
+            return result;
+        }
+        if (!startPassable->Test(startIndex)) return result;
+
+        ChunkFill &startFill = fills[startChunk];
+        startFill.Passable = startPassable;
+        startFill.Filled.Set(startIndex, true);
+        startFill.Queued = true;
+        queue.push_back(startChunk);
+
+        while (!queue.empty()) {
+            glm::ivec3 chunkPosition = queue.back();
+            queue.pop_back();
+            ChunkFill &fill = fills.at(chunkPosition);
+            fill.Queued = false;
+
+            FillChunk(*fill.Passable, fill.Filled);
+            glm::u64 numFilled = fill.Filled.Count();
+            result.NumVoxels += numFilled - fill.NumFilled;
+            fill.NumFilled = numFilled;
+            if (result.NumVoxels > settings.MaxVoxels) {
+                result.ReachedMaxVoxels = true;
+                break;
+            }
+
+            // seed the neighbours with the filled voxels on each face, seed(word of the neighbour, bits of that word)
+            const glm::u64 *filled = fill.Filled.GetWords();
+            auto spread = [&](glm::ivec3 direction, auto &&forEachBorderRow) {
+                ChunkFill *neighbour = nullptr;
+                bool seeded = false;
+                forEachBorderRow([&](glm::u32 toWord, glm::u64 seeds) {
+                    if (seeds == 0 || (neighbour && !neighbour->Passable)) return;
+                    if (!neighbour) {
+                        auto [it, inserted] = fills.try_emplace(chunkPosition + direction);
+                        neighbour = &it->second;
+                        if (inserted) neighbour->Passable = passable(chunkPosition + direction);
+                        if (!neighbour->Passable) {
+                            result.ReachedUnloadedChunk = true;
+                            return;
+                        }
+                    }
+
+                    glm::u64 &neighbourWord = neighbour->Filled.GetWords()[toWord];
+                    glm::u64 added = seeds & neighbour->Passable->GetWord(toWord) & ~neighbourWord;
+                    neighbourWord |= added;
+                    seeded |= added != 0;
+                });
+
+                if (seeded && !neighbour->Queued) {
+                    neighbour->Queued = true;
+                    queue.push_back(chunkPosition + direction);
+                }
+            };
+
+            spread({1, 0, 0}, [&](auto &&seed) {
+                for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE; y++) seed(y, filled[LAST * ROW_STRIDE_X + y]);
+            });
+            spread({-1, 0, 0}, [&](auto &&seed) {
+                for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE; y++) seed(LAST * ROW_STRIDE_X + y, filled[y]);
+            });
+            spread({0, 1, 0}, [&](auto &&seed) {
+                for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE; x++) seed(x * ROW_STRIDE_X, filled[x * ROW_STRIDE_X + LAST]);
+            });
+            spread({0, -1, 0}, [&](auto &&seed) {
+                for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE; x++) seed(x * ROW_STRIDE_X + LAST, filled[x * ROW_STRIDE_X]);
+            });
+            spread({0, 0, 1}, [&](auto &&seed) {
+                for (glm::u32 word = 0; word < VoxelBitmask::NUM_WORDS; word++) seed(word, filled[word] >> LAST);
+            });
+            spread({0, 0, -1}, [&](auto &&seed) {
+                for (glm::u32 word = 0; word < VoxelBitmask::NUM_WORDS; word++) seed(word, (filled[word] & 1) << LAST);
+            });
+        }
+
+        for (auto &[chunkPosition, fill] : fills) {
+            if (fill.NumFilled > 0) result.Chunks.emplace(chunkPosition, fill.Filled);
+        }
+
+        if (LOG) Spire::info("[FloodFill] Filled {} voxels in {} chunks in {} ms", result.NumVoxels, result.Chunks.size(), timer.MillisSinceStart());
+        return result;
+    }
+
+    void FloodFill::FillChunk(const VoxelBitmask &passable, VoxelBitmask &filled) {
+        const glm::u64 *passableWords = passable.GetWords();
+        glm::u64 *filledWords = filled.GetWords();
+
+        // new seeds haven't been filled along their rows yet
+        for (std::size_t word = 0; word < VoxelBitmask::NUM_WORDS; word++) {
+            if (filledWords[word] != 0) filledWords[word] = FillRow(filledWords[word] & passableWords[word], passableWords[word]);
+        }
+
+        // every row is filled along z, so a row only changes if a row next to it in x or y has filled more
+        // sweeps alternate direction so the fill spreads the whole way across the chunk in one sweep in either direction
+        bool changed = true;
+        for (glm::u32 sweep = 0; changed; sweep++) {
+            changed = false;
+            bool forwards = sweep % 2 == 0;
+            for (std::size_t i = 0; i < VoxelBitmask::NUM_WORDS; i++) {
+                std::size_t word = forwards ? i : VoxelBitmask::NUM_WORDS - 1 - i;
+                glm::u64 passableRow = passableWords[word];
+                if (passableRow == 0) continue;
+
+                glm::u32 x = word / ROW_STRIDE_X;
+                glm::u32 y = word % ROW_STRIDE_X;
+                glm::u64 row = filledWords[word];
+                glm::u64 seeds = row;
+                if (y > 0) seeds |= filledWords[word - 1];
+                if (y < LAST) seeds |= filledWords[word + 1];
+                if (x > 0) seeds |= filledWords[word - ROW_STRIDE_X];
+                if (x < LAST) seeds |= filledWords[word + ROW_STRIDE_X];
+                seeds &= passableRow;
+                if (seeds == row) continue;
+
+                filledWords[word] = FillRow(seeds, passableRow);
+                changed = true;
+            }
+        }
+    }
+
+    glm::u64 FloodFill::FillRow(glm::u64 seeds, glm::u64 passable) {
+        assert((seeds & ~passable) == 0);
+
+        // occluded fill in both directions, each step doubles how far the seeds have spread (Kogge-Stone)
+        glm::u64 up = seeds;
+        glm::u64 down = seeds;
+        glm::u64 passableUp = passable;
+        glm::u64 passableDown = passable;
+        for (glm::u32 shift = 1; shift < SPIRE_VOXEL_CHUNK_SIZE; shift *= 2) {
+            up |= passableUp & (up << shift);
+            passableUp &= passableUp << shift;
+            down |= passableDown & (down >> shift);
+            passableDown &= passableDown >> shift;
+        }
+        return up | down;
+    }
+} // SpireVoxel
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "Chunk/VoxelBitmask.h"
+#include "Chunk/VoxelType.h"
+
+namespace SpireVoxel {
+    class VoxelWorld;
+
+    // Flood fill (6 connected) across chunk borders, for tools like "fill enclosed area", "delete floating island" and "replace connected type"
+    // Works on VoxelBitmask words: each word is a row of 64 voxels along z, so a row is filled along z in a few shifts
+    // and spreads to the rows next to it in x and y with a single OR, like greedy meshing
+    class FloodFill {
+    public:
+        FloodFill() = delete;
+
+        // Filled voxels of each chunk, can be applied with MaskVoxelEdit
+        using ChunkMasks = std::unordered_map<glm::ivec3, VoxelBitmask>;
+
+        // Returns the voxels of a chunk the fill can spread through, or nullptr if the chunk isn't loaded
+        // The pointer must stay valid until the fill returns
+        using PassableLookup = std::function<const VoxelBitmask *(glm::ivec3 chunkPosition)>;
+
+        enum class Through {
+            AIR, // e.g. filling an enclosed cavity
+            SOLID, // e.g. finding an island
+            SAME_TYPE // voxels of the same type as the start voxel
+        };
+
+        struct Settings {
+            glm::u64 MaxVoxels = 16 * 1024 * 1024; // the fill stops once it has filled more than this
+        };
+
+        struct Result {
+            ChunkMasks Chunks;
+            glm::u64 NumVoxels = 0;
+            bool ReachedUnloadedChunk = false; // the fill leaked into a chunk that isn't loaded
+            bool ReachedMaxVoxels = false; // the fill stopped early, Chunks is only part of the region
+
+            // true if the region is enclosed by loaded voxels and fully filled
+            [[nodiscard]] bool IsComplete() const { return !ReachedUnloadedChunk && !ReachedMaxVoxels; }
+        };
+
+    public:
+        // Fill from start through voxels of loaded full detail chunks, owner thread only
+        [[nodiscard]] static Result Fill(const VoxelWorld &world, glm::ivec3 start, Through through);
+
+        [[nodiscard]] static Result Fill(const VoxelWorld &world, glm::ivec3 start, Through through, Settings settings);
+
+        // Fill from start through the voxels passable returns, filling is empty if start isn't passable
+        [[nodiscard]] static Result Fill(const PassableLookup &passable, glm::ivec3 start, Settings settings);
+
+        // Grow filled through passable within a single chunk until it stops changing
+        static void FillChunk(const VoxelBitmask &passable, VoxelBitmask &filled);
+
+        // Grow the seed bits of a row along z through the passable bits (seeds must be passable)
+        [[nodiscard]] static glm::u64 FillRow(glm::u64 seeds, glm::u64 passable);
+    };
+} // SpireVoxel
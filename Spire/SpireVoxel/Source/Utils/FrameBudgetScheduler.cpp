@@ -0,0 +1,51 @@
+#include "FrameBudgetScheduler.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    FrameBudgetScheduler::FrameBudgetScheduler() : FrameBudgetScheduler(Settings{}) {
+    }
+
+    FrameBudgetScheduler::FrameBudgetScheduler(Settings settings) : m_settings(settings) {
+        assert(m_settings.Smoothing > 0 && m_settings.Smoothing <= 1);
+    }
+
+    FrameBudgetScheduler::JobType FrameBudgetScheduler::Register(const std::string &name, float initialUnitCostMillis) {
+        m_jobs.push_back({name, initialUnitCostMillis, 0, 0});
+        m_lastAdmittedFrames.push_back(m_frame);
+        return static_cast<JobType>(m_jobs.size() - 1);
+    }
+
+    void FrameBudgetScheduler::BeginFrame() {
+        if (LOG && m_usedMillis > m_settings.BudgetMillis) {
+            Spire::info("[FrameBudgetScheduler] Used {} ms of {} ms", m_usedMillis, m_settings.BudgetMillis);
+        }
+        m_usedMillis = 0;
+        m_frame++;
+    }
+
+    glm::u32 FrameBudgetScheduler::Admit(JobType type, glm::u32 count, glm::u32 minCount) {
+        JobStats &job = m_jobs.at(type);
+        glm::u32 admitted = count;
+        if (job.UnitCostMillis > 0) {
+            float fits = std::floor(GetRemainingMillis() / job.UnitCostMillis);
+            if (fits < static_cast<float>(count)) admitted = static_cast<glm::u32>(fits);
+        }
+        // the estimate only changes when work runs, so an estimate over the budget would never be measured again
+        if (m_frame - m_lastAdmittedFrames[type] >= m_settings.MaxStarvedFrames) minCount = std::max(minCount, 1u);
+        admitted = std::min(count, std::max(admitted, minCount));
+        job.UnitsDeferred += count - admitted;
+        if (admitted > 0 || count == 0) m_lastAdmittedFrames[type] = m_frame;
+        return admitted;
+    }
+
+    void FrameBudgetScheduler::Report(JobType type, glm::u32 units, float millis) {
+        m_usedMillis += millis;
+        if (units == 0) return;
+
+        JobStats &job = m_jobs.at(type);
+        job.UnitsRun += units;
+        float unitMillis = millis / static_cast<float>(units);
+        job.UnitCostMillis += m_settings.Smoothing * (unitMillis - job.UnitCostMillis);
+    }
+} // SpireVoxel
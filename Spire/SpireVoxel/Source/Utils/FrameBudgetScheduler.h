@@ -0,0 +1,69 @@
+#pragma once
+
+#include "EngineIncludes.h"
+
+namespace SpireVoxel {
+
+    // Shares a per frame millisecond budget between world maintenance work (mesh uploads, compression, generation...)
+    // Each kind of work is registered as a job type with an estimated cost per unit (e.g. per chunk),
+    // work is admitted while its estimated cost fits in what is left of the budget and the estimates are learnt from measured durations
+    // Overrunning the budget is limited to one misestimated batch
+    // Owner thread only
+    class FrameBudgetScheduler {
+    public:
+        using JobType = glm::u32;
+
+        struct Settings {
+            float BudgetMillis = 4.0f;
+            float Smoothing = 0.25f; // how much each measurement moves the cost estimate, 1 only uses the latest
+            glm::u32 MaxStarvedFrames = 30; // work that hasn't been admitted for this many frames is admitted one unit to measure its cost again
+        };
+
+        struct JobStats {
+            std::string Name;
+            float UnitCostMillis; // current estimate
+            glm::u64 UnitsRun;
+            glm::u64 UnitsDeferred; // asked for but not admitted, summed over frames
+        };
+
+    public:
+        FrameBudgetScheduler();
+
+        explicit FrameBudgetScheduler(Settings settings);
+
+        DISABLE_COPY_AND_MOVE(FrameBudgetScheduler)
+
+    public:
+        [[nodiscard]] JobType Register(const std::string &name, float initialUnitCostMillis);
+
+        // Call at the start of each frame
+        void BeginFrame();
+
+        // Number of count units that fit in the remaining budget, never less than minCount
+        // Work that asked for units but got none for MaxStarvedFrames frames gets one, so one slow measurement can't defer it forever
+        // Call Report once the work is done
+        [[nodiscard]] glm::u32 Admit(JobType type, glm::u32 count, glm::u32 minCount = 0);
+
+        // Charge the measured time of admitted work to the budget and learn the cost per unit
+        void Report(JobType type, glm::u32 units, float millis);
+
+        [[nodiscard]] float GetUsedMillis() const { return m_usedMillis; }
+
+        [[nodiscard]] float GetRemainingMillis() const { return std::max(0.0f, m_settings.BudgetMillis - m_usedMillis); }
+
+        [[nodiscard]] float GetBudgetMillis() const { return m_settings.BudgetMillis; }
+
+        void SetBudgetMillis(float budgetMillis) { m_settings.BudgetMillis = budgetMillis; }
+
+        [[nodiscard]] float GetUnitCostMillis(JobType type) const { return m_jobs.at(type).UnitCostMillis; }
+
+        [[nodiscard]] const std::vector<JobStats> &GetJobStats() const { return m_jobs; }
+
+    private:
+        Settings m_settings;
+        std::vector<JobStats> m_jobs; // indexed by JobType
+        std::vector<glm::u64> m_lastAdmittedFrames; // per JobType, also updated when nothing was asked for
+        glm::u64 m_frame = 0;
+        float m_usedMillis = 0;
+    };
+} // SpireVoxel
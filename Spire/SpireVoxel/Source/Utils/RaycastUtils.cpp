@@ -2,8 +2,44 @@
 #include <glm/gtc/epsilon.hpp>
 #include "../../Assets/Shaders/ShaderInfo.h"
 #include "Chunk/VoxelWorld.h"
+#include "Chunk/Chunk.h"
 
 namespace SpireVoxel {
+    // Box of voxels known to be air, the ray can step through it without looking up voxels
+    struct EmptyRegion {
+        glm::ivec3 Min = {};
+        glm::ivec3 Max = {}; // exclusive
+
+        [[nodiscard]] bool Contains(glm::ivec3 voxel) const {
+            return voxel.x >= Min.x && voxel.y >= Min.y && voxel.z >= Min.z &&
+                   voxel.x < Max.x && voxel.y < Max.y && voxel.z < Max.z;
+        }
+    };
+
+    // Returns true if there is a voxel at worldPosition
+    // If there isn't, emptyRegion is set to the largest known empty region containing it (unloaded chunk, empty chunk, empty brick, or nothing)
+    bool IsVoxelAtOrFindEmptyRegion(const VoxelWorld &world, glm::ivec3 worldPosition, EmptyRegion &emptyRegion) {
+        glm::ivec3 chunkPosition = VoxelWorld::GetChunkPositionOfVoxel(worldPosition);
+        glm::ivec3 chunkOrigin = chunkPosition * SPIRE_VOXEL_CHUNK_SIZE;
+        const Chunk *chunk = world.TryGetLoadedChunk(chunkPosition);
+        if (chunk) chunk->Touch();
+
+        if (!chunk || chunk->GetOccupancy().IsEmpty()) {
+            emptyRegion = {chunkOrigin, chunkOrigin + glm::ivec3(SPIRE_VOXEL_CHUNK_SIZE)};
+            return false;
+        }
+
+        glm::uvec3 positionInChunk = worldPosition - chunkOrigin;
+        if (chunk->GetOccupancy().IsBrickEmpty(ChunkOccupancy::GetBrickIndexOfVoxel(positionInChunk))) {
+            glm::ivec3 brickOrigin = chunkOrigin + glm::ivec3(positionInChunk / ChunkOccupancy::BRICK_SIZE * ChunkOccupancy::BRICK_SIZE);
+            emptyRegion = {brickOrigin, brickOrigin + glm::ivec3(ChunkOccupancy::BRICK_SIZE)};
+            return false;
+        }
+
+        emptyRegion = {};
+        return chunk->GetVoxel(SPIRE_VOXEL_POSITION_TO_INDEX(positionInChunk)) != VOXEL_TYPE_AIR;
+    }
+
     RaycastUtils::Hit RaycastUtils::Raycast(VoxelWorld &world,
                                             glm::vec3 position,
                                             glm::vec3 normalizedForward,
@@ -43,6 +79,7 @@ namespace SpireVoxel {
         Hit hit = {.HitAnything = false};
 
         int lastAxis = -1;
+        EmptyRegion emptyRegion = {};
 
         while (true) {
             glm::vec3 voxelCenter = glm::vec3(voxel) + 0.5f;
@@ -52,7 +89,8 @@ namespace SpireVoxel {
                 return hit;
             }
 
-            if (world.IsVoxelAt(voxel)) {
+            // skip lookups while inside empty space
+            if (!emptyRegion.Contains(voxel) && IsVoxelAtOrFindEmptyRegion(world, voxel, emptyRegion)) {
                 hit.HitAnything = true;
                 hit.VoxelPosition = voxel;
                 if (lastAxis == 0) hit.Face = step.x > 0 ? SPIRE_VOXEL_FACE_NEG_X : SPIRE_VOXEL_FACE_POS_X;
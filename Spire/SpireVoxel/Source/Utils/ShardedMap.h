@@ -0,0 +1,195 @@
+#pragma once
+
+#include "EngineIncludes.h"
+
+#include <shared_mutex>
+
+namespace SpireVoxel {
+    // unordered_map split into shards, each guarded by its own reader/writer lock
+    // Lookups from any thread only take a shared lock on one shard, so they don't contend with each other
+    // Insertion, removal and iteration must all happen on a single owner thread:
+    //  - the owner can iterate without locking because nothing else changes the map
+    //  - other threads may look up values while the owner inserts/removes, the shard lock protects them from rehashing
+    // Values are not protected by the map, only the key -> value table is
+    template<typename Key, typename Value, std::size_t NumShards = 64>
+    class ShardedMap {
+        static_assert(NumShards > 0 && (NumShards & (NumShards - 1)) == 0, "NumShards must be a power of two");
+
+        using Map = std::unordered_map<Key, Value>;
+
+        struct Shard {
+            mutable std::shared_mutex Mutex;
+            Map Values;
+        };
+
+    public:
+        // Iterates shard by shard, yields the std::pair<const Key, Value> of the underlying maps
+        // Like std::unordered_map the order is stable as long as the map isn't changed
+        template<typename MapIterator, typename ShardArray>
+        class IteratorBase {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename std::iterator_traits<MapIterator>::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::iterator_traits<MapIterator>::pointer;
+            using reference = typename std::iterator_traits<MapIterator>::reference;
+
+            IteratorBase() = default;
+
+            IteratorBase(ShardArray *shards, std::size_t shardIndex) : m_shards(shards), m_shardIndex(shardIndex) {
+                if (m_shardIndex < NumShards) {
+                    m_iterator = (*m_shards)[m_shardIndex].Values.begin();
+                    SkipEmptyShards();
+                }
+            }
+
+            reference operator*() const { return *m_iterator; }
+
+            pointer operator->() const { return &*m_iterator; }
+
+            IteratorBase &operator++() {
+                ++m_iterator;
+                SkipEmptyShards();
+                return *this;
+            }
+
+            IteratorBase operator++(int) {
+                IteratorBase copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            bool operator==(const IteratorBase &other) const {
+                if (m_shardIndex != other.m_shardIndex) return false;
+                return m_shardIndex >= NumShards || m_iterator == other.m_iterator;
+            }
+
+            bool operator!=(const IteratorBase &other) const { return !(*this == other); }
+
+        private:
+            void SkipEmptyShards() {
+                while (m_iterator == (*m_shards)[m_shardIndex].Values.end()) {
+                    m_shardIndex++;
+                    if (m_shardIndex >= NumShards) return;
+                    m_iterator = (*m_shards)[m_shardIndex].Values.begin();
+                }
+            }
+
+        private:
+            ShardArray *m_shards = nullptr;
+            std::size_t m_shardIndex = NumShards;
+            MapIterator m_iterator = {};
+        };
+
+        using Iterator = IteratorBase<typename Map::iterator, std::array<Shard, NumShards> >;
+        using ConstIterator = IteratorBase<typename Map::const_iterator, const std::array<Shard, NumShards> >;
+
+    public:
+        ShardedMap() = default;
+
+        DISABLE_COPY(ShardedMap)
+
+        // Thread safe
+        // Returns a copy of the value (e.g. a pointer) so the shard lock isn't held after returning
+        [[nodiscard]] std::optional<Value> TryGet(const Key &key) const requires std::is_copy_constructible_v<Value> {
+            const Shard &shard = GetShard(key);
+            std::shared_lock lock(shard.Mutex);
+            auto it = shard.Values.find(key);
+            if (it == shard.Values.end()) return std::nullopt;
+            return it->second;
+        }
+
+        // Thread safe
+        // Calls function(const Value &) with the shard locked if the key exists, returns the result or defaultResult
+        template<typename Result, typename Function>
+        [[nodiscard]] Result Visit(const Key &key, Result defaultResult, Function &&function) const {
+            const Shard &shard = GetShard(key);
+            std::shared_lock lock(shard.Mutex);
+            auto it = shard.Values.find(key);
+            if (it == shard.Values.end()) return defaultResult;
+            return function(it->second);
+        }
+
+        // Thread safe
+        [[nodiscard]] bool Contains(const Key &key) const {
+            const Shard &shard = GetShard(key);
+            std::shared_lock lock(shard.Mutex);
+            return shard.Values.contains(key);
+        }
+
+        // Owner thread only
+        // Returns the value at key and true if createValue was called to insert it
+        template<typename CreateValue>
+        std::pair<Value &, bool> TryEmplace(const Key &key, CreateValue &&createValue) {
+            Shard &shard = GetShard(key);
+            {
+                // the owner thread is the only writer so it doesn't need a lock to read
+                auto it = shard.Values.find(key);
+                if (it != shard.Values.end()) return {it->second, false};
+            }
+
+            Value value = createValue();
+            std::unique_lock lock(shard.Mutex);
+            auto [it, inserted] = shard.Values.try_emplace(key, std::move(value));
+            assert(inserted);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            return {it->second, true};
+        }
+
+        // Owner thread only
+        // Removes the value at key and returns it so it is destroyed outside the lock
+        std::optional<Value> Extract(const Key &key) {
+            Shard &shard = GetShard(key);
+            std::unique_lock lock(shard.Mutex);
+            auto node = shard.Values.extract(key);
+            if (node.empty()) return std::nullopt;
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            return std::move(node.mapped());
+        }
+
+        // Thread safe, but only exact when called from the owner thread
+        [[nodiscard]] std::size_t Size() const { return m_size.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] bool Empty() const { return Size() == 0; }
+
+        // Owner thread only
+        // Approximate heap usage of the table, not including anything the values point to
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const {
+            glm::u64 usage = 0;
+            for (const Shard &shard : m_shards) {
+                usage += Spire::EstimateHashContainerMemoryUsage(shard.Values);
+            }
+            return usage;
+        }
+
+        // Owner thread only
+        Iterator begin() { return Iterator(&m_shards, 0); }
+
+        Iterator end() { return Iterator(&m_shards, NumShards); }
+
+        ConstIterator begin() const { return ConstIterator(&m_shards, 0); }
+
+        ConstIterator end() const { return ConstIterator(&m_shards, NumShards); }
+
+        [[nodiscard]] static std::size_t GetShardIndex(const Key &key) {
+            if constexpr (NumShards == 1) {
+                return 0;
+            } else {
+                // The maps use the low bits of the hash for their buckets, so pick the shard from the high bits of a mixed hash
+                // otherwise every key in a shard would land in the same 1/NumShards of its buckets
+                auto hash = static_cast<glm::u64>(std::hash<Key>{}(key));
+                hash *= 0x9E3779B97F4A7C15ull;
+                return static_cast<std::size_t>(hash >> (64 - std::countr_zero(NumShards)));
+            }
+        }
+
+    private:
+        [[nodiscard]] Shard &GetShard(const Key &key) { return m_shards[GetShardIndex(key)]; }
+
+        [[nodiscard]] const Shard &GetShard(const Key &key) const { return m_shards[GetShardIndex(key)]; }
+
+    private:
+        std::array<Shard, NumShards> m_shards;
+        std::atomic<std::size_t> m_size = 0;
+    };
+} // SpireVoxel
@@ -0,0 +1,77 @@
+#include "SimulationThread.h"
+
+namespace SpireVoxel {
+    static constexpr bool LOG = false;
+
+    SimulationThread::SimulationThread(std::function<void(std::thread::id ownerThread)> setOwnerThread, std::function<void()> tick)
+        : m_setOwnerThread(std::move(setOwnerThread)),
+          m_tick(std::move(tick)),
+          m_thread([this] { Run(); }) {
+        assert(m_setOwnerThread && m_tick);
+    }
+
+    SimulationThread::~SimulationThread() {
+        Wait();
+        {
+            std::unique_lock lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+    }
+
+    void SimulationThread::Kick() {
+        assert(!m_kicked);
+        m_callerThread = std::this_thread::get_id();
+        m_kicked = true;
+
+        // the mutex orders everything the caller did to the world before the tick
+        std::unique_lock lock(m_mutex);
+        assert(!m_tickInFlight);
+        m_setOwnerThread(m_thread.get_id());
+        m_tickRequested = true;
+        m_tickInFlight = true;
+        lock.unlock();
+        m_condition.notify_all();
+    }
+
+    void SimulationThread::Wait() {
+        if (!m_kicked) return;
+        m_kicked = false;
+
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [this] { return !m_tickInFlight; });
+        m_setOwnerThread(m_callerThread);
+    }
+
+    glm::u64 SimulationThread::NumTicks() const {
+        std::unique_lock lock(m_mutex);
+        return m_numTicks;
+    }
+
+    float SimulationThread::GetLastTickMillis() const {
+        std::unique_lock lock(m_mutex);
+        return m_lastTickMillis;
+    }
+
+    void SimulationThread::Run() {
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_condition.wait(lock, [this] { return m_tickRequested || m_stopping; });
+            if (m_stopping) return;
+            m_tickRequested = false;
+            lock.unlock();
+
+            Spire::Timer timer;
+            m_tick();
+            float millis = timer.MillisSinceStart();
+            if (LOG) Spire::info("[SimulationThread] Tick took {} ms", millis);
+
+            lock.lock();
+            m_numTicks++;
+            m_lastTickMillis = millis;
+            m_tickInFlight = false;
+            m_condition.notify_all();
+        }
+    }
+} // SpireVoxel
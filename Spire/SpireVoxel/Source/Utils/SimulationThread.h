@@ -0,0 +1,54 @@
+#pragma once
+
+#include "EngineIncludes.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace SpireVoxel {
+    // Runs one world tick (edits, generation, LOD, meshing dispatch) per frame on its own thread
+    // Kick hands the world to the simulation thread and starts a tick, Wait blocks until it's done and hands the world back,
+    // so the caller can update the camera and UI and render the previous tick's snapshot between the two while the world is being simulated
+    // The caller can only touch the world between Wait and Kick
+    class SimulationThread {
+    public:
+        // setOwnerThread - moves the world to a thread (VoxelWorld::SetOwnerThread), called before each tick starts and once it's done
+        SimulationThread(std::function<void(std::thread::id ownerThread)> setOwnerThread, std::function<void()> tick);
+
+        ~SimulationThread();
+
+        DISABLE_COPY_AND_MOVE(SimulationThread)
+
+    public:
+        // Start a tick, the caller must own the world and no tick can be in flight
+        // Waits for the tick in flight when destroyed
+        void Kick();
+
+        // Wait for the tick in flight to finish and take the world back, does nothing if no tick was kicked
+        void Wait();
+
+        [[nodiscard]] glm::u64 NumTicks() const;
+
+        [[nodiscard]] float GetLastTickMillis() const;
+
+    private:
+        void Run();
+
+    private:
+        std::function<void(std::thread::id ownerThread)> m_setOwnerThread;
+        std::function<void()> m_tick;
+        std::thread::id m_callerThread;
+        bool m_kicked = false; // caller only
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_tickRequested = false;
+        bool m_tickInFlight = false;
+        bool m_stopping = false;
+        glm::u64 m_numTicks = 0;
+        float m_lastTickMillis = 0;
+
+        std::thread m_thread; // last so everything is initialised before it starts
+    };
+} // SpireVoxel
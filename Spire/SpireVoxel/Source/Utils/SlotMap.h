@@ -0,0 +1,109 @@
+#pragma once
+
+#include "EngineIncludes.h"
+
+namespace SpireVoxel {
+    // Refers to a value in a SlotMap, stays the same size as two u32s so it can be stored anywhere
+    // A handle to a removed value never becomes valid again, even if its index is reused
+    struct SlotMapHandle {
+        static constexpr glm::u32 NULL_INDEX = std::numeric_limits<glm::u32>::max();
+
+        glm::u32 Index = NULL_INDEX;
+        glm::u32 Generation = 0; // slots start at generation 1 so a default handle is never valid
+
+        [[nodiscard]] bool IsNull() const { return Index == NULL_INDEX; }
+
+        bool operator==(const SlotMapHandle &other) const = default;
+    };
+
+    // Stores values in slots that are reused after removal, lookups by handle are O(1) and detect removed values
+    // The lowest free index is always reused first so indices stay compact (e.g. to index a GPU buffer)
+    // Not thread safe
+    template<typename Value>
+    class SlotMap {
+        struct Slot {
+            Value Item{};
+            glm::u32 Generation = 0;
+            bool Occupied = false;
+        };
+
+    public:
+        using Handle = SlotMapHandle;
+
+        SlotMap() = default;
+
+        DISABLE_COPY(SlotMap)
+
+        DEFAULT_MOVE(SlotMap)
+
+        Handle Insert(Value value) {
+            glm::u32 index;
+            if (m_freeIndices.empty()) {
+                index = static_cast<glm::u32>(m_slots.size());
+                assert(index != Handle::NULL_INDEX);
+                m_slots.emplace_back();
+            } else {
+                index = m_freeIndices.top();
+                m_freeIndices.pop();
+            }
+
+            Slot &slot = m_slots[index];
+            slot.Item = std::move(value);
+            slot.Generation++;
+            slot.Occupied = true;
+            m_size++;
+            return {index, slot.Generation};
+        }
+
+        // Returns the removed value, or nothing if the handle wasn't valid
+        std::optional<Value> Remove(Handle handle) {
+            if (!Contains(handle)) return std::nullopt;
+
+            Slot &slot = m_slots[handle.Index];
+            std::optional<Value> value = std::move(slot.Item);
+            slot.Item = {};
+            slot.Occupied = false;
+            m_freeIndices.push(handle.Index);
+            m_size--;
+            return value;
+        }
+
+        [[nodiscard]] bool Contains(Handle handle) const {
+            if (handle.Index >= m_slots.size()) return false;
+            const Slot &slot = m_slots[handle.Index];
+            return slot.Occupied && slot.Generation == handle.Generation;
+        }
+
+        // nullptr if the handle isn't valid
+        [[nodiscard]] Value *TryGet(Handle handle) { return Contains(handle) ? &m_slots[handle.Index].Item : nullptr; }
+
+        [[nodiscard]] const Value *TryGet(Handle handle) const { return Contains(handle) ? &m_slots[handle.Index].Item : nullptr; }
+
+        [[nodiscard]] std::size_t Size() const { return m_size; }
+
+        [[nodiscard]] bool Empty() const { return m_size == 0; }
+
+        // One past the highest index ever used, not every slot below it is occupied
+        [[nodiscard]] std::size_t NumSlots() const { return m_slots.size(); }
+
+        // Heap usage of the slots and free list, not including anything the values point to
+        [[nodiscard]] glm::u64 CalculateMemoryUsage() const {
+            return m_slots.capacity() * sizeof(Slot) + m_freeIndices.size() * sizeof(glm::u32);
+        }
+
+        // Calls function(Handle, Value &) for each value in index order
+        template<typename Function>
+        void ForEach(Function &&function) {
+            for (glm::u32 i = 0; i < m_slots.size(); i++) {
+                if (m_slots[i].Occupied) function(Handle{i, m_slots[i].Generation}, m_slots[i].Item);
+            }
+        }
+
+    private:
+        std::vector<Slot> m_slots;
+        std::priority_queue<glm::u32, std::vector<glm::u32>, std::greater<> > m_freeIndices;
+        std::size_t m_size = 0;
+    };
+} // SpireVoxel
+
+MAKE_HASHABLE(SpireVoxel::SlotMapHandle, t.Index, t.Generation);
@@ -0,0 +1,15 @@
+#include "VoxelCameraSnapshot.h"
+
+namespace SpireVoxel {
+    VoxelCameraSnapshot::VoxelCameraSnapshot(IVoxelCamera &camera)
+        : m_camera(camera) {
+        Capture();
+    }
+
+    void VoxelCameraSnapshot::Capture() {
+        m_cameraInfo = m_camera.GetCameraInfo();
+        m_position = m_camera.GetPosition();
+        m_forward = m_camera.GetForward();
+        m_frustum = m_camera.CalculateFrustum();
+    }
+} // SpireVoxel
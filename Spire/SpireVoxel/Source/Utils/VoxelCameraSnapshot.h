@@ -0,0 +1,38 @@
+#pragma once
+
+#include "EngineIncludes.h"
+#include "IVoxelCamera.h"
+#include "../../Assets/Shaders/ShaderInfo.h"
+
+namespace SpireVoxel {
+    // A camera as it was when last captured, so a world simulated on another thread doesn't see it move mid tick
+    // Capture on the thread that moves the camera while the world isn't being simulated, e.g. between SimulationThread::Wait and Kick
+    // Render and GetDescriptor aren't captured, they go straight to the camera on the render thread
+    class VoxelCameraSnapshot final : public IVoxelCamera {
+    public:
+        // Captures the camera straight away
+        explicit VoxelCameraSnapshot(IVoxelCamera &camera);
+
+    public:
+        void Capture();
+
+        [[nodiscard]] CameraInfo GetCameraInfo() const override { return m_cameraInfo; }
+
+        [[nodiscard]] glm::vec3 GetPosition() const override { return m_position; }
+
+        void Render(const RenderInfo &renderInfo) override { m_camera.Render(renderInfo); }
+
+        [[nodiscard]] Spire::PerImageDescriptor GetDescriptor(glm::u32 binding) const override { return m_camera.GetDescriptor(binding); }
+
+        [[nodiscard]] Spire::Frustum CalculateFrustum() const override { return m_frustum; }
+
+        [[nodiscard]] glm::vec3 GetForward() const override { return m_forward; }
+
+    private:
+        IVoxelCamera &m_camera;
+        CameraInfo m_cameraInfo{};
+        glm::vec3 m_position{};
+        glm::vec3 m_forward{};
+        Spire::Frustum m_frustum;
+    };
+} // SpireVoxel
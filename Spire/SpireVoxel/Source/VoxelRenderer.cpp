@@ -46,8 +46,9 @@ namespace SpireVoxel {
         SetupGraphicsPipeline();
         CreateAndRecordCommandBuffers();
 
+        // broadcast on the world's owner thread, the command buffers are recorded on the render thread
         m_worldEditCallback = m_world->GetRenderer().GetOnWorldEditSubscribers().AddCallback([this]() {
-            CreateAndRecordCommandBuffers();
+            m_commandBuffersOutdated = true;
         });
     }
 
@@ -57,15 +58,25 @@ namespace SpireVoxel {
 
     void VoxelRenderer::Update() {
         m_currentFrame++;
+        m_world->Update();
+        m_world->GetRenderer().Simulate(m_camera.GetPosition());
+    }
+
+    VkCommandBuffer VoxelRenderer::Render(glm::u32 imageIndex) {
         m_oldCommandBuffers.Update();
         m_oldDescriptorManagers.Update();
         m_oldPipelines.Update();
 
-        m_world->Update();
-    }
+        // take the snapshot first, anything it draws was allocated before it was published so a pipeline request it needs is already set
+        VoxelWorldRenderer &worldRenderer = m_world->GetRenderer();
+        worldRenderer.Render(imageIndex);
 
-    VkCommandBuffer VoxelRenderer::Render(glm::u32 imageIndex) const {
-        m_world->GetRenderer().Render(imageIndex, m_camera.GetPosition());
+        bool commandBuffersOutdated = m_commandBuffersOutdated.exchange(false);
+        if (m_pipelineOutdated.exchange(false)) {
+            RecreatePipeline();
+        } else if (commandBuffersOutdated || m_recordedNumChunks != worldRenderer.GetSnapshot().DrawCommands.size()) {
+            CreateAndRecordCommandBuffers();
+        }
 
         RenderInfo renderInfo = {
             .ImageIndex = imageIndex
@@ -94,6 +105,10 @@ namespace SpireVoxel {
         CreateAndRecordCommandBuffers();
     }
 
+    void VoxelRenderer::RequestRecreatePipeline() {
+        m_pipelineOutdated = true;
+    }
+
     void VoxelRenderer::BeginRendering(VkCommandBuffer commandBuffer, glm::u32 imageIndex) const {
         auto &rm = m_engine.GetRenderingManager();
 
@@ -139,6 +154,8 @@ namespace SpireVoxel {
             rm.GetCommandManager().EndCommandBuffer(commandBuffer);
         }
 
+        m_recordedNumChunks = m_world->GetRenderer().GetSnapshot().DrawCommands.size();
+
         //  info("Command buffers recorded in {} ms", timer.MillisSinceStart()); // 0.1 to 0.8 ms
     }
 
@@ -24,11 +24,12 @@ namespace SpireVoxel {
         ~VoxelRenderer();
 
     public:
-        // Call this once per frame
+        // Call this once per frame on the world's owner thread, simulates the world and publishes what to draw
         void Update();
 
-        // Call this once per frame
-        [[nodiscard]] VkCommandBuffer Render(glm::u32 imageIndex) const;
+        // Call this once per frame on the render thread, draws the latest published snapshot
+        // Doesn't touch the world so it can run while Update runs on a simulation thread
+        [[nodiscard]] VkCommandBuffer Render(glm::u32 imageIndex);
 
         void OnWindowResize();
 
@@ -38,6 +39,9 @@ namespace SpireVoxel {
 
         void RecreatePipeline();
 
+        // Thread safe, the pipeline is recreated by the next Render
+        void RequestRecreatePipeline();
+
     private:
         void BeginRendering(VkCommandBuffer commandBuffer, glm::u32 imageIndex) const;
 
@@ -71,5 +75,9 @@ namespace SpireVoxel {
 
         glm::u64 m_currentFrame = 0;
         int m_worldEditCallback;
+        // set from the simulation side, handled on the render thread
+        std::atomic<bool> m_pipelineOutdated = false;
+        std::atomic<bool> m_commandBuffersOutdated = false;
+        std::size_t m_recordedNumChunks = 0; // draw count baked into the command buffers
     };
 } // SpireVoxel
@@ -0,0 +1,123 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/Meshing/ChunkDirtyList.h"
+
+#include <mutex>
+#include <thread>
+
+using namespace SpireVoxel;
+
+static ChunkHandle Handle(glm::u32 index) {
+    return {index, 1};
+}
+
+TEST(ChunkDirtyListTests, TestDeduplicatedByFlag) {
+    ChunkDirtyList list;
+    std::array<std::atomic<bool>, 3> dirty = {};
+
+    EXPECT_TRUE(list.Push(Handle(0), dirty[0]));
+    EXPECT_TRUE(list.Push(Handle(1), dirty[1]));
+    EXPECT_FALSE(list.Push(Handle(0), dirty[0])); // already in the list
+    EXPECT_TRUE(list.Push(Handle(2), dirty[2]));
+    EXPECT_EQ(list.Size(), 3);
+
+    std::vector<ChunkHandle> visited;
+    list.ForEach([&](ChunkHandle handle) { visited.push_back(handle); });
+    EXPECT_EQ(visited.size(), 3);
+
+    std::vector<ChunkHandle> expected = {Handle(0), Handle(1), Handle(2)};
+    EXPECT_EQ(list.TakeAll(), expected);
+    EXPECT_EQ(list.Size(), 0);
+
+    // still dirty until cleared, so an edit made while the owner is taking doesn't push the chunk again
+    EXPECT_FALSE(list.Push(Handle(1), dirty[1]));
+    EXPECT_TRUE(list.TakeAll().empty());
+    ChunkDirtyList::Clear(dirty[1]);
+    EXPECT_TRUE(list.Push(Handle(1), dirty[1]));
+    EXPECT_EQ(list.TakeAll(), std::vector<ChunkHandle>{Handle(1)});
+}
+
+// Many threads notifying overlapping chunks, each edit also notifies its 6 neighbours like VoxelWorld does,
+// while the owner takes the dirty chunks every "frame"
+template<typename Notify, typename TakeAll>
+static float RunContention(glm::u32 numThreads, glm::u32 numChunks, glm::u32 editsPerThread, Notify notify, TakeAll takeAll) {
+    std::atomic<bool> start = false;
+    std::atomic<glm::u32> numFinished = 0;
+    std::vector<std::thread> threads;
+    for (glm::u32 thread = 0; thread < numThreads; thread++) {
+        threads.emplace_back([&, thread] {
+            std::mt19937 random(thread);
+            while (!start) std::this_thread::yield();
+            for (glm::u32 i = 0; i < editsPerThread; i++) {
+                glm::u32 chunk = random() % numChunks;
+                notify(chunk);
+                for (glm::u32 neighbour : {chunk + 1, chunk + numChunks - 1, chunk + 16, chunk + numChunks - 16, chunk + 256, chunk + numChunks - 256}) {
+                    notify(neighbour % numChunks);
+                }
+            }
+            numFinished++;
+        });
+    }
+
+    Spire::Timer timer;
+    start = true;
+    while (numFinished < numThreads) {
+        takeAll();
+        std::this_thread::yield();
+    }
+    for (std::thread &thread : threads) thread.join();
+    float millis = timer.MillisSinceStart();
+    takeAll();
+    return millis;
+}
+
+TEST(ChunkDirtyListTests, TestContention) {
+    static constexpr glm::u32 NUM_THREADS = 32;
+    static constexpr glm::u32 NUM_CHUNKS = 4096;
+    static constexpr glm::u32 EDITS_PER_THREAD = 20000;
+
+    // what NotifyChunkEdited used to do
+    std::mutex mutex;
+    std::unordered_set<glm::u32> lockedSet;
+    float lockedMillis = RunContention(NUM_THREADS, NUM_CHUNKS, EDITS_PER_THREAD, [&](glm::u32 chunk) {
+        std::unique_lock lock(mutex);
+        lockedSet.insert(chunk);
+    }, [&] {
+        std::unordered_set<glm::u32> taken;
+        std::unique_lock lock(mutex);
+        taken.swap(lockedSet);
+    });
+
+    ChunkDirtyList list;
+    std::vector<std::atomic<bool> > dirty(NUM_CHUNKS);
+    std::vector<glm::u32> numTaken(NUM_CHUNKS, 0);
+    std::atomic<glm::u64> numSuccessfulPushes = 0;
+    glm::u32 numDuplicates = 0;
+    float listMillis = RunContention(NUM_THREADS, NUM_CHUNKS, EDITS_PER_THREAD, [&](glm::u32 chunk) {
+        if (list.Push(Handle(chunk), dirty[chunk])) numSuccessfulPushes.fetch_add(1, std::memory_order_relaxed);
+    }, [&] {
+        std::vector<ChunkHandle> taken = list.TakeAll();
+        std::unordered_set<glm::u32> seen;
+        for (ChunkHandle handle : taken) {
+            if (!seen.insert(handle.Index).second) numDuplicates++;
+            numTaken[handle.Index]++;
+            ChunkDirtyList::Clear(dirty[handle.Index]);
+        }
+    });
+
+    Spire::info("{} threads notified {} chunk edits: mutex and set {} ms, lock free list {} ms", NUM_THREADS, NUM_THREADS * EDITS_PER_THREAD * 7,
+                lockedMillis, listMillis);
+
+    // each chunk is in the list at most once, everything pushed was taken and nothing is left dirty
+    EXPECT_EQ(numDuplicates, 0);
+    EXPECT_EQ(list.Size(), 0);
+    glm::u64 totalTaken = 0;
+    for (glm::u32 chunk = 0; chunk < NUM_CHUNKS; chunk++) {
+        totalTaken += numTaken[chunk];
+        ASSERT_GT(numTaken[chunk], 0);
+        ASSERT_FALSE(dirty[chunk].load());
+    }
+    EXPECT_EQ(totalTaken, numSuccessfulPushes.load());
+}
@@ -0,0 +1,75 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/ChunkOccupancy.h"
+
+TEST(ChunkOccupancyTests, TestBrickIndexOfVoxel) {
+    using SpireVoxel::ChunkOccupancy;
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(0u), 0);
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(glm::uvec3(7, 7, 7)), 0);
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(glm::uvec3(0, 0, 8)), 1);
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(glm::uvec3(0, 8, 0)), ChunkOccupancy::BRICKS_PER_AXIS);
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(glm::uvec3(63, 63, 63)), ChunkOccupancy::NUM_BRICKS - 1);
+    EXPECT_EQ(ChunkOccupancy::GetBrickIndexOfVoxel(static_cast<glm::u32>(SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(9, 17, 40))),
+              ChunkOccupancy::GetBrickIndex({1, 2, 5}));
+}
+
+TEST(ChunkOccupancyTests, TestVoxelChanged) {
+    SpireVoxel::ChunkOccupancy occupancy;
+    EXPECT_TRUE(occupancy.IsEmpty());
+
+    glm::u32 index = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(9, 17, 40);
+    glm::u32 brick = SpireVoxel::ChunkOccupancy::GetBrickIndexOfVoxel(index);
+    occupancy.OnVoxelChanged(index, false, true);
+    EXPECT_EQ(occupancy.GetSolidCount(), 1);
+    EXPECT_FALSE(occupancy.IsBrickEmpty(brick));
+    EXPECT_EQ(occupancy.GetBrickMask().count(), 1);
+
+    occupancy.OnVoxelChanged(index, true, true);
+    EXPECT_EQ(occupancy.GetSolidCount(), 1);
+
+    occupancy.OnVoxelChanged(index, true, false);
+    EXPECT_TRUE(occupancy.IsEmpty());
+    EXPECT_TRUE(occupancy.IsBrickEmpty(brick));
+}
+
+TEST(ChunkOccupancyTests, TestVoxelsSetMatchesRecalculate) {
+    SpireVoxel::VoxelBitmask bits;
+    SpireVoxel::ChunkOccupancy occupancy;
+
+    std::mt19937 random(1234);
+    for (int i = 0; i < 200; i++) {
+        glm::u32 start = random() % SPIRE_VOXEL_CHUNK_VOLUME;
+        glm::u32 end = std::min<glm::u32>(SPIRE_VOXEL_CHUNK_VOLUME, start + random() % 3000);
+        bool present = random() % 3 != 0;
+
+        occupancy.OnVoxelsSet(start, end, present, bits);
+        for (glm::u32 j = start; j < end; j++) bits.Set(j, present);
+    }
+
+    SpireVoxel::ChunkOccupancy expected;
+    expected.Recalculate(bits);
+
+    EXPECT_EQ(occupancy.GetSolidCount(), bits.Count());
+    EXPECT_EQ(occupancy.GetSolidCount(), expected.GetSolidCount());
+    EXPECT_TRUE(occupancy.GetBrickMask() == expected.GetBrickMask());
+    for (glm::u32 brick = 0; brick < SpireVoxel::ChunkOccupancy::NUM_BRICKS; brick++) {
+        EXPECT_EQ(occupancy.GetBrickSolidCount(brick), expected.GetBrickSolidCount(brick));
+    }
+}
+
+TEST(ChunkOccupancyTests, TestRegionEmpty) {
+    SpireVoxel::VoxelBitmask bits;
+    bits.Set(SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(20, 30, 40), true);
+
+    SpireVoxel::ChunkOccupancy occupancy;
+    occupancy.Recalculate(bits);
+
+    EXPECT_FALSE(occupancy.IsRegionEmpty({0, 0, 0}, {64, 64, 64}));
+    EXPECT_FALSE(occupancy.IsRegionEmpty({20, 30, 40}, {21, 31, 41}));
+    EXPECT_TRUE(occupancy.IsRegionEmpty({0, 0, 0}, {16, 64, 64}));
+    EXPECT_TRUE(occupancy.IsRegionEmpty({24, 0, 0}, {64, 64, 64}));
+    EXPECT_TRUE(occupancy.IsRegionEmpty({0, 0, 48}, {64, 64, 64}));
+    EXPECT_TRUE(occupancy.IsRegionEmpty({5, 5, 5}, {5, 10, 10})); // zero volume
+}
@@ -0,0 +1,191 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/ChunkResidencyManager.h"
+#include "Serialisation/ChunkSwapStore.h"
+
+using Voxels = std::array<SpireVoxel::VoxelType, SPIRE_VOXEL_CHUNK_VOLUME>;
+
+// different for every chunk, mixes long runs with noise so it would be hard to get right by accident
+static void FillTestVoxels(Voxels &voxels, glm::u32 chunk) {
+    for (glm::u32 i = 0; i < SPIRE_VOXEL_CHUNK_VOLUME; i++) {
+        voxels[i] = (i / 1000 + chunk) % 3 == 0 ? static_cast<SpireVoxel::VoxelType>((i * 2654435761u + chunk * 40503u) >> 28) : static_cast<SpireVoxel::VoxelType>(chunk + 1);
+    }
+}
+
+static void FillTestStorage(SpireVoxel::ChunkVoxelStorage &storage, glm::u32 chunk) {
+    auto &data = storage.Write();
+    FillTestVoxels(data.Voxels, chunk);
+    for (glm::u32 i = 0; i < SPIRE_VOXEL_CHUNK_VOLUME; i++) {
+        data.Bits.Set(i, data.Voxels[i] != 0);
+    }
+    data.Occupancy.Recalculate(data.Bits);
+}
+
+TEST(ChunkSwapStoreTests, TestPageOutAndIn) {
+    SpireVoxel::ChunkSwapStore store;
+    SpireVoxel::ChunkVoxelStorage storage;
+    FillTestStorage(storage, 3);
+    glm::u32 count = storage.Read().Bits.Count();
+
+    ASSERT_TRUE(store.PageOut(storage, {-1, 2, 3}, false));
+    EXPECT_TRUE(storage.IsPagedOut());
+    EXPECT_LT(storage.GetMemoryUsage(), 1024);
+    EXPECT_TRUE(std::filesystem::exists(store.GetDirectory()));
+
+    auto expected = std::make_unique<Voxels>();
+    FillTestVoxels(*expected, 3);
+    EXPECT_EQ(storage.Read().Voxels, *expected);
+    EXPECT_TRUE(storage.IsResident());
+    EXPECT_EQ(storage.Read().Bits.Count(), count);
+    EXPECT_FALSE(storage.IsCorrupted());
+
+    SpireVoxel::ChunkSwapStore::Stats stats = store.GetStats();
+    EXPECT_EQ(stats.PageOuts, 1);
+    EXPECT_EQ(stats.PageIns, 1);
+    EXPECT_EQ(stats.FailedPageIns, 0);
+    EXPECT_EQ(stats.SkippedWrites, 0);
+    EXPECT_GT(stats.BytesWritten, 0);
+    EXPECT_EQ(stats.BytesRead, stats.BytesWritten);
+
+    // unchanged so the file doesn't need writing again
+    ASSERT_TRUE(store.PageOut(storage, {-1, 2, 3}, true));
+    EXPECT_EQ(store.GetStats().SkippedWrites, 1);
+    EXPECT_EQ(storage.Read().Voxels, *expected);
+}
+
+TEST(ChunkSwapStoreTests, TestSharedStorageIsNotPagedOut) {
+    SpireVoxel::ChunkSwapStore store;
+    SpireVoxel::ChunkVoxelStorage empty;
+    EXPECT_FALSE(store.PageOut(empty, {0, 0, 0}, false));
+    EXPECT_FALSE(empty.IsPagedOut());
+    EXPECT_EQ(store.GetStats().PageOuts, 0);
+}
+
+TEST(ChunkSwapStoreTests, TestPageOutCompressed) {
+    SpireVoxel::ChunkSwapStore store;
+    SpireVoxel::ChunkVoxelStorage storage;
+    storage.Write().Voxels.fill(4);
+    ASSERT_TRUE(storage.Compress(4.0f));
+
+    ASSERT_TRUE(store.PageOut(storage, {0, 0, 0}, false));
+    EXPECT_TRUE(storage.IsPagedOut());
+    EXPECT_EQ(storage.Read().Voxels[SPIRE_VOXEL_CHUNK_VOLUME - 1], 4);
+    EXPECT_EQ(storage.Read().Bits.Count(), SPIRE_VOXEL_CHUNK_VOLUME);
+}
+
+TEST(ChunkSwapStoreTests, TestCopyPagesIn) {
+    SpireVoxel::ChunkSwapStore store;
+    SpireVoxel::ChunkVoxelStorage a;
+    FillTestStorage(a, 1);
+    ASSERT_TRUE(store.PageOut(a, {0, 0, 0}, false));
+
+    SpireVoxel::ChunkVoxelStorage b = a;
+    EXPECT_TRUE(a.IsResident());
+    EXPECT_TRUE(a.SharesDataWith(b));
+}
+
+TEST(ChunkSwapStoreTests, TestFilesOutliveStore) {
+    SpireVoxel::ChunkVoxelStorage storage;
+    FillTestStorage(storage, 2);
+    std::filesystem::path directory;
+    {
+        SpireVoxel::ChunkSwapStore store;
+        directory = store.GetDirectory();
+        ASSERT_TRUE(store.PageOut(storage, {5, 5, 5}, false));
+    }
+
+    // still paged out so the file must still be there
+    EXPECT_TRUE(std::filesystem::exists(directory));
+    auto expected = std::make_unique<Voxels>();
+    FillTestVoxels(*expected, 2);
+    EXPECT_EQ(storage.Read().Voxels, *expected);
+
+    // paged in so nothing references the files anymore
+    EXPECT_FALSE(std::filesystem::exists(directory));
+}
+
+TEST(ChunkSwapStoreTests, TestSelectEvictionsLeastRecentlyUsed) {
+    std::vector<SpireVoxel::ChunkResidencyManager::EvictionCandidate> candidates = {
+        {.LastAccessFrame = 5, .SquaredDistance = 1, .MemoryUsage = 1000, .Index = 0},
+        {.LastAccessFrame = 2, .SquaredDistance = 1, .MemoryUsage = 1000, .Index = 1},
+        {.LastAccessFrame = 9, .SquaredDistance = 1, .MemoryUsage = 1000, .Index = 2},
+        {.LastAccessFrame = 2, .SquaredDistance = 4, .MemoryUsage = 1000, .Index = 3},
+    };
+
+    EXPECT_EQ(SpireVoxel::ChunkResidencyManager::SelectEvictions(candidates, 4000, 4000), 0);
+    ASSERT_EQ(SpireVoxel::ChunkResidencyManager::SelectEvictions(candidates, 4000, 1500), 3);
+    // oldest first, further first when equally old
+    EXPECT_EQ(candidates[0].Index, 3);
+    EXPECT_EQ(candidates[1].Index, 1);
+    EXPECT_EQ(candidates[2].Index, 0);
+    EXPECT_EQ(SpireVoxel::ChunkResidencyManager::SelectEvictions(candidates, 4000, 0), 4);
+}
+
+// Walks over a world that is much bigger than the memory budget, paging chunks out the same way the residency manager does
+// then walks back checking every voxel survived
+TEST(ChunkSwapStoreTests, TestWalkWorldLargerThanBudget) {
+    static constexpr glm::u32 NUM_CHUNKS = 48;
+    static constexpr glm::u64 BUDGET = 6 * sizeof(SpireVoxel::ChunkVoxelStorage::Data);
+
+    SpireVoxel::ChunkSwapStore store;
+    std::vector<SpireVoxel::ChunkVoxelStorage> storages(NUM_CHUNKS);
+    std::vector<glm::u64> lastAccessFrame(NUM_CHUNKS, 0);
+    std::vector<std::uint8_t> swapFileCurrent(NUM_CHUNKS, false);
+    glm::u64 frame = 0;
+
+    // shared storage is only counted once, like VoxelWorld::CalculateCPUMemoryUsageForChunks
+    auto calculateUsage = [&] {
+        glm::u64 usage = 0;
+        std::unordered_set<const void *> counted;
+        for (const SpireVoxel::ChunkVoxelStorage &storage : storages) {
+            if (counted.insert(storage.GetDataIdentity()).second) usage += storage.GetMemoryUsage();
+        }
+        return usage;
+    };
+
+    auto enforceBudget = [&] {
+        glm::u64 usage = calculateUsage();
+        std::vector<SpireVoxel::ChunkResidencyManager::EvictionCandidate> candidates;
+        for (glm::u32 i = 0; i < NUM_CHUNKS; i++) {
+            if (storages[i].IsPagedOut() || storages[i].IsShared()) continue;
+            candidates.push_back({lastAccessFrame[i], 0.0f, storages[i].GetMemoryUsage(), i});
+        }
+
+        std::size_t count = SpireVoxel::ChunkResidencyManager::SelectEvictions(candidates, usage, BUDGET);
+        for (std::size_t i = 0; i < count; i++) {
+            glm::u32 chunk = static_cast<glm::u32>(candidates[i].Index);
+            ASSERT_NE(lastAccessFrame[chunk], frame) << "evicted a chunk used this frame";
+            ASSERT_TRUE(store.PageOut(storages[chunk], glm::ivec3(chunk, -static_cast<int>(chunk), 0), swapFileCurrent[chunk]));
+            swapFileCurrent[chunk] = true;
+        }
+
+        ASSERT_LE(calculateUsage(), BUDGET);
+    };
+
+    for (glm::u32 i = 0; i < NUM_CHUNKS; i++) {
+        frame++;
+        FillTestStorage(storages[i], i);
+        lastAccessFrame[i] = frame;
+        swapFileCurrent[i] = false;
+        enforceBudget();
+    }
+    EXPECT_GE(store.GetStats().PageOuts, NUM_CHUNKS - 6);
+
+    auto expected = std::make_unique<Voxels>();
+    for (glm::u32 i = NUM_CHUNKS; i-- > 0;) {
+        frame++;
+        FillTestVoxels(*expected, i);
+        ASSERT_EQ(storages[i].Read().Voxels, *expected) << "chunk " << i;
+        ASSERT_FALSE(storages[i].IsCorrupted());
+        lastAccessFrame[i] = frame;
+        enforceBudget();
+    }
+
+    SpireVoxel::ChunkSwapStore::Stats stats = store.GetStats();
+    EXPECT_EQ(stats.FailedPageIns, 0);
+    EXPECT_GE(stats.PageIns, NUM_CHUNKS - 6);
+    // nothing was edited on the way back so chunks paged out again didn't need writing
+    EXPECT_GT(stats.SkippedWrites, 0);
+}
@@ -0,0 +1,299 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/Chunk.h"
+#include "Chunk/ChunkTickSystem.h"
+#include "Utils/TaskGraph.h"
+
+using namespace SpireVoxel;
+
+namespace {
+    constexpr VoxelType STONE = 1;
+    constexpr VoxelType SAND = 2;
+    constexpr VoxelType WATER = 3;
+    constexpr VoxelType PLANT = 4;
+
+    using ChunkVoxels = std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME>;
+
+    glm::ivec3 GetChunkOfVoxel(glm::ivec3 position) {
+        return glm::ivec3(glm::floor(glm::vec3(position) / static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE)));
+    }
+
+    glm::u32 IndexInChunk(glm::ivec3 position) {
+        return SPIRE_VOXEL_POSITION_TO_INDEX(position - GetChunkOfVoxel(position) * SPIRE_VOXEL_CHUNK_SIZE);
+    }
+
+    // Chunks in a map, the map isn't changed while ticking so tasks only touch the arrays of their neighbourhood
+    class TestVoxels : public ITickVoxels {
+    public:
+        void AddChunk(glm::ivec3 chunkPosition, ChunkState state = ChunkState::READY) {
+            m_chunks[chunkPosition] = std::make_unique<ChunkVoxels>();
+            m_chunks[chunkPosition]->fill(VOXEL_TYPE_AIR);
+            m_states[chunkPosition] = state;
+        }
+
+        void SetState(glm::ivec3 chunkPosition, ChunkState state) { m_states.at(chunkPosition) = state; }
+
+        void Set(glm::ivec3 position, VoxelType type) { (*m_chunks.at(GetChunkOfVoxel(position)))[IndexInChunk(position)] = type; }
+
+        [[nodiscard]] VoxelType Get(glm::ivec3 position) const { return (*m_chunks.at(GetChunkOfVoxel(position)))[IndexInChunk(position)]; }
+
+        [[nodiscard]] ChunkState GetChunkState(glm::ivec3 chunkPosition) const override {
+            auto state = m_states.find(chunkPosition);
+            return state == m_states.end() ? ChunkState::UNAVAILABLE : state->second;
+        }
+
+        [[nodiscard]] const ChunkVoxels &ReadVoxels(glm::ivec3 chunkPosition) const override { return *m_chunks.at(chunkPosition); }
+
+        [[nodiscard]] VoxelType GetVoxel(glm::ivec3 chunkPosition, glm::u32 index) const override {
+            assert(GetChunkState(chunkPosition) == ChunkState::READY);
+            return (*m_chunks.at(chunkPosition))[index];
+        }
+
+        void SetVoxel(glm::ivec3 chunkPosition, glm::u32 index, VoxelType type) override {
+            assert(GetChunkState(chunkPosition) == ChunkState::READY);
+            (*m_chunks.at(chunkPosition))[index] = type;
+        }
+
+        [[nodiscard]] bool operator==(const TestVoxels &other) const {
+            if (m_chunks.size() != other.m_chunks.size()) return false;
+            for (const auto &[chunkPosition, voxels] : m_chunks) {
+                auto otherVoxels = other.m_chunks.find(chunkPosition);
+                if (otherVoxels == other.m_chunks.end() || *voxels != *otherVoxels->second) return false;
+            }
+            return true;
+        }
+
+    private:
+        std::unordered_map<glm::ivec3, std::unique_ptr<ChunkVoxels> > m_chunks;
+        std::unordered_map<glm::ivec3, ChunkState> m_states;
+    };
+
+    bool TryMove(ChunkTickSystem::TickContext &context, glm::ivec3 from, glm::ivec3 to, VoxelType type) {
+        if (!context.IsAvailable(to) || context.GetVoxel(to) != VOXEL_TYPE_AIR) return false;
+        context.SetVoxel(to, type);
+        context.SetVoxel(from, VOXEL_TYPE_AIR);
+        return true;
+    }
+
+    // Falls straight down, otherwise slides down a random diagonal
+    void TickSand(ChunkTickSystem::TickContext &context, glm::ivec3 position, VoxelType type) {
+        if (TryMove(context, position, position + glm::ivec3(0, -1, 0), type)) return;
+        static constexpr std::array<glm::ivec3, 4> DIAGONALS = {glm::ivec3(1, -1, 0), glm::ivec3(-1, -1, 0), glm::ivec3(0, -1, 1), glm::ivec3(0, -1, -1)};
+        TryMove(context, position, position + DIAGONALS[context.Random(position) % DIAGONALS.size()], type);
+    }
+
+    // Falls straight down, otherwise flows to a random side
+    void TickWater(ChunkTickSystem::TickContext &context, glm::ivec3 position, VoxelType type) {
+        if (TryMove(context, position, position + glm::ivec3(0, -1, 0), type)) return;
+        static constexpr std::array<glm::ivec3, 4> SIDES = {glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0), glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1)};
+        TryMove(context, position, position + SIDES[context.Random(position, 1) % SIDES.size()], type);
+    }
+
+    // Grows up by chance until it is 8 tall, stays active while it can still grow
+    void TickPlant(ChunkTickSystem::TickContext &context, glm::ivec3 position, VoxelType type) {
+        glm::ivec3 above = position + glm::ivec3(0, 1, 0);
+        if (!context.IsAvailable(above) || context.GetVoxel(above) != VOXEL_TYPE_AIR) return;
+        if (context.GetVoxel(position - glm::ivec3(0, 8, 0)) == PLANT) return;
+        if (context.Random(position, 2) % 3 == 0) context.SetVoxel(above, type);
+        else context.KeepActive();
+    }
+
+    void RegisterCallbacks(ChunkTickSystem &tickSystem) {
+        tickSystem.Register(SAND, TickSand);
+        tickSystem.Register(WATER, TickWater);
+        tickSystem.Register(PLANT, TickPlant);
+    }
+
+    // 4x3x4 ready chunks with a stone floor, sand and water dropped near chunk borders and plants on the floor
+    void BuildWorld(TestVoxels &voxels) {
+        for (glm::i32 x = -2; x < 2; x++) {
+            for (glm::i32 y = -1; y < 2; y++) {
+                for (glm::i32 z = -2; z < 2; z++) {
+                    voxels.AddChunk({x, y, z});
+                }
+            }
+        }
+        // a chunk next to them that is still generating, and one in the middle of the floor
+        voxels.AddChunk({2, 0, 0}, ITickVoxels::ChunkState::NOT_READY);
+        voxels.SetState({0, -1, 0}, ITickVoxels::ChunkState::NOT_READY);
+
+        for (glm::i32 x = -128; x < 128; x++) {
+            for (glm::i32 z = -128; z < 128; z++) {
+                voxels.Set({x, -64, z}, STONE);
+            }
+        }
+
+        std::mt19937 random(7);
+        std::uniform_int_distribution<glm::i32> horizontal(-128, 127);
+        std::uniform_int_distribution<glm::i32> boundary(-1, 1);
+        std::uniform_int_distribution<glm::i32> border(-4, 3);
+        for (glm::u32 i = 0; i < 3000; i++) {
+            // half of them straddle the chunk borders on x and z
+            glm::ivec3 position = {horizontal(random), horizontal(random) / 2 + 64, horizontal(random)};
+            if (i % 2 == 0) position.x = boundary(random) * SPIRE_VOXEL_CHUNK_SIZE + border(random);
+            if (i % 4 == 0) position.z = boundary(random) * SPIRE_VOXEL_CHUNK_SIZE + border(random);
+            voxels.Set(position, i % 3 == 0 ? WATER : SAND);
+        }
+        for (glm::u32 i = 0; i < 200; i++) {
+            voxels.Set({horizontal(random), -63, horizontal(random)}, PLANT);
+        }
+    }
+
+    void ActivateAll(ChunkTickSystem &tickSystem) {
+        for (glm::i32 x = -3; x < 3; x++) {
+            for (glm::i32 y = -2; y < 3; y++) {
+                for (glm::i32 z = -3; z < 3; z++) {
+                    tickSystem.Activate({x, y, z});
+                }
+            }
+        }
+    }
+}
+
+// Ticking in parallel must give exactly what ticking every chunk on one thread gives
+TEST(ChunkTickSystemTests, TestParallelMatchesSingleThreaded) {
+    constexpr glm::u32 NUM_TICKS = 40;
+
+    auto run = [](TestVoxels &voxels, bool parallel) {
+        auto tickSystem = std::make_unique<ChunkTickSystem>(voxels, ChunkTickSystem::Settings{.FramesPerTick = 1, .Parallel = parallel});
+        RegisterCallbacks(*tickSystem);
+        BuildWorld(voxels);
+        ActivateAll(*tickSystem);
+        for (glm::u32 tick = 0; tick < NUM_TICKS; tick++) {
+            // the generating chunk finishes part way through
+            if (tick == NUM_TICKS / 2) voxels.SetState({0, -1, 0}, ITickVoxels::ChunkState::READY);
+            EXPECT_TRUE(tickSystem->Update());
+        }
+        return tickSystem;
+    };
+
+    TestVoxels serialVoxels;
+    TestVoxels parallelVoxels;
+    std::unique_ptr<ChunkTickSystem> serial = run(serialVoxels, false);
+    std::unique_ptr<ChunkTickSystem> parallel = run(parallelVoxels, true);
+
+    EXPECT_TRUE(serialVoxels == parallelVoxels);
+    EXPECT_EQ(serial->GetStats().Ticks, parallel->GetStats().Ticks);
+    EXPECT_EQ(serial->GetStats().ChunksTicked, parallel->GetStats().ChunksTicked);
+    EXPECT_EQ(serial->GetStats().VoxelsTicked, parallel->GetStats().VoxelsTicked);
+    EXPECT_EQ(serial->GetStats().VoxelsWritten, parallel->GetStats().VoxelsWritten);
+    EXPECT_EQ(serial->NumActiveChunks(), parallel->NumActiveChunks());
+
+    // something actually happened, and the not ready chunks were never written
+    EXPECT_GT(parallel->GetStats().VoxelsWritten, 1000);
+    EXPECT_TRUE(parallel->IsActive({2, 0, 0}));
+    Spire::info("Ticked {} chunks, {} voxels, wrote {} voxels", parallel->GetStats().ChunksTicked, parallel->GetStats().VoxelsTicked,
+                parallel->GetStats().VoxelsWritten);
+}
+
+TEST(ChunkTickSystemTests, TestOnlyActiveChunksAreTicked) {
+    TestVoxels voxels;
+    for (glm::i32 y = -1; y < 2; y++) {
+        voxels.AddChunk({0, y, 0});
+        voxels.AddChunk({5, y, 0});
+    }
+    ChunkTickSystem tickSystem(voxels, ChunkTickSystem::Settings{.FramesPerTick = 2});
+
+    // nothing is registered so there is nothing to tick
+    tickSystem.Activate({0, 0, 0});
+    EXPECT_EQ(tickSystem.NumActiveChunks(), 0);
+
+    tickSystem.Register(SAND, TickSand);
+    voxels.Set({3, 1, 3}, SAND); // lands on the bottom of chunk (0, 0, 0) and crosses into the chunk below
+    voxels.Set({5 * 64 + 3, 1, 3}, SAND); // never activated so it never falls
+    tickSystem.Activate({0, 0, 0});
+    EXPECT_TRUE(tickSystem.IsActive({0, 0, 0}));
+
+    EXPECT_FALSE(tickSystem.Update());
+    EXPECT_TRUE(tickSystem.Update());
+    EXPECT_EQ(voxels.Get({3, 0, 3}), SAND);
+    EXPECT_EQ(voxels.Get({3, 1, 3}), VOXEL_TYPE_AIR);
+    // writing next to the border wakes the chunk below up
+    EXPECT_TRUE(tickSystem.IsActive({0, -1, 0}));
+
+    for (glm::u32 i = 0; i < 200 && tickSystem.NumActiveChunks() > 0; i++) tickSystem.Tick();
+    // fell to the bottom of the loaded chunks and stopped, then every chunk dropped out of the active set
+    EXPECT_EQ(voxels.Get({3, -64, 3}), SAND);
+    EXPECT_EQ(tickSystem.NumActiveChunks(), 0);
+    EXPECT_EQ(voxels.Get({5 * 64 + 3, 1, 3}), SAND);
+
+    // unloaded chunks are dropped, not ticked
+    glm::u64 chunksTicked = tickSystem.GetStats().ChunksTicked;
+    tickSystem.Activate({100, 0, 0});
+    tickSystem.Tick();
+    EXPECT_EQ(tickSystem.GetStats().ChunksTicked, chunksTicked);
+    EXPECT_EQ(tickSystem.NumActiveChunks(), 0);
+
+    // chunks that aren't ready stay active until they are
+    voxels.SetState({5, 0, 0}, ITickVoxels::ChunkState::NOT_READY);
+    tickSystem.Activate({5, 0, 0});
+    tickSystem.Tick();
+    EXPECT_TRUE(tickSystem.IsActive({5, 0, 0}));
+    EXPECT_EQ(voxels.Get({5 * 64 + 3, 1, 3}), SAND);
+    voxels.SetState({5, 0, 0}, ITickVoxels::ChunkState::READY);
+    tickSystem.Tick();
+    EXPECT_EQ(voxels.Get({5 * 64 + 3, 0, 3}), SAND);
+}
+
+TEST(ChunkTickSystemTests, TestColoursNeverOverlap) {
+    // same colour means at least 3 apart on some axis, so the 3x3x3 neighbourhoods are disjoint
+    for (glm::i32 a = 0; a < 6 * 6 * 6; a++) {
+        glm::ivec3 first = glm::ivec3(a / 36, (a / 6) % 6, a % 6) - glm::ivec3(3);
+        for (glm::i32 b = a + 1; b < 6 * 6 * 6; b++) {
+            glm::ivec3 second = glm::ivec3(b / 36, (b / 6) % 6, b % 6) - glm::ivec3(3);
+            if (ChunkTickSystem::GetColour(first) != ChunkTickSystem::GetColour(second)) continue;
+            glm::ivec3 distance = glm::abs(first - second);
+            EXPECT_GE(glm::max(distance.x, glm::max(distance.y, distance.z)), 3);
+        }
+        EXPECT_LT(ChunkTickSystem::GetColour(first), ChunkTickSystem::NUM_COLOURS);
+    }
+
+    // while a chunk ticks no other running tick may touch its neighbourhood
+    TestVoxels voxels;
+    ChunkTickSystem tickSystem(voxels);
+    std::unordered_map<glm::ivec3, std::atomic<glm::u32> > busy;
+    for (glm::i32 x = -4; x < 5; x++) {
+        for (glm::i32 y = -1; y < 2; y++) {
+            for (glm::i32 z = -4; z < 5; z++) {
+                voxels.AddChunk({x, y, z});
+                busy[{x, y, z}] = 0;
+            }
+        }
+    }
+    std::atomic<glm::u32> numOverlaps = 0;
+    std::atomic<glm::u32> running = 0;
+    std::atomic<glm::u32> maxRunning = 0;
+    tickSystem.Register(STONE, [&](ChunkTickSystem::TickContext &context, glm::ivec3, VoxelType) {
+        std::vector<glm::ivec3> neighbourhood;
+        for (glm::i32 i = 0; i < 27; i++) {
+            glm::ivec3 neighbour = context.GetChunkPosition() + glm::ivec3(i / 9, (i / 3) % 3, i % 3) - glm::ivec3(1);
+            if (busy.contains(neighbour)) neighbourhood.push_back(neighbour);
+        }
+        for (glm::ivec3 neighbour : neighbourhood) {
+            if (busy.at(neighbour)++ != 0) numOverlaps++;
+        }
+        glm::u32 nowRunning = ++running;
+        glm::u32 previousMax = maxRunning;
+        while (nowRunning > previousMax && !maxRunning.compare_exchange_weak(previousMax, nowRunning)) {
+        }
+
+        Spire::Timer timer;
+        while (timer.MillisSinceStart() < 1.0f) {
+        }
+
+        running--;
+        for (glm::ivec3 neighbour : neighbourhood) busy.at(neighbour)--;
+    });
+
+    for (auto &[chunkPosition, _] : busy) {
+        voxels.Set(chunkPosition * SPIRE_VOXEL_CHUNK_SIZE, STONE);
+        tickSystem.Activate(chunkPosition);
+    }
+    tickSystem.Tick();
+
+    EXPECT_EQ(tickSystem.GetStats().LastChunksTicked, busy.size());
+    EXPECT_EQ(numOverlaps, 0);
+    if (Spire::TaskGraph::Instance().NumThreads() > 1) EXPECT_GT(maxRunning, 1);
+}
@@ -0,0 +1,203 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "Chunk/ChunkVoxelStorage.h"
+
+TEST(ChunkVoxelStorageTests, TestDefaultStorageIsSharedEmpty) {
+    SpireVoxel::ChunkVoxelStorage a;
+    SpireVoxel::ChunkVoxelStorage b;
+
+    EXPECT_TRUE(a.SharesDataWith(b));
+    EXPECT_TRUE(a.IsShared());
+    EXPECT_FALSE(a.IsCorrupted());
+    EXPECT_EQ(a.Read().Voxels[0], 0);
+    EXPECT_EQ(a.Read().Bits.Count(), 0);
+}
+
+TEST(ChunkVoxelStorageTests, TestCopyShares) {
+    SpireVoxel::ChunkVoxelStorage a;
+    a.Write().Voxels[5] = 3;
+    EXPECT_FALSE(a.IsShared());
+
+    SpireVoxel::ChunkVoxelStorage b = a;
+    EXPECT_TRUE(a.SharesDataWith(b));
+    EXPECT_EQ(a.GetDataIdentity(), b.GetDataIdentity());
+    EXPECT_EQ(b.Read().Voxels[5], 3);
+}
+
+TEST(ChunkVoxelStorageTests, TestWriteDetaches) {
+    SpireVoxel::ChunkVoxelStorage a;
+    a.Write().Voxels[5] = 3;
+    SpireVoxel::ChunkVoxelStorage b = a;
+
+    b.Write().Voxels[5] = 7;
+    EXPECT_FALSE(a.SharesDataWith(b));
+    EXPECT_FALSE(a.IsShared());
+    EXPECT_FALSE(b.IsShared());
+    EXPECT_EQ(a.Read().Voxels[5], 3);
+    EXPECT_EQ(b.Read().Voxels[5], 7);
+}
+
+TEST(ChunkVoxelStorageTests, TestWritingDefaultStorageDoesNotChangeOthers) {
+    SpireVoxel::ChunkVoxelStorage a;
+    a.Write().Voxels[SPIRE_VOXEL_CHUNK_VOLUME - 1] = 1;
+    a.Write().Bits.Set(SPIRE_VOXEL_CHUNK_VOLUME - 1, true);
+
+    SpireVoxel::ChunkVoxelStorage b;
+    EXPECT_EQ(b.Read().Voxels[SPIRE_VOXEL_CHUNK_VOLUME - 1], 0);
+    EXPECT_FALSE(b.Read().Bits[SPIRE_VOXEL_CHUNK_VOLUME - 1]);
+}
+
+static void FillTestPattern(SpireVoxel::ChunkVoxelStorage &storage) {
+    auto &data = storage.Write();
+    // a solid floor with a few columns on top
+    for (glm::u32 x = 0; x < SPIRE_VOXEL_CHUNK_SIZE; x++) {
+        for (glm::u32 y = 0; y < SPIRE_VOXEL_CHUNK_SIZE; y++) {
+            for (glm::u32 z = 0; z < SPIRE_VOXEL_CHUNK_SIZE; z++) {
+                SpireVoxel::VoxelType type = 0;
+                if (y < 20) type = 1;
+                else if (x % 16 == 0 && z % 16 == 0 && y < 40) type = 2;
+                data.Voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, z)] = type;
+                data.Bits.Set(SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(x, y, z), type != 0);
+            }
+        }
+    }
+    data.Occupancy.Recalculate(data.Bits);
+}
+
+TEST(ChunkVoxelStorageTests, TestCompressRoundTrip) {
+    SpireVoxel::ChunkVoxelStorage a;
+    FillTestPattern(a);
+    // too big for the stack
+    auto expected = std::make_unique<SpireVoxel::ChunkVoxelStorage::Data>(a.Read());
+
+    ASSERT_TRUE(a.Compress(4.0f));
+    EXPECT_TRUE(a.IsCompressed());
+    EXPECT_LT(a.GetMemoryUsage() * 4, sizeof(SpireVoxel::ChunkVoxelStorage::Data));
+
+    EXPECT_TRUE(a.EnsureResident());
+    EXPECT_FALSE(a.IsCompressed());
+    EXPECT_FALSE(a.EnsureResident());
+    EXPECT_EQ(a.GetMemoryUsage(), sizeof(SpireVoxel::ChunkVoxelStorage::Data));
+
+    const SpireVoxel::ChunkVoxelStorage::Data &data = a.Read();
+    EXPECT_EQ(data.Voxels, expected->Voxels);
+    EXPECT_EQ(data.Bits.Count(), expected->Bits.Count());
+    for (glm::u32 i = 0; i < SPIRE_VOXEL_CHUNK_VOLUME; i++) {
+        ASSERT_EQ(data.Bits[i], expected->Bits[i]);
+    }
+    for (glm::u32 brick = 0; brick < SpireVoxel::ChunkOccupancy::NUM_BRICKS; brick++) {
+        ASSERT_EQ(data.Occupancy.IsBrickEmpty(brick), expected->Occupancy.IsBrickEmpty(brick));
+    }
+    EXPECT_FALSE(a.IsCorrupted());
+}
+
+TEST(ChunkVoxelStorageTests, TestAccessDecompresses) {
+    SpireVoxel::ChunkVoxelStorage a;
+    FillTestPattern(a);
+    ASSERT_TRUE(a.Compress(4.0f));
+    EXPECT_EQ(a.Read().Voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 0, 0)], 1);
+    EXPECT_FALSE(a.IsCompressed());
+
+    ASSERT_TRUE(a.Compress(4.0f));
+    a.Write().Voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(1, 30, 1)] = 5;
+    EXPECT_FALSE(a.IsCompressed());
+    EXPECT_EQ(a.Read().Voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(1, 30, 1)], 5);
+    EXPECT_EQ(a.Read().Voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 40, 0)], 0);
+}
+
+TEST(ChunkVoxelStorageTests, TestSharedStorageIsNotCompressed) {
+    SpireVoxel::ChunkVoxelStorage empty;
+    EXPECT_FALSE(empty.Compress(4.0f));
+    EXPECT_FALSE(empty.IsCompressed());
+
+    SpireVoxel::ChunkVoxelStorage a;
+    FillTestPattern(a);
+    SpireVoxel::ChunkVoxelStorage b = a;
+    EXPECT_FALSE(a.Compress(4.0f));
+    EXPECT_TRUE(a.SharesDataWith(b));
+}
+
+TEST(ChunkVoxelStorageTests, TestNoisyStorageIsNotCompressed) {
+    SpireVoxel::ChunkVoxelStorage a;
+    auto &data = a.Write();
+    for (glm::u32 i = 0; i < SPIRE_VOXEL_CHUNK_VOLUME; i++) {
+        data.Voxels[i] = static_cast<SpireVoxel::VoxelType>((i * 2654435761u) >> 29);
+    }
+
+    EXPECT_FALSE(a.Compress(4.0f));
+    EXPECT_FALSE(a.IsCompressed());
+    EXPECT_EQ(a.Read().Voxels[7], static_cast<SpireVoxel::VoxelType>((7 * 2654435761u) >> 29));
+}
+
+TEST(ChunkVoxelStorageTests, TestCopyCompressed) {
+    SpireVoxel::ChunkVoxelStorage a;
+    FillTestPattern(a);
+    ASSERT_TRUE(a.Compress(4.0f));
+
+    SpireVoxel::ChunkVoxelStorage b = a;
+    EXPECT_TRUE(b.IsCompressed());
+    EXPECT_TRUE(a.SharesDataWith(b));
+
+    // each copy decompresses into its own data
+    b.Write().Voxels[0] = 9;
+    EXPECT_TRUE(a.IsCompressed());
+    EXPECT_EQ(a.Read().Voxels[0], 1);
+    EXPECT_EQ(b.Read().Voxels[0], 9);
+    EXPECT_FALSE(a.SharesDataWith(b));
+}
+
+TEST(ChunkVoxelStorageTests, TestReadWhileWriteDetaches) {
+    SpireVoxel::ChunkVoxelStorage a;
+    a.Write().Voxels[0] = 7;
+
+    // each write detaches from the previous copy, the copies are kept so the data the reader may still hold isn't freed
+    constexpr glm::u32 NUM_DETACHES = 32;
+    std::vector<SpireVoxel::ChunkVoxelStorage> copies;
+    copies.reserve(NUM_DETACHES);
+    std::atomic<bool> done = false;
+    std::thread writer([&] {
+        for (glm::u32 i = 0; i < NUM_DETACHES; i++) {
+            copies.push_back(a);
+            a.Write().Voxels[1] = static_cast<SpireVoxel::VoxelType>(i);
+        }
+        done = true;
+    });
+
+    glm::u32 numReads = 0;
+    while (!done || numReads == 0) {
+        EXPECT_EQ(a.Read().Voxels[0], 7);
+        EXPECT_FALSE(a.IsCorrupted());
+        numReads++;
+    }
+    writer.join();
+
+    EXPECT_EQ(a.Read().Voxels[1], NUM_DETACHES - 1);
+    EXPECT_FALSE(a.SharesDataWith(copies.back()));
+}
+
+TEST(ChunkVoxelStorageTests, TestCopyWhilePagingOut) {
+    std::array<SpireVoxel::VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> saved{};
+    saved[5] = 3;
+    SpireVoxel::ChunkVoxelStorage a;
+    a.Write().Voxels = saved;
+    auto pageIn = [&saved](std::array<SpireVoxel::VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> &voxels) {
+        voxels = saved;
+        return true;
+    };
+
+    // a copy pages the storage in, it must never see it paged out again half way through
+    constexpr glm::u32 NUM_COPIES = 50000;
+    std::atomic<bool> done = false;
+    std::thread pager([&] {
+        while (!done) (void) a.PageOut(pageIn);
+    });
+    for (glm::u32 i = 0; i < NUM_COPIES; i++) {
+        SpireVoxel::ChunkVoxelStorage copy = a;
+        EXPECT_EQ(copy.Read().Voxels[5], 3);
+    }
+    done = true;
+    pager.join();
+}
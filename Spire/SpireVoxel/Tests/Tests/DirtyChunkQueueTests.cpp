@@ -0,0 +1,186 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/Meshing/DirtyChunkQueue.h"
+
+using namespace SpireVoxel;
+
+static ChunkHandle Handle(glm::u32 index) {
+    return {index, 1};
+}
+
+static DirtyChunkQueue::View ViewFromChunk(glm::ivec3 cameraChunk) {
+    return {(glm::vec3(cameraChunk) + 0.5f) * static_cast<float>(SPIRE_VOXEL_CHUNK_SIZE)};
+}
+
+TEST(DirtyChunkQueueTests, TestTakeClosest) {
+    glm::ivec3 cameraChunk = {-2, 0, -1};
+    DirtyChunkQueue queue;
+    queue.SetView(ViewFromChunk(cameraChunk));
+
+    std::mt19937 random(3);
+    std::uniform_int_distribution<glm::i32> coordinate(-20, 20);
+    std::unordered_map<ChunkHandle, glm::ivec3> positions;
+    std::vector<float> distances;
+    for (glm::u32 i = 0; i < 5000; i++) {
+        glm::ivec3 position = {coordinate(random), coordinate(random), coordinate(random)};
+        queue.Push(Handle(i), position);
+        queue.Push(Handle(i), position); // already queued
+        positions[Handle(i)] = position;
+        distances.push_back(glm::length(glm::vec3(position - cameraChunk)));
+    }
+    EXPECT_EQ(queue.Size(), 5000);
+    std::ranges::sort(distances);
+
+    // taking in batches gives every chunk in distance order, negative coordinates included
+    std::size_t taken = 0;
+    while (!queue.Empty()) {
+        for (ChunkHandle handle : queue.Take(64)) {
+            ASSERT_FLOAT_EQ(glm::length(glm::vec3(positions.at(handle) - cameraChunk)), distances[taken]);
+            taken++;
+        }
+    }
+    EXPECT_EQ(taken, 5000);
+    EXPECT_TRUE(queue.Take(1).empty());
+}
+
+TEST(DirtyChunkQueueTests, TestOffscreenChunksLater) {
+    glm::vec3 eye = glm::vec3(32);
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 10000.0f) * glm::lookAt(eye, eye + glm::vec3(0, 0, 1), glm::vec3(0, 1, 0));
+
+    DirtyChunkQueue queue;
+    queue.SetView({eye, {0, 0, 1}, Spire::Frustum(viewProjection)});
+    queue.Push(Handle(0), {0, 0, -2}); // behind the camera, 2 chunks away
+    queue.Push(Handle(1), {0, 0, 3}); // in front, 3 chunks away
+    queue.Push(Handle(2), {0, 0, -10});
+
+    std::vector<ChunkHandle> expected = {Handle(1), Handle(0), Handle(2)};
+    EXPECT_EQ(queue.Take(3), expected);
+}
+
+TEST(DirtyChunkQueueTests, TestWaitingChunksCatchUp) {
+    DirtyChunkQueue queue(DirtyChunkQueue::Settings{.FramesPerChunk = 60.0f});
+    DirtyChunkQueue::View view = ViewFromChunk({0, 0, 0});
+    queue.SetView(view);
+    queue.Push(Handle(0), {10, 0, 0});
+
+    for (glm::u32 frame = 0; frame < 300; frame++) queue.SetView(view);
+    queue.Push(Handle(1), {0, 0, 1});
+    EXPECT_EQ(queue.Take(1).front(), Handle(1)); // 5 chunks of waiting isn't enough to beat 9 chunks of distance
+    queue.Push(Handle(1), {0, 0, 1});
+
+    for (glm::u32 frame = 0; frame < 600; frame++) queue.SetView(view);
+    queue.Push(Handle(2), {0, 0, 1});
+    std::vector<ChunkHandle> expected = {Handle(1), Handle(0), Handle(2)};
+    EXPECT_EQ(queue.Take(3), expected);
+}
+
+TEST(DirtyChunkQueueTests, TestRekeyWhenCameraMoves) {
+    DirtyChunkQueue queue;
+    queue.SetView(ViewFromChunk({0, 0, 0}));
+    queue.Push(Handle(0), {-6, 0, 0});
+    queue.Push(Handle(1), {5, 0, 0});
+    glm::u64 numRekeys = queue.NumRekeys();
+
+    // moving within a chunk or turning slightly keeps the keys
+    DirtyChunkQueue::View view = ViewFromChunk({0, 0, 0});
+    view.Position += glm::vec3(10.0f);
+    view.Forward = glm::normalize(glm::vec3(0.1f, 0, 1));
+    queue.SetView(view);
+    EXPECT_EQ(queue.NumRekeys(), numRekeys);
+
+    queue.SetView(ViewFromChunk({-4, 0, 0}));
+    EXPECT_EQ(queue.NumRekeys(), numRekeys + 1);
+    EXPECT_EQ(queue.Take(1).front(), Handle(0));
+
+    queue.Push(Handle(0), {-6, 0, 0});
+    queue.SetView(ViewFromChunk({4, 0, 0}));
+    EXPECT_EQ(queue.Take(1).front(), Handle(1));
+}
+
+TEST(DirtyChunkQueueTests, TestSelection) {
+    DirtyChunkQueue queue;
+    queue.SetView(ViewFromChunk({0, 0, 0}));
+    for (glm::u32 i = 0; i < 10; i++) queue.Push(Handle(i), {static_cast<glm::i32>(i), 0, 0});
+    EXPECT_TRUE(queue.Remove(Handle(3)));
+    EXPECT_FALSE(queue.Remove(Handle(3)));
+
+    // keep 0 and 4, drop 1 and take the rest
+    std::vector<glm::ivec3> offered;
+    std::size_t numTaken = queue.Take(3, [&](ChunkHandle handle, glm::ivec3 chunkPosition) {
+        offered.push_back(chunkPosition);
+        if (handle == Handle(0) || handle == Handle(4)) return DirtyChunkQueue::Selection::KEEP;
+        if (handle == Handle(1)) return DirtyChunkQueue::Selection::DROP;
+        return DirtyChunkQueue::Selection::TAKE;
+    });
+    EXPECT_EQ(numTaken, 3);
+    std::vector<glm::ivec3> expectedOffered = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {4, 0, 0}, {5, 0, 0}, {6, 0, 0}};
+    EXPECT_EQ(offered, expectedOffered);
+
+    std::vector<ChunkHandle> expected = {Handle(0), Handle(4), Handle(7), Handle(8), Handle(9)};
+    EXPECT_EQ(queue.Size(), expected.size());
+    EXPECT_EQ(queue.Take(10), expected);
+
+    // removing and pushing again moves the chunk to its new position
+    queue.Push(Handle(0), {8, 0, 0});
+    queue.Push(Handle(1), {2, 0, 0});
+    queue.Remove(Handle(0));
+    queue.Push(Handle(0), {1, 0, 0});
+    expected = {Handle(0), Handle(1)};
+    EXPECT_EQ(queue.Take(10), expected);
+}
+
+TEST(DirtyChunkQueueTests, TestKeptChunksEndTake) {
+    DirtyChunkQueue queue;
+    queue.SetView(ViewFromChunk({0, 0, 0}));
+    for (glm::u32 i = 0; i < 1000; i++) queue.Push(Handle(i), {static_cast<glm::i32>(i), 0, 0});
+
+    // every chunk can't be taken yet, only maxCount of them are offered
+    std::size_t numOffered = 0;
+    EXPECT_EQ(queue.Take(4, [&](ChunkHandle, glm::ivec3) {
+        numOffered++;
+        return DirtyChunkQueue::Selection::KEEP;
+    }), 0);
+    EXPECT_EQ(numOffered, 4);
+    EXPECT_EQ(queue.Size(), 1000);
+    EXPECT_EQ(queue.Take(1).front(), Handle(0));
+}
+
+TEST(DirtyChunkQueueTests, TestHeldChunks) {
+    DirtyChunkQueue queue;
+    queue.SetView(ViewFromChunk({0, 0, 0}));
+    for (glm::u32 i = 0; i < 10; i++) queue.Push(Handle(i), {static_cast<glm::i32>(i), 0, 0});
+
+    // hold the closest chunks like the mesher does while they are being meshed
+    auto holdBelow = [&](glm::u32 index) {
+        return [index](ChunkHandle handle, glm::ivec3) {
+            return handle.Index < index ? DirtyChunkQueue::Selection::HOLD : DirtyChunkQueue::Selection::TAKE;
+        };
+    };
+    EXPECT_EQ(queue.Take(2, holdBelow(3)), 2);
+    EXPECT_EQ(queue.Size(), 8);
+    EXPECT_TRUE(queue.Contains(Handle(0)));
+
+    // held chunks aren't offered again, even after a rekey
+    std::vector<ChunkHandle> offered;
+    queue.SetView(ViewFromChunk({20, 0, 0}));
+    queue.SetView(ViewFromChunk({0, 0, 0}));
+    queue.Push(Handle(1), {1, 0, 0}); // already queued
+    EXPECT_EQ(queue.Take(2, [&](ChunkHandle handle, glm::ivec3) {
+        offered.push_back(handle);
+        return DirtyChunkQueue::Selection::TAKE;
+    }), 2);
+    std::vector<ChunkHandle> expected = {Handle(5), Handle(6)};
+    EXPECT_EQ(offered, expected);
+
+    // released chunks are offered again with their age
+    queue.Release(Handle(2));
+    queue.Release(Handle(7)); // not held
+    queue.Release(Handle(0));
+    expected = {Handle(0), Handle(2), Handle(7), Handle(8), Handle(9)};
+    EXPECT_EQ(queue.Take(10), expected);
+    EXPECT_EQ(queue.Size(), 1); // 1 is still held
+    EXPECT_TRUE(queue.Remove(Handle(1)));
+    EXPECT_TRUE(queue.Empty());
+}
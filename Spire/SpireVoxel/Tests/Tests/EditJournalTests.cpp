@@ -0,0 +1,406 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Edits/EditJournal.h"
+
+using namespace SpireVoxel;
+
+namespace {
+    using ChunkVoxels = std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME>;
+
+    // Chunks in a map, every write increases the chunk's version like Chunk does
+    class TestVoxels : public IJournalVoxels {
+    public:
+        void AddChunk(glm::ivec3 chunkPosition, const ChunkVoxels &voxels) {
+            m_chunks[chunkPosition].Write().Voxels = voxels;
+            m_versions[chunkPosition] = 0;
+        }
+
+        void RemoveChunk(glm::ivec3 chunkPosition) {
+            m_chunks.erase(chunkPosition);
+            m_versions.erase(chunkPosition);
+        }
+
+        [[nodiscard]] const ChunkVoxels &Read(glm::ivec3 chunkPosition) const { return m_chunks.at(chunkPosition).Read().Voxels; }
+
+        [[nodiscard]] std::map<std::tuple<glm::i32, glm::i32, glm::i32>, ChunkVoxels> GetAll() const {
+            std::map<std::tuple<glm::i32, glm::i32, glm::i32>, ChunkVoxels> all;
+            for (const auto &[chunkPosition, storage] : m_chunks) all[{chunkPosition.x, chunkPosition.y, chunkPosition.z}] = storage.Read().Voxels;
+            return all;
+        }
+
+        [[nodiscard]] const ChunkVoxelStorage *TryGetVoxels(glm::ivec3 chunkPosition) const override {
+            auto storage = m_chunks.find(chunkPosition);
+            return storage == m_chunks.end() ? nullptr : &storage->second;
+        }
+
+        [[nodiscard]] glm::u64 GetVersion(glm::ivec3 chunkPosition) const override { return m_versions.at(chunkPosition); }
+
+        void SetVoxels(glm::ivec3 chunkPosition, glm::u32 startIndex, glm::u32 endIndex, VoxelType type) override {
+            ChunkVoxels &voxels = m_chunks.at(chunkPosition).Write().Voxels;
+            std::fill(voxels.begin() + startIndex, voxels.begin() + endIndex, type);
+            m_versions.at(chunkPosition)++;
+        }
+
+        void ApplyEdit(IVoxelEdit &edit) override;
+
+        void NotifyChunkEdits(const std::unordered_set<glm::ivec3> &chunkPositions) override {
+            Notified.insert(chunkPositions.begin(), chunkPositions.end());
+        }
+
+        std::unordered_set<glm::ivec3> Notified;
+
+    private:
+        std::unordered_map<glm::ivec3, ChunkVoxelStorage> m_chunks;
+        std::unordered_map<glm::ivec3, glm::u64> m_versions;
+    };
+
+    // Fills runs of voxels through TestVoxels, which applies every edit of these tests
+    class FillVoxelEdit final : public IVoxelEdit {
+    public:
+        struct Fill {
+            glm::ivec3 ChunkPosition;
+            glm::u32 StartIndex;
+            glm::u32 EndIndex;
+            VoxelType Type;
+        };
+
+        explicit FillVoxelEdit(std::vector<Fill> fills, bool knowsWrittenChunks = true)
+            : m_fills(std::move(fills)),
+              m_knowsWrittenChunks(knowsWrittenChunks) {
+        }
+
+        void Apply(VoxelWorld &world) override { ADD_FAILURE() << "Only applied through TestVoxels"; }
+
+        void Write(TestVoxels &voxels) const {
+            for (const Fill &fill : m_fills) {
+                if (voxels.TryGetVoxels(fill.ChunkPosition)) voxels.SetVoxels(fill.ChunkPosition, fill.StartIndex, fill.EndIndex, fill.Type);
+            }
+        }
+
+        [[nodiscard]] std::optional<std::vector<glm::ivec3> > GetWrittenChunks() const override {
+            if (!m_knowsWrittenChunks) return std::nullopt;
+            std::vector<glm::ivec3> chunks;
+            for (const Fill &fill : m_fills) chunks.push_back(fill.ChunkPosition);
+            return chunks;
+        }
+
+    private:
+        std::vector<Fill> m_fills;
+        bool m_knowsWrittenChunks;
+    };
+
+    void TestVoxels::ApplyEdit(IVoxelEdit &edit) {
+        static_cast<FillVoxelEdit &>(edit).Write(*this);
+    }
+
+    FillVoxelEdit FillVoxel(glm::ivec3 chunkPosition, glm::u32 index, VoxelType type) {
+        return FillVoxelEdit({{chunkPosition, index, index + 1, type}});
+    }
+
+    // An interior voxel, its neighbours' meshes don't read it
+    const glm::u32 INTERIOR_INDEX = SPIRE_VOXEL_POSITION_TO_INDEX(glm::uvec3(10, 10, 10));
+}
+
+TEST(EditJournalTests, TestDeltaOfUnchangedChunk) {
+    ChunkVoxels voxels = {};
+    voxels[1234] = 5;
+    EXPECT_FALSE(EditJournal::CalculateDelta({0, 0, 0}, voxels, voxels).has_value());
+}
+
+TEST(EditJournalTests, TestDeltaIsRunLengthEncoded) {
+    ChunkVoxels before = {};
+    ChunkVoxels after;
+    after.fill(3);
+
+    std::optional<EditJournal::ChunkDelta> delta = EditJournal::CalculateDelta({1, -2, 3}, before, after);
+    ASSERT_TRUE(delta.has_value());
+    EXPECT_EQ(delta->ChunkPosition, glm::ivec3(1, -2, 3));
+    ASSERT_EQ(delta->Before.size(), 1);
+    ASSERT_EQ(delta->After.size(), 1);
+    EXPECT_EQ(delta->Before[0].StartIndex, 0);
+    EXPECT_EQ(delta->Before[0].EndIndex, SPIRE_VOXEL_CHUNK_VOLUME);
+    EXPECT_EQ(delta->Before[0].Type, VOXEL_TYPE_AIR);
+    EXPECT_EQ(delta->After[0].Type, 3);
+
+    // unchanged voxels split the runs, a change of the previous type splits only the before runs
+    after = before;
+    after[10] = after[11] = after[13] = 1;
+    before[11] = 2;
+    delta = EditJournal::CalculateDelta({0, 0, 0}, before, after);
+    ASSERT_TRUE(delta.has_value());
+    ASSERT_EQ(delta->Before.size(), 3);
+    ASSERT_EQ(delta->After.size(), 2);
+    EXPECT_EQ(delta->After[0].StartIndex, 10);
+    EXPECT_EQ(delta->After[0].EndIndex, 12);
+    EXPECT_EQ(delta->After[1].StartIndex, 13);
+    EXPECT_EQ(delta->After[1].EndIndex, 14);
+    EXPECT_EQ(delta->Before[1].Type, 2);
+}
+
+TEST(EditJournalTests, TestFullUndoRestoresWorld) {
+    std::mt19937 random(37);
+    std::uniform_int_distribution<glm::i32> chunkDistribution(-1, 1);
+    std::uniform_int_distribution<glm::u32> indexDistribution(0, SPIRE_VOXEL_CHUNK_VOLUME - 1);
+    std::uniform_int_distribution<glm::u32> lengthDistribution(1, 5000);
+    std::uniform_int_distribution<glm::u32> typeDistribution(0, 6);
+    std::uniform_int_distribution<glm::u32> strokeDistribution(1, 4);
+
+    TestVoxels voxels;
+    for (glm::i32 x = -1; x <= 1; x++) {
+        for (glm::i32 y = -1; y <= 1; y++) {
+            for (glm::i32 z = -1; z <= 1; z++) {
+                ChunkVoxels chunkVoxels;
+                for (VoxelType &voxel : chunkVoxels) voxel = static_cast<VoxelType>(typeDistribution(random));
+                voxels.AddChunk({x, y, z}, chunkVoxels);
+            }
+        }
+    }
+    const auto original = voxels.GetAll();
+
+    EditJournal journal(voxels, {});
+    for (int stroke = 0; stroke < 100; stroke++) {
+        // every other stroke has its edits in a nested stroke
+        journal.BeginStroke();
+        if (stroke % 2 == 1) journal.BeginStroke();
+        glm::u32 numEdits = strokeDistribution(random);
+        for (glm::u32 edit = 0; edit < numEdits; edit++) {
+            glm::ivec3 chunkPosition = {chunkDistribution(random), chunkDistribution(random), chunkDistribution(random)};
+            glm::u32 start = indexDistribution(random);
+            glm::u32 end = std::min<glm::u32>(start + lengthDistribution(random), SPIRE_VOXEL_CHUNK_VOLUME);
+            FillVoxelEdit fill({{chunkPosition, start, end, static_cast<VoxelType>(typeDistribution(random))}});
+            journal.Apply(fill);
+        }
+        if (stroke % 2 == 1) journal.EndStroke();
+        journal.EndStroke();
+    }
+    const auto edited = voxels.GetAll();
+    ASSERT_NE(edited, original);
+    ASSERT_GT(journal.NumUndoEntries(), 0);
+
+    std::size_t numEntries = journal.NumUndoEntries();
+    while (journal.Undo()) {
+    }
+    EXPECT_TRUE(voxels.GetAll() == original);
+    EXPECT_EQ(journal.NumUndoEntries(), 0);
+    EXPECT_EQ(journal.NumRedoEntries(), numEntries);
+
+    while (journal.Redo()) {
+    }
+    EXPECT_TRUE(voxels.GetAll() == edited);
+    EXPECT_EQ(journal.NumUndoEntries(), numEntries);
+}
+
+TEST(EditJournalTests, TestStrokeIsOneEntry) {
+    TestVoxels voxels;
+    voxels.AddChunk({0, 0, 0}, {});
+    voxels.AddChunk({1, 0, 0}, {});
+    EditJournal journal(voxels, {});
+
+    journal.BeginStroke();
+    FillVoxelEdit first = FillVoxel({0, 0, 0}, INTERIOR_INDEX, 1);
+    journal.Apply(first);
+    journal.BeginStroke();
+    FillVoxelEdit nested = FillVoxel({1, 0, 0}, INTERIOR_INDEX, 2);
+    journal.Apply(nested);
+    journal.EndStroke();
+    // a later edit of the same chunk keeps the snapshot from the start of the stroke
+    FillVoxelEdit overwrite = FillVoxel({0, 0, 0}, INTERIOR_INDEX, 3);
+    journal.Apply(overwrite);
+    EXPECT_TRUE(journal.IsInStroke());
+    EXPECT_EQ(journal.NumUndoEntries(), 0);
+    journal.EndStroke();
+    EXPECT_FALSE(journal.IsInStroke());
+    ASSERT_EQ(journal.NumUndoEntries(), 1);
+
+    EXPECT_TRUE(journal.Undo());
+    EXPECT_EQ(voxels.Read({0, 0, 0})[INTERIOR_INDEX], VOXEL_TYPE_AIR);
+    EXPECT_EQ(voxels.Read({1, 0, 0})[INTERIOR_INDEX], VOXEL_TYPE_AIR);
+    EXPECT_EQ(voxels.Notified, (std::unordered_set<glm::ivec3>{{0, 0, 0}, {1, 0, 0}}));
+    EXPECT_FALSE(journal.Undo());
+
+    EXPECT_TRUE(journal.Redo());
+    EXPECT_EQ(voxels.Read({0, 0, 0})[INTERIOR_INDEX], 3);
+    EXPECT_EQ(voxels.Read({1, 0, 0})[INTERIOR_INDEX], 2);
+    EXPECT_FALSE(journal.Redo());
+
+    // a stroke that puts every voxel back records nothing
+    journal.BeginStroke();
+    FillVoxelEdit change = FillVoxel({0, 0, 0}, INTERIOR_INDEX, 4);
+    FillVoxelEdit revert = FillVoxel({0, 0, 0}, INTERIOR_INDEX, 3);
+    journal.Apply(change);
+    journal.Apply(revert);
+    journal.EndStroke();
+    EXPECT_EQ(journal.NumUndoEntries(), 1);
+}
+
+TEST(EditJournalTests, TestNewEditClearsRedo) {
+    TestVoxels voxels;
+    voxels.AddChunk({0, 0, 0}, {});
+    EditJournal journal(voxels, {});
+
+    FillVoxelEdit first = FillVoxel({0, 0, 0}, INTERIOR_INDEX, 1);
+    FillVoxelEdit second = FillVoxel({0, 0, 0}, INTERIOR_INDEX + 1, 2);
+    journal.Apply(first);
+    journal.Apply(second);
+    EXPECT_TRUE(journal.Undo());
+    EXPECT_EQ(journal.NumRedoEntries(), 1);
+
+    FillVoxelEdit third = FillVoxel({0, 0, 0}, INTERIOR_INDEX + 2, 3);
+    journal.Apply(third);
+    EXPECT_EQ(journal.NumUndoEntries(), 2);
+    EXPECT_EQ(journal.NumRedoEntries(), 0);
+    EXPECT_FALSE(journal.Redo());
+
+    // an edit that doesn't know its chunks is applied, but can't be undone
+    FillVoxelEdit unknown({{{0, 0, 0}, 0, 1, 4}}, false);
+    journal.Apply(unknown);
+    EXPECT_EQ(voxels.Read({0, 0, 0})[0], 4);
+    EXPECT_EQ(journal.NumUndoEntries(), 0);
+    EXPECT_EQ(journal.GetMemoryUsage(), 0);
+}
+
+TEST(EditJournalTests, TestMaxMemoryForgetsOldestEntries) {
+    ChunkVoxels before = {};
+    ChunkVoxels after = {};
+    after[INTERIOR_INDEX] = 1;
+    const std::size_t entryMemory = EditJournal::CalculateDelta({0, 0, 0}, before, after)->GetMemoryUsage();
+
+    TestVoxels voxels;
+    voxels.AddChunk({0, 0, 0}, {});
+    // while an edit is applied its stroke's snapshot leaves room for two entries, the third is recorded when the stroke ends
+    EditJournal journal(voxels, {.MaxMemory = 2 * (sizeof(EditJournal::Entry) + entryMemory) + sizeof(ChunkVoxelStorage::Data)});
+
+    for (glm::u32 i = 0; i < 5; i++) {
+        FillVoxelEdit fill = FillVoxel({0, 0, 0}, INTERIOR_INDEX + i, 1);
+        journal.Apply(fill);
+        EXPECT_EQ(journal.NumUndoEntries(), std::min<glm::u32>(i + 1, 3));
+    }
+    EXPECT_EQ(journal.GetMemoryUsage(), 3 * (sizeof(EditJournal::Entry) + entryMemory));
+
+    while (journal.Undo()) {
+    }
+    // the two oldest edits were forgotten
+    const ChunkVoxels &voxelsAfterUndo = voxels.Read({0, 0, 0});
+    EXPECT_EQ(voxelsAfterUndo[INTERIOR_INDEX], 1);
+    EXPECT_EQ(voxelsAfterUndo[INTERIOR_INDEX + 1], 1);
+    EXPECT_EQ(voxelsAfterUndo[INTERIOR_INDEX + 2], VOXEL_TYPE_AIR);
+    EXPECT_EQ(voxelsAfterUndo[INTERIOR_INDEX + 4], VOXEL_TYPE_AIR);
+
+    journal.Clear();
+    EXPECT_EQ(journal.NumRedoEntries(), 0);
+    EXPECT_EQ(journal.GetMemoryUsage(), 0);
+}
+
+TEST(EditJournalTests, TestStrokeSnapshotsCountTowardsMaxMemory) {
+    ChunkVoxels before = {};
+    ChunkVoxels after = {};
+    after[INTERIOR_INDEX] = 1;
+    const std::size_t entryMemory = sizeof(EditJournal::Entry) + EditJournal::CalculateDelta({0, 0, 0}, before, after)->GetMemoryUsage();
+
+    TestVoxels voxels;
+    for (glm::i32 x = 0; x < 3; x++) voxels.AddChunk({x, 0, 0}, {});
+    EditJournal journal(voxels, {.MaxMemory = sizeof(ChunkVoxelStorage::Data) + entryMemory});
+
+    for (glm::u32 i = 0; i < 2; i++) {
+        FillVoxelEdit fill = FillVoxel({0, 0, 0}, INTERIOR_INDEX + i, 1);
+        journal.Apply(fill);
+    }
+    EXPECT_EQ(journal.NumUndoEntries(), 2);
+    EXPECT_EQ(journal.GetSnapshotMemoryUsage(), 0);
+
+    // a snapshot holds the old voxels once its chunk is written, the oldest entries make room for it
+    journal.BeginStroke();
+    FillVoxelEdit first = FillVoxel({1, 0, 0}, INTERIOR_INDEX, 2);
+    journal.Apply(first);
+    EXPECT_EQ(journal.GetSnapshotMemoryUsage(), sizeof(ChunkVoxelStorage::Data));
+    EXPECT_EQ(journal.NumUndoEntries(), 1);
+    EXPECT_EQ(journal.GetMemoryUsage(), entryMemory);
+
+    FillVoxelEdit second = FillVoxel({2, 0, 0}, INTERIOR_INDEX, 2);
+    journal.Apply(second);
+    EXPECT_EQ(journal.GetSnapshotMemoryUsage(), 2 * sizeof(ChunkVoxelStorage::Data));
+    EXPECT_EQ(journal.NumUndoEntries(), 0);
+    EXPECT_EQ(journal.GetMemoryUsage(), 0);
+
+    journal.EndStroke();
+    EXPECT_EQ(journal.GetSnapshotMemoryUsage(), 0);
+    EXPECT_EQ(journal.NumUndoEntries(), 1);
+
+    // the stroke itself can still be undone
+    EXPECT_TRUE(journal.Undo());
+    EXPECT_EQ(voxels.Read({1, 0, 0})[INTERIOR_INDEX], VOXEL_TYPE_AIR);
+    EXPECT_EQ(voxels.Read({2, 0, 0})[INTERIOR_INDEX], VOXEL_TYPE_AIR);
+    EXPECT_EQ(voxels.Read({0, 0, 0})[INTERIOR_INDEX], 1);
+}
+
+TEST(EditJournalTests, TestMaxMemoryForgetsFurthestRedoEntries) {
+    ChunkVoxels before = {};
+    ChunkVoxels after = {};
+    after[INTERIOR_INDEX] = 1;
+    const std::size_t entryMemory = sizeof(EditJournal::Entry) + EditJournal::CalculateDelta({0, 0, 0}, before, after)->GetMemoryUsage();
+
+    TestVoxels voxels;
+    for (glm::i32 x = 0; x < 3; x++) voxels.AddChunk({x, 0, 0}, {});
+    EditJournal journal(voxels, {.MaxMemory = 2 * sizeof(ChunkVoxelStorage::Data) + entryMemory});
+
+    for (glm::u32 i = 0; i < 2; i++) {
+        FillVoxelEdit fill = FillVoxel({0, 0, 0}, INTERIOR_INDEX + i, 1);
+        journal.Apply(fill);
+    }
+    EXPECT_TRUE(journal.Undo());
+    EXPECT_TRUE(journal.Undo());
+    EXPECT_EQ(journal.NumRedoEntries(), 2);
+
+    // a stroke that doesn't change anything doesn't clear the redo history, but its snapshots still need room
+    journal.BeginStroke();
+    FillVoxelEdit first = FillVoxel({1, 0, 0}, INTERIOR_INDEX, VOXEL_TYPE_AIR);
+    FillVoxelEdit second = FillVoxel({2, 0, 0}, INTERIOR_INDEX, VOXEL_TYPE_AIR);
+    journal.Apply(first);
+    EXPECT_EQ(journal.NumRedoEntries(), 2);
+    journal.Apply(second);
+    EXPECT_EQ(journal.NumRedoEntries(), 1);
+    journal.EndStroke();
+    EXPECT_EQ(journal.NumUndoEntries(), 0);
+    EXPECT_EQ(journal.NumRedoEntries(), 1);
+
+    // the entry that would be redone last was forgotten
+    EXPECT_TRUE(journal.Redo());
+    EXPECT_FALSE(journal.Redo());
+    EXPECT_EQ(voxels.Read({0, 0, 0})[INTERIOR_INDEX], 1);
+    EXPECT_EQ(voxels.Read({0, 0, 0})[INTERIOR_INDEX + 1], VOXEL_TYPE_AIR);
+}
+
+TEST(EditJournalTests, TestDeltaVoxelEditWrite) {
+    ChunkVoxels before = {};
+    ChunkVoxels after = {};
+    after[INTERIOR_INDEX] = 1;
+    // a border voxel changing from air is read by the neighbour's mesh
+    after[SPIRE_VOXEL_POSITION_TO_INDEX(glm::uvec3(0, 10, 10))] = 2;
+    std::vector<EditJournal::ChunkDelta> deltas;
+    deltas.push_back(EditJournal::CalculateDelta({0, 0, 0}, before, after).value());
+    deltas.push_back(EditJournal::CalculateDelta({5, 0, 0}, before, after).value());
+
+    TestVoxels voxels;
+    voxels.AddChunk({0, 0, 0}, {});
+    DeltaVoxelEdit edit(deltas, false);
+    EXPECT_EQ(edit.GetWrittenChunks(), (std::vector<glm::ivec3>{{0, 0, 0}, {5, 0, 0}}));
+
+    // the chunk that isn't loaded is skipped
+    EXPECT_EQ(edit.Write(voxels), (std::unordered_set<glm::ivec3>{{0, 0, 0}, {-1, 0, 0}}));
+    EXPECT_TRUE(voxels.Read({0, 0, 0}) == after);
+    EXPECT_EQ(voxels.GetVersion({0, 0, 0}), 2);
+
+    // runs that are already written change nothing
+    EXPECT_TRUE(edit.Write(voxels).empty());
+    EXPECT_EQ(voxels.GetVersion({0, 0, 0}), 2);
+
+    // changing the type of a voxel that stays solid only changes its own chunk's mesh
+    after[SPIRE_VOXEL_POSITION_TO_INDEX(glm::uvec3(0, 10, 10))] = 3;
+    std::vector<EditJournal::ChunkDelta> retype = {EditJournal::CalculateDelta({0, 0, 0}, voxels.Read({0, 0, 0}), after).value()};
+    EXPECT_EQ(DeltaVoxelEdit(retype, false).Write(voxels), std::unordered_set<glm::ivec3>{glm::ivec3(0, 0, 0)});
+
+    EXPECT_EQ(DeltaVoxelEdit(deltas, true).Write(voxels), (std::unordered_set<glm::ivec3>{{0, 0, 0}, {-1, 0, 0}}));
+    EXPECT_TRUE(voxels.Read({0, 0, 0}) == before);
+}
@@ -0,0 +1,80 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Edits/EditQueue.h"
+
+#include <thread>
+
+using namespace SpireVoxel;
+
+// Remembers who submitted it, never applied
+class SubmittedEdit final : public IVoxelEdit {
+public:
+    SubmittedEdit(glm::u32 producer, glm::u32 index) : Producer(producer), Index(index) {
+    }
+
+    void Apply(VoxelWorld &world) override {
+    }
+
+    glm::u32 Producer;
+    glm::u32 Index;
+};
+
+TEST(EditQueueTests, TestTakeInSequenceOrder) {
+    EditQueue queue;
+    EXPECT_TRUE(queue.Take().empty());
+
+    for (glm::u32 i = 0; i < 5; i++) {
+        EXPECT_EQ(queue.Submit(SubmittedEdit(0, i)), i);
+    }
+    std::vector<EditQueue::Command> commands = queue.Take();
+    ASSERT_EQ(commands.size(), 5);
+    for (glm::u32 i = 0; i < 5; i++) {
+        EXPECT_EQ(commands[i].Sequence, i);
+        EXPECT_EQ(dynamic_cast<SubmittedEdit &>(*commands[i].Edit).Index, i);
+    }
+    EXPECT_TRUE(queue.Take().empty());
+}
+
+TEST(EditQueueTests, TestManyProducers) {
+    static constexpr glm::u32 NUM_PRODUCERS = 16;
+    static constexpr glm::u32 EDITS_PER_PRODUCER = 20000;
+    static constexpr glm::u32 NUM_EDITS = NUM_PRODUCERS * EDITS_PER_PRODUCER;
+
+    EditQueue queue;
+    std::vector<std::vector<EditQueue::SequenceNumber> > submittedSequences(NUM_PRODUCERS);
+    std::atomic<bool> start = false;
+    std::vector<std::thread> producers;
+    for (glm::u32 producer = 0; producer < NUM_PRODUCERS; producer++) {
+        producers.emplace_back([&, producer] {
+            while (!start) std::this_thread::yield();
+            for (glm::u32 i = 0; i < EDITS_PER_PRODUCER; i++) {
+                submittedSequences[producer].push_back(queue.Submit(SubmittedEdit(producer, i)));
+            }
+        });
+    }
+
+    // take while the producers are submitting, like the world does every frame
+    Spire::Timer timer;
+    start = true;
+    std::vector<EditQueue::Command> taken;
+    taken.reserve(NUM_EDITS);
+    while (taken.size() < NUM_EDITS && timer.MillisSinceStart() < 30000) {
+        for (EditQueue::Command &command : queue.Take()) taken.push_back(std::move(command));
+    }
+    for (std::thread &producer : producers) producer.join();
+    float millis = timer.MillisSinceStart();
+    Spire::info("{} producers submitted {} edits in {} ms", NUM_PRODUCERS, NUM_EDITS, millis);
+
+    // nothing lost, every edit taken in sequence order, and each producer's edits in the order it submitted them
+    ASSERT_EQ(taken.size(), NUM_EDITS);
+    EXPECT_TRUE(queue.Take().empty());
+    std::vector<glm::u32> nextIndex(NUM_PRODUCERS, 0);
+    for (std::size_t i = 0; i < taken.size(); i++) {
+        ASSERT_EQ(taken[i].Sequence, i);
+        auto &edit = dynamic_cast<SubmittedEdit &>(*taken[i].Edit);
+        ASSERT_EQ(edit.Index, nextIndex[edit.Producer]++);
+        ASSERT_EQ(submittedSequences[edit.Producer][edit.Index], taken[i].Sequence);
+    }
+}
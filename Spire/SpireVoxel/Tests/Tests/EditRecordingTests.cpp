@@ -0,0 +1,167 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "Edits/BasicVoxelEdit.h"
+#include "Edits/CuboidVoxelEdit.h"
+#include "Edits/EditReplay.h"
+
+using namespace SpireVoxel;
+
+using ChunkVoxels = std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME>;
+
+TEST(EditRecordingTests, TestSaveAndLoad) {
+    std::mt19937 random(40);
+    std::uniform_int_distribution<glm::u32> indexDistribution(0, SPIRE_VOXEL_CHUNK_VOLUME - 1);
+    std::uniform_int_distribution<glm::u32> typeDistribution(0, 3);
+
+    EditRecording recording;
+    for (int i = 0; i < 20; i++) {
+        ChunkVoxels before = {};
+        ChunkVoxels after = {};
+        for (int voxel = 0; voxel < 500; voxel++) after[indexDistribution(random)] = static_cast<VoxelType>(typeDistribution(random));
+
+        EditRecording::Edit edit = {static_cast<float>(i) * 16.6f, {}};
+        std::optional<EditJournal::ChunkDelta> delta = EditJournal::CalculateDelta({i, -i, 3}, before, after);
+        if (delta) edit.Chunks.push_back(std::move(delta.value()));
+        recording.Add(std::move(edit));
+    }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "SpireVoxelTests" / "TestSaveAndLoad.sprve";
+    ASSERT_TRUE(recording.Save(path));
+    std::optional<EditRecording> loaded = EditRecording::Load(path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->CountWrittenVoxels(), recording.CountWrittenVoxels());
+    ASSERT_EQ(loaded->GetEdits().size(), recording.GetEdits().size());
+    for (std::size_t i = 0; i < recording.GetEdits().size(); i++) {
+        const EditRecording::Edit &expected = recording.GetEdits()[i];
+        const EditRecording::Edit &actual = loaded->GetEdits()[i];
+        EXPECT_EQ(actual.TimeMillis, expected.TimeMillis);
+        EXPECT_EQ(actual.Type, IVoxelEdit::RecordedType::NONE);
+        ASSERT_EQ(actual.Chunks.size(), expected.Chunks.size());
+        for (std::size_t chunk = 0; chunk < expected.Chunks.size(); chunk++) {
+            EXPECT_EQ(actual.Chunks[chunk].ChunkPosition, expected.Chunks[chunk].ChunkPosition);
+            ASSERT_EQ(actual.Chunks[chunk].Before.size(), expected.Chunks[chunk].Before.size());
+            ASSERT_EQ(actual.Chunks[chunk].After.size(), expected.Chunks[chunk].After.size());
+            for (std::size_t run = 0; run < expected.Chunks[chunk].After.size(); run++) {
+                EXPECT_EQ(actual.Chunks[chunk].After[run].StartIndex, expected.Chunks[chunk].After[run].StartIndex);
+                EXPECT_EQ(actual.Chunks[chunk].After[run].EndIndex, expected.Chunks[chunk].After[run].EndIndex);
+                EXPECT_EQ(actual.Chunks[chunk].After[run].Type, expected.Chunks[chunk].After[run].Type);
+            }
+        }
+    }
+
+    // a truncated file is rejected rather than half loaded
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+    EXPECT_FALSE(EditRecording::Load(path).has_value());
+    std::filesystem::remove(path);
+}
+
+// what EditRecording::Apply records, without a world to apply it to
+static EditRecording::Edit RecordEdit(float timeMillis, const IVoxelEdit &voxelEdit) {
+    return {timeMillis, {}, voxelEdit.GetRecordedType(), EditRecording::Describe(voxelEdit)};
+}
+
+TEST(EditRecordingTests, TestEditsAreRecordedAsThemselves) {
+    EditRecording recording;
+    recording.Add(RecordEdit(0, BasicVoxelEdit({{{1, -2, 70}, 3}, {{-65, 0, 5}, 0}})));
+    recording.Add(RecordEdit(5, CuboidVoxelEdit({-10, 4, 60}, {20, 1, 4}, 7)));
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "SpireVoxelTests" / "TestEditsAreRecordedAsThemselves.sprve";
+    ASSERT_TRUE(recording.Save(path));
+    std::optional<EditRecording> loaded = EditRecording::Load(path);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->GetEdits().size(), 2);
+
+    // the replayed edits are the recorded ones, recording them again gives the same description
+    for (std::size_t i = 0; i < 2; i++) {
+        const EditRecording::Edit &expected = recording.GetEdits()[i];
+        const EditRecording::Edit &actual = loaded->GetEdits()[i];
+        EXPECT_EQ(actual.Type, expected.Type);
+        EXPECT_EQ(actual.Description, expected.Description);
+
+        std::unique_ptr<IVoxelEdit> voxelEdit = EditRecording::CreateEdit(actual);
+        ASSERT_NE(voxelEdit, nullptr);
+        EXPECT_EQ(voxelEdit->GetRecordedType(), expected.Type);
+        EXPECT_EQ(EditRecording::Describe(*voxelEdit), expected.Description);
+    }
+
+    std::optional<std::vector<glm::ivec3> > writtenChunks = EditRecording::CreateEdit(loaded->GetEdits()[1])->GetWrittenChunks();
+    ASSERT_TRUE(writtenChunks.has_value());
+    EXPECT_EQ(writtenChunks->size(), 2); // x from -10 to 9 crosses a chunk boundary
+
+    // a description that can't be read back is rejected when loading, not when replaying
+    EditRecording::Edit truncated = RecordEdit(10, BasicVoxelEdit(glm::ivec3(0, 0, 0), 1));
+    truncated.Description.pop_back();
+    EXPECT_EQ(EditRecording::CreateEdit(truncated), nullptr);
+    recording.Add(std::move(truncated));
+    ASSERT_TRUE(recording.Save(path));
+    EXPECT_FALSE(EditRecording::Load(path).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST(EditRecordingTests, TestRecordHeaderIsChecked) {
+    CuboidVoxelEdit cuboid({-10, 4, 60}, {20, 1, 4}, 7);
+    EditRecording::Edit edit = RecordEdit(0, cuboid);
+    ASSERT_NE(EditRecording::CreateEdit(edit), nullptr);
+
+    // the description starts with an identifier, the record version and a byte order mark
+    std::ostringstream raw;
+    cuboid.Record(raw);
+    std::string header = edit.Description.substr(0, edit.Description.size() - raw.str().size());
+    EXPECT_EQ(header.size(), 8);
+    EXPECT_EQ(header.substr(0, 4), "SVER");
+    EXPECT_EQ(edit.Description.substr(header.size()), raw.str());
+
+    // no header, another record version, or the other byte order
+    EditRecording::Edit headerless = edit;
+    headerless.Description = raw.str();
+    EXPECT_EQ(EditRecording::CreateEdit(headerless), nullptr);
+    EditRecording::Edit newerVersion = edit;
+    newerVersion.Description[4] = static_cast<char>(IVoxelEdit::RECORD_VERSION + 1);
+    EXPECT_EQ(EditRecording::CreateEdit(newerVersion), nullptr);
+    EditRecording::Edit swapped = edit;
+    std::swap(swapped.Description[6], swapped.Description[7]);
+    EXPECT_EQ(EditRecording::CreateEdit(swapped), nullptr);
+
+    // and loading rejects the file instead of replaying part of it
+    EditRecording recording;
+    recording.Add(edit);
+    recording.Add(swapped);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "SpireVoxelTests" / "TestRecordHeaderIsChecked.sprve";
+    ASSERT_TRUE(recording.Save(path));
+    EXPECT_FALSE(EditRecording::Load(path).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST(EditRecordingTests, TestEditsWithoutRecordedTypeReplayTheirVoxels) {
+    ChunkVoxels before = {};
+    ChunkVoxels after = {};
+    after[10] = 2;
+    EditRecording::Edit edit = {0, {}};
+    edit.Chunks.push_back(EditJournal::CalculateDelta({1, 2, 3}, before, after).value());
+
+    std::unique_ptr<IVoxelEdit> voxelEdit = EditRecording::CreateEdit(edit);
+    ASSERT_NE(voxelEdit, nullptr);
+    EXPECT_EQ(voxelEdit->GetRecordedType(), IVoxelEdit::RecordedType::NONE);
+    EXPECT_EQ(voxelEdit->GetWrittenChunks(), std::vector<glm::ivec3>{glm::ivec3(1, 2, 3)});
+}
+
+TEST(EditRecordingTests, TestPercentiles) {
+    std::vector<float> millis;
+    for (int i = 100; i >= 1; i--) millis.push_back(static_cast<float>(i));
+
+    EditReplay::Percentiles percentiles = EditReplay::CalculatePercentiles(millis);
+    EXPECT_EQ(percentiles.P50, 50);
+    EXPECT_EQ(percentiles.P90, 90);
+    EXPECT_EQ(percentiles.P99, 99);
+    EXPECT_EQ(percentiles.Max, 100);
+
+    percentiles = EditReplay::CalculatePercentiles({7});
+    EXPECT_EQ(percentiles.P50, 7);
+    EXPECT_EQ(percentiles.P99, 7);
+
+    percentiles = EditReplay::CalculatePercentiles({});
+    EXPECT_EQ(percentiles.Max, 0);
+}
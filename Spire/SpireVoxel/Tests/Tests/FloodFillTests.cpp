@@ -0,0 +1,139 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Edits/MaskVoxelEdit.h"
+#include "Utils/FloodFill.h"
+
+using namespace SpireVoxel;
+
+using PassableWorld = std::unordered_map<glm::ivec3, VoxelBitmask>;
+
+static FloodFill::PassableLookup Lookup(const PassableWorld &world) {
+    return [&world](glm::ivec3 chunkPosition) -> const VoxelBitmask * {
+        auto it = world.find(chunkPosition);
+        return it == world.end() ? nullptr : &it->second;
+    };
+}
+
+static glm::u32 IndexInChunk(glm::ivec3 position) {
+    return SPIRE_VOXEL_POSITION_TO_INDEX(position - VoxelWorld::GetChunkPositionOfVoxel(position) * SPIRE_VOXEL_CHUNK_SIZE);
+}
+
+static void SetPassable(PassableWorld &world, glm::ivec3 position, bool passable) {
+    world[VoxelWorld::GetChunkPositionOfVoxel(position)].Set(IndexInChunk(position), passable);
+}
+
+static bool IsFilled(const FloodFill::Result &result, glm::ivec3 position) {
+    auto it = result.Chunks.find(VoxelWorld::GetChunkPositionOfVoxel(position));
+    return it != result.Chunks.end() && it->second.Test(IndexInChunk(position));
+}
+
+TEST(FloodFillTests, TestFillRow) {
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; i++) {
+        glm::u64 passable = random() | random(); // mostly passable so there are long runs
+        glm::u64 seeds = random() & random() & random() & passable;
+
+        // naive: a bit is filled if a seed is in the same run of passable bits
+        glm::u64 expected = 0;
+        for (glm::u32 bit = 0; bit < 64; bit++) {
+            if (!((seeds >> bit) & 1)) continue;
+            for (glm::i32 z = bit; z < 64 && ((passable >> z) & 1); z++) expected |= glm::u64(1) << z;
+            for (glm::i32 z = bit; z >= 0 && ((passable >> z) & 1); z--) expected |= glm::u64(1) << z;
+        }
+        ASSERT_EQ(FloodFill::FillRow(seeds, passable), expected);
+    }
+}
+
+TEST(FloodFillTests, TestMatchesBreadthFirstSearch) {
+    // random caves over 2x2x1 chunks, the fill must match a per voxel BFS
+    std::mt19937 random(7);
+    std::bernoulli_distribution isPassable(0.7);
+    PassableWorld world;
+    glm::ivec3 min = {-SPIRE_VOXEL_CHUNK_SIZE, 0, 0};
+    glm::ivec3 max = {SPIRE_VOXEL_CHUNK_SIZE, 2 * SPIRE_VOXEL_CHUNK_SIZE, SPIRE_VOXEL_CHUNK_SIZE}; // exclusive
+    for (glm::i32 x = min.x; x < max.x; x++) {
+        for (glm::i32 y = min.y; y < max.y; y++) {
+            for (glm::i32 z = min.z; z < max.z; z++) SetPassable(world, {x, y, z}, isPassable(random));
+        }
+    }
+    glm::ivec3 start = {-3, 70, 20};
+    SetPassable(world, start, true);
+
+    FloodFill::Result result = FloodFill::Fill(Lookup(world), start, FloodFill::Settings{});
+    EXPECT_TRUE(result.ReachedUnloadedChunk); // 70% open always reaches the edge
+
+    std::unordered_set<glm::ivec3> visited = {start};
+    std::vector<glm::ivec3> frontier = {start};
+    while (!frontier.empty()) {
+        glm::ivec3 position = frontier.back();
+        frontier.pop_back();
+        for (glm::u32 face = 0; face < SPIRE_VOXEL_NUM_FACES; face++) {
+            glm::ivec3 next = position + FaceToDirection(face);
+            if (next.x < min.x || next.y < min.y || next.z < min.z || next.x >= max.x || next.y >= max.y || next.z >= max.z) continue;
+            if (!world[VoxelWorld::GetChunkPositionOfVoxel(next)].Test(IndexInChunk(next))) continue;
+            if (visited.insert(next).second) frontier.push_back(next);
+        }
+    }
+
+    EXPECT_EQ(result.NumVoxels, visited.size());
+    for (const glm::ivec3 &position : visited) ASSERT_TRUE(IsFilled(result, position));
+}
+
+TEST(FloodFillTests, TestFillCavity) {
+    // a 100^3 air cavity across 8 chunks, surrounded by loaded solid chunks
+    PassableWorld world;
+    for (glm::i32 x = -2; x <= 1; x++) {
+        for (glm::i32 y = -2; y <= 1; y++) {
+            for (glm::i32 z = -2; z <= 1; z++) world[{x, y, z}] = {};
+        }
+    }
+    glm::ivec3 cavityMin = glm::ivec3(-50);
+    glm::ivec3 cavitySize = glm::ivec3(100);
+    for (glm::i32 x = 0; x < cavitySize.x; x++) {
+        for (glm::i32 y = 0; y < cavitySize.y; y++) {
+            for (glm::i32 z = 0; z < cavitySize.z; z++) SetPassable(world, cavityMin + glm::ivec3(x, y, z), true);
+        }
+    }
+
+    Spire::Timer timer;
+    FloodFill::Result result = FloodFill::Fill(Lookup(world), {10, -20, 30}, FloodFill::Settings{});
+    float millis = timer.MillisSinceStart();
+    Spire::info("Flood filled a {} voxel cavity in {} ms", result.NumVoxels, millis);
+
+    EXPECT_TRUE(result.IsComplete());
+    EXPECT_EQ(result.NumVoxels, 100 * 100 * 100);
+    EXPECT_EQ(result.Chunks.size(), 8);
+    EXPECT_TRUE(IsFilled(result, cavityMin));
+    EXPECT_TRUE(IsFilled(result, cavityMin + cavitySize - 1));
+    EXPECT_FALSE(IsFilled(result, cavityMin - 1));
+
+    // a hole in the wall leaks into chunks that aren't loaded
+    for (glm::i32 x = cavityMin.x + cavitySize.x; x < 2 * SPIRE_VOXEL_CHUNK_SIZE; x++) SetPassable(world, {x, 0, 0}, true);
+    result = FloodFill::Fill(Lookup(world), {10, -20, 30}, FloodFill::Settings{});
+    EXPECT_TRUE(result.ReachedUnloadedChunk);
+    EXPECT_FALSE(result.IsComplete());
+
+    result = FloodFill::Fill(Lookup(world), {10, -20, 30}, FloodFill::Settings{.MaxVoxels = 1000});
+    EXPECT_TRUE(result.ReachedMaxVoxels);
+
+    // not passable at the start fills nothing
+    result = FloodFill::Fill(Lookup(world), cavityMin - 1, FloodFill::Settings{});
+    EXPECT_EQ(result.NumVoxels, 0);
+    EXPECT_TRUE(result.IsComplete());
+}
+
+TEST(FloodFillTests, TestMaskRuns) {
+    VoxelBitmask mask;
+    mask.Set(0, true);
+    mask.Set(1, true);
+    mask.Set(5, true);
+    for (glm::u32 i = 60; i < 70; i++) mask.Set(i, true); // runs are split at rows
+    mask.Set(SPIRE_VOXEL_CHUNK_VOLUME - 1, true);
+
+    std::vector<std::pair<glm::u32, glm::u32> > runs;
+    MaskVoxelEdit::ForEachRun(mask, [&](glm::u32 start, glm::u32 end) { runs.emplace_back(start, end); });
+    std::vector<std::pair<glm::u32, glm::u32> > expected = {{0, 2}, {5, 6}, {60, 64}, {64, 70}, {SPIRE_VOXEL_CHUNK_VOLUME - 1, SPIRE_VOXEL_CHUNK_VOLUME}};
+    EXPECT_EQ(runs, expected);
+}
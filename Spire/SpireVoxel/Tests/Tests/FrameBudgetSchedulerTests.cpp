@@ -0,0 +1,120 @@
+#include "EngineIncludes.h"
+#include <gtest/gtest.h>
+
+#include "Utils/FrameBudgetScheduler.h"
+
+using namespace SpireVoxel;
+
+static void Spin(float millis) {
+    Spire::Timer timer;
+    while (timer.MillisSinceStart() < millis) {
+    }
+}
+
+TEST(FrameBudgetSchedulerTests, TestBudgetRespectedUnderFlood) {
+    constexpr float BUDGET = 2.0f;
+    constexpr float JOB_MILLIS = 0.1f;
+    constexpr glm::u32 NUM_CHEAP = 1800;
+    constexpr glm::u32 NUM_EXPENSIVE = 200;
+
+    FrameBudgetScheduler scheduler(FrameBudgetScheduler::Settings{.BudgetMillis = BUDGET});
+    FrameBudgetScheduler::JobType cheap = scheduler.Register("Cheap", 0.01f); // badly underestimated at first
+    FrameBudgetScheduler::JobType expensive = scheduler.Register("Expensive", 1.0f);
+
+    // like mesh uploads and compression, expensive work always makes progress and cheap work uses what is left
+    glm::u32 cheapLeft = NUM_CHEAP;
+    glm::u32 expensiveLeft = NUM_EXPENSIVE;
+    glm::u32 numFrames = 0;
+    glm::u32 numOverrunFrames = 0;
+    float maxFrameMillis = 0;
+    while (cheapLeft > 0 || expensiveLeft > 0) {
+        scheduler.BeginFrame();
+        Spire::Timer frameTimer;
+        glm::u32 numExpensive = scheduler.Admit(expensive, expensiveLeft, 1);
+        Spire::Timer timer;
+        Spin(static_cast<float>(numExpensive) * 3 * JOB_MILLIS);
+        scheduler.Report(expensive, numExpensive, timer.MillisSinceStart());
+        expensiveLeft -= numExpensive;
+
+        glm::u32 numCheap = scheduler.Admit(cheap, cheapLeft);
+        timer.Restart();
+        Spin(static_cast<float>(numCheap) * JOB_MILLIS);
+        scheduler.Report(cheap, numCheap, timer.MillisSinceStart());
+        cheapLeft -= numCheap;
+
+        float frameMillis = frameTimer.MillisSinceStart();
+        maxFrameMillis = std::max(maxFrameMillis, frameMillis);
+        // the only overrun allowed is a misestimated batch, more can only come from the test being preempted
+        if (scheduler.GetUsedMillis() > BUDGET + 3 * JOB_MILLIS) numOverrunFrames++;
+        numFrames++;
+        ASSERT_LT(numFrames, NUM_CHEAP + NUM_EXPENSIVE);
+    }
+    Spire::info("Ran {} jobs in {} frames with a {} ms budget, longest frame {} ms", NUM_CHEAP + NUM_EXPENSIVE, numFrames, BUDGET, maxFrameMillis);
+
+    EXPECT_LT(numOverrunFrames, numFrames / 10);
+    // (1800 * 0.1 + 200 * 0.3) / 2 = 120 frames if the budget is filled
+    EXPECT_LT(numFrames, 200);
+    EXPECT_NEAR(scheduler.GetUnitCostMillis(cheap), JOB_MILLIS, JOB_MILLIS);
+    EXPECT_NEAR(scheduler.GetUnitCostMillis(expensive), 3 * JOB_MILLIS, 3 * JOB_MILLIS);
+    EXPECT_GT(scheduler.GetJobStats()[cheap].UnitsDeferred, 0);
+}
+
+TEST(FrameBudgetSchedulerTests, TestAdmitLearnsCost) {
+    FrameBudgetScheduler scheduler(FrameBudgetScheduler::Settings{.BudgetMillis = 10.0f, .Smoothing = 0.5f});
+    FrameBudgetScheduler::JobType type = scheduler.Register("Chunk", 1.0f);
+
+    scheduler.BeginFrame();
+    EXPECT_EQ(scheduler.Admit(type, 100), 10);
+    EXPECT_EQ(scheduler.Admit(type, 4), 4);
+
+    // the work was cheaper than expected
+    for (glm::u32 frame = 0; frame < 20; frame++) {
+        scheduler.BeginFrame();
+        scheduler.Report(type, 10, 1.0f);
+    }
+    EXPECT_NEAR(scheduler.GetUnitCostMillis(type), 0.1f, 0.001f);
+
+    scheduler.BeginFrame();
+    EXPECT_NEAR(static_cast<float>(scheduler.Admit(type, 1000)), 100.0f, 1.0f);
+
+    // once the budget is used only the minimum is admitted
+    scheduler.Report(type, 100, 10.0f);
+    EXPECT_EQ(scheduler.GetRemainingMillis(), 0);
+    EXPECT_EQ(scheduler.Admit(type, 50), 0);
+    EXPECT_EQ(scheduler.Admit(type, 50, 2), 2);
+    EXPECT_EQ(scheduler.GetJobStats()[type].UnitsRun, 20 * 10 + 100);
+}
+
+TEST(FrameBudgetSchedulerTests, TestSlowMeasurementDoesNotStarve) {
+    FrameBudgetScheduler scheduler(FrameBudgetScheduler::Settings{.BudgetMillis = 4.0f, .Smoothing = 1.0f, .MaxStarvedFrames = 10});
+    FrameBudgetScheduler::JobType type = scheduler.Register("Compression", 0.5f);
+
+    // e.g. the thread was preempted while compressing
+    scheduler.BeginFrame();
+    ASSERT_EQ(scheduler.Admit(type, 1), 1);
+    scheduler.Report(type, 1, 100.0f);
+
+    glm::u32 numStarved = 0;
+    for (;;) {
+        scheduler.BeginFrame();
+        if (scheduler.Admit(type, 8) > 0) break;
+        numStarved++;
+        ASSERT_LT(numStarved, 10);
+    }
+    EXPECT_EQ(numStarved, 9);
+    EXPECT_EQ(scheduler.GetJobStats()[type].UnitsDeferred, 9 * 8 + 7);
+
+    // measuring the unit again corrects the estimate
+    scheduler.Report(type, 1, 0.5f);
+    scheduler.BeginFrame();
+    EXPECT_EQ(scheduler.Admit(type, 8), 8);
+
+    // frames where nothing was asked for don't count as starved
+    scheduler.Report(type, 8, 800.0f);
+    for (glm::u32 frame = 0; frame < 20; frame++) {
+        scheduler.BeginFrame();
+        EXPECT_EQ(scheduler.Admit(type, 0), 0);
+    }
+    scheduler.BeginFrame();
+    EXPECT_EQ(scheduler.Admit(type, 8), 0);
+}
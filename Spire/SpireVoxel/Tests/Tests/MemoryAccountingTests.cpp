@@ -0,0 +1,133 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/ChunkVoxelStorage.h"
+#include "Utils/MemoryAccounting.h"
+
+using Spire::MemoryAccounting;
+using Spire::MemoryCategory;
+
+static glm::u64 GetBytes(MemoryCategory category) {
+    return MemoryAccounting::Instance().GetBytes(category);
+}
+
+TEST(MemoryAccountingTests, TestTrackingAllocator) {
+    glm::u64 before = GetBytes(MemoryCategory::MeshScratch);
+    {
+        std::vector<glm::u32, Spire::TrackingAllocator<glm::u32, MemoryCategory::MeshScratch> > vector;
+        vector.reserve(1000);
+        EXPECT_EQ(GetBytes(MemoryCategory::MeshScratch), before + vector.capacity() * sizeof(glm::u32));
+
+        // other categories aren't affected
+        glm::u64 staging = GetBytes(MemoryCategory::Staging);
+        vector.reserve(5000);
+        EXPECT_EQ(GetBytes(MemoryCategory::MeshScratch), before + vector.capacity() * sizeof(glm::u32));
+        EXPECT_EQ(GetBytes(MemoryCategory::Staging), staging);
+    }
+    EXPECT_EQ(GetBytes(MemoryCategory::MeshScratch), before);
+}
+
+TEST(MemoryAccountingTests, TestMemoryCounter) {
+    glm::u64 before = GetBytes(MemoryCategory::ChunkMetadata);
+    {
+        Spire::MemoryCounter counter(MemoryCategory::ChunkMetadata);
+        counter.Set(100);
+        EXPECT_EQ(GetBytes(MemoryCategory::ChunkMetadata), before + 100);
+        counter.Set(40);
+        EXPECT_EQ(GetBytes(MemoryCategory::ChunkMetadata), before + 40);
+        counter.Set(250);
+        EXPECT_EQ(GetBytes(MemoryCategory::ChunkMetadata), before + 250);
+    }
+    // the last value is freed when the counter is destroyed
+    EXPECT_EQ(GetBytes(MemoryCategory::ChunkMetadata), before);
+}
+
+TEST(MemoryAccountingTests, TestPeak) {
+    MemoryAccounting &accounting = MemoryAccounting::Instance();
+    accounting.ResetPeaks();
+    glm::u64 before = GetBytes(MemoryCategory::Staging);
+    EXPECT_EQ(accounting.GetReport().Get(MemoryCategory::Staging).PeakBytes, before);
+
+    accounting.Allocate(MemoryCategory::Staging, 1000);
+    accounting.Allocate(MemoryCategory::Staging, 500);
+    accounting.Free(MemoryCategory::Staging, 1200);
+
+    MemoryAccounting::Report report = accounting.GetReport();
+    EXPECT_EQ(report.Get(MemoryCategory::Staging).Bytes, before + 300);
+    EXPECT_EQ(report.Get(MemoryCategory::Staging).PeakBytes, before + 1500);
+
+    accounting.Free(MemoryCategory::Staging, 300);
+    accounting.ResetPeaks();
+    EXPECT_EQ(accounting.GetReport().Get(MemoryCategory::Staging).PeakBytes, before);
+}
+
+TEST(MemoryAccountingTests, TestVoxelStorageIsReported) {
+    glm::u64 before = GetBytes(MemoryCategory::VoxelStorage);
+    {
+        // empty storages share one allocation that always exists
+        SpireVoxel::ChunkVoxelStorage storage;
+        SpireVoxel::ChunkVoxelStorage copy = storage;
+        EXPECT_EQ(GetBytes(MemoryCategory::VoxelStorage), before);
+
+        // writing detaches, includes the shared_ptr control block
+        storage.Write().Voxels[5] = 1;
+        glm::u64 resident = GetBytes(MemoryCategory::VoxelStorage);
+        EXPECT_GE(resident, before + sizeof(SpireVoxel::ChunkVoxelStorage::Data));
+        EXPECT_LT(resident, before + sizeof(SpireVoxel::ChunkVoxelStorage::Data) + 256);
+
+        // sharing the written data doesn't allocate
+        copy = storage;
+        EXPECT_EQ(GetBytes(MemoryCategory::VoxelStorage), resident);
+        copy = {};
+
+        // compressing frees the uncompressed data
+        ASSERT_TRUE(storage.Compress(4.0f));
+        glm::u64 compressed = GetBytes(MemoryCategory::VoxelStorage);
+        EXPECT_LT(compressed, before + 1024);
+        EXPECT_GT(compressed, before);
+
+        EXPECT_EQ(storage.Read().Voxels[5], 1);
+        EXPECT_EQ(GetBytes(MemoryCategory::VoxelStorage), resident);
+    }
+    EXPECT_EQ(GetBytes(MemoryCategory::VoxelStorage), before);
+}
+
+TEST(MemoryAccountingTests, TestReport) {
+    MemoryAccounting &accounting = MemoryAccounting::Instance();
+    accounting.Allocate(MemoryCategory::GPUVertex, 4096);
+    accounting.Allocate(MemoryCategory::MeshScratch, 1024);
+
+    MemoryAccounting::Report report = accounting.GetReport();
+    glm::u64 cpu = 0;
+    glm::u64 gpu = 0;
+    for (std::size_t i = 0; i < MemoryAccounting::NUM_CATEGORIES; i++) {
+        if (MemoryAccounting::IsGPUCategory(static_cast<MemoryCategory>(i))) gpu += report.Categories[i].Bytes;
+        else cpu += report.Categories[i].Bytes;
+    }
+    EXPECT_EQ(report.GetCPUBytes(), cpu);
+    EXPECT_EQ(report.GetGPUBytes(), gpu);
+    EXPECT_GE(report.GetGPUBytes(), 4096);
+    EXPECT_GE(report.GetCPUBytes(), 1024);
+
+    // dump the report like a headless run would, then check every category made it into the file
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "SpireVoxelMemoryAccountingTest.json";
+    ASSERT_TRUE(accounting.WriteJSON(path));
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+    EXPECT_NE(json.find(std::format(R"("gpu_bytes": {})", report.GetGPUBytes())), std::string::npos);
+    for (std::size_t i = 0; i < MemoryAccounting::NUM_CATEGORIES; i++) {
+        auto category = static_cast<MemoryCategory>(i);
+        EXPECT_NE(json.find(std::format(R"("{}": {{"gpu": {}, "bytes": {})", MemoryAccounting::GetCategoryName(category),
+                                        MemoryAccounting::IsGPUCategory(category) ? "true" : "false", report.Categories[i].Bytes)), std::string::npos)
+            << MemoryAccounting::GetCategoryName(category);
+    }
+
+    accounting.Free(MemoryCategory::GPUVertex, 4096);
+    accounting.Free(MemoryCategory::MeshScratch, 1024);
+}
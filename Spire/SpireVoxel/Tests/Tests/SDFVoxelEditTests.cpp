@@ -0,0 +1,156 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+#include <numbers>
+#include <numeric>
+
+#include "Edits/SDFVoxelEdit.h"
+#include "Utils/TaskGraph.h"
+
+using namespace SpireVoxel;
+
+// Every voxel in the chunk with its center inside the shape, evaluated one by one
+static std::vector<bool> RasteriseBruteForce(const ISDFShape &shape, glm::ivec3 chunkPosition) {
+    std::vector<bool> inside(SPIRE_VOXEL_CHUNK_VOLUME);
+    for (glm::u32 i = 0; i < SPIRE_VOXEL_CHUNK_VOLUME; i++) {
+        glm::vec3 center = glm::vec3(chunkPosition * SPIRE_VOXEL_CHUNK_SIZE) + glm::vec3(SPIRE_VOXEL_INDEX_TO_POSITION(glm::uvec3, i)) + 0.5f;
+        inside[i] = shape.Distance(center) <= 0.0f;
+    }
+    return inside;
+}
+
+static std::vector<bool> Rasterise(const ISDFShape &shape, glm::ivec3 chunkPosition) {
+    std::vector<bool> inside(SPIRE_VOXEL_CHUNK_VOLUME);
+    glm::u32 previousEnd = 0;
+    SDFVoxelEdit::RasteriseChunk(shape, chunkPosition, [&](glm::u32 start, glm::u32 end) {
+        EXPECT_LT(start, end);
+        EXPECT_LE(previousEnd, start); // in order and not overlapping
+        EXPECT_LE(end, SPIRE_VOXEL_CHUNK_VOLUME);
+        std::fill(inside.begin() + start, inside.begin() + end, true);
+        previousEnd = end;
+    });
+    return inside;
+}
+
+static std::vector<std::pair<std::string, std::shared_ptr<const ISDFShape> > > CreateTestShapes() {
+    auto sphere = std::make_shared<SphereSDF>(glm::vec3(10.0f, 20.0f, -5.0f), 40.0f);
+    auto capsule = std::make_shared<CapsuleSDF>(glm::vec3(-30.0f, 5.0f, 2.0f), glm::vec3(50.0f, 30.0f, 10.0f), 12.5f);
+    auto cylinder = std::make_shared<CylinderSDF>(glm::vec3(0.0f, -20.0f, 0.0f), glm::vec3(0.0f, 70.0f, 0.0f), 30.0f);
+    auto cone = std::make_shared<ConeSDF>(glm::vec3(5.0f, -10.0f, 5.0f), glm::vec3(20.0f, 60.0f, -8.0f), 35.0f, 0.0f);
+    return {
+        {"sphere", sphere},
+        {"capsule", capsule},
+        {"cylinder", cylinder},
+        {"cone", cone},
+        {"smooth union", std::make_shared<SmoothUnionSDF>(sphere, capsule, 8.0f)},
+        {"smooth subtract", std::make_shared<SmoothSubtractSDF>(cylinder, sphere, 8.0f)},
+        {"hard subtract", std::make_shared<SmoothSubtractSDF>(cone, capsule, 0.0f)}
+    };
+}
+
+TEST(SDFVoxelEditTests, TestShapeDistances) {
+    SphereSDF sphere({0, 0, 0}, 10.0f);
+    EXPECT_FLOAT_EQ(sphere.Distance({0, 0, 0}), -10.0f);
+    EXPECT_FLOAT_EQ(sphere.Distance({10, 0, 0}), 0.0f);
+    EXPECT_FLOAT_EQ(sphere.Distance({0, 15, 0}), 5.0f);
+
+    CapsuleSDF capsule({0, 0, 0}, {0, 20, 0}, 5.0f);
+    EXPECT_FLOAT_EQ(capsule.Distance({0, 10, 0}), -5.0f);
+    EXPECT_FLOAT_EQ(capsule.Distance({8, 10, 0}), 3.0f);
+    EXPECT_FLOAT_EQ(capsule.Distance({0, 27, 0}), 2.0f); // rounded end
+
+    CylinderSDF cylinder({0, 0, 0}, {0, 20, 0}, 5.0f);
+    EXPECT_NEAR(cylinder.Distance({0, 10, 0}), -5.0f, 1e-4f);
+    EXPECT_NEAR(cylinder.Distance({0, 27, 0}), 7.0f, 1e-4f); // flat end
+    EXPECT_NEAR(cylinder.Distance({8, 10, 0}), 3.0f, 1e-4f);
+    EXPECT_NEAR(cylinder.Distance({0, 19, 0}), -1.0f, 1e-4f);
+
+    ConeSDF cone({0, 0, 0}, {0, 20, 0}, 10.0f, 0.0f);
+    EXPECT_LT(cone.Distance({0, 1, 0}), 0.0f);
+    EXPECT_NEAR(cone.Distance({0, 25, 0}), 5.0f, 1e-4f); // past the tip
+    EXPECT_GT(cone.Distance({8, 15, 0}), 0.0f); // radius is 2.5 here
+
+    // blending makes the union bigger between the shapes and the subtraction smaller
+    auto a = std::make_shared<SphereSDF>(glm::vec3(-6, 0, 0), 5.0f);
+    auto b = std::make_shared<SphereSDF>(glm::vec3(6, 0, 0), 5.0f);
+    EXPECT_GT(SmoothUnionSDF(a, b, 0.0f).Distance({0, 0, 0}), 0.0f);
+    EXPECT_LT(SmoothUnionSDF(a, b, 8.0f).Distance({0, 0, 0}), 0.0f);
+    EXPECT_FLOAT_EQ(SmoothUnionSDF(a, b, 8.0f).Distance({-6, 0, 0}), -5.0f); // far from the blend
+    EXPECT_LT(SmoothSubtractSDF(a, b, 0.0f).Distance({-2, 0, 0}), 0.0f);
+    EXPECT_GT(SmoothSubtractSDF(a, b, 8.0f).Distance({-2, 0, 0}), 0.0f); // carved out by the blend
+}
+
+TEST(SDFVoxelEditTests, TestRasteriseMatchesBruteForce) {
+    for (const auto &[name, shape] : CreateTestShapes()) {
+        for (const glm::ivec3 &chunkPosition : SDFVoxelEdit::GetChunksInBounds(shape->GetBounds())) {
+            EXPECT_TRUE(Rasterise(*shape, chunkPosition) == RasteriseBruteForce(*shape, chunkPosition))
+                << name << " in chunk " << chunkPosition.x << " " << chunkPosition.y << " " << chunkPosition.z;
+        }
+    }
+}
+
+TEST(SDFVoxelEditTests, TestSmoothSubtractMatchesBruteForce) {
+    // wide blends between overlapping shapes, where the blended distance is furthest from max(a, -b)
+    auto cylinder = std::make_shared<CylinderSDF>(glm::vec3(0.0f, -40.0f, 0.0f), glm::vec3(0.0f, 40.0f, 0.0f), 45.0f);
+    for (float smoothness : {4.0f, 16.0f, 40.0f}) {
+        for (glm::vec3 center : {glm::vec3(30.0f, 10.0f, 0.0f), glm::vec3(-12.5f, 40.0f, 20.0f), glm::vec3(0.0f, 0.0f, 45.0f)}) {
+            SmoothSubtractSDF shape(cylinder, std::make_shared<SphereSDF>(center, 25.0f), smoothness);
+            for (const glm::ivec3 &chunkPosition : SDFVoxelEdit::GetChunksInBounds(shape.GetBounds())) {
+                EXPECT_TRUE(Rasterise(shape, chunkPosition) == RasteriseBruteForce(shape, chunkPosition))
+                    << "smoothness " << smoothness << " in chunk " << chunkPosition.x << " " << chunkPosition.y << " " << chunkPosition.z;
+            }
+        }
+    }
+}
+
+TEST(SDFVoxelEditTests, TestChunksOutsideBoundsAreEmpty) {
+    for (const auto &[name, shape] : CreateTestShapes()) {
+        std::vector<glm::ivec3> chunks = SDFVoxelEdit::GetChunksInBounds(shape->GetBounds());
+        std::unordered_set<glm::ivec3> inBounds(chunks.begin(), chunks.end());
+
+        // the ring of chunks around the bounds must have nothing inside the shape
+        glm::ivec3 min = chunks.front();
+        glm::ivec3 max = chunks.back();
+        for (glm::i32 x = min.x - 1; x <= max.x + 1; x++) {
+            for (glm::i32 y = min.y - 1; y <= max.y + 1; y++) {
+                for (glm::i32 z = min.z - 1; z <= max.z + 1; z++) {
+                    if (inBounds.contains({x, y, z})) continue;
+                    std::vector<bool> inside = RasteriseBruteForce(*shape, {x, y, z});
+                    EXPECT_EQ(std::count(inside.begin(), inside.end(), true), 0) << name << " in chunk " << x << " " << y << " " << z;
+                }
+            }
+        }
+    }
+}
+
+TEST(SDFVoxelEditTests, TestRasteriseFullyInsideChunk) {
+    // one run for the whole chunk
+    SphereSDF sphere({32, 32, 32}, 200.0f);
+    std::vector<std::pair<glm::u32, glm::u32> > runs;
+    SDFVoxelEdit::RasteriseChunk(sphere, {0, 0, 0}, [&](glm::u32 start, glm::u32 end) { runs.emplace_back(start, end); });
+    ASSERT_EQ(runs.size(), 1);
+    EXPECT_EQ(runs[0].first, 0);
+    EXPECT_EQ(runs[0].second, SPIRE_VOXEL_CHUNK_VOLUME);
+
+    runs.clear();
+    SDFVoxelEdit::RasteriseChunk(sphere, {10, 0, 0}, [&](glm::u32 start, glm::u32 end) { runs.emplace_back(start, end); });
+    EXPECT_TRUE(runs.empty());
+}
+
+TEST(SDFVoxelEditTests, TestLargeBrush) {
+    // radius 64 sphere, rasterise every chunk in parallel like Apply does
+    SphereSDF sphere({-3.5f, 10.0f, 40.0f}, 64.0f);
+    std::vector<glm::ivec3> chunks = SDFVoxelEdit::GetChunksInBounds(sphere.GetBounds());
+    std::vector<glm::u64> voxelsInside(chunks.size(), 0);
+
+    Spire::Timer timer;
+    Spire::TaskGraph::Instance().ParallelFor(0, chunks.size(), [&](std::size_t i) {
+        SDFVoxelEdit::RasteriseChunk(sphere, chunks[i], [&](glm::u32 start, glm::u32 end) { voxelsInside[i] += end - start; });
+    }, Spire::TaskPriority::Interactive);
+    Spire::info("Rasterised a radius 64 sphere over {} chunks in {} ms", chunks.size(), timer.MillisSinceStart());
+
+    // the number of voxel centers in a sphere is close to its volume
+    double volume = 4.0 / 3.0 * std::numbers::pi * 64.0 * 64.0 * 64.0;
+    glm::u64 total = std::accumulate(voxelsInside.begin(), voxelsInside.end(), glm::u64(0));
+    EXPECT_NEAR(static_cast<double>(total), volume, volume * 0.01);
+}
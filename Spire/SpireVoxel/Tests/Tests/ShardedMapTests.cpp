@@ -0,0 +1,120 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+
+#include "Utils/ShardedMap.h"
+
+using TestMap = SpireVoxel::ShardedMap<glm::ivec3, std::unique_ptr<int> >;
+
+static int *TryGet(const TestMap &map, glm::ivec3 key) {
+    return map.Visit(key, static_cast<int *>(nullptr), [](const std::unique_ptr<int> &value) { return value.get(); });
+}
+
+TEST(ShardedMapTests, TestEmplaceAndExtract) {
+    TestMap map;
+    EXPECT_TRUE(map.Empty());
+
+    auto [value, inserted] = map.TryEmplace({1, 2, 3}, [] { return std::make_unique<int>(5); });
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*value, 5);
+
+    // doesn't call createValue when the key exists
+    auto [existing, insertedAgain] = map.TryEmplace({1, 2, 3}, []() -> std::unique_ptr<int> {
+        ADD_FAILURE();
+        return nullptr;
+    });
+    EXPECT_FALSE(insertedAgain);
+    EXPECT_EQ(existing.get(), value.get());
+    EXPECT_EQ(map.Size(), 1);
+    EXPECT_TRUE(map.Contains({1, 2, 3}));
+    EXPECT_EQ(*TryGet(map, {1, 2, 3}), 5);
+    EXPECT_EQ(TryGet(map, {3, 2, 1}), nullptr);
+
+    std::optional<std::unique_ptr<int> > extracted = map.Extract({1, 2, 3});
+    ASSERT_TRUE(extracted.has_value());
+    EXPECT_EQ(**extracted, 5);
+    EXPECT_FALSE(map.Extract({1, 2, 3}).has_value());
+    EXPECT_TRUE(map.Empty());
+}
+
+TEST(ShardedMapTests, TestIterationVisitsEveryValueOnce) {
+    TestMap map;
+    std::set<std::tuple<int, int, int> > expected;
+    for (int x = -8; x < 8; x++) {
+        for (int z = -8; z < 8; z++) {
+            (void) map.TryEmplace({x, 0, z}, [&] { return std::make_unique<int>(x * 100 + z); });
+            expected.insert({x, 0, z});
+        }
+    }
+
+    std::set<std::tuple<int, int, int> > visited;
+    for (auto &[key, value] : map) {
+        EXPECT_EQ(*value, key.x * 100 + key.z);
+        EXPECT_TRUE(visited.insert({key.x, key.y, key.z}).second);
+    }
+    EXPECT_EQ(visited, expected);
+    EXPECT_EQ(map.Size(), expected.size());
+
+    const TestMap &constMap = map;
+    EXPECT_EQ(std::distance(constMap.begin(), constMap.end()), static_cast<std::ptrdiff_t>(expected.size()));
+
+    TestMap empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(ShardedMapTests, TestShardsAreUsed) {
+    std::set<std::size_t> shards;
+    for (int x = 0; x < 32; x++) {
+        for (int y = 0; y < 32; y++) {
+            std::size_t shard = TestMap::GetShardIndex({x, y, 0});
+            EXPECT_LT(shard, 64);
+            shards.insert(shard);
+        }
+    }
+    EXPECT_EQ(shards.size(), 64);
+}
+
+TEST(ShardedMapTests, TestConcurrentLookupsWhileOwnerInserts) {
+    TestMap map;
+    constexpr int COUNT = 4096;
+
+    // odd keys are always present, even keys are inserted and removed while the readers run (rehashing the shards)
+    for (int x = 1; x < COUNT; x += 2) {
+        (void) map.TryEmplace({x, 0, 0}, [x] { return std::make_unique<int>(x); });
+    }
+
+    std::atomic<bool> done = false;
+    std::atomic<int> missing = 0;
+    std::atomic<int> wrong = 0;
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while (!done) {
+                for (int x = 0; x < COUNT; x++) {
+                    // the owner may destroy the value once the lock is released so read it inside Visit
+                    int value = map.Visit(glm::ivec3{x, 0, 0}, -1, [](const std::unique_ptr<int> &v) { return *v; });
+                    if (value == -1 && x % 2 == 1) missing++;
+                    if (value != -1 && value != x) wrong++;
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 8; round++) {
+        for (int x = 0; x < COUNT; x += 2) {
+            (void) map.TryEmplace({x, 0, 0}, [x] { return std::make_unique<int>(x); });
+        }
+        for (int x = 0; x < COUNT; x += 2) {
+            map.Extract({x, 0, 0});
+        }
+    }
+    done = true;
+    for (auto &reader : readers) reader.join();
+
+    EXPECT_EQ(map.Size(), COUNT / 2);
+    EXPECT_EQ(missing, 0);
+    EXPECT_EQ(wrong, 0);
+}
@@ -0,0 +1,150 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/ChunkVoxelStorage.h"
+#include "Utils/SimulationThread.h"
+#include "Utils/TripleBuffer.h"
+
+using namespace SpireVoxel;
+
+namespace {
+    // Owner thread like VoxelWorld::SetOwnerThread stores it
+    struct OwnerThread {
+        [[nodiscard]] bool IsOwnerThread() const { return std::this_thread::get_id() == Thread.load(); }
+
+        [[nodiscard]] std::function<void(std::thread::id)> Setter() {
+            return [this](std::thread::id ownerThread) {
+                Thread.store(ownerThread);
+                NumHandovers++;
+            };
+        }
+
+        std::atomic<std::thread::id> Thread = std::this_thread::get_id();
+        std::atomic<glm::u32> NumHandovers = 0;
+    };
+
+    // What a tick publishes for the main thread, the storages share their data with the world until it writes them again
+    struct WorldSnapshot {
+        glm::u64 Tick = 0;
+        std::vector<ChunkVoxelStorage> Chunks;
+    };
+}
+
+TEST(SimulationThreadTests, TestOwnershipFollowsTick) {
+    OwnerThread owner;
+    std::thread::id tickThread;
+    bool ownedInTick = false;
+    SimulationThread simulation(owner.Setter(), [&] {
+        tickThread = std::this_thread::get_id();
+        ownedInTick = owner.IsOwnerThread();
+    });
+
+    for (glm::u32 tick = 1; tick <= 3; tick++) {
+        simulation.Kick();
+        // handed over before the tick starts
+        EXPECT_FALSE(owner.IsOwnerThread());
+
+        simulation.Wait();
+        EXPECT_TRUE(owner.IsOwnerThread());
+        EXPECT_TRUE(ownedInTick);
+        EXPECT_NE(tickThread, std::this_thread::get_id());
+        EXPECT_EQ(simulation.NumTicks(), tick);
+    }
+    EXPECT_EQ(owner.NumHandovers, 6);
+}
+
+TEST(SimulationThreadTests, TestWaitWithoutKick) {
+    OwnerThread owner;
+    glm::u32 numTicks = 0;
+    SimulationThread simulation(owner.Setter(), [&] { numTicks++; });
+
+    simulation.Wait();
+    EXPECT_TRUE(owner.IsOwnerThread());
+    EXPECT_EQ(owner.NumHandovers, 0);
+
+    // only the first Wait after a Kick hands the world back
+    simulation.Kick();
+    simulation.Wait();
+    simulation.Wait();
+    EXPECT_TRUE(owner.IsOwnerThread());
+    EXPECT_EQ(owner.NumHandovers, 2);
+    EXPECT_EQ(numTicks, 1);
+    EXPECT_EQ(simulation.NumTicks(), 1);
+}
+
+TEST(SimulationThreadTests, TestDestroyWhileTickInFlight) {
+    OwnerThread owner;
+    std::atomic<bool> tickStarted = false;
+    std::atomic<bool> release = false;
+    std::atomic<bool> tickFinished = false;
+
+    auto simulation = std::make_unique<SimulationThread>(owner.Setter(), [&] {
+        tickStarted = true;
+        while (!release) std::this_thread::yield();
+        tickFinished = true;
+    });
+    simulation->Kick();
+    while (!tickStarted) std::this_thread::yield();
+
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+    simulation.reset();
+    // the destructor waited for the tick and took the world back
+    EXPECT_TRUE(tickFinished);
+    EXPECT_TRUE(owner.IsOwnerThread());
+    releaser.join();
+}
+
+TEST(SimulationThreadTests, TestReadSnapshotsWhileWorldIsEdited) {
+    constexpr glm::u32 NUM_CHUNKS = 4;
+    constexpr glm::u64 NUM_TICKS = 50;
+
+    OwnerThread owner;
+    std::vector<ChunkVoxelStorage> world(NUM_CHUNKS);
+    Spire::TripleBuffer<WorldSnapshot> snapshots;
+    glm::u64 tick = 0;
+
+    // every tick fills each chunk with its tick number then publishes the chunks, like GameApplication publishes what its UI shows
+    SimulationThread simulation(owner.Setter(), [&] {
+        EXPECT_TRUE(owner.IsOwnerThread());
+        tick++;
+        for (ChunkVoxelStorage &chunk : world) {
+            ChunkVoxelStorage::Data &data = chunk.Write();
+            data.Voxels.fill(static_cast<VoxelType>(tick));
+        }
+        WorldSnapshot &snapshot = snapshots.GetBack();
+        snapshot.Tick = tick;
+        snapshot.Chunks = world;
+        snapshots.Publish();
+    });
+
+    glm::u64 lastTickRead = 0;
+    glm::u64 numReads = 0;
+    for (glm::u64 frame = 0; frame < NUM_TICKS; frame++) {
+        simulation.Kick();
+        // the main thread only reads snapshots while the tick writes the world
+        Spire::Timer timer;
+        do {
+            snapshots.Acquire();
+            const WorldSnapshot &snapshot = snapshots.GetFront();
+            EXPECT_GE(snapshot.Tick, lastTickRead);
+            lastTickRead = snapshot.Tick;
+            for (const ChunkVoxelStorage &chunk : snapshot.Chunks) {
+                const ChunkVoxelStorage::Data &data = chunk.Read();
+                // a snapshot is never changed by later ticks
+                ASSERT_TRUE(std::ranges::all_of(data.Voxels, [&](VoxelType type) { return type == static_cast<VoxelType>(snapshot.Tick); }));
+            }
+            numReads++;
+        } while (timer.MillisSinceStart() < 1.0f);
+        simulation.Wait();
+        EXPECT_TRUE(owner.IsOwnerThread());
+    }
+
+    snapshots.Acquire();
+    EXPECT_EQ(snapshots.GetFront().Tick, NUM_TICKS);
+    EXPECT_GE(numReads, NUM_TICKS);
+    EXPECT_EQ(world[0].Read().Voxels[0], static_cast<VoxelType>(NUM_TICKS));
+}
@@ -0,0 +1,114 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Utils/SlotMap.h"
+
+using SpireVoxel::SlotMap;
+using SpireVoxel::SlotMapHandle;
+
+TEST(SlotMapTests, TestInsertAndGet) {
+    SlotMap<int> map;
+    EXPECT_TRUE(map.Empty());
+
+    SlotMapHandle a = map.Insert(1);
+    SlotMapHandle b = map.Insert(2);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(map.Size(), 2);
+    EXPECT_EQ(map.NumSlots(), 2);
+
+    ASSERT_NE(map.TryGet(a), nullptr);
+    ASSERT_NE(map.TryGet(b), nullptr);
+    EXPECT_EQ(*map.TryGet(a), 1);
+    EXPECT_EQ(*map.TryGet(b), 2);
+
+    *map.TryGet(a) = 3;
+    const SlotMap<int> &constMap = map;
+    EXPECT_EQ(*constMap.TryGet(a), 3);
+}
+
+TEST(SlotMapTests, TestRemoveInvalidatesHandle) {
+    SlotMap<std::unique_ptr<int> > map;
+    SlotMapHandle handle = map.Insert(std::make_unique<int>(5));
+
+    std::optional<std::unique_ptr<int> > removed = map.Remove(handle);
+    ASSERT_TRUE(removed.has_value());
+    EXPECT_EQ(**removed, 5);
+
+    EXPECT_FALSE(map.Contains(handle));
+    EXPECT_EQ(map.TryGet(handle), nullptr);
+    EXPECT_FALSE(map.Remove(handle).has_value());
+    EXPECT_TRUE(map.Empty());
+}
+
+TEST(SlotMapTests, TestReusedIndexGetsNewGeneration) {
+    SlotMap<int> map;
+    SlotMapHandle old = map.Insert(1);
+    map.Remove(old);
+
+    SlotMapHandle reused = map.Insert(2);
+    EXPECT_EQ(reused.Index, old.Index);
+    EXPECT_NE(reused.Generation, old.Generation);
+
+    // the old handle must not see the new value
+    EXPECT_FALSE(map.Contains(old));
+    EXPECT_EQ(map.TryGet(old), nullptr);
+    EXPECT_FALSE(map.Remove(old).has_value());
+    EXPECT_EQ(*map.TryGet(reused), 2);
+}
+
+TEST(SlotMapTests, TestLowestFreeIndexReused) {
+    SlotMap<int> map;
+    std::vector<SlotMapHandle> handles;
+    for (int i = 0; i < 8; i++) handles.push_back(map.Insert(i));
+
+    map.Remove(handles[5]);
+    map.Remove(handles[2]);
+    map.Remove(handles[6]);
+
+    EXPECT_EQ(map.Insert(10).Index, 2);
+    EXPECT_EQ(map.Insert(11).Index, 5);
+    EXPECT_EQ(map.Insert(12).Index, 6);
+    EXPECT_EQ(map.Insert(13).Index, 8);
+    EXPECT_EQ(map.NumSlots(), 9);
+}
+
+TEST(SlotMapTests, TestDefaultHandleIsInvalid) {
+    SlotMap<int> map;
+    SlotMapHandle handle = {};
+    EXPECT_TRUE(handle.IsNull());
+    EXPECT_FALSE(map.Contains(handle));
+
+    map.Insert(1);
+    EXPECT_FALSE(map.Contains(handle));
+    // index 0 at generation 0 never existed either
+    EXPECT_FALSE(map.Contains({0, 0}));
+}
+
+TEST(SlotMapTests, TestForEach) {
+    SlotMap<int> map;
+    std::vector<SlotMapHandle> handles;
+    for (int i = 0; i < 5; i++) handles.push_back(map.Insert(i * 10));
+    map.Remove(handles[1]);
+    map.Remove(handles[3]);
+
+    std::vector<int> visited;
+    map.ForEach([&](SlotMapHandle handle, int &value) {
+        EXPECT_TRUE(map.Contains(handle));
+        visited.push_back(value);
+    });
+    EXPECT_EQ(visited, (std::vector<int>{0, 20, 40}));
+}
+
+TEST(SlotMapTests, TestHandlesAreHashable) {
+    SlotMap<int> map;
+    SlotMapHandle a = map.Insert(1);
+    map.Remove(a);
+    SlotMapHandle b = map.Insert(2);
+
+    // same index, different generations
+    std::unordered_set<SlotMapHandle> set = {a, b, b};
+    EXPECT_EQ(set.size(), 2);
+    EXPECT_TRUE(set.contains(a));
+    EXPECT_TRUE(set.contains(b));
+}
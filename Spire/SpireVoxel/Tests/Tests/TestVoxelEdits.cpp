@@ -3,7 +3,9 @@
 #include <gtest/gtest.h>
 
 #include "TestHelpers.h"
+#include "Edits/BatchedVoxelEdit.h"
 #include "Edits/CuboidVoxelEdit.h"
+#include "Edits/MergedVoxelEdit.h"
 
 TEST(VoxelEditTests, TestCuboidEditsA) {
     // single chunk, fully inside, half-open range
@@ -58,7 +60,7 @@ TEST(VoxelEditTests, TestCuboidEditsC) {
 }
 
 TEST(VoxelEditTests, TestCalculateAffectedChunkMeshesA) {
-    // edit touches negative X, positive X, negative Y and negative Z boundaries
+    // edit touches negative X, positive X, negative Y and negative Z boundaries, so the edge and corner chunks read it for AO too
     std::vector<SpireVoxel::CuboidVoxelEdit::Edit> edits = {
         {{0, 0, 0}, {0, 0, 0}, {SPIRE_VOXEL_CHUNK_SIZE, 1, 5}}
     };
@@ -66,11 +68,284 @@ TEST(VoxelEditTests, TestCalculateAffectedChunkMeshesA) {
     std::unordered_set chunks =
         SpireVoxel::CuboidVoxelEdit::CalculateAffectedChunkMeshes(edits);
 
-    EXPECT_EQ(chunks.size(), 5);
+    EXPECT_EQ(chunks.size(), 12);
 
     EXPECT_TRUE(chunks.contains(glm::ivec3(0, 0, 0)));
     EXPECT_TRUE(chunks.contains(glm::ivec3(-1, 0, 0)));
     EXPECT_TRUE(chunks.contains(glm::ivec3(1, 0, 0)));
     EXPECT_TRUE(chunks.contains(glm::ivec3(0, -1, 0)));
     EXPECT_TRUE(chunks.contains(glm::ivec3(0, 0, -1)));
+    EXPECT_TRUE(chunks.contains(glm::ivec3(1, -1, -1)));
+    EXPECT_FALSE(chunks.contains(glm::ivec3(0, 1, 0)));
+    EXPECT_FALSE(chunks.contains(glm::ivec3(0, 0, 1)));
+}
+
+TEST(VoxelEditTests, TestCalculateAffectedChunkMeshesB) {
+    using SpireVoxel::CuboidVoxelEdit;
+
+    // interior
+    std::unordered_set chunks = CuboidVoxelEdit::CalculateAffectedChunkMeshes({{{0, 0, 0}, {1, 1, 1}, {10, 10, 10}}});
+    EXPECT_EQ(chunks, (std::unordered_set<glm::ivec3>{{0, 0, 0}}));
+
+    // ends one voxel before the boundary
+    chunks = CuboidVoxelEdit::CalculateAffectedChunkMeshes({{{0, 0, 0}, {60, 5, 5}, {3, 1, 1}}});
+    EXPECT_EQ(chunks, (std::unordered_set<glm::ivec3>{{0, 0, 0}}));
+
+    // ends on the boundary
+    chunks = CuboidVoxelEdit::CalculateAffectedChunkMeshes({{{0, 0, 0}, {60, 5, 5}, {4, 1, 1}}});
+    EXPECT_EQ(chunks, (std::unordered_set<glm::ivec3>{{0, 0, 0}, {1, 0, 0}}));
+
+    // corner
+    chunks = CuboidVoxelEdit::CalculateAffectedChunkMeshes({{{-1, 0, 0}, {63, 63, 63}, {1, 1, 1}}});
+    EXPECT_EQ(chunks.size(), 8);
+    EXPECT_TRUE(chunks.contains(glm::ivec3(0, 1, 1)));
+}
+
+static glm::u32 NeighbourBit(glm::i32 x, glm::i32 y, glm::i32 z) {
+    return 1u << ((x + 1) * 9 + (y + 1) * 3 + (z + 1));
+}
+
+TEST(VoxelEditTests, TestChangedNeighbours) {
+    using SpireVoxel::IVoxelEdit;
+    std::array<SpireVoxel::VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> voxels = {};
+    voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(63, 5, 5)] = 1;
+    auto changed = [&](glm::uvec3 position, SpireVoxel::VoxelType type) {
+        glm::u32 index = SPIRE_VOXEL_POSITION_TO_INDEX(position);
+        return IVoxelEdit::GetChangedNeighbours(voxels, index, index + 1, type);
+    };
+
+    // nothing changes
+    EXPECT_EQ(changed({5, 5, 5}, SpireVoxel::VOXEL_TYPE_AIR), 0);
+    EXPECT_EQ(changed({63, 5, 5}, 1), 0);
+
+    // interior
+    EXPECT_EQ(changed({5, 5, 5}, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+    EXPECT_EQ(changed({62, 62, 62}, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+
+    // boundary, neighbours only read whether the voxel is air
+    EXPECT_EQ(changed({63, 5, 5}, 2), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+    EXPECT_EQ(changed({63, 5, 5}, SpireVoxel::VOXEL_TYPE_AIR), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(1, 0, 0));
+    EXPECT_EQ(changed({5, 5, 0}, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(0, 0, -1));
+
+    // edge
+    EXPECT_EQ(changed({0, 0, 5}, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(-1, 0, 0) | NeighbourBit(0, -1, 0) | NeighbourBit(-1, -1, 0));
+
+    // corner
+    glm::u32 corner = changed({63, 63, 63}, 1);
+    EXPECT_EQ(std::popcount(corner), 8);
+    EXPECT_EQ(corner, IVoxelEdit::GetAffectedNeighbours(glm::uvec3(63, 63, 63)));
+    EXPECT_TRUE(corner & NeighbourBit(1, 1, 1));
+
+    // every bit maps back to its offset
+    for (glm::i32 x = -1; x <= 1; x++) {
+        for (glm::i32 y = -1; y <= 1; y++) {
+            for (glm::i32 z = -1; z <= 1; z++) {
+                EXPECT_EQ(IVoxelEdit::GetNeighbourOffset(std::countr_zero(NeighbourBit(x, y, z))), glm::ivec3(x, y, z));
+            }
+        }
+    }
+    EXPECT_EQ(IVoxelEdit::GetNeighbourOffset(std::countr_zero(IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT)), glm::ivec3(0));
+}
+
+TEST(VoxelEditTests, TestChangedNeighboursOfRuns) {
+    using SpireVoxel::IVoxelEdit;
+    std::array<SpireVoxel::VoxelType, SPIRE_VOXEL_CHUNK_VOLUME> voxels = {};
+
+    // a whole column on the -X face, only the voxels that become solid count
+    std::fill(voxels.begin() + SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 5, 0), voxels.begin() + SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 6, 0), 1);
+    glm::u32 start = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 5, 0);
+    glm::u32 end = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 6, 0);
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, start, end, 2), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+
+    voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 5, 30)] = SpireVoxel::VOXEL_TYPE_AIR;
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, start, end, 2), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(-1, 0, 0));
+
+    voxels[SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(0, 5, 63)] = SpireVoxel::VOXEL_TYPE_AIR;
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, start, end, 2),
+              IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(-1, 0, 0) | NeighbourBit(0, 0, 1) | NeighbourBit(-1, 0, 1));
+
+    // an interior column only reaches a neighbour through its ends
+    start = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(10, 10, 0);
+    end = SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(10, 10, 10);
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, start + 1, end, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, start, end, 1), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT | NeighbourBit(0, 0, -1));
+
+    // filling the whole chunk reaches every neighbour, filling it again changes nothing
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, 0, SPIRE_VOXEL_CHUNK_VOLUME, 1), (1u << 27) - 1);
+    voxels.fill(1);
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, 0, SPIRE_VOXEL_CHUNK_VOLUME, 1), 0);
+    EXPECT_EQ(IVoxelEdit::GetChangedNeighbours(voxels, 0, SPIRE_VOXEL_CHUNK_VOLUME, 3), IVoxelEdit::OWN_CHUNK_NEIGHBOUR_BIT);
+}
+
+TEST(VoxelEditTests, TestBatchedEditsGroupedByChunk) {
+    using SpireVoxel::BatchedVoxelEdit;
+    std::vector<BatchedVoxelEdit::ChunkEdit> chunkEdits = BatchedVoxelEdit::GroupEdits({
+        {{5, 5, 3}, 1},
+        {{-1, 0, 0}, 2},
+        {{5, 5, 1}, 1},
+        {{5, 5, 2}, 1}, // joins the run of z = 1 and z = 3
+        {{5, 5, 4}, 2}, // different type so starts a new run
+        {{-1, 0, 0}, 3} // last edit wins
+    });
+
+    ASSERT_EQ(chunkEdits.size(), 2);
+    EXPECT_IVEC3_EQ(chunkEdits[0].ChunkPosition, glm::ivec3(0, 0, 0));
+    ASSERT_EQ(chunkEdits[0].Runs.size(), 2);
+    EXPECT_EQ(chunkEdits[0].Runs[0].StartIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(5, 5, 1));
+    EXPECT_EQ(chunkEdits[0].Runs[0].EndIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(5, 5, 4));
+    EXPECT_EQ(chunkEdits[0].Runs[0].Type, 1);
+    EXPECT_EQ(chunkEdits[0].Runs[1].StartIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(5, 5, 4));
+    EXPECT_EQ(chunkEdits[0].Runs[1].EndIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(5, 5, 5));
+    EXPECT_EQ(chunkEdits[0].Runs[1].Type, 2);
+
+    EXPECT_IVEC3_EQ(chunkEdits[1].ChunkPosition, glm::ivec3(-1, 0, 0));
+    ASSERT_EQ(chunkEdits[1].Runs.size(), 1);
+    EXPECT_EQ(chunkEdits[1].Runs[0].StartIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(SPIRE_VOXEL_CHUNK_SIZE - 1, 0, 0));
+    EXPECT_EQ(chunkEdits[1].Runs[0].EndIndex, SPIRE_VOXEL_POSITION_XYZ_TO_INDEX(SPIRE_VOXEL_CHUNK_SIZE - 1, 0, 0) + 1);
+    EXPECT_EQ(chunkEdits[1].Runs[0].Type, 3);
+}
+
+TEST(VoxelEditTests, TestBatchedEditsMatchSequentialEdits) {
+    // many random writes to a few chunks, applying the runs must give the same voxels as applying each edit in order
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<glm::i32> position(-SPIRE_VOXEL_CHUNK_SIZE, SPIRE_VOXEL_CHUNK_SIZE - 1);
+    std::uniform_int_distribution<glm::u32> type(0, 3);
+
+    std::vector<SpireVoxel::BatchedVoxelEdit::Edit> edits;
+    std::unordered_map<glm::ivec3, std::vector<SpireVoxel::VoxelType> > expected;
+    for (glm::u32 i = 0; i < 200000; i++) {
+        glm::ivec3 voxel = {position(random), position(random), position(random)};
+        auto voxelType = static_cast<SpireVoxel::VoxelType>(type(random));
+        edits.push_back({voxel, voxelType});
+
+        glm::ivec3 chunkPosition = SpireVoxel::VoxelWorld::GetChunkPositionOfVoxel(voxel);
+        std::vector<SpireVoxel::VoxelType> &voxels = expected[chunkPosition];
+        voxels.resize(SPIRE_VOXEL_CHUNK_VOLUME, SPIRE_VOXEL_UINT16_MAX);
+        voxels[SPIRE_VOXEL_POSITION_TO_INDEX(glm::uvec3(voxel - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE))] = voxelType;
+    }
+
+    std::vector<SpireVoxel::BatchedVoxelEdit::ChunkEdit> chunkEdits = SpireVoxel::BatchedVoxelEdit::GroupEdits(edits);
+    EXPECT_EQ(chunkEdits.size(), 8);
+    for (const auto &chunkEdit : chunkEdits) {
+        std::vector<SpireVoxel::VoxelType> voxels(SPIRE_VOXEL_CHUNK_VOLUME, SPIRE_VOXEL_UINT16_MAX);
+        glm::u32 previousEnd = 0;
+        for (const auto &run : chunkEdit.Runs) {
+            EXPECT_LE(previousEnd, run.StartIndex);
+            EXPECT_LT(run.StartIndex, run.EndIndex);
+            std::fill(voxels.begin() + run.StartIndex, voxels.begin() + run.EndIndex, run.Type);
+            previousEnd = run.EndIndex;
+        }
+        EXPECT_TRUE(voxels == expected[chunkEdit.ChunkPosition]);
+    }
+}
+
+TEST(VoxelEditTests, TestBatchedEditAffectedChunkMeshes) {
+    using SpireVoxel::BatchedVoxelEdit;
+
+    // interior voxels don't affect neighbours
+    std::unordered_set chunks = BatchedVoxelEdit::CalculateAffectedChunkMeshes(BatchedVoxelEdit::GroupEdits({{{1, 1, 1}, 1}, {{62, 30, 62}, 1}}));
+    EXPECT_EQ(chunks.size(), 1);
+    EXPECT_TRUE(chunks.contains(glm::ivec3(0, 0, 0)));
+
+    // a face voxel affects the chunk across that face
+    chunks = BatchedVoxelEdit::CalculateAffectedChunkMeshes(BatchedVoxelEdit::GroupEdits({{{63, 5, 5}, 1}}));
+    EXPECT_EQ(chunks.size(), 2);
+    EXPECT_TRUE(chunks.contains(glm::ivec3(1, 0, 0)));
+
+    // an edge voxel is also read by the diagonal chunk for AO
+    chunks = BatchedVoxelEdit::CalculateAffectedChunkMeshes(BatchedVoxelEdit::GroupEdits({{{-64, 0, 5}, 1}}));
+    EXPECT_EQ(chunks.size(), 4);
+    EXPECT_TRUE(chunks.contains(glm::ivec3(-1, 0, 0)));
+    EXPECT_TRUE(chunks.contains(glm::ivec3(-2, 0, 0)));
+    EXPECT_TRUE(chunks.contains(glm::ivec3(-1, -1, 0)));
+    EXPECT_TRUE(chunks.contains(glm::ivec3(-2, -1, 0)));
+
+    // a corner voxel is read by all 8 chunks around the corner
+    chunks = BatchedVoxelEdit::CalculateAffectedChunkMeshes(BatchedVoxelEdit::GroupEdits({{{63, 63, 63}, 1}}));
+    EXPECT_EQ(chunks.size(), 8);
+    EXPECT_TRUE(chunks.contains(glm::ivec3(1, 1, 1)));
+    EXPECT_FALSE(chunks.contains(glm::ivec3(-1, 0, 0)));
+}
+
+TEST(VoxelEditTests, TestWrittenChunks) {
+    std::optional<std::vector<glm::ivec3> > chunks = SpireVoxel::CuboidVoxelEdit({-1, 0, 0}, {3, 5, 2}, 1).GetWrittenChunks();
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(std::unordered_set<glm::ivec3>(chunks->begin(), chunks->end()), (std::unordered_set<glm::ivec3>{{-1, 0, 0}, {0, 0, 0}}));
+
+    chunks = SpireVoxel::MergedVoxelEdit()
+            .With(SpireVoxel::BasicVoxelEdit({{{0, 0, 0}, 1}, {{1, 0, 0}, 1}}))
+            .With(SpireVoxel::BatchedVoxelEdit({{{0, 0, 200}, 1}}))
+            .GetWrittenChunks();
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(std::unordered_set<glm::ivec3>(chunks->begin(), chunks->end()), (std::unordered_set<glm::ivec3>{{0, 0, 0}, {0, 0, 3}}));
+}
+
+TEST(VoxelEditTests, TestPartitionEdits) {
+    std::vector<std::vector<glm::ivec3> > writtenChunks = {
+        {{0, 0, 0}},
+        {{1, 0, 0}},
+        {{2, 0, 0}, {3, 0, 0}},
+        {{3, 0, 0}, {1, 0, 0}}, // joins edits 1 and 2
+        {{5, 0, 0}},
+        {}
+    };
+    std::vector<const std::vector<glm::ivec3> *> pointers;
+    for (const auto &chunks : writtenChunks) pointers.push_back(&chunks);
+
+    std::vector<std::vector<std::size_t> > groups = SpireVoxel::MergedVoxelEdit::PartitionEdits(pointers);
+    EXPECT_EQ(groups, (std::vector<std::vector<std::size_t> >{{0}, {1, 2, 3}, {4}, {5}}));
+}
+
+TEST(VoxelEditTests, TestParallelEditsMatchSerialEdits) {
+    // each fake edit does a read-modify-write of random voxels in random chunks, so any reordering of edits that share a chunk changes the result
+    static constexpr glm::i32 WORLD_SIZE = 4;
+    static constexpr glm::u32 VOXELS_PER_CHUNK = 256;
+    using FakeWorld = std::unordered_map<glm::ivec3, std::vector<glm::u32> >;
+
+    std::mt19937 random(5678);
+    for (glm::u32 iteration = 0; iteration < 20; iteration++) {
+        struct FakeEdit {
+            std::vector<std::pair<glm::ivec3, glm::u32> > Voxels;
+        };
+
+        std::uniform_int_distribution<glm::i32> chunkCoordinate(0, WORLD_SIZE - 1);
+        std::uniform_int_distribution<glm::u32> voxel(0, VOXELS_PER_CHUNK - 1);
+        std::vector<FakeEdit> edits(200 + random() % 200);
+        std::vector<std::optional<std::vector<glm::ivec3> > > writtenChunks;
+        for (FakeEdit &edit : edits) {
+            std::unordered_set<glm::ivec3> chunks;
+            glm::u32 numChunks = 1 + random() % 3;
+            for (glm::u32 i = 0; i < numChunks; i++) {
+                glm::ivec3 chunk = {chunkCoordinate(random), chunkCoordinate(random), chunkCoordinate(random)};
+                chunks.insert(chunk);
+                for (glm::u32 j = 0; j < 16; j++) edit.Voxels.emplace_back(chunk, voxel(random));
+            }
+
+            // some edits don't know what they write
+            if (random() % 25 == 0) writtenChunks.emplace_back(std::nullopt);
+            else writtenChunks.emplace_back(std::vector<glm::ivec3>(chunks.begin(), chunks.end()));
+        }
+
+        FakeWorld serialWorld;
+        for (glm::i32 x = 0; x < WORLD_SIZE; x++) {
+            for (glm::i32 y = 0; y < WORLD_SIZE; y++) {
+                for (glm::i32 z = 0; z < WORLD_SIZE; z++) {
+                    serialWorld[{x, y, z}] = std::vector<glm::u32>(VOXELS_PER_CHUNK, 0);
+                }
+            }
+        }
+        FakeWorld parallelWorld = serialWorld;
+
+        auto applyEdit = [&](FakeWorld &world, std::size_t i) {
+            for (const auto &[chunk, index] : edits[i].Voxels) {
+                glm::u32 &value = world.at(chunk)[index];
+                value = value * 31 + static_cast<glm::u32>(i) + 1;
+            }
+        };
+
+        for (std::size_t i = 0; i < edits.size(); i++) applyEdit(serialWorld, i);
+        SpireVoxel::MergedVoxelEdit::ApplyPartitioned(writtenChunks, [&](std::size_t i) { applyEdit(parallelWorld, i); });
+
+        EXPECT_TRUE(serialWorld == parallelWorld) << "iteration " << iteration;
+    }
 }
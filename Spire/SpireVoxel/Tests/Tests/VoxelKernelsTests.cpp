@@ -0,0 +1,108 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "Chunk/VoxelKernels.h"
+
+using SpireVoxel::VoxelKernels;
+using SpireVoxel::VoxelType;
+
+static std::vector<VoxelType> GenerateVoxels(std::size_t count, glm::u32 seed, int airChance) {
+    std::mt19937 random(seed);
+    std::vector<VoxelType> voxels(count);
+    for (VoxelType &voxel : voxels) {
+        voxel = static_cast<int>(random() % 100) < airChance ? 0 : static_cast<VoxelType>(1 + random() % 0xFFFF);
+    }
+    return voxels;
+}
+
+// Runs test once for every instruction set the CPU supports, restores the original instruction set afterwards
+static void ForEachInstructionSet(const std::function<void(VoxelKernels::InstructionSet)> &test) {
+    VoxelKernels::InstructionSet original = VoxelKernels::GetInstructionSet();
+    for (auto instructionSet : {VoxelKernels::InstructionSet::SCALAR, VoxelKernels::InstructionSet::SSE2, VoxelKernels::InstructionSet::AVX2, VoxelKernels::InstructionSet::NEON}) {
+        if (!VoxelKernels::SetInstructionSet(instructionSet)) continue;
+        test(instructionSet);
+    }
+    EXPECT_TRUE(VoxelKernels::SetInstructionSet(original));
+}
+
+TEST(VoxelKernelsTests, TestScalarAlwaysSupported) {
+    EXPECT_TRUE(VoxelKernels::IsSupported(VoxelKernels::InstructionSet::SCALAR));
+    EXPECT_TRUE(VoxelKernels::IsSupported(VoxelKernels::GetInstructionSet()));
+}
+
+TEST(VoxelKernelsTests, TestPackPresenceBits) {
+    std::vector voxels = GenerateVoxels(SPIRE_VOXEL_CHUNK_VOLUME, 1, 50);
+    voxels[0] = 0;
+    voxels[63] = 0x8000; // sign bit set, make sure it isn't treated as negative
+
+    ForEachInstructionSet([&](VoxelKernels::InstructionSet instructionSet) {
+        std::vector<glm::u64> bits(SPIRE_VOXEL_CHUNK_VOLUME / 64, 0xDEADBEEF);
+        VoxelKernels::PackPresenceBits(voxels.data(), bits.data(), voxels.size());
+        for (std::size_t i = 0; i < voxels.size(); i++) {
+            bool present = (bits[i / 64] >> (i % 64)) & 1;
+            ASSERT_EQ(present, voxels[i] != 0) << VoxelKernels::ToString(instructionSet) << " index " << i;
+        }
+    });
+}
+
+TEST(VoxelKernelsTests, TestSetBitSpan) {
+    std::mt19937 random(2);
+    std::vector<glm::u64> expected(16, 0);
+    std::vector<glm::u64> actual(16, 0);
+    for (int i = 0; i < 500; i++) {
+        std::size_t start = random() % (16 * 64);
+        std::size_t end = start + random() % (16 * 64 - start + 1);
+        bool value = random() % 2;
+
+        VoxelKernels::SetBitSpan(actual.data(), start, end, value);
+        for (std::size_t bit = start; bit < end; bit++) {
+            glm::u64 mask = glm::u64(1) << (bit % 64);
+            expected[bit / 64] = value ? expected[bit / 64] | mask : expected[bit / 64] & ~mask;
+        }
+        ASSERT_TRUE(actual == expected) << "span " << start << " to " << end;
+    }
+}
+
+TEST(VoxelKernelsTests, TestFill) {
+    ForEachInstructionSet([&](VoxelKernels::InstructionSet instructionSet) {
+        for (std::size_t offset : {0, 1, 7}) {
+            for (std::size_t count : {0, 1, 15, 16, 33, 1000}) {
+                std::vector<VoxelType> voxels(offset + count + 3, 9);
+                VoxelKernels::Fill(voxels.data() + offset, count, 4);
+                for (std::size_t i = 0; i < voxels.size(); i++) {
+                    bool inSpan = i >= offset && i < offset + count;
+                    EXPECT_EQ(voxels[i], inSpan ? 4 : 9) << VoxelKernels::ToString(instructionSet);
+                }
+            }
+        }
+    });
+}
+
+TEST(VoxelKernelsTests, TestCountNonAir) {
+    std::vector voxels = GenerateVoxels(100003, 3, 70);
+    ForEachInstructionSet([&](VoxelKernels::InstructionSet instructionSet) {
+        for (std::size_t offset : {0, 1, 5}) {
+            std::size_t count = voxels.size() - offset;
+            auto expected = static_cast<std::size_t>(std::count_if(voxels.begin() + offset, voxels.end(), [](VoxelType t) { return t != 0; }));
+            EXPECT_EQ(VoxelKernels::CountNonAir(voxels.data() + offset, count), expected) << VoxelKernels::ToString(instructionSet);
+        }
+    });
+}
+
+TEST(VoxelKernelsTests, TestAllEqualAndEqual) {
+    std::vector<VoxelType> voxels(1001, 7);
+    std::vector<VoxelType> copy = voxels;
+    ForEachInstructionSet([&](VoxelKernels::InstructionSet instructionSet) {
+        EXPECT_TRUE(VoxelKernels::AllEqual(voxels.data(), voxels.size(), 7)) << VoxelKernels::ToString(instructionSet);
+        EXPECT_FALSE(VoxelKernels::AllEqual(voxels.data(), voxels.size(), 6)) << VoxelKernels::ToString(instructionSet);
+        EXPECT_TRUE(VoxelKernels::Equal(voxels.data(), copy.data(), voxels.size())) << VoxelKernels::ToString(instructionSet);
+
+        for (std::size_t changed : {0, 500, 999, 1000}) {
+            copy[changed] = 8;
+            EXPECT_FALSE(VoxelKernels::AllEqual(copy.data(), copy.size(), 7)) << VoxelKernels::ToString(instructionSet) << " " << changed;
+            EXPECT_FALSE(VoxelKernels::Equal(voxels.data(), copy.data(), voxels.size())) << VoxelKernels::ToString(instructionSet) << " " << changed;
+            copy[changed] = 7;
+        }
+    });
+}
@@ -0,0 +1,152 @@
+#include "EngineIncludes.h"
+#include "../Assets/Shaders/ShaderInfo.h"
+#include <gtest/gtest.h>
+
+#include "TestHelpers.h"
+#include "Edits/VoxelRegion.h"
+
+using namespace SpireVoxel;
+
+using ChunkVoxels = std::array<VoxelType, SPIRE_VOXEL_CHUNK_VOLUME>;
+
+// Every voxel is different so any misplaced voxel is caught
+static VoxelRegion CreateNumberedRegion(glm::uvec3 size) {
+    VoxelRegion region(size);
+    for (glm::u32 x = 0; x < size.x; x++) {
+        for (glm::u32 y = 0; y < size.y; y++) {
+            for (glm::u32 z = 0; z < size.z; z++) {
+                region.SetVoxel({x, y, z}, static_cast<VoxelType>(region.GetIndex({x, y, z}) + 1));
+            }
+        }
+    }
+    return region;
+}
+
+static VoxelType GetWorldVoxel(std::unordered_map<glm::ivec3, ChunkVoxels> &world, glm::ivec3 position) {
+    glm::ivec3 chunkPosition = VoxelWorld::GetChunkPositionOfVoxel(position);
+    return world[chunkPosition][SPIRE_VOXEL_POSITION_TO_INDEX(glm::uvec3(position - chunkPosition * SPIRE_VOXEL_CHUNK_SIZE))];
+}
+
+TEST(VoxelRegionTests, TestRotate) {
+    VoxelRegion region = CreateNumberedRegion({2, 3, 4});
+
+    // a quarter turn around Y turns +Z into +X
+    VoxelRegion rotatedY = region.Rotated(1, 1);
+    EXPECT_UVEC3_EQ(rotatedY.GetSize(), glm::uvec3(4, 3, 2));
+    // a quarter turn around X turns +Y into +Z
+    VoxelRegion rotatedX = region.Rotated(0, 1);
+    EXPECT_UVEC3_EQ(rotatedX.GetSize(), glm::uvec3(2, 4, 3));
+    for (glm::u32 x = 0; x < 2; x++) {
+        for (glm::u32 y = 0; y < 3; y++) {
+            for (glm::u32 z = 0; z < 4; z++) {
+                EXPECT_EQ(rotatedY.GetVoxel({z, y, 1 - x}), region.GetVoxel({x, y, z}));
+                EXPECT_EQ(rotatedX.GetVoxel({x, 3 - z, y}), region.GetVoxel({x, y, z}));
+            }
+        }
+    }
+
+    for (glm::u32 axis = 0; axis < 3; axis++) {
+        EXPECT_TRUE(region.Rotated(axis, 4) == region);
+        EXPECT_TRUE(region.Rotated(axis, 1).Rotated(axis, 3) == region);
+        EXPECT_TRUE(region.Rotated(axis, -1) == region.Rotated(axis, 3));
+        EXPECT_TRUE(region.Rotated(axis, 1).Rotated(axis, 1) == region.Rotated(axis, 2));
+    }
+}
+
+TEST(VoxelRegionTests, TestMirror) {
+    VoxelRegion region = CreateNumberedRegion({5, 2, 3});
+
+    VoxelRegion mirrored = region.Mirrored(0);
+    EXPECT_UVEC3_EQ(mirrored.GetSize(), region.GetSize());
+    EXPECT_EQ(mirrored.GetVoxel({0, 1, 2}), region.GetVoxel({4, 1, 2}));
+    EXPECT_EQ(mirrored.GetVoxel({3, 0, 1}), region.GetVoxel({1, 0, 1}));
+
+    for (glm::u32 axis = 0; axis < 3; axis++) {
+        EXPECT_TRUE(region.Mirrored(axis).Mirrored(axis) == region);
+    }
+    // half a turn around Y is mirroring both X and Z
+    EXPECT_TRUE(region.Rotated(1, 2) == region.Mirrored(0).Mirrored(2));
+}
+
+TEST(VoxelRegionTests, TestCopyAndPasteRows) {
+    std::mt19937 random(39);
+    std::uniform_int_distribution<glm::u32> type(0, 1000);
+
+    std::unordered_map<glm::ivec3, ChunkVoxels> world;
+    glm::ivec3 origin = {-70, -5, 30};
+    glm::uvec3 size = {100, 70, 40};
+    for (const glm::ivec3 &chunkPosition : VoxelRegion::GetChunksInBox(origin, size)) {
+        for (VoxelType &voxel : world[chunkPosition]) voxel = static_cast<VoxelType>(type(random));
+    }
+    EXPECT_EQ(world.size(), 3 * 3 * 2);
+
+    VoxelRegion region(size);
+    for (const auto &[chunkPosition, voxels] : world) {
+        region.CopyFromChunk(origin, chunkPosition, voxels);
+    }
+    for (glm::u32 x = 0; x < size.x; x++) {
+        for (glm::u32 y = 0; y < size.y; y++) {
+            for (glm::u32 z = 0; z < size.z; z++) {
+                ASSERT_EQ(region.GetVoxel({x, y, z}), GetWorldVoxel(world, origin + glm::ivec3(x, y, z)));
+            }
+        }
+    }
+
+    // paste the rows somewhere else like PasteVoxelEdit does, every voxel of the region is written exactly once
+    std::unordered_map<glm::ivec3, ChunkVoxels> pasted;
+    glm::ivec3 pasteOrigin = {13, -64, -1};
+    std::size_t written = 0;
+    for (const glm::ivec3 &chunkPosition : VoxelRegion::GetChunksInBox(pasteOrigin, size)) {
+        ChunkVoxels &voxels = pasted[chunkPosition];
+        voxels.fill(SPIRE_VOXEL_UINT16_MAX);
+        VoxelRegion::ForEachRowInChunk(pasteOrigin, size, chunkPosition, [&](glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length) {
+            ASSERT_LE(chunkIndex % SPIRE_VOXEL_CHUNK_SIZE + length, SPIRE_VOXEL_CHUNK_SIZE); // rows never wrap
+            std::copy_n(region.GetVoxels().data() + regionIndex, length, voxels.data() + chunkIndex);
+            written += length;
+        });
+    }
+    EXPECT_EQ(written, region.GetVolume());
+    for (glm::u32 x = 0; x < size.x; x++) {
+        for (glm::u32 y = 0; y < size.y; y++) {
+            for (glm::u32 z = 0; z < size.z; z++) {
+                ASSERT_EQ(GetWorldVoxel(pasted, pasteOrigin + glm::ivec3(x, y, z)), region.GetVoxel({x, y, z}));
+            }
+        }
+    }
+}
+
+TEST(VoxelRegionTests, TestLargeRegion) {
+    ChunkVoxels voxels;
+    std::mt19937 random(256);
+    std::uniform_int_distribution<glm::u32> type(0, 3);
+    for (VoxelType &voxel : voxels) voxel = static_cast<VoxelType>(type(random));
+
+    // 256^3 starting halfway through a chunk, every chunk has the same voxels
+    glm::ivec3 origin = {-32, 32, 5};
+    glm::uvec3 size = glm::uvec3(256);
+    std::vector<glm::ivec3> chunks = VoxelRegion::GetChunksInBox(origin, size);
+
+    Spire::Timer timer;
+    VoxelRegion region(size);
+    for (const glm::ivec3 &chunkPosition : chunks) region.CopyFromChunk(origin, chunkPosition, voxels);
+    float copyTime = timer.MillisSinceStart();
+
+    timer.Restart();
+    VoxelRegion rotated = region.Rotated(1, 1);
+    float rotateTime = timer.MillisSinceStart();
+
+    timer.Restart();
+    ChunkVoxels destination = {};
+    std::size_t written = 0;
+    for (const glm::ivec3 &chunkPosition : chunks) {
+        VoxelRegion::ForEachRowInChunk(origin, rotated.GetSize(), chunkPosition, [&](glm::u32 chunkIndex, std::size_t regionIndex, glm::u32 length) {
+            std::copy_n(rotated.GetVoxels().data() + regionIndex, length, destination.data() + chunkIndex);
+            written += length;
+        });
+    }
+    float pasteTime = timer.MillisSinceStart();
+
+    Spire::info("256^3 region: copied in {} ms, rotated in {} ms, rows pasted in {} ms", copyTime, rotateTime, pasteTime);
+    EXPECT_EQ(written, region.GetVolume());
+    EXPECT_EQ(rotated.GetVoxel({0, 10, 255}), region.GetVoxel({0, 10, 0}));
+}